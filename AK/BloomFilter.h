@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Types.h>
+
+namespace AK {
+
+// A fixed-size bloom filter over precomputed hashes.
+// Each hash sets two bits, one from its low half and one from its high half.
+template<size_t bit_count>
+class BloomFilter {
+    static_assert(bit_count > 0 && (bit_count & (bit_count - 1)) == 0, "BloomFilter size must be a power of two");
+    static_assert(bit_count <= 65536);
+
+public:
+    void add(unsigned hash)
+    {
+        set_bit(hash & bit_mask);
+        set_bit((hash >> 16) & bit_mask);
+    }
+
+    // May return true for hashes that were never added, but never returns false for ones that were.
+    bool may_contain(unsigned hash) const
+    {
+        return test_bit(hash & bit_mask) && test_bit((hash >> 16) & bit_mask);
+    }
+
+    void clear() { m_words.fill(0); }
+
+private:
+    static constexpr unsigned bit_mask = bit_count - 1;
+
+    void set_bit(unsigned bit) { m_words[bit / 32] |= 1u << (bit % 32); }
+    bool test_bit(unsigned bit) const { return m_words[bit / 32] & (1u << (bit % 32)); }
+
+    Array<u32, (bit_count + 31) / 32> m_words {};
+};
+
+}
+
+using AK::BloomFilter;
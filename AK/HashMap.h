@@ -57,6 +57,8 @@ public:
 
     HashSetResult set(const K& key, const V& value) { return m_table.set({ key, value }); }
     HashSetResult set(const K& key, V&& value) { return m_table.set({ key, move(value) }); }
+    [[nodiscard]] bool try_set(const K& key, const V& value) { return m_table.try_set({ key, value }); }
+    [[nodiscard]] bool try_set(const K& key, V&& value) { return m_table.try_set({ key, move(value) }); }
     bool remove(const K& key)
     {
         auto it = find(key);
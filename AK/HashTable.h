@@ -252,33 +252,17 @@ public:
     template<typename U = T>
     HashSetResult set(U&& value, HashSetExistingEntryBehavior existing_entry_behaviour = HashSetExistingEntryBehavior::Replace)
     {
-        auto& bucket = lookup_for_writing(value);
-        if (bucket.used) {
-            if (existing_entry_behaviour == HashSetExistingEntryBehavior::Keep)
-                return HashSetResult::KeptExistingEntry;
-            (*bucket.slot()) = forward<U>(value);
-            return HashSetResult::ReplacedExistingEntry;
-        }
-
-        new (bucket.slot()) T(forward<U>(value));
-        bucket.used = true;
-        if (bucket.deleted) {
-            bucket.deleted = false;
-            --m_deleted_count;
-        }
-
-        if constexpr (IsOrdered) {
-            if (!m_collection_data.head) [[unlikely]] {
-                m_collection_data.head = &bucket;
-            } else {
-                bucket.previous = m_collection_data.tail;
-                m_collection_data.tail->next = &bucket;
-            }
-            m_collection_data.tail = &bucket;
-        }
+        return write_value(lookup_for_writing(value), forward<U>(value), existing_entry_behaviour);
+    }
 
-        ++m_size;
-        return HashSetResult::InsertedNewEntry;
+    template<typename U = T>
+    [[nodiscard]] bool try_set(U&& value, HashSetExistingEntryBehavior existing_entry_behaviour = HashSetExistingEntryBehavior::Replace)
+    {
+        auto* bucket = try_lookup_for_writing(value);
+        if (!bucket)
+            return false;
+        write_value(*bucket, forward<U>(value), existing_entry_behaviour);
+        return true;
     }
 
     template<typename TUnaryPredicate>
@@ -343,6 +327,37 @@ public:
     }
 
 private:
+    template<typename U>
+    HashSetResult write_value(BucketType& bucket, U&& value, HashSetExistingEntryBehavior existing_entry_behaviour)
+    {
+        if (bucket.used) {
+            if (existing_entry_behaviour == HashSetExistingEntryBehavior::Keep)
+                return HashSetResult::KeptExistingEntry;
+            (*bucket.slot()) = forward<U>(value);
+            return HashSetResult::ReplacedExistingEntry;
+        }
+
+        new (bucket.slot()) T(forward<U>(value));
+        bucket.used = true;
+        if (bucket.deleted) {
+            bucket.deleted = false;
+            --m_deleted_count;
+        }
+
+        if constexpr (IsOrdered) {
+            if (!m_collection_data.head) [[unlikely]] {
+                m_collection_data.head = &bucket;
+            } else {
+                bucket.previous = m_collection_data.tail;
+                m_collection_data.tail->next = &bucket;
+            }
+            m_collection_data.tail = &bucket;
+        }
+
+        ++m_size;
+        return HashSetResult::InsertedNewEntry;
+    }
+
     void insert_during_rehash(T&& value)
     {
         auto& bucket = lookup_for_writing(value);
@@ -370,23 +385,28 @@ private:
     }
 
     void rehash(size_t new_capacity)
+    {
+        auto did_allocate = try_rehash(new_capacity);
+        VERIFY(did_allocate);
+    }
+
+    [[nodiscard]] bool try_rehash(size_t new_capacity)
     {
         new_capacity = max(new_capacity, static_cast<size_t>(4));
         new_capacity = kmalloc_good_size(new_capacity * sizeof(BucketType)) / sizeof(BucketType);
 
+        auto* new_buckets = (BucketType*)kmalloc(size_in_bytes(new_capacity));
+        if (!new_buckets)
+            return false;
+        __builtin_memset(new_buckets, 0, size_in_bytes(new_capacity));
+
         auto* old_buckets = m_buckets;
         auto old_capacity = m_capacity;
         Iterator old_iter = begin();
 
-        if constexpr (IsOrdered) {
-            m_buckets = (BucketType*)kmalloc(size_in_bytes(new_capacity));
-            __builtin_memset(m_buckets, 0, size_in_bytes(new_capacity));
-
+        m_buckets = new_buckets;
+        if constexpr (IsOrdered)
             m_collection_data = { nullptr, nullptr };
-        } else {
-            m_buckets = (BucketType*)kmalloc(size_in_bytes(new_capacity));
-            __builtin_memset(m_buckets, 0, size_in_bytes(new_capacity));
-        }
 
         m_capacity = new_capacity;
         m_deleted_count = 0;
@@ -395,7 +415,7 @@ private:
             m_buckets[m_capacity].end = true;
 
         if (!old_buckets)
-            return;
+            return true;
 
         for (auto it = move(old_iter); it != end(); ++it) {
             insert_during_rehash(move(*it));
@@ -403,6 +423,7 @@ private:
         }
 
         kfree_sized(old_buckets, size_in_bytes(old_capacity));
+        return true;
     }
 
     template<typename TUnaryPredicate>
@@ -426,8 +447,15 @@ private:
 
     [[nodiscard]] BucketType& lookup_for_writing(T const& value)
     {
-        if (should_grow())
-            rehash(capacity() * 2);
+        auto* bucket = try_lookup_for_writing(value);
+        VERIFY(bucket);
+        return *bucket;
+    }
+
+    [[nodiscard]] BucketType* try_lookup_for_writing(T const& value)
+    {
+        if (should_grow() && !try_rehash(capacity() * 2))
+            return nullptr;
 
         auto hash = TraitsForT::hash(value);
         BucketType* first_empty_bucket = nullptr;
@@ -435,14 +463,14 @@ private:
             auto& bucket = m_buckets[hash % m_capacity];
 
             if (bucket.used && TraitsForT::equals(*bucket.slot(), value))
-                return bucket;
+                return &bucket;
 
             if (!bucket.used) {
                 if (!first_empty_bucket)
                     first_empty_bucket = &bucket;
 
                 if (!bucket.deleted)
-                    return *const_cast<BucketType*>(first_empty_bucket);
+                    return const_cast<BucketType*>(first_empty_bucket);
             }
 
             hash = double_hash(hash);
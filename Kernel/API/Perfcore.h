@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// The binary perfcore format.
+//
+// A perfcore starts with the magic and a u32 version, followed by a stream of records.
+// Every record starts with a RecordType byte. All integers after that are unsigned LEB128,
+// and signed deltas are zigzag-encoded first.
+//
+// Strings and stacks are written once and then referred to by their index, which is
+// simply the number of records of the same kind that came before them.
+
+namespace Perfcore {
+
+static constexpr char magic[] = { 'P', 'E', 'R', 'F', 'C', 'O', 'R', 'E' };
+static constexpr u32 version = 1;
+
+enum class RecordType : u8 {
+    // Length, followed by that many bytes of UTF-8.
+    String = 1,
+    // Frame count, followed by each frame address as a delta from the previous one (the first one from 0).
+    Stack = 2,
+    // PERF_EVENT_* type, pid, tid, timestamp delta from the previous event, lost samples,
+    // and stack index + 1 (0 for no stack). Then, depending on the type:
+    //   malloc, kmalloc, kfree, mmap, munmap: ptr, size (mmap: then the name's string index)
+    //   free: ptr
+    //   process_create: parent pid, executable string index
+    //   process_exec: executable string index
+    //   thread_create: parent tid
+    //   context_switch: next pid, next tid
+    //   signpost: arg1 (a string index), arg2
+    Event = 3,
+};
+
+constexpr u64 zigzag_encode(i64 value)
+{
+    return (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63);
+}
+
+constexpr i64 zigzag_decode(u64 value)
+{
+    return static_cast<i64>(value >> 1) ^ -static_cast<i64>(value & 1);
+}
+
+}
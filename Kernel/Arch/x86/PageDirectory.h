@@ -22,6 +22,14 @@ public:
         m_raw |= PhysicalAddress::physical_page_base(value);
     }
 
+    // When is_huge() is set, this entry maps a 2 MiB large page directly instead of pointing to a page table.
+    PhysicalPtr large_page_base() const { return m_raw & 0x000fffffffe00000ULL; }
+    void set_large_page_base(PhysicalPtr value)
+    {
+        m_raw &= 0x8000000000000fffULL;
+        m_raw |= value & 0x000fffffffe00000ULL;
+    }
+
     bool is_null() const { return m_raw == 0; }
     void clear() { m_raw = 0; }
 
@@ -22,6 +22,8 @@ public:
 
     virtual KResultOr<Memory::Region*> mmap(Process&, FileDescription&, Memory::VirtualRange const&, u64 offset, int prot, bool shared) override;
 
+    virtual bool is_anonymous_file() const override { return true; }
+
 private:
     virtual StringView class_name() const override { return "AnonymousFile"; }
     virtual String absolute_path(const FileDescription&) const override { return ":anonymous-file:"; }
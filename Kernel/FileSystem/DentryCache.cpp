@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/DentryCache.h>
+#include <Kernel/FileSystem/FileSystem.h>
+#include <Kernel/FileSystem/Inode.h>
+
+namespace Kernel {
+
+DentryCache::DentryCache()
+{
+    m_table.ensure_capacity(capacity);
+}
+
+DentryCache::~DentryCache()
+{
+    invalidate_all();
+}
+
+bool DentryCache::can_cache_lookups_in(Custody const& parent)
+{
+    return parent.inode().fs().supports_watchers();
+}
+
+unsigned DentryCache::hash_for(InodeIdentifier directory, StringView name)
+{
+    auto directory_hash = pair_int_hash(directory.fsid(), directory.index().value());
+    return pair_int_hash(directory_hash, name.hash());
+}
+
+DentryCache::LookupResult DentryCache::lookup(Custody& parent, StringView name, RefPtr<Custody>& child, u64& generation)
+{
+    auto hash = hash_for(parent.inode().identifier(), name);
+
+    MutexLocker locker(m_lock);
+    auto it = m_table.find(hash, [&](auto* entry) {
+        return entry->parent.ptr() == &parent && entry->name->view() == name;
+    });
+    if (it == m_table.end()) {
+        ++m_statistics.misses;
+        generation = m_generation;
+        return LookupResult::Miss;
+    }
+
+    auto& entry = **it;
+    m_lru_list.remove(entry);
+    m_lru_list.append(entry);
+
+    if (!entry.child) {
+        ++m_statistics.negative_hits;
+        return LookupResult::NegativeHit;
+    }
+    ++m_statistics.hits;
+    child = entry.child;
+    return LookupResult::Hit;
+}
+
+void DentryCache::add(Custody& parent, StringView name, Custody& child, u64 generation)
+{
+    add_entry(parent, name, &child, generation);
+}
+
+void DentryCache::add_negative(Custody& parent, StringView name, u64 generation)
+{
+    add_entry(parent, name, nullptr, generation);
+}
+
+void DentryCache::add_entry(Custody& parent, StringView name, Custody* child, u64 generation)
+{
+    auto entry_name = KString::try_create(name);
+    if (!entry_name)
+        return;
+    auto* new_entry = new (nothrow) Entry {
+        .parent = parent,
+        .parent_identifier = parent.inode().identifier(),
+        .name = entry_name.release_nonnull(),
+        .child = child,
+        .hash = hash_for(parent.inode().identifier(), name),
+        .list_node = {},
+    };
+    if (!new_entry)
+        return;
+
+    Entry::List doomed;
+    {
+        MutexLocker locker(m_lock);
+        bool is_stale = generation != m_generation;
+        bool is_duplicate = m_table.find(new_entry->hash, [&](auto* entry) {
+            return entry->parent.ptr() == &parent && entry->name->view() == name;
+        }) != m_table.end();
+        if (is_stale || is_duplicate) {
+            doomed.append(*new_entry);
+        } else {
+            if (m_statistics.entries == capacity) {
+                remove_entry_locked(*m_lru_list.first(), doomed);
+                ++m_statistics.evictions;
+            }
+            m_table.set(new_entry);
+            m_lru_list.append(*new_entry);
+            ++m_statistics.entries;
+        }
+    }
+    destroy_entries(doomed);
+}
+
+void DentryCache::invalidate(InodeIdentifier directory, StringView name)
+{
+    auto hash = hash_for(directory, name);
+
+    Entry::List doomed;
+    {
+        MutexLocker locker(m_lock);
+        ++m_generation;
+        for (;;) {
+            auto it = m_table.find(hash, [&](auto* entry) {
+                return entry->parent_identifier == directory && entry->name->view() == name;
+            });
+            if (it == m_table.end())
+                break;
+            remove_entry_locked(**it, doomed);
+            ++m_statistics.invalidations;
+        }
+    }
+    destroy_entries(doomed);
+}
+
+void DentryCache::invalidate_directory(InodeIdentifier directory)
+{
+    Entry::List doomed;
+    {
+        MutexLocker locker(m_lock);
+        ++m_generation;
+        for (auto it = m_lru_list.begin(); it != m_lru_list.end();) {
+            auto& entry = *it;
+            ++it;
+            if (entry.parent_identifier != directory)
+                continue;
+            remove_entry_locked(entry, doomed);
+            ++m_statistics.invalidations;
+        }
+    }
+    destroy_entries(doomed);
+}
+
+void DentryCache::invalidate_all()
+{
+    Entry::List doomed;
+    {
+        MutexLocker locker(m_lock);
+        ++m_generation;
+        while (auto* entry = m_lru_list.first()) {
+            remove_entry_locked(*entry, doomed);
+            ++m_statistics.invalidations;
+        }
+    }
+    destroy_entries(doomed);
+}
+
+DentryCache::Statistics DentryCache::statistics() const
+{
+    MutexLocker locker(m_lock);
+    return m_statistics;
+}
+
+void DentryCache::remove_entry_locked(Entry& entry, Entry::List& doomed)
+{
+    VERIFY(m_lock.is_locked());
+    m_table.remove(&entry);
+    m_lru_list.remove(entry);
+    doomed.append(entry);
+    --m_statistics.entries;
+}
+
+void DentryCache::destroy_entries(Entry::List& doomed)
+{
+    // Dropping the last reference to a Custody takes the global custody list lock,
+    // and dropping an Inode may hit the disk, so none of this happens under m_lock.
+    while (auto* entry = doomed.take_first())
+        delete entry;
+}
+
+}
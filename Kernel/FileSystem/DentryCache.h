@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashTable.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/StringView.h>
+#include <Kernel/FileSystem/InodeIdentifier.h>
+#include <Kernel/Forward.h>
+#include <Kernel/KString.h>
+#include <Kernel/Locking/Mutex.h>
+
+namespace Kernel {
+
+// Remembers the outcome of looking up a name in a directory during path resolution,
+// including names that turned out not to exist.
+//
+// Only directories whose file system reports child changes via Inode::did_add_child()
+// and Inode::did_remove_child() are cached, since those hooks are what keep it honest.
+class DentryCache {
+    AK_MAKE_NONCOPYABLE(DentryCache);
+    AK_MAKE_NONMOVABLE(DentryCache);
+
+public:
+    static constexpr size_t capacity = 4096;
+
+    enum class LookupResult {
+        Miss,
+        Hit,
+        NegativeHit,
+    };
+
+    struct Statistics {
+        u64 hits { 0 };
+        u64 negative_hits { 0 };
+        u64 misses { 0 };
+        u64 invalidations { 0 };
+        u64 evictions { 0 };
+        size_t entries { 0 };
+    };
+
+    DentryCache();
+    ~DentryCache();
+
+    static bool can_cache_lookups_in(Custody const& parent);
+
+    // On a miss, `generation` is set to a token that has to be passed back to add() or add_negative().
+    // If anything was invalidated in the meantime, the result of the lookup is not recorded.
+    LookupResult lookup(Custody& parent, StringView name, RefPtr<Custody>& child, u64& generation);
+    void add(Custody& parent, StringView name, Custody& child, u64 generation);
+    void add_negative(Custody& parent, StringView name, u64 generation);
+
+    void invalidate(InodeIdentifier directory, StringView name);
+    void invalidate_directory(InodeIdentifier directory);
+    void invalidate_all();
+
+    Statistics statistics() const;
+
+private:
+    struct Entry {
+        NonnullRefPtr<Custody> parent;
+        InodeIdentifier parent_identifier;
+        NonnullOwnPtr<KString> name;
+        RefPtr<Custody> child;
+        unsigned hash { 0 };
+        IntrusiveListNode<Entry> list_node;
+
+        using List = IntrusiveList<Entry, RawPtr<Entry>, &Entry::list_node>;
+    };
+
+    struct EntryTraits : public GenericTraits<Entry*> {
+        static unsigned hash(Entry const* entry) { return entry->hash; }
+        static bool equals(Entry const* a, Entry const* b) { return a == b; }
+    };
+
+    static unsigned hash_for(InodeIdentifier directory, StringView name);
+
+    void add_entry(Custody& parent, StringView name, Custody* child, u64 generation);
+    void remove_entry_locked(Entry&, Entry::List& doomed);
+    static void destroy_entries(Entry::List& doomed);
+
+    mutable Mutex m_lock { "DentryCache" };
+    HashTable<Entry*, EntryTraits> m_table;
+    // Least recently used entries are at the front.
+    Entry::List m_lru_list;
+    u64 m_generation { 0 };
+    Statistics m_statistics;
+};
+
+}
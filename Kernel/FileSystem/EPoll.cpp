@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+static BlockFlags block_flags_from_epoll_events(u32 events)
+{
+    auto block_flags = BlockFlags::None;
+    if (events & EPOLLIN)
+        block_flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        block_flags |= BlockFlags::Write;
+    if (events & EPOLLPRI)
+        block_flags |= BlockFlags::ReadPriority;
+    return block_flags;
+}
+
+static u32 epoll_events_from_block_flags(BlockFlags block_flags)
+{
+    u32 events = 0;
+    if (has_flag(block_flags, BlockFlags::Read))
+        events |= EPOLLIN;
+    if (has_flag(block_flags, BlockFlags::Write))
+        events |= EPOLLOUT;
+    if (has_flag(block_flags, BlockFlags::ReadPriority))
+        events |= EPOLLPRI;
+    if (has_flag(block_flags, BlockFlags::ReadHangUp))
+        events |= EPOLLRDHUP;
+    if (has_flag(block_flags, BlockFlags::WriteError))
+        events |= EPOLLERR;
+    if (has_flag(block_flags, BlockFlags::WriteHangUp))
+        events |= EPOLLHUP;
+    return events;
+}
+
+void FileBlockerSet::add_epoll_watch(EPollWatch& watch)
+{
+    SpinlockLocker lock(m_lock);
+    m_epoll_watches.append(watch);
+}
+
+void FileBlockerSet::remove_epoll_watch(EPollWatch& watch)
+{
+    SpinlockLocker lock(m_lock);
+    if (watch.blocker_set_list_node.is_in_list())
+        m_epoll_watches.remove(watch);
+}
+
+void FileBlockerSet::remove_epoll_watches_for(FileDescription& description)
+{
+    for (;;) {
+        EPollWatch* watch = nullptr;
+        RefPtr<EPoll> epoll;
+        {
+            SpinlockLocker lock(m_lock);
+            for (auto& it : m_epoll_watches) {
+                if (&it.description == &description) {
+                    watch = &it;
+                    break;
+                }
+            }
+            if (!watch)
+                return;
+            m_epoll_watches.remove(*watch);
+            // If the EPoll is already being torn down, its destructor owns the watch.
+            if (watch->epoll.try_ref())
+                epoll = adopt_ref(watch->epoll);
+        }
+        if (epoll)
+            epoll->forget_watch({}, *watch);
+    }
+}
+
+void FileBlockerSet::notify_epoll_watches_locked()
+{
+    VERIFY(m_lock.is_locked());
+    for (auto& watch : m_epoll_watches)
+        watch.epoll.notify_watch_ready({}, watch);
+}
+
+KResultOr<NonnullRefPtr<EPoll>> EPoll::create()
+{
+    auto epoll = adopt_ref_if_nonnull(new (nothrow) EPoll);
+    if (epoll)
+        return epoll.release_nonnull();
+    return ENOMEM;
+}
+
+EPoll::~EPoll()
+{
+    MutexLocker locker(m_lock);
+    for (auto& it : m_watches)
+        it.value->file->blocker_set().remove_epoll_watch(*it.value);
+
+    SpinlockLocker lock(m_ready_lock);
+    m_ready_list.clear();
+}
+
+bool EPoll::can_read(const FileDescription&, size_t) const
+{
+    SpinlockLocker lock(m_ready_lock);
+    return !m_ready_list.is_empty();
+}
+
+KResult EPoll::add_watch(int fd, FileDescription& description, epoll_event const& event)
+{
+    // FIXME: Support nesting EPolls.
+    if (description.is_epoll())
+        return EINVAL;
+
+    MutexLocker locker(m_lock);
+    if (auto it = m_watches.find(fd); it != m_watches.end()) {
+        if (&it->value->description == &description)
+            return EEXIST;
+        // The fd was closed and reused while its old description is still open elsewhere.
+        // That watch can no longer be reached through this fd, so replace it.
+        auto& stale_watch = *it->value;
+        stale_watch.file->blocker_set().remove_epoll_watch(stale_watch);
+        {
+            SpinlockLocker lock(m_ready_lock);
+            if (stale_watch.ready_list_node.is_in_list())
+                m_ready_list.remove(stale_watch);
+        }
+        m_watches.remove(it);
+    }
+
+    auto watch = adopt_own_if_nonnull(new (nothrow) EPollWatch(*this, description, description.file(), fd, event));
+    if (!watch)
+        return ENOMEM;
+
+    auto& watch_ref = *watch;
+    m_watches.set(fd, watch.release_nonnull());
+    description.blocker_set().add_epoll_watch(watch_ref);
+
+    // The file may already be ready, in which case no readiness change will ever tell us about it.
+    queue_watch(watch_ref);
+    return KSuccess;
+}
+
+KResult EPoll::modify_watch(int fd, FileDescription& description, epoll_event const& event)
+{
+    MutexLocker locker(m_lock);
+    auto it = m_watches.find(fd);
+    if (it == m_watches.end() || &it->value->description != &description)
+        return ENOENT;
+
+    auto& watch = *it->value;
+    {
+        SpinlockLocker lock(m_ready_lock);
+        watch.event = event;
+        watch.is_disabled = false;
+    }
+    queue_watch(watch);
+    return KSuccess;
+}
+
+KResult EPoll::remove_watch(int fd, FileDescription& description)
+{
+    MutexLocker locker(m_lock);
+    auto it = m_watches.find(fd);
+    if (it == m_watches.end() || &it->value->description != &description)
+        return ENOENT;
+
+    auto& watch = *it->value;
+    watch.file->blocker_set().remove_epoll_watch(watch);
+    {
+        SpinlockLocker lock(m_ready_lock);
+        if (watch.ready_list_node.is_in_list())
+            m_ready_list.remove(watch);
+    }
+    m_watches.remove(it);
+    return KSuccess;
+}
+
+void EPoll::forget_watch(Badge<FileBlockerSet>, EPollWatch& watch)
+{
+    MutexLocker locker(m_lock);
+    {
+        SpinlockLocker lock(m_ready_lock);
+        if (watch.ready_list_node.is_in_list())
+            m_ready_list.remove(watch);
+    }
+    auto it = m_watches.find(watch.fd);
+    VERIFY(it != m_watches.end() && it->value.ptr() == &watch);
+    m_watches.remove(it);
+}
+
+void EPoll::notify_watch_ready(Badge<FileBlockerSet>, EPollWatch& watch)
+{
+    queue_watch(watch);
+}
+
+void EPoll::queue_watch(EPollWatch& watch)
+{
+    {
+        SpinlockLocker lock(m_ready_lock);
+        if (watch.is_disabled || watch.ready_list_node.is_in_list())
+            return;
+        m_ready_list.append(watch);
+    }
+    evaluate_block_conditions();
+}
+
+size_t EPoll::collect_ready_events(Span<epoll_event> events)
+{
+    SpinlockLocker lock(m_ready_lock);
+
+    // Watches are only queued when their file's state changed, so we still
+    // have to ask the file whether the events we care about are there.
+    EPollWatch::ReadyList still_ready_list;
+    size_t count = 0;
+    while (count < events.size()) {
+        auto* watch = m_ready_list.take_first();
+        if (!watch)
+            break;
+        auto ready_flags = watch->description.should_unblock(block_flags_from_epoll_events(watch->event.events));
+        if (ready_flags == BlockFlags::None)
+            continue;
+
+        events[count++] = { epoll_events_from_block_flags(ready_flags), watch->event.data };
+
+        if (watch->event.events & EPOLLONESHOT)
+            watch->is_disabled = true;
+        else if (!(watch->event.events & EPOLLET))
+            still_ready_list.append(*watch);
+    }
+
+    // Level-triggered watches stay queued until a later wait finds them no longer ready.
+    while (auto* watch = still_ready_list.take_first())
+        m_ready_list.append(*watch);
+    return count;
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Span.h>
+#include <Kernel/FileSystem/EPollWatch.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Locking/Mutex.h>
+#include <Kernel/Locking/Spinlock.h>
+
+namespace Kernel {
+
+// A persistent interest set of file descriptors, as used by epoll(7).
+//
+// Unlike select() and poll(), the set of watched descriptors is kept in the
+// kernel between calls. Readiness changes on a watched file queue its watch
+// on the ready list, so waiting only costs as much as the number of
+// descriptors that actually became ready.
+class EPoll final : public File {
+public:
+    static KResultOr<NonnullRefPtr<EPoll>> create();
+    virtual ~EPoll() override;
+
+    // The EPoll itself becomes readable when there are watches on its ready list.
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EINVAL; }
+
+    virtual String absolute_path(const FileDescription&) const override { return "epoll"; }
+    virtual StringView class_name() const override { return "EPoll"; }
+    virtual bool is_epoll() const override { return true; }
+
+    KResult add_watch(int fd, FileDescription&, epoll_event const&);
+    KResult modify_watch(int fd, FileDescription&, epoll_event const&);
+    KResult remove_watch(int fd, FileDescription&);
+
+    // Fills `events` with the watches that are currently ready and returns how many were filled in.
+    size_t collect_ready_events(Span<epoll_event> events);
+
+    void notify_watch_ready(Badge<FileBlockerSet>, EPollWatch&);
+    void forget_watch(Badge<FileBlockerSet>, EPollWatch&);
+
+private:
+    EPoll() = default;
+
+    void queue_watch(EPollWatch&);
+
+    Mutex m_lock { "EPoll" };
+    HashMap<int, NonnullOwnPtr<EPollWatch>> m_watches;
+
+    mutable Spinlock<u8> m_ready_lock;
+    EPollWatch::ReadyList m_ready_list;
+};
+
+}
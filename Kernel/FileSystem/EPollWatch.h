@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullRefPtr.h>
+#include <Kernel/Forward.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+// One entry in the interest set of an EPoll.
+//
+// A watch is linked into the FileBlockerSet of the file it watches, so that
+// a readiness change on that file queues exactly this watch on its EPoll's
+// ready list. The EPoll owns the watch; the raw description pointer is kept
+// valid by the FileDescription destructor, which unregisters its watches.
+struct EPollWatch {
+    EPollWatch(EPoll& epoll, FileDescription& description, NonnullRefPtr<File> file, int fd, epoll_event const& event)
+        : epoll(epoll)
+        , description(description)
+        , file(move(file))
+        , fd(fd)
+        , event(event)
+    {
+    }
+
+    EPoll& epoll;
+    FileDescription& description;
+    NonnullRefPtr<File> file;
+    int fd { -1 };
+
+    // These are protected by the owning EPoll's ready list lock.
+    epoll_event event {};
+    bool is_disabled { false };
+
+    IntrusiveListNode<EPollWatch> blocker_set_list_node;
+    IntrusiveListNode<EPollWatch> ready_list_node;
+
+    using BlockerSetList = IntrusiveList<EPollWatch, RawPtr<EPollWatch>, &EPollWatch::blocker_set_list_node>;
+    using ReadyList = IntrusiveList<EPollWatch, RawPtr<EPollWatch>, &EPollWatch::ready_list_node>;
+};
+
+}
@@ -12,6 +12,7 @@
 #include <AK/Types.h>
 #include <AK/Weakable.h>
 #include <Kernel/Forward.h>
+#include <Kernel/FileSystem/EPollWatch.h>
 #include <Kernel/KResult.h>
 #include <Kernel/UnixTypes.h>
 #include <Kernel/UserOrKernelBuffer.h>
@@ -40,7 +41,18 @@ public:
             auto& blocker = static_cast<Thread::FileBlocker&>(b);
             return blocker.unblock(false, data);
         });
+        if (!m_epoll_watches.is_empty())
+            notify_epoll_watches_locked();
     }
+
+    void add_epoll_watch(EPollWatch&);
+    void remove_epoll_watch(EPollWatch&);
+    void remove_epoll_watches_for(FileDescription&);
+
+private:
+    void notify_epoll_watches_locked();
+
+    EPollWatch::BlockerSetList m_epoll_watches;
 };
 
 // File is the base class for anything that can be referenced by a FileDescription.
@@ -111,6 +123,8 @@ public:
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
     virtual bool is_inode_watcher() const { return false; }
+    virtual bool is_epoll() const { return false; }
+    virtual bool is_anonymous_file() const { return false; }
 
     virtual FileBlockerSet& blocker_set() { return m_blocker_set; }
 
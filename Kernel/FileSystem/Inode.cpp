@@ -211,6 +211,8 @@ void Inode::set_metadata_dirty(bool metadata_dirty)
 
 void Inode::did_add_child(InodeIdentifier const&, String const& name)
 {
+    VirtualFileSystem::the().dentry_cache().invalidate(identifier(), name);
+
     MutexLocker locker(m_inode_lock);
 
     for (auto& watcher : m_watchers) {
@@ -220,6 +222,14 @@ void Inode::did_add_child(InodeIdentifier const&, String const& name)
 
 void Inode::did_remove_child(InodeIdentifier const&, String const& name)
 {
+    auto& dentry_cache = VirtualFileSystem::the().dentry_cache();
+    if (name == ".") {
+        // A directory only loses "." when it's being removed, so nothing in it can be looked up anymore.
+        dentry_cache.invalidate_directory(identifier());
+    } else {
+        dentry_cache.invalidate(identifier(), name);
+    }
+
     MutexLocker locker(m_inode_lock);
 
     if (name == "." || name == "..") {
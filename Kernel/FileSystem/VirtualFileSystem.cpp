@@ -62,6 +62,7 @@ KResult VirtualFileSystem::mount(FileSystem& fs, Custody& mount_point, int flags
         // FIXME: check that this is not already a mount point
         Mount mount { fs, &mount_point, flags };
         mounts.append(move(mount));
+        m_dentry_cache.invalidate_all();
         return KSuccess;
     });
 }
@@ -73,6 +74,7 @@ KResult VirtualFileSystem::bind_mount(Custody& source, Custody& mount_point, int
         // FIXME: check that this is not already a mount point
         Mount mount { source.inode(), mount_point, flags };
         mounts.append(move(mount));
+        m_dentry_cache.invalidate_all();
         return KSuccess;
     });
 }
@@ -86,6 +88,8 @@ KResult VirtualFileSystem::remount(Custody& mount_point, int new_flags)
         return ENODEV;
 
     mount->set_flags(new_flags);
+    // Cached custodies carry the mount flags they were created with.
+    m_dentry_cache.invalidate_all();
     return KSuccess;
 }
 
@@ -98,6 +102,8 @@ KResult VirtualFileSystem::unmount(Inode& guest_inode)
             auto& mount = mounts[i];
             if (&mount.guest() != &guest_inode)
                 continue;
+            // The cache holds references to inodes on every file system, which would keep this one busy.
+            m_dentry_cache.invalidate_all();
             if (auto result = mount.guest_fs().prepare_to_unmount(); result.is_error()) {
                 dbgln("VirtualFileSystem: Failed to unmount!");
                 return result;
@@ -973,32 +979,56 @@ KResultOr<NonnullRefPtr<Custody>> VirtualFileSystem::resolve_path_without_veil(S
         }
 
         // Okay, let's look up this part.
-        auto child_or_error = parent.inode().lookup(part);
-        if (child_or_error.is_error()) {
+        bool can_use_dentry_cache = DentryCache::can_cache_lookups_in(parent);
+        auto cache_result = DentryCache::LookupResult::Miss;
+        RefPtr<Custody> cached_custody;
+        u64 cache_generation = 0;
+        if (can_use_dentry_cache)
+            cache_result = m_dentry_cache.lookup(parent, part, cached_custody, cache_generation);
+
+        auto report_lookup_failure = [&](KResult error) {
             if (out_parent) {
                 // ENOENT with a non-null parent custody signals to caller that
                 // we found the immediate parent of the file, but the file itself
                 // does not exist yet.
                 *out_parent = have_more_parts ? nullptr : &parent;
             }
-            return child_or_error.error();
-        }
-        auto child_inode = child_or_error.release_value();
+            return error;
+        };
 
-        int mount_flags_for_child = parent.mount_flags();
+        if (cache_result == DentryCache::LookupResult::NegativeHit)
+            return report_lookup_failure(ENOENT);
 
-        // See if there's something mounted on the child; in that case
-        // we would need to return the guest inode, not the host inode.
-        if (auto mount = find_mount_for_host(child_inode->identifier())) {
-            child_inode = mount->guest();
-            mount_flags_for_child = mount->flags();
-        }
+        if (cache_result == DentryCache::LookupResult::Hit) {
+            custody = cached_custody.release_nonnull();
+        } else {
+            auto child_or_error = parent.inode().lookup(part);
+            if (child_or_error.is_error()) {
+                if (can_use_dentry_cache && child_or_error.error() == ENOENT)
+                    m_dentry_cache.add_negative(parent, part, cache_generation);
+                return report_lookup_failure(child_or_error.error());
+            }
+            auto found_inode = child_or_error.release_value();
 
-        auto new_custody_or_error = Custody::try_create(&parent, part, *child_inode, mount_flags_for_child);
-        if (new_custody_or_error.is_error())
-            return new_custody_or_error.error();
+            int mount_flags_for_child = parent.mount_flags();
+
+            // See if there's something mounted on the child; in that case
+            // we would need to return the guest inode, not the host inode.
+            if (auto mount = find_mount_for_host(found_inode->identifier())) {
+                found_inode = mount->guest();
+                mount_flags_for_child = mount->flags();
+            }
+
+            auto new_custody_or_error = Custody::try_create(&parent, part, *found_inode, mount_flags_for_child);
+            if (new_custody_or_error.is_error())
+                return new_custody_or_error.error();
+
+            custody = new_custody_or_error.release_value();
+            if (can_use_dentry_cache)
+                m_dentry_cache.add(parent, part, custody, cache_generation);
+        }
 
-        custody = new_custody_or_error.release_value();
+        NonnullRefPtr<Inode> child_inode = custody->inode();
 
         if (child_inode->metadata().is_symlink()) {
             if (!have_more_parts) {
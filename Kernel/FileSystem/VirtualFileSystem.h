@@ -13,6 +13,7 @@
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
 #include <AK/String.h>
+#include <Kernel/FileSystem/DentryCache.h>
 #include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/FileSystem/InodeIdentifier.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
@@ -73,6 +74,7 @@ public:
     static void sync();
 
     Custody& root_custody();
+    DentryCache& dentry_cache() { return m_dentry_cache; }
     KResultOr<NonnullRefPtr<Custody>> resolve_path(StringView path, Custody& base, RefPtr<Custody>* out_parent = nullptr, int options = 0, int symlink_recursion_level = 0);
     KResultOr<NonnullRefPtr<Custody>> resolve_path_without_veil(StringView path, Custody& base, RefPtr<Custody>* out_parent = nullptr, int options = 0, int symlink_recursion_level = 0);
 
@@ -94,6 +96,8 @@ private:
     RefPtr<Custody> m_root_custody;
 
     MutexProtected<Vector<Mount, 16>> m_mounts;
+
+    DentryCache m_dentry_cache;
 };
 
 }
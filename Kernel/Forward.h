@@ -23,6 +23,7 @@ class DevFSRootDirectoryInode;
 class Device;
 class DiskCache;
 class DoubleBuffer;
+class EPoll;
 class File;
 class FileDescription;
 class FileSystem;
@@ -91,6 +92,7 @@ class SpinlockLocker;
 template<typename T>
 class KResultOr;
 
+struct EPollWatch;
 struct InodeMetadata;
 struct TrapFrame;
 
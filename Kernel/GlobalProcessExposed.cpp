@@ -16,6 +16,7 @@
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/Interrupts/GenericInterruptHandler.h>
 #include <Kernel/Interrupts/InterruptManagement.h>
@@ -109,6 +110,16 @@ private:
             obj.add("bytes_in", socket.bytes_in());
             obj.add("packets_out", socket.packets_out());
             obj.add("bytes_out", socket.bytes_out());
+            obj.add("retransmitted_packets", socket.retransmitted_packets());
+            obj.add("mss", socket.maximum_segment_size());
+            obj.add("congestion_window", socket.congestion_window());
+            obj.add("slow_start_threshold", socket.slow_start_threshold());
+            obj.add("send_window", socket.send_window_size());
+            obj.add("window_scaling", socket.has_window_scaling());
+            obj.add("selective_acks", socket.has_selective_acks());
+            obj.add("smoothed_rtt_us", socket.smoothed_rtt_us());
+            obj.add("rtt_variance_us", socket.rtt_variance_us());
+            obj.add("retransmit_timeout_us", socket.retransmit_timeout_us());
             if (Process::current().is_superuser() || Process::current().uid() == socket.origin_uid()) {
                 obj.add("origin_pid", socket.origin_pid().value());
                 obj.add("origin_uid", socket.origin_uid().value());
@@ -410,6 +421,29 @@ private:
     }
 };
 
+class ProcFSDentryCache final : public ProcFSGlobalInformation {
+public:
+    static NonnullRefPtr<ProcFSDentryCache> must_create();
+
+private:
+    ProcFSDentryCache();
+    virtual bool output(KBufferBuilder& builder) override
+    {
+        auto statistics = VirtualFileSystem::the().dentry_cache().statistics();
+
+        JsonObjectSerializer<KBufferBuilder> json { builder };
+        json.add("hits", statistics.hits);
+        json.add("negative_hits", statistics.negative_hits);
+        json.add("misses", statistics.misses);
+        json.add("invalidations", statistics.invalidations);
+        json.add("evictions", statistics.evictions);
+        json.add("entries", statistics.entries);
+        json.add("capacity", DentryCache::capacity);
+        json.finish();
+        return true;
+    }
+};
+
 class ProcFSOverallProcesses final : public ProcFSGlobalInformation {
 public:
     static NonnullRefPtr<ProcFSOverallProcesses> must_create();
@@ -470,6 +504,8 @@ private:
             process_object.add("amount_shared", process.address_space().amount_shared());
             process_object.add("amount_purgeable_volatile", process.address_space().amount_purgeable_volatile());
             process_object.add("amount_purgeable_nonvolatile", process.address_space().amount_purgeable_nonvolatile());
+            process_object.add("amount_large_pages", process.address_space().amount_large_pages());
+            process_object.add("large_page_splits", process.address_space().large_page_splits());
             process_object.add("dumpable", process.is_dumpable());
             process_object.add("kernel", process.is_kernel_process());
             auto thread_array = process_object.add_array("threads");
@@ -491,6 +527,7 @@ private:
                 thread_object.add("inode_faults", thread.inode_faults());
                 thread_object.add("zero_faults", thread.zero_faults());
                 thread_object.add("cow_faults", thread.cow_faults());
+                thread_object.add("large_page_faults", thread.large_page_faults());
                 thread_object.add("file_read_bytes", thread.file_read_bytes());
                 thread_object.add("file_write_bytes", thread.file_write_bytes());
                 thread_object.add("unix_socket_read_bytes", thread.unix_socket_read_bytes());
@@ -722,7 +759,7 @@ private:
         if (!g_global_perf_events)
             return false;
 
-        return g_global_perf_events->to_json(builder);
+        return !g_global_perf_events->to_binary(builder).is_error();
     }
 };
 
@@ -756,6 +793,10 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSMemoryStatus> ProcFSMemoryStatus::must_crea
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSMemoryStatus).release_nonnull();
 }
+UNMAP_AFTER_INIT NonnullRefPtr<ProcFSDentryCache> ProcFSDentryCache::must_create()
+{
+    return adopt_ref_if_nonnull(new (nothrow) ProcFSDentryCache).release_nonnull();
+}
 UNMAP_AFTER_INIT NonnullRefPtr<ProcFSOverallProcesses> ProcFSOverallProcesses::must_create()
 {
     return adopt_ref_if_nonnull(new (nothrow) ProcFSOverallProcesses).release_nonnull();
@@ -818,6 +859,10 @@ UNMAP_AFTER_INIT ProcFSMemoryStatus::ProcFSMemoryStatus()
     : ProcFSGlobalInformation("memstat"sv)
 {
 }
+UNMAP_AFTER_INIT ProcFSDentryCache::ProcFSDentryCache()
+    : ProcFSGlobalInformation("dentrycache"sv)
+{
+}
 UNMAP_AFTER_INIT ProcFSOverallProcesses::ProcFSOverallProcesses()
     : ProcFSGlobalInformation("all"sv)
 {
@@ -888,6 +933,7 @@ UNMAP_AFTER_INIT NonnullRefPtr<ProcFSRootDirectory> ProcFSRootDirectory::must_cr
     directory->m_components.append(ProcFSSelfProcessDirectory::must_create());
     directory->m_components.append(ProcFSDiskUsage::must_create());
     directory->m_components.append(ProcFSMemoryStatus::must_create());
+    directory->m_components.append(ProcFSDentryCache::must_create());
     directory->m_components.append(ProcFSOverallProcesses::must_create());
     directory->m_components.append(ProcFSCPUInformation::must_create());
     directory->m_components.append(ProcFSDmesg::must_create());
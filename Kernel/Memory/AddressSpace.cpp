@@ -443,4 +443,14 @@ size_t AddressSpace::amount_purgeable_nonvolatile() const
     return amount;
 }
 
+size_t AddressSpace::amount_large_pages() const
+{
+    return m_page_directory->large_page_count() * large_page_size;
+}
+
+size_t AddressSpace::large_page_splits() const
+{
+    return m_page_directory->large_page_splits();
+}
+
 }
@@ -64,6 +64,8 @@ public:
     size_t amount_shared() const;
     size_t amount_purgeable_volatile() const;
     size_t amount_purgeable_nonvolatile() const;
+    size_t amount_large_pages() const;
+    size_t large_page_splits() const;
 
 private:
     explicit AddressSpace(NonnullRefPtr<PageDirectory>);
@@ -266,6 +266,29 @@ NonnullRefPtr<PhysicalPage> AnonymousVMObject::allocate_committed_page(Badge<Reg
     return m_unused_committed_pages->take_one();
 }
 
+bool AnonymousVMObject::try_allocate_committed_large_page(Badge<Region>, size_t first_page_index)
+{
+    SpinlockLocker lock(m_lock);
+
+    // Once we've been cloned, pages may be shared with another process and have to be tracked one by one.
+    if (!m_cow_map.is_null() || is_volatile() || !m_unused_committed_pages.has_value())
+        return false;
+    if (first_page_index + pages_per_large_page > page_count())
+        return false;
+    for (size_t i = 0; i < pages_per_large_page; ++i) {
+        if (!physical_pages()[first_page_index + i]->is_lazy_committed_page())
+            return false;
+    }
+
+    auto large_page = m_unused_committed_pages->take_large_page();
+    if (large_page.is_empty())
+        return false;
+    auto large_page_pages = large_page.span();
+    for (size_t i = 0; i < pages_per_large_page; ++i)
+        physical_pages()[first_page_index + i] = large_page_pages[i];
+    return true;
+}
+
 Bitmap& AnonymousVMObject::ensure_cow_map()
 {
     if (m_cow_map.is_null())
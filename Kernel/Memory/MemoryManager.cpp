@@ -533,7 +533,8 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
-    if (!pde.is_present()) {
+    if (!pde.is_present() || pde.is_huge()) {
+        auto original_pde = pde.raw();
         bool did_purge = false;
         auto page_table = allocate_user_physical_page(ShouldZeroFill::Yes, &did_purge);
         if (!page_table) {
@@ -547,7 +548,26 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
             pd = quickmap_pd(page_directory, page_directory_table_index);
             VERIFY(&pde == &pd[page_directory_index]); // Sanity check
 
-            VERIFY(!pde.is_present()); // Should have not changed
+            VERIFY(pde.raw() == original_pde); // Should have not changed
+        }
+        if (pde.is_huge()) {
+            // Someone wants to change a single page inside a large page, so split it into a page table
+            // that maps the same 2 MiB with the same permissions, one page at a time.
+            auto* page_table_entries = quickmap_pt(page_table->paddr());
+            for (size_t i = 0; i < pages_per_large_page; ++i) {
+                auto& pte = page_table_entries[i];
+                pte.set_physical_page_base(pde.large_page_base() + i * PAGE_SIZE);
+                pte.set_cache_disabled(pde.is_cache_disabled());
+                pte.set_writable(pde.is_writable());
+                pte.set_user_allowed(pde.is_user_allowed());
+                pte.set_execute_disabled(pde.is_execute_disabled());
+                pte.set_present(true);
+            }
+            pde.clear();
+            VERIFY(page_directory.m_large_page_count > 0);
+            --page_directory.m_large_page_count;
+            ++page_directory.m_large_page_splits;
+            flush_tlb(&page_directory, VirtualAddress(vaddr.get() & ~(large_page_size - 1)), pages_per_large_page);
         }
         pde.set_page_table_base(page_table->paddr().get());
         pde.set_user_allowed(true);
@@ -575,6 +595,8 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
+    // Large pages always lie within a single region, which releases them whole via release_large_pde().
+    VERIFY(!pde.is_huge());
     if (pde.is_present()) {
         auto* page_table = quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()));
         auto& pte = page_table[page_table_index];
@@ -600,6 +622,50 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
     }
 }
 
+PageDirectoryEntry* MemoryManager::ensure_large_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    VERIFY(page_directory.get_lock().is_locked_by_current_processor());
+    VERIFY(!(vaddr.get() & (large_page_size - 1)));
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    PageDirectoryEntry& pde = pd[page_directory_index];
+    if (pde.is_present() && pde.is_huge())
+        return &pde;
+
+    if (pde.is_present()) {
+        // The caller's region covers this whole page table, so every mapping in it is about to be replaced anyway.
+        pde.clear();
+        auto result = page_directory.m_page_tables.remove(vaddr.get());
+        VERIFY(result);
+    }
+    ++page_directory.m_large_page_count;
+    return &pde;
+}
+
+bool MemoryManager::release_large_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(s_mm_lock.is_locked_by_current_processor());
+    VERIFY(page_directory.get_lock().is_locked_by_current_processor());
+    VERIFY(!(vaddr.get() & (large_page_size - 1)));
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    PageDirectoryEntry& pde = pd[page_directory_index];
+    if (!pde.is_present() || !pde.is_huge())
+        return false;
+
+    pde.clear();
+    VERIFY(page_directory.m_large_page_count > 0);
+    --page_directory.m_large_page_count;
+    return true;
+}
+
 UNMAP_AFTER_INIT void MemoryManager::initialize(u32 cpu)
 {
     ProcessorSpecific<MemoryManagerData>::initialize();
@@ -850,6 +916,30 @@ NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_user_physical_page
     return page.release_nonnull();
 }
 
+NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_committed_user_physical_large_page(Badge<CommittedPhysicalPageSet>)
+{
+    SpinlockLocker lock(s_mm_lock);
+    VERIFY(m_system_memory_info.user_physical_pages_committed >= pages_per_large_page);
+
+    for (auto& region : m_user_physical_regions) {
+        auto physical_pages = region.take_contiguous_free_pages(pages_per_large_page, large_page_size);
+        if (physical_pages.is_empty())
+            continue;
+
+        m_system_memory_info.user_physical_pages_committed -= pages_per_large_page;
+        m_system_memory_info.user_physical_pages_used += pages_per_large_page;
+        for (auto& page : physical_pages) {
+            auto* ptr = quickmap_page(page);
+            memset(ptr, 0, PAGE_SIZE);
+            unquickmap_page();
+        }
+        return physical_pages;
+    }
+
+    // Physical memory is too fragmented; the caller falls back to allocating pages one at a time.
+    return {};
+}
+
 RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill should_zero_fill, bool* did_purge)
 {
     SpinlockLocker lock(s_mm_lock);
@@ -1119,6 +1209,16 @@ NonnullRefPtr<PhysicalPage> CommittedPhysicalPageSet::take_one()
     return MM.allocate_committed_user_physical_page({}, MemoryManager::ShouldZeroFill::Yes);
 }
 
+NonnullRefPtrVector<PhysicalPage> CommittedPhysicalPageSet::take_large_page()
+{
+    if (m_page_count < pages_per_large_page)
+        return {};
+    auto physical_pages = MM.allocate_committed_user_physical_large_page({});
+    if (!physical_pages.is_empty())
+        m_page_count -= pages_per_large_page;
+    return physical_pages;
+}
+
 void CommittedPhysicalPageSet::uncommit_one()
 {
     VERIFY(m_page_count > 0);
@@ -46,6 +46,9 @@ public:
 
     RecursiveSpinlock& get_lock() { return m_lock; }
 
+    size_t large_page_count() const { return m_large_page_count; }
+    size_t large_page_splits() const { return m_large_page_splits; }
+
 private:
     PageDirectory();
 
@@ -62,6 +65,10 @@ private:
 #endif
     HashMap<FlatPtr, NonnullRefPtr<PhysicalPage>> m_page_tables;
     RecursiveSpinlock m_lock;
+
+    // Page directory entries that currently map a large page, and how many of them had to be split back into page tables.
+    size_t m_large_page_count { 0 };
+    size_t m_large_page_splits { 0 };
 };
 
 }
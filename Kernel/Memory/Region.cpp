@@ -206,6 +206,54 @@ bool Region::map_individual_page_impl(size_t page_index)
     return true;
 }
 
+bool Region::can_map_large_page(size_t page_index) const
+{
+    auto page_vaddr = vaddr_from_page_index(page_index);
+    if (page_vaddr.get() & (large_page_size - 1))
+        return false;
+    if (page_index + pages_per_large_page > page_count())
+        return false;
+    if (!is_user() || !vmobject().is_anonymous() || (!is_readable() && !is_writable()))
+        return false;
+
+    // A large page has to map physically contiguous, aligned memory with the same permissions all the way through.
+    // This also rules out the shared zero page and the lazy committed page, which are mapped over and over again.
+    auto* first_page = physical_page(page_index);
+    if (!first_page || (first_page->paddr().get() & (large_page_size - 1)))
+        return false;
+    bool large_page_is_writable = is_writable() && !should_cow(page_index);
+    for (size_t i = 1; i < pages_per_large_page; ++i) {
+        auto* page = physical_page(page_index + i);
+        if (!page || page->paddr() != first_page->paddr().offset(i * PAGE_SIZE))
+            return false;
+        if ((is_writable() && !should_cow(page_index + i)) != large_page_is_writable)
+            return false;
+    }
+    return true;
+}
+
+bool Region::map_large_page_impl(size_t page_index)
+{
+    VERIFY(m_page_directory->get_lock().is_locked_by_current_processor());
+    if (!can_map_large_page(page_index))
+        return false;
+    auto page_vaddr = vaddr_from_page_index(page_index);
+
+    // NOTE: We have to take the MM lock for PDE's to stay valid while we use them.
+    SpinlockLocker mm_locker(s_mm_lock);
+
+    auto* pde = MM.ensure_large_pde(*m_page_directory, page_vaddr);
+    pde->set_large_page_base(physical_page(page_index)->paddr().get());
+    pde->set_huge(true);
+    pde->set_cache_disabled(!m_cacheable);
+    pde->set_present(true);
+    pde->set_writable(is_writable() && !should_cow(page_index));
+    if (Processor::current().has_feature(CPUFeature::NX))
+        pde->set_execute_disabled(!is_executable());
+    pde->set_user_allowed(true);
+    return true;
+}
+
 bool Region::do_remap_vmobject_page(size_t page_index, bool with_flush)
 {
     SpinlockLocker lock(vmobject().m_lock);
@@ -215,6 +263,18 @@ bool Region::do_remap_vmobject_page(size_t page_index, bool with_flush)
         return true; // not an error, region doesn't map this page
     SpinlockLocker page_lock(m_page_directory->get_lock());
     VERIFY(physical_page(page_index));
+
+    // If the surrounding 2 MiB can (still, or once again) be mapped as a large page, do that instead of splitting it.
+    auto page_index_in_large_page = (vaddr_from_page_index(page_index).get() & (large_page_size - 1)) / PAGE_SIZE;
+    if (page_index_in_large_page <= page_index) {
+        auto first_page_index = page_index - page_index_in_large_page;
+        if (map_large_page_impl(first_page_index)) {
+            if (with_flush)
+                MM.flush_tlb(m_page_directory, vaddr_from_page_index(first_page_index), pages_per_large_page);
+            return true;
+        }
+    }
+
     bool success = map_individual_page_impl(page_index);
     if (with_flush)
         MM.flush_tlb(m_page_directory, vaddr_from_page_index(page_index));
@@ -232,6 +292,42 @@ bool Region::remap_vmobject_page(size_t page_index, bool with_flush)
     return success;
 }
 
+bool Region::do_remap_vmobject_large_page(size_t first_page_index)
+{
+    SpinlockLocker lock(vmobject().m_lock);
+    if (!m_page_directory)
+        return true; // not an error, region may have not yet mapped it
+    SpinlockLocker page_lock(m_page_directory->get_lock());
+
+    auto page_index = first_page_index;
+    if (translate_vmobject_page(page_index) && map_large_page_impl(page_index)) {
+        MM.flush_tlb(m_page_directory, vaddr_from_page_index(page_index), pages_per_large_page);
+        return true;
+    }
+
+    // This region maps (part of) the range at an address where a large page doesn't fit.
+    bool success = true;
+    for (size_t i = 0; i < pages_per_large_page; ++i) {
+        page_index = first_page_index + i;
+        if (!translate_vmobject_page(page_index))
+            continue;
+        if (!map_individual_page_impl(page_index))
+            success = false;
+        MM.flush_tlb(m_page_directory, vaddr_from_page_index(page_index));
+    }
+    return success;
+}
+
+bool Region::remap_vmobject_large_page(size_t first_page_index)
+{
+    bool success = true;
+    vmobject().for_each_region([&](auto& region) {
+        if (!region.do_remap_vmobject_large_page(first_page_index))
+            success = false;
+    });
+    return success;
+}
+
 void Region::unmap(ShouldDeallocateVirtualRange deallocate_range)
 {
     if (!m_page_directory)
@@ -241,6 +337,10 @@ void Region::unmap(ShouldDeallocateVirtualRange deallocate_range)
     size_t count = page_count();
     for (size_t i = 0; i < count; ++i) {
         auto vaddr = vaddr_from_page_index(i);
+        if (!(vaddr.get() & (large_page_size - 1)) && i + pages_per_large_page <= count && MM.release_large_pde(*m_page_directory, vaddr)) {
+            i += pages_per_large_page - 1;
+            continue;
+        }
         MM.release_pte(*m_page_directory, vaddr, i == count - 1);
     }
     MM.flush_tlb(m_page_directory, vaddr(), page_count());
@@ -270,6 +370,10 @@ bool Region::map(PageDirectory& page_directory, ShouldFlushTLB should_flush_tlb)
     set_page_directory(page_directory);
     size_t page_index = 0;
     while (page_index < page_count()) {
+        if (map_large_page_impl(page_index)) {
+            page_index += pages_per_large_page;
+            continue;
+        }
         if (!map_individual_page_impl(page_index))
             break;
         ++page_index;
@@ -310,6 +414,8 @@ PageFaultResponse Region::handle_fault(PageFault const& fault)
         if (page_slot->is_lazy_committed_page()) {
             auto page_index_in_vmobject = translate_to_vmobject_page(page_index_in_region);
             VERIFY(m_vmobject->is_anonymous());
+            if (auto response = try_handle_large_page_fault(page_index_in_region); response.has_value())
+                return response.release_value();
             page_slot = static_cast<AnonymousVMObject&>(*m_vmobject).allocate_committed_page({});
             if (!remap_vmobject_page(page_index_in_vmobject))
                 return PageFaultResponse::OutOfMemory;
@@ -355,6 +461,8 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
 
     if (page_slot->is_lazy_committed_page()) {
         VERIFY(m_vmobject->is_anonymous());
+        if (auto response = try_handle_large_page_fault(page_index_in_region); response.has_value())
+            return response.release_value();
         page_slot = static_cast<AnonymousVMObject&>(*m_vmobject).allocate_committed_page({});
         dbgln_if(PAGE_FAULT_DEBUG, "      >> ALLOCATED COMMITTED {}", page_slot->paddr());
     } else {
@@ -373,6 +481,29 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
     return PageFaultResponse::Continue;
 }
 
+Optional<PageFaultResponse> Region::try_handle_large_page_fault(size_t page_index_in_region)
+{
+    VERIFY(vmobject().is_anonymous());
+    if (!is_user())
+        return {};
+
+    // Back the whole 2 MiB around the fault at once if it lies within this region and none of it has been touched yet.
+    auto large_page_vaddr = VirtualAddress(vaddr_from_page_index(page_index_in_region).get() & ~(large_page_size - 1));
+    if (large_page_vaddr < vaddr() || large_page_vaddr.offset(large_page_size) > range().end())
+        return {};
+    auto first_page_index_in_vmobject = translate_to_vmobject_page(page_index_from_address(large_page_vaddr));
+    if (!static_cast<AnonymousVMObject&>(vmobject()).try_allocate_committed_large_page({}, first_page_index_in_vmobject))
+        return {};
+
+    dbgln_if(PAGE_FAULT_DEBUG, "      >> ALLOCATED LARGE PAGE {} for {}", physical_page(page_index_from_address(large_page_vaddr))->paddr(), large_page_vaddr);
+    if (auto current_thread = Thread::current())
+        current_thread->did_large_page_fault();
+
+    if (!remap_vmobject_large_page(first_page_index_in_vmobject))
+        return PageFaultResponse::OutOfMemory;
+    return PageFaultResponse::Continue;
+}
+
 PageFaultResponse Region::handle_cow_fault(size_t page_index_in_region)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -187,6 +187,8 @@ private:
 
     [[nodiscard]] bool remap_vmobject_page(size_t page_index, bool with_flush = true);
     [[nodiscard]] bool do_remap_vmobject_page(size_t page_index, bool with_flush = true);
+    [[nodiscard]] bool remap_vmobject_large_page(size_t first_page_index);
+    [[nodiscard]] bool do_remap_vmobject_large_page(size_t first_page_index);
 
     void set_access_bit(Access access, bool b)
     {
@@ -199,8 +201,11 @@ private:
     [[nodiscard]] PageFaultResponse handle_cow_fault(size_t page_index);
     [[nodiscard]] PageFaultResponse handle_inode_fault(size_t page_index);
     [[nodiscard]] PageFaultResponse handle_zero_fault(size_t page_index);
+    [[nodiscard]] Optional<PageFaultResponse> try_handle_large_page_fault(size_t page_index);
 
     [[nodiscard]] bool map_individual_page_impl(size_t page_index);
+    [[nodiscard]] bool can_map_large_page(size_t page_index) const;
+    [[nodiscard]] bool map_large_page_impl(size_t page_index);
 
     RefPtr<PageDirectory> m_page_directory;
     VirtualRange m_range;
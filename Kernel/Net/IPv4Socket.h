@@ -91,6 +91,7 @@ protected:
     void set_peer_address(IPv4Address address) { m_peer_address = address; }
 
     static OwnPtr<DoubleBuffer> create_receive_buffer();
+    const DoubleBuffer& receive_buffer() const { return *m_receive_buffer; }
 
 private:
     virtual bool is_ipv4() const override { return true; }
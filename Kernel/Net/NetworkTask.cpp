@@ -36,6 +36,7 @@ static void flush_delayed_tcp_acks();
 static void retransmit_tcp_packets();
 
 static Thread* network_task = nullptr;
+static WaitQueue* network_task_wait_queue = nullptr;
 static HashTable<RefPtr<TCPSocket>>* delayed_ack_sockets;
 
 [[noreturn]] static void NetworkTask_main(void*);
@@ -52,11 +53,18 @@ bool NetworkTask::is_current()
     return Thread::current() == network_task;
 }
 
+void NetworkTask::wake()
+{
+    if (network_task_wait_queue)
+        network_task_wait_queue->wake_all();
+}
+
 void NetworkTask_main(void*)
 {
     delayed_ack_sockets = new HashTable<RefPtr<TCPSocket>>;
 
     WaitQueue packet_wait_queue;
+    network_task_wait_queue = &packet_wait_queue;
     int pending_packets = 0;
     NetworkingManagement::the().for_each([&](auto& adapter) {
         dmesgln("NetworkTask: {} network adapter found: hw={}", adapter.class_name(), adapter.mac_address().to_string());
@@ -452,6 +460,7 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            client->receive_syn_options(tcp_packet);
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             client->set_state(TCPSocket::State::SynReceived);
             return;
@@ -465,11 +474,13 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
         switch (tcp_packet.flags()) {
         case TCPFlags::SYN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            socket->receive_syn_options(tcp_packet);
             (void)socket->send_ack(true);
             socket->set_state(TCPSocket::State::SynReceived);
             return;
         case TCPFlags::ACK | TCPFlags::SYN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            socket->receive_syn_options(tcp_packet);
             (void)socket->send_ack(true);
             socket->set_state(TCPSocket::State::Established);
             socket->set_setup_state(Socket::SetupState::Completed);
@@ -640,16 +651,24 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
 
 void retransmit_tcp_packets()
 {
-    // We must keep the sockets alive until after we've unlocked the hash table
-    // in case retransmit_packets() realizes that it wants to close the socket.
-    NonnullRefPtrVector<TCPSocket, 16> sockets;
-    TCPSocket::sockets_for_retransmit().for_each_shared([&](const auto& socket) {
-        sockets.append(socket);
-    });
+    for (;;) {
+        // We must keep the socket alive until after we've unlocked the list
+        // in case retransmit_timer_expired() realizes that it wants to close the socket.
+        RefPtr<TCPSocket> socket;
+        TCPSocket::sockets_with_expired_retransmit_timers().with([&](auto& list) {
+            while (auto* expired_socket = list.take_first()) {
+                // The socket may already be on its way out.
+                if (expired_socket->try_ref()) {
+                    socket = adopt_ref(*expired_socket);
+                    return;
+                }
+            }
+        });
+        if (!socket)
+            return;
 
-    for (auto& socket : sockets) {
-        MutexLocker socket_locker(socket.mutex());
-        socket.retransmit_packets();
+        MutexLocker socket_locker(socket->mutex());
+        socket->retransmit_timer_expired();
     }
 }
 
@@ -11,5 +11,6 @@ class NetworkTask {
 public:
     static void spawn();
     static bool is_current();
+    static void wake();
 };
 }
@@ -21,6 +21,22 @@ struct TCPFlags {
     };
 };
 
+enum class TCPOptionKind : u8 {
+    End = 0,
+    NOP = 1,
+    MSS = 2,
+    WindowScale = 3,
+    SACKPermitted = 4,
+    SACK = 5,
+};
+
+class [[gnu::packed]] TCPOptionNOP {
+private:
+    u8 m_option_kind { (u8)TCPOptionKind::NOP };
+};
+
+static_assert(sizeof(TCPOptionNOP) == 1);
+
 class [[gnu::packed]] TCPOptionMSS {
 public:
     TCPOptionMSS(u16 value)
@@ -38,6 +54,38 @@ private:
 
 static_assert(sizeof(TCPOptionMSS) == 4);
 
+class [[gnu::packed]] TCPOptionWindowScale {
+public:
+    TCPOptionWindowScale(u8 value)
+        : m_value(value)
+    {
+    }
+
+    u8 value() const { return m_value; }
+
+private:
+    u8 m_option_kind { (u8)TCPOptionKind::WindowScale };
+    u8 m_option_length { sizeof(TCPOptionWindowScale) };
+    u8 m_value;
+};
+
+static_assert(sizeof(TCPOptionWindowScale) == 3);
+
+class [[gnu::packed]] TCPOptionSACKPermitted {
+private:
+    u8 m_option_kind { (u8)TCPOptionKind::SACKPermitted };
+    u8 m_option_length { sizeof(TCPOptionSACKPermitted) };
+};
+
+static_assert(sizeof(TCPOptionSACKPermitted) == 2);
+
+struct [[gnu::packed]] TCPSACKBlock {
+    NetworkOrdered<u32> left_edge;
+    NetworkOrdered<u32> right_edge;
+};
+
+static_assert(sizeof(TCPSACKBlock) == 8);
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
@@ -77,6 +125,31 @@ public:
     u16 urgent() const { return m_urgent; }
     void set_urgent(u16 urgent) { m_urgent = urgent; }
 
+    template<typename Callback>
+    void for_each_option(Callback callback) const
+    {
+        if (header_size() <= sizeof(TCPPacket))
+            return;
+        auto* options = ((const u8*)this) + sizeof(TCPPacket);
+        size_t options_size = header_size() - sizeof(TCPPacket);
+        for (size_t offset = 0; offset < options_size;) {
+            auto kind = (TCPOptionKind)options[offset];
+            if (kind == TCPOptionKind::End)
+                return;
+            if (kind == TCPOptionKind::NOP) {
+                ++offset;
+                continue;
+            }
+            if (offset + 1 >= options_size)
+                return;
+            size_t length = options[offset + 1];
+            if (length < 2 || offset + length > options_size)
+                return;
+            callback(kind, ReadonlyBytes { options + offset + 2, length - 2 });
+            offset += length;
+        }
+    }
+
     const void* payload() const { return ((const u8*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
@@ -13,6 +13,7 @@
 #include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/NetworkTask.h>
 #include <Kernel/Net/NetworkingManagement.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCP.h>
@@ -22,6 +23,22 @@
 
 namespace Kernel {
 
+// Sequence numbers wrap around, so they have to be compared using serial number arithmetic (RFC 1982).
+static bool sequence_number_before(u32 a, u32 b)
+{
+    return static_cast<i32>(a - b) < 0;
+}
+
+static bool sequence_number_before_or_equal(u32 a, u32 b)
+{
+    return static_cast<i32>(a - b) <= 0;
+}
+
+static Time current_tcp_time()
+{
+    return TimeManagement::the().current_time(CLOCK_MONOTONIC_COARSE);
+}
+
 void TCPSocket::for_each(Function<void(const TCPSocket&)> callback)
 {
     sockets_by_tuple().for_each_shared([&](const auto& it) {
@@ -135,10 +152,13 @@ void TCPSocket::release_for_accept(RefPtr<TCPSocket> socket)
     [[maybe_unused]] auto rc = queue_connection_from(*socket);
 }
 
-TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, OwnPtr<KBuffer> scratch_buffer)
+TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, OwnPtr<KBuffer> scratch_buffer, NonnullRefPtr<Timer> retransmit_timer)
     : IPv4Socket(SOCK_STREAM, protocol, move(receive_buffer), move(scratch_buffer))
+    , m_retransmit_timer(move(retransmit_timer))
 {
-    m_last_retransmit_time = kgettimeofday();
+    // Pick the smallest window scale that lets us advertise the whole receive buffer.
+    while (m_receive_window_scale < maximum_window_scale && ((size_t)NumericLimits<u16>::max() << m_receive_window_scale) < this->receive_buffer().capacity())
+        ++m_receive_window_scale;
 }
 
 TCPSocket::~TCPSocket()
@@ -147,7 +167,11 @@ TCPSocket::~TCPSocket()
         table.remove(tuple());
     });
 
-    dequeue_for_retransmit();
+    TimerQueue::the().cancel_timer(*m_retransmit_timer);
+    sockets_with_expired_retransmit_timers().with([&](auto& list) {
+        if (m_retransmit_list_node.is_in_list())
+            list.remove(*this);
+    });
 
     dbgln_if(TCP_SOCKET_DEBUG, "~TCPSocket in state {}", to_string(state()));
 }
@@ -159,7 +183,11 @@ KResultOr<NonnullRefPtr<TCPSocket>> TCPSocket::create(int protocol, NonnullOwnPt
     if (!scratch_buffer)
         return ENOMEM;
 
-    auto socket = adopt_ref_if_nonnull(new (nothrow) TCPSocket(protocol, move(receive_buffer), move(scratch_buffer)));
+    auto retransmit_timer = adopt_ref_if_nonnull(new (nothrow) Timer);
+    if (!retransmit_timer)
+        return ENOMEM;
+
+    auto socket = adopt_ref_if_nonnull(new (nothrow) TCPSocket(protocol, move(receive_buffer), move(scratch_buffer), retransmit_timer.release_nonnull()));
     if (socket)
         return socket.release_nonnull();
     return ENOMEM;
@@ -183,6 +211,9 @@ KResultOr<size_t> TCPSocket::protocol_send(const UserOrKernelBuffer& data, size_
     if (routing_decision.is_zero())
         return set_so_error(EHOSTUNREACH);
     size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+    if (m_peer_maximum_segment_size)
+        mss = min(mss, m_peer_maximum_segment_size);
+    m_maximum_segment_size = mss;
     data_length = min(data_length, mss);
     if (auto result = send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &data, data_length, &routing_decision); result.is_error())
         return result;
@@ -204,8 +235,17 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
 
-    const bool has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    const bool is_syn = flags & TCPFlags::SYN;
+    const bool has_window_scale_option = is_syn && m_offer_window_scaling;
+    const bool has_sack_permitted_option = is_syn && m_offer_selective_acks;
+    size_t options_size = 0;
+    if (is_syn)
+        options_size += sizeof(TCPOptionMSS);
+    if (has_window_scale_option)
+        options_size += sizeof(TCPOptionNOP) + sizeof(TCPOptionWindowScale);
+    if (has_sack_permitted_option)
+        options_size += 2 * sizeof(TCPOptionNOP) + sizeof(TCPOptionSACKPermitted);
+    VERIFY(options_size % sizeof(u32) == 0);
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -219,7 +259,9 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
+    auto window_size = advertised_window_size(is_syn);
+    tcp_packet.set_window_size(window_size);
+    m_last_advertised_window_size = window_size << (is_syn ? 0 : m_receive_window_scale);
     tcp_packet.set_sequence_number(m_sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
@@ -235,17 +277,31 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
         return set_so_error(EFAULT);
     }
 
+    auto packet_sequence_number = m_sequence_number;
     if (flags & TCPFlags::SYN) {
         ++m_sequence_number;
     } else {
         m_sequence_number += payload_size;
     }
 
-    if (has_mss_option) {
+    if (is_syn) {
+        auto* options = packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket);
+        auto append_option = [&](auto const& option) {
+            memcpy(options, &option, sizeof(option));
+            options += sizeof(option);
+        };
         u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-        TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer->size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
+        append_option(TCPOptionMSS { mss });
+        if (has_window_scale_option) {
+            append_option(TCPOptionNOP {});
+            append_option(TCPOptionWindowScale { m_receive_window_scale });
+        }
+        if (has_sack_permitted_option) {
+            append_option(TCPOptionNOP {});
+            append_option(TCPOptionNOP {});
+            append_option(TCPOptionSACKPermitted {});
+        }
+        VERIFY(options == packet->buffer->data() + ipv4_payload_offset + tcp_header_size);
     }
 
     tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
@@ -256,10 +312,12 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     m_bytes_out += buffer_size;
     if (tcp_packet.has_syn() || payload_size > 0) {
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-            unacked_packets.packets.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter });
+            unacked_packets.packets.append({ packet_sequence_number, m_sequence_number, payload_size, move(packet), ipv4_payload_offset, *routing_decision.adapter, 0, current_tcp_time() });
             unacked_packets.size += payload_size;
-            enqueue_for_retransmit();
         });
+        // RFC 6298 (5.1): Start the timer if it isn't already running.
+        if (!m_retransmit_deadline.has_value())
+            start_retransmit_timer();
     } else {
         routing_decision.adapter->release_packet_buffer(*packet);
     }
@@ -274,33 +332,64 @@ void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
-        int removed = 0;
+        // The window in a SYN is never scaled; receive_syn_options() takes care of that one.
+        if (!packet.has_syn())
+            m_send_window_size = (u32)packet.window_size() << m_send_window_scale;
+
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+            auto now = current_tcp_time();
+            Optional<Time> rtt_sample;
+            size_t acked_bytes = 0;
+            int removed = 0;
             while (!unacked_packets.packets.is_empty()) {
-                auto& packet = unacked_packets.packets.first();
-
-                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
-
-                if (packet.ack_number <= ack_number) {
-                    auto old_adapter = packet.adapter.strong_ref();
-                    if (old_adapter)
-                        old_adapter->release_packet_buffer(*packet.buffer);
-                    TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                    auto payload_size = packet.buffer->buffer->data() + packet.buffer->buffer->size() - (u8*)tcp_packet.payload();
-                    unacked_packets.size -= payload_size;
-                    evaluate_block_conditions();
-                    unacked_packets.packets.take_first();
-                    removed++;
-                } else {
+                auto& outgoing_packet = unacked_packets.packets.first();
+
+                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", outgoing_packet.ack_number);
+
+                if (!sequence_number_before_or_equal(outgoing_packet.ack_number, ack_number))
                     break;
-                }
+
+                // Karn's algorithm: An ACK for a retransmitted packet doesn't tell us which transmission it's for.
+                if (outgoing_packet.tx_counter == 0 && !rtt_sample.has_value())
+                    rtt_sample = now - outgoing_packet.last_sent_time;
+
+                auto old_adapter = outgoing_packet.adapter.strong_ref();
+                if (old_adapter)
+                    old_adapter->release_packet_buffer(*outgoing_packet.buffer);
+                unacked_packets.size -= outgoing_packet.payload_size;
+                if (outgoing_packet.is_sacked)
+                    unacked_packets.sacked_size -= outgoing_packet.payload_size;
+                if (outgoing_packet.is_lost)
+                    unacked_packets.lost_size -= outgoing_packet.payload_size;
+                acked_bytes += outgoing_packet.payload_size;
+                unacked_packets.packets.take_first();
+                removed++;
             }
 
-            if (unacked_packets.packets.is_empty()) {
+            if (rtt_sample.has_value())
+                update_rtt_estimate(rtt_sample.value());
+
+            if (m_selective_acks_enabled)
+                process_selective_acks(unacked_packets, packet);
+
+            bool has_payload = size > packet.header_size();
+            if (removed > 0) {
+                m_last_ack_number_received = ack_number;
                 m_retransmit_attempts = 0;
-                dequeue_for_retransmit();
+                process_new_ack(unacked_packets, ack_number, acked_bytes);
+                evaluate_block_conditions();
+            } else if (ack_number == m_last_ack_number_received && !unacked_packets.packets.is_empty() && !has_payload && !packet.has_syn() && !packet.has_fin()) {
+                process_duplicate_ack(unacked_packets);
             }
 
+            if (unacked_packets.lost_size > 0)
+                retransmit_lost_packets(unacked_packets);
+
+            if (unacked_packets.packets.is_empty())
+                stop_retransmit_timer();
+            else if (removed > 0)
+                start_retransmit_timer(); // RFC 6298 (5.3)
+
             dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
         });
     }
@@ -309,6 +398,230 @@ void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
     m_bytes_in += packet.header_size() + size;
 }
 
+void TCPSocket::receive_syn_options(const TCPPacket& packet)
+{
+    VERIFY(packet.has_syn());
+
+    Optional<u8> peer_window_scale;
+    bool peer_offered_selective_acks = false;
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == sizeof(u16))
+                m_peer_maximum_segment_size = (data[0] << 8) | data[1];
+            break;
+        case TCPOptionKind::WindowScale:
+            if (data.size() == sizeof(u8))
+                peer_window_scale = min(data[0], maximum_window_scale);
+            break;
+        case TCPOptionKind::SACKPermitted:
+            if (data.is_empty())
+                peer_offered_selective_acks = true;
+            break;
+        default:
+            break;
+        }
+    });
+
+    // When accepting a connection, our SYN may only carry the options the peer offered.
+    if (!packet.has_ack()) {
+        m_offer_window_scaling = peer_window_scale.has_value();
+        m_offer_selective_acks = peer_offered_selective_acks;
+    }
+    m_window_scaling_enabled = m_offer_window_scaling && peer_window_scale.has_value();
+    m_send_window_scale = m_window_scaling_enabled ? peer_window_scale.value() : 0;
+    if (!m_window_scaling_enabled)
+        m_receive_window_scale = 0;
+    m_selective_acks_enabled = m_offer_selective_acks && peer_offered_selective_acks;
+    m_send_window_size = packet.window_size();
+
+    u32 mss = 536;
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (!routing_decision.is_zero())
+        mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+    if (m_peer_maximum_segment_size)
+        mss = min(mss, m_peer_maximum_segment_size);
+    m_maximum_segment_size = mss;
+
+    // RFC 6928: Start out with an initial window of ten segments.
+    m_congestion_window = initial_window_segments * mss;
+    m_last_ack_number_received = m_sequence_number;
+    m_recovery_point = m_sequence_number;
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) negotiated mss={}, window_scaling={} ({}/{}), sack={}",
+        this, m_maximum_segment_size, m_window_scaling_enabled, m_send_window_scale, m_receive_window_scale, m_selective_acks_enabled);
+}
+
+void TCPSocket::process_selective_acks(UnackedPackets& unacked_packets, TCPPacket const& packet)
+{
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        if (kind != TCPOptionKind::SACK || data.size() % sizeof(TCPSACKBlock) != 0)
+            return;
+        for (size_t offset = 0; offset < data.size(); offset += sizeof(TCPSACKBlock)) {
+            TCPSACKBlock block;
+            memcpy(&block, data.offset(offset), sizeof(block));
+            for (auto& outgoing_packet : unacked_packets.packets) {
+                if (outgoing_packet.is_sacked || outgoing_packet.payload_size == 0)
+                    continue;
+                if (!sequence_number_before_or_equal(block.left_edge, outgoing_packet.sequence_number)
+                    || !sequence_number_before_or_equal(outgoing_packet.ack_number, block.right_edge))
+                    continue;
+                outgoing_packet.is_sacked = true;
+                unacked_packets.sacked_size += outgoing_packet.payload_size;
+                if (outgoing_packet.is_lost) {
+                    outgoing_packet.is_lost = false;
+                    unacked_packets.lost_size -= outgoing_packet.payload_size;
+                }
+            }
+        }
+    });
+}
+
+void TCPSocket::process_new_ack(UnackedPackets& unacked_packets, u32 ack_number, size_t acked_bytes)
+{
+    u32 mss = m_maximum_segment_size;
+    m_duplicate_acks_received = 0;
+
+    if (m_in_fast_recovery) {
+        if (sequence_number_before_or_equal(m_recovery_point, ack_number)) {
+            // RFC 6582 3.2 (3): A full acknowledgment ends fast recovery.
+            m_congestion_window = min<u32>(m_slow_start_threshold, max<u32>(bytes_in_flight(unacked_packets), mss) + mss);
+            m_in_fast_recovery = false;
+        } else {
+            // RFC 6582 3.2 (3): A partial acknowledgment means the next hole was lost as well.
+            for (auto& outgoing_packet : unacked_packets.packets) {
+                if (!outgoing_packet.is_sacked) {
+                    mark_packet_lost(unacked_packets, outgoing_packet);
+                    break;
+                }
+            }
+            m_congestion_window -= min<u32>(acked_bytes, m_congestion_window);
+            if (acked_bytes >= mss)
+                m_congestion_window += mss;
+            m_congestion_window = max(m_congestion_window, mss);
+        }
+        return;
+    }
+
+    static constexpr u32 maximum_congestion_window = (u32)NumericLimits<u16>::max() << maximum_window_scale;
+    if (m_congestion_window < m_slow_start_threshold) {
+        // RFC 5681 3.1 (2): Slow start
+        m_congestion_window += min<u32>(acked_bytes, mss);
+    } else {
+        // RFC 5681 3.1 (3): Congestion avoidance
+        m_congestion_window += max<u32>(1, mss * mss / m_congestion_window);
+    }
+    m_congestion_window = min(m_congestion_window, maximum_congestion_window);
+}
+
+void TCPSocket::process_duplicate_ack(UnackedPackets& unacked_packets)
+{
+    ++m_duplicate_acks_received;
+
+    if (m_in_fast_recovery) {
+        // RFC 5681 3.2 (4): Every further duplicate ACK means another segment has left the network.
+        m_congestion_window += m_maximum_segment_size;
+        return;
+    }
+
+    if (m_duplicate_acks_received != duplicate_ack_threshold)
+        return;
+
+    // RFC 6582 4.1: Don't go into fast retransmit again for losses from before the last recovery.
+    if (sequence_number_before(m_last_ack_number_received, m_recovery_point))
+        return;
+
+    enter_fast_recovery(unacked_packets);
+}
+
+void TCPSocket::enter_fast_recovery(UnackedPackets& unacked_packets)
+{
+    u32 mss = m_maximum_segment_size;
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) entering fast recovery, cwnd={}", this, m_congestion_window);
+
+    // RFC 5681 3.2 (2) and (3)
+    m_slow_start_threshold = max<u32>(bytes_in_flight(unacked_packets) / 2, 2 * mss);
+    m_recovery_point = m_sequence_number;
+    m_in_fast_recovery = true;
+
+    // The first unacknowledged packet is lost. If the peer told us about packets it got beyond that,
+    // anything before them that it didn't tell us about is most likely lost as well.
+    Optional<u32> highest_sacked_sequence_number;
+    for (auto& outgoing_packet : unacked_packets.packets) {
+        if (outgoing_packet.is_sacked)
+            highest_sacked_sequence_number = outgoing_packet.sequence_number;
+    }
+    bool marked_first = false;
+    for (auto& outgoing_packet : unacked_packets.packets) {
+        if (outgoing_packet.is_sacked)
+            continue;
+        if (marked_first && (!highest_sacked_sequence_number.has_value() || !sequence_number_before(outgoing_packet.sequence_number, highest_sacked_sequence_number.value())))
+            break;
+        mark_packet_lost(unacked_packets, outgoing_packet);
+        marked_first = true;
+    }
+
+    m_congestion_window = m_slow_start_threshold + duplicate_ack_threshold * mss;
+}
+
+void TCPSocket::mark_packet_lost(UnackedPackets& unacked_packets, OutgoingPacket& outgoing_packet)
+{
+    if (outgoing_packet.is_lost || outgoing_packet.is_sacked)
+        return;
+    outgoing_packet.is_lost = true;
+    unacked_packets.lost_size += outgoing_packet.payload_size;
+}
+
+size_t TCPSocket::bytes_in_flight(UnackedPackets const& unacked_packets) const
+{
+    // RFC 6675 calls this the "pipe": What we sent minus what we know has left the network.
+    return unacked_packets.size - unacked_packets.sacked_size - unacked_packets.lost_size;
+}
+
+size_t TCPSocket::available_send_window(UnackedPackets const& unacked_packets) const
+{
+    size_t window = min(m_congestion_window, m_send_window_size);
+    auto in_flight = bytes_in_flight(unacked_packets);
+    if (in_flight < window)
+        return window - in_flight;
+    // With nothing in flight we always allow one segment, which doubles as a probe for a closed window.
+    return unacked_packets.packets.is_empty() ? m_maximum_segment_size : 0;
+}
+
+u32 TCPSocket::advertised_window_size(bool is_syn) const
+{
+    // did_receive() refuses packets whose headers don't fit in the buffer alongside the payload,
+    // so keep room for one set of headers.
+    constexpr size_t header_room = sizeof(IPv4Packet) + 15 * sizeof(u32);
+    size_t space = receive_buffer().space_for_writing();
+    space = space > header_room ? space - header_room : 0;
+    // The window in a SYN is never scaled.
+    u8 scale = is_syn ? 0 : m_receive_window_scale;
+    return min<size_t>(space >> scale, NumericLimits<u16>::max());
+}
+
+void TCPSocket::update_rtt_estimate(Time const& sample)
+{
+    u64 rtt = clamp<i64>(sample.to_microseconds(), 1, maximum_retransmit_timeout_us);
+
+    // RFC 6298 2.2 and 2.3
+    if (m_smoothed_rtt_us == 0) {
+        m_smoothed_rtt_us = rtt;
+        m_rtt_variance_us = rtt / 2;
+    } else {
+        u64 delta = m_smoothed_rtt_us > rtt ? m_smoothed_rtt_us - rtt : rtt - m_smoothed_rtt_us;
+        m_rtt_variance_us = (3 * (u64)m_rtt_variance_us + delta) / 4;
+        m_smoothed_rtt_us = (7 * (u64)m_smoothed_rtt_us + rtt) / 8;
+    }
+
+    // We use a lower minimum than the one second RFC 6298 (2.4) asks for, like most other
+    // implementations do; it mainly matters on fast local links.
+    constexpr u64 clock_granularity_us = 1000;
+    u64 timeout = m_smoothed_rtt_us + max(clock_granularity_us, 4 * (u64)m_rtt_variance_us);
+    m_retransmit_timeout_us = clamp<u64>(timeout, minimum_retransmit_timeout_us, maximum_retransmit_timeout_us);
+}
+
 bool TCPSocket::should_delay_next_ack() const
 {
     // FIXME: We don't know the MSS here so make a reasonable guess.
@@ -512,92 +825,186 @@ KResult TCPSocket::close()
     return result;
 }
 
-static Singleton<MutexProtected<TCPSocket::RetransmitList>> s_sockets_for_retransmit;
+static Singleton<SpinlockProtected<TCPSocket::RetransmitList>> s_sockets_with_expired_retransmit_timers;
 
-MutexProtected<TCPSocket::RetransmitList>& TCPSocket::sockets_for_retransmit()
+SpinlockProtected<TCPSocket::RetransmitList>& TCPSocket::sockets_with_expired_retransmit_timers()
 {
-    return *s_sockets_for_retransmit;
+    return *s_sockets_with_expired_retransmit_timers;
 }
 
-void TCPSocket::enqueue_for_retransmit()
+void TCPSocket::start_retransmit_timer()
 {
-    sockets_for_retransmit().with_exclusive([&](auto& list) {
-        list.append(*this);
-    });
+    m_retransmit_deadline = current_tcp_time() + Time::from_microseconds(m_retransmit_timeout_us);
+    arm_retransmit_timer();
+}
+
+void TCPSocket::stop_retransmit_timer()
+{
+    // If the timer is armed, it will notice that there's no deadline anymore when it fires.
+    m_retransmit_deadline = {};
+}
+
+void TCPSocket::arm_retransmit_timer()
+{
+    // Restarting the timer for every ACK would mean a trip through the timer queue each time.
+    // Instead we just move the deadline and let an early firing timer re-arm itself.
+    if (m_retransmit_timer_armed.exchange(true))
+        return;
+
+    // The callback may still be finishing up on another processor.
+    TimerQueue::the().cancel_timer(*m_retransmit_timer);
+
+    if (!TimerQueue::the().add_timer_without_id(*m_retransmit_timer, CLOCK_MONOTONIC_COARSE, m_retransmit_deadline.value(), [this] { retransmit_timer_fired(); }))
+        retransmit_timer_fired();
 }
 
-void TCPSocket::dequeue_for_retransmit()
+void TCPSocket::retransmit_timer_fired()
 {
-    sockets_for_retransmit().with_exclusive([&](auto& list) {
-        list.remove(*this);
+    // This runs from a deferred call, so all we can do here is hand the socket to the NetworkTask.
+    m_retransmit_timer_armed = false;
+    sockets_with_expired_retransmit_timers().with([&](auto& list) {
+        if (!m_retransmit_list_node.is_in_list())
+            list.append(*this);
     });
+    NetworkTask::wake();
 }
 
-void TCPSocket::retransmit_packets()
+void TCPSocket::retransmit_timer_expired()
 {
-    auto now = kgettimeofday();
+    VERIFY(mutex().is_locked());
 
-    // RFC6298 says we should have at least one second between retransmits. According to
-    // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
-    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
+    if (!m_retransmit_deadline.has_value())
+        return;
 
-    if (m_last_retransmit_time > now - Time::from_seconds(retransmit_interval))
+    if (current_tcp_time() < m_retransmit_deadline.value()) {
+        arm_retransmit_timer();
         return;
+    }
 
-    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit, rto={}us", this, m_retransmit_timeout_us);
 
-    m_last_retransmit_time = now;
     ++m_retransmit_attempts;
 
     if (m_retransmit_attempts > maximum_retransmits) {
+        stop_retransmit_timer();
         set_state(TCPSocket::State::Closed);
         set_error(TCPSocket::Error::RetransmitTimeout);
         set_setup_state(Socket::SetupState::Completed);
         return;
     }
 
+    bool has_unacked_packets = m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        if (unacked_packets.packets.is_empty())
+            return false;
+
+        u32 mss = m_maximum_segment_size;
+
+        // RFC 5681 3.1 (4): After a timeout we go back to slow start with a loss window of one segment.
+        m_slow_start_threshold = max<u32>(bytes_in_flight(unacked_packets) / 2, 2 * mss);
+        m_congestion_window = mss;
+        m_in_fast_recovery = false;
+        m_duplicate_acks_received = 0;
+        m_recovery_point = m_sequence_number;
+
+        // RFC 2018 8: After a timeout, we can't rely on anything the peer told us about holes.
+        for (auto& outgoing_packet : unacked_packets.packets) {
+            outgoing_packet.is_sacked = false;
+            outgoing_packet.is_lost = false;
+        }
+        unacked_packets.sacked_size = 0;
+        unacked_packets.lost_size = 0;
+        for (auto& outgoing_packet : unacked_packets.packets)
+            mark_packet_lost(unacked_packets, outgoing_packet);
+
+        retransmit_lost_packets(unacked_packets);
+        return true;
+    });
+
+    if (!has_unacked_packets) {
+        stop_retransmit_timer();
+        return;
+    }
+
+    // RFC 6298 (5.5) and (5.6): Back off the timer, and start it again.
+    m_retransmit_timeout_us = min(m_retransmit_timeout_us * 2, maximum_retransmit_timeout_us);
+    start_retransmit_timer();
+}
+
+void TCPSocket::retransmit_lost_packets(UnackedPackets& unacked_packets)
+{
     auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return;
 
-    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-        for (auto& packet : unacked_packets.packets) {
-            packet.tx_counter++;
-
-            if constexpr (TCP_SOCKET_DEBUG) {
-                auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                    local_address(), local_port(),
-                    peer_address(), peer_port(),
-                    (tcp_packet.has_syn() ? "SYN " : ""),
-                    (tcp_packet.has_ack() ? "ACK " : ""),
-                    (tcp_packet.has_fin() ? "FIN " : ""),
-                    (tcp_packet.has_rst() ? "RST " : ""),
-                    tcp_packet.sequence_number(),
-                    tcp_packet.ack_number(),
-                    packet.tx_counter);
-            }
+    bool did_retransmit = false;
+    for (auto& outgoing_packet : unacked_packets.packets) {
+        if (!outgoing_packet.is_lost)
+            continue;
+        // Lost packets go out as the congestion window allows, but at least one always does so that we make progress.
+        if (did_retransmit && bytes_in_flight(unacked_packets) + outgoing_packet.payload_size > m_congestion_window)
+            break;
+        outgoing_packet.is_lost = false;
+        unacked_packets.lost_size -= outgoing_packet.payload_size;
+        retransmit_packet(outgoing_packet, routing_decision);
+        did_retransmit = true;
+    }
+}
 
-            size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-            if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-                // FIXME: Add support for this. This can happen if after a route change
-                // we ended up on another adapter which doesn't have the same layer 2 type
-                // like the previous adapter.
-                VERIFY_NOT_REACHED();
-            }
+void TCPSocket::retransmit_packet(OutgoingPacket& packet, RoutingDecision& routing_decision)
+{
+    packet.tx_counter++;
+    packet.last_sent_time = current_tcp_time();
+    m_retransmitted_packets++;
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
 
-            auto packet_buffer = packet.buffer->bytes();
+    size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
+    if (ipv4_payload_offset != packet.ipv4_payload_offset) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // like the previous adapter.
+        VERIFY_NOT_REACHED();
+    }
 
-            routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-                local_address(), routing_decision.next_hop, peer_address(),
-                IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, ttl());
-            routing_decision.adapter->send_packet(packet_buffer);
-            m_packets_out++;
-            m_bytes_out += packet_buffer.size();
-        }
-    });
+    auto packet_buffer = packet.buffer->bytes();
+
+    routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
+        local_address(), routing_decision.next_hop, peer_address(),
+        IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, ttl());
+    routing_decision.adapter->send_packet(packet_buffer);
+    m_packets_out++;
+    m_bytes_out += packet_buffer.size();
+}
+
+KResultOr<size_t> TCPSocket::recvfrom(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*> addr, Userspace<socklen_t*> addr_length, Time& packet_timestamp)
+{
+    auto nreceived_or_error = IPv4Socket::recvfrom(description, buffer, buffer_length, flags, addr, addr_length, packet_timestamp);
+    if (nreceived_or_error.is_error() || nreceived_or_error.value() == 0)
+        return nreceived_or_error;
+
+    MutexLocker locker(mutex());
+    if (m_state != State::Established && m_state != State::FinWait1 && m_state != State::FinWait2)
+        return nreceived_or_error;
+
+    // If the peer last saw a (nearly) closed window, it won't send anything until we tell it that
+    // reading made room again (RFC 1122 4.2.3.3).
+    u32 window = advertised_window_size(false) << m_receive_window_scale;
+    u32 threshold = min<u32>(receive_buffer().capacity() / 2, 2 * m_maximum_segment_size);
+    if (m_last_advertised_window_size < threshold && window >= threshold)
+        [[maybe_unused]] auto rc = send_ack(true);
+    return nreceived_or_error;
 }
 
 bool TCPSocket::can_write(const FileDescription& file_description, size_t size) const
@@ -612,7 +1019,7 @@ bool TCPSocket::can_write(const FileDescription& file_description, size_t size)
         return true;
 
     return m_unacked_packets.with_shared([&](auto& unacked_packets) {
-        return unacked_packets.size + size <= m_send_window_size;
+        return available_send_window(unacked_packets) > size;
     });
 }
 }
@@ -12,7 +12,9 @@
 #include <AK/WeakPtr.h>
 #include <Kernel/KResult.h>
 #include <Kernel/Locking/MutexProtected.h>
+#include <Kernel/Locking/SpinlockProtected.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/TimerQueue.h>
 
 namespace Kernel {
 
@@ -130,6 +132,17 @@ public:
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 retransmitted_packets() const { return m_retransmitted_packets; }
+
+    u32 congestion_window() const { return m_congestion_window; }
+    u32 slow_start_threshold() const { return m_slow_start_threshold; }
+    u32 send_window_size() const { return m_send_window_size; }
+    u32 maximum_segment_size() const { return m_maximum_segment_size; }
+    bool has_window_scaling() const { return m_window_scaling_enabled; }
+    bool has_selective_acks() const { return m_selective_acks_enabled; }
+    u32 smoothed_rtt_us() const { return m_smoothed_rtt_us; }
+    u32 rtt_variance_us() const { return m_rtt_variance_us; }
+    u32 retransmit_timeout_us() const { return m_retransmit_timeout_us; }
 
     // FIXME: Make this configurable?
     static constexpr u32 maximum_duplicate_acks = 5;
@@ -139,6 +152,7 @@ public:
     KResult send_ack(bool allow_duplicate = false);
     KResult send_tcp_packet(u16 flags, const UserOrKernelBuffer* = nullptr, size_t = 0, RoutingDecision* = nullptr);
     void receive_tcp_packet(const TCPPacket&, u16 size);
+    void receive_syn_options(const TCPPacket&);
 
     bool should_delay_next_ack() const;
 
@@ -153,10 +167,11 @@ public:
     void release_to_originator();
     void release_for_accept(RefPtr<TCPSocket>);
 
-    void retransmit_packets();
+    void retransmit_timer_expired();
 
     virtual KResult close() override;
 
+    virtual KResultOr<size_t> recvfrom(FileDescription&, UserOrKernelBuffer&, size_t, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&) override;
     virtual bool can_write(const FileDescription&, size_t) const override;
 
     static NetworkOrdered<u16> compute_tcp_checksum(IPv4Address const& source, IPv4Address const& destination, TCPPacket const&, u16 payload_size);
@@ -165,7 +180,7 @@ protected:
     void set_direction(Direction direction) { m_direction = direction; }
 
 private:
-    explicit TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, OwnPtr<KBuffer> scratch_buffer);
+    explicit TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, OwnPtr<KBuffer> scratch_buffer, NonnullRefPtr<Timer> retransmit_timer);
     virtual StringView class_name() const override { return "TCPSocket"; }
 
     virtual void shut_down_for_writing() override;
@@ -178,8 +193,24 @@ private:
     virtual KResult protocol_bind() override;
     virtual KResult protocol_listen(bool did_allocate_port) override;
 
-    void enqueue_for_retransmit();
-    void dequeue_for_retransmit();
+    struct OutgoingPacket;
+    struct UnackedPackets;
+
+    void start_retransmit_timer();
+    void stop_retransmit_timer();
+    void arm_retransmit_timer();
+    void retransmit_timer_fired();
+    void update_rtt_estimate(Time const& sample);
+    void process_selective_acks(UnackedPackets&, TCPPacket const&);
+    void process_new_ack(UnackedPackets&, u32 ack_number, size_t acked_bytes);
+    void process_duplicate_ack(UnackedPackets&);
+    void enter_fast_recovery(UnackedPackets&);
+    void mark_packet_lost(UnackedPackets&, OutgoingPacket&);
+    void retransmit_lost_packets(UnackedPackets&);
+    void retransmit_packet(OutgoingPacket&, RoutingDecision&);
+    u32 advertised_window_size(bool is_syn) const;
+    size_t bytes_in_flight(UnackedPackets const&) const;
+    size_t available_send_window(UnackedPackets const&) const;
 
     WeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullRefPtr<TCPSocket>> m_pending_release_for_accept;
@@ -195,16 +226,23 @@ private:
     u32 m_bytes_out { 0 };
 
     struct OutgoingPacket {
+        u32 sequence_number { 0 };
         u32 ack_number { 0 };
+        size_t payload_size { 0 };
         RefPtr<PacketWithTimestamp> buffer;
         size_t ipv4_payload_offset;
         WeakPtr<NetworkAdapter> adapter;
         int tx_counter { 0 };
+        Time last_sent_time;
+        bool is_sacked { false };
+        bool is_lost { false };
     };
 
     struct UnackedPackets {
         SinglyLinkedList<OutgoingPacket> packets;
         size_t size { 0 };
+        size_t sacked_size { 0 };
+        size_t lost_size { 0 };
     };
 
     MutexProtected<UnackedPackets> m_unacked_packets;
@@ -216,17 +254,51 @@ private:
 
     // FIXME: Make this configurable (sysctl)
     static constexpr u32 maximum_retransmits = 5;
-    Time m_last_retransmit_time;
     u32 m_retransmit_attempts { 0 };
-
-    // FIXME: Parse window size TCP option from the peer
+    u32 m_retransmitted_packets { 0 };
+
+    // RFC 6298: Retransmission timer, driven by smoothed round-trip time measurements.
+    static constexpr u32 initial_retransmit_timeout_us = 1'000'000;
+    static constexpr u32 minimum_retransmit_timeout_us = 200'000;
+    static constexpr u32 maximum_retransmit_timeout_us = 60'000'000;
+    u32 m_smoothed_rtt_us { 0 };
+    u32 m_rtt_variance_us { 0 };
+    u32 m_retransmit_timeout_us { initial_retransmit_timeout_us };
+    Optional<Time> m_retransmit_deadline;
+    NonnullRefPtr<Timer> m_retransmit_timer;
+    Atomic<bool> m_retransmit_timer_armed { false };
+
+    // RFC 5681 congestion control with the NewReno modification from RFC 6582.
+    static constexpr u32 initial_window_segments = 10;
+    static constexpr u32 duplicate_ack_threshold = 3;
+    u32 m_congestion_window { 0 };
+    u32 m_slow_start_threshold { NumericLimits<u32>::max() };
+    u32 m_last_ack_number_received { 0 };
+    u32 m_duplicate_acks_received { 0 };
+    u32 m_recovery_point { 0 };
+    bool m_in_fast_recovery { false };
+
+    // The peer's MSS option; the route's MTU may lower it further.
+    u32 m_peer_maximum_segment_size { 0 };
+    u32 m_maximum_segment_size { 536 };
+
+    // RFC 7323 window scaling and RFC 2018 selective acknowledgments. We offer both in our
+    // SYN, and they are only used if the peer's SYN offered them as well.
+    static constexpr u8 maximum_window_scale = 14;
+    bool m_offer_window_scaling { true };
+    bool m_offer_selective_acks { true };
+    bool m_window_scaling_enabled { false };
+    bool m_selective_acks_enabled { false };
+    u8 m_send_window_scale { 0 };
+    u8 m_receive_window_scale { 0 };
     u32 m_send_window_size { 64 * KiB };
+    u32 m_last_advertised_window_size { 0 };
 
     IntrusiveListNode<TCPSocket> m_retransmit_list_node;
 
 public:
     using RetransmitList = IntrusiveList<TCPSocket, RawPtr<TCPSocket>, &TCPSocket::m_retransmit_list_node>;
-    static MutexProtected<TCPSocket::RetransmitList>& sockets_for_retransmit();
+    static SpinlockProtected<TCPSocket::RetransmitList>& sockets_with_expired_retransmit_timers();
 };
 
 }
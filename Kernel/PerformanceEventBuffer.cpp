@@ -4,9 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <AK/JsonArraySerializer.h>
-#include <AK/JsonObjectSerializer.h>
+#include <AK/HashMap.h>
 #include <AK/ScopeGuard.h>
+#include <Kernel/API/Perfcore.h>
 #include <Kernel/Arch/x86/SmapDisabler.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/KBufferBuilder.h>
@@ -163,113 +163,164 @@ PerformanceEvent& PerformanceEventBuffer::at(size_t index)
     return events[index];
 }
 
-template<typename Serializer>
-bool PerformanceEventBuffer::to_json_impl(Serializer& object) const
+static void append_varint(KBufferBuilder& builder, u64 value)
 {
-    {
-        auto strings = object.add_array("strings");
-        for (auto& it : m_strings) {
-            strings.add(it.view());
+    u8 bytes[10];
+    size_t size = 0;
+    do {
+        bytes[size] = value & 0x7f;
+        value >>= 7;
+        if (value)
+            bytes[size] |= 0x80;
+        ++size;
+    } while (value);
+    builder.append_bytes({ bytes, size });
+}
+
+static unsigned stack_hash(PerformanceEvent const& event)
+{
+    unsigned hash = event.stack_size;
+    for (size_t i = 0; i < event.stack_size; ++i)
+        hash = pair_int_hash(hash, ptr_hash(event.stack[i]));
+    return hash;
+}
+
+static bool stacks_are_equal(PerformanceEvent const& a, PerformanceEvent const& b)
+{
+    return a.stack_size == b.stack_size && !memcmp(a.stack, b.stack, a.stack_size * sizeof(FlatPtr));
+}
+
+KResult PerformanceEventBuffer::to_binary(KBufferBuilder& builder) const
+{
+    builder.append_bytes({ Perfcore::magic, sizeof(Perfcore::magic) });
+    builder.append_bytes({ &Perfcore::version, sizeof(Perfcore::version) });
+
+    // Registered strings come first, so signposts can keep referring to them by the ID they were registered with.
+    u32 string_count = 0;
+    auto append_string = [&](StringView string) {
+        builder.append(static_cast<char>(Perfcore::RecordType::String));
+        append_varint(builder, string.length());
+        builder.append(string);
+        return string_count++;
+    };
+    for (auto& string : m_strings)
+        append_string(string.view());
+
+    HashMap<StringView, u32> string_indices;
+    auto intern_string = [&](StringView string) -> Optional<u32> {
+        if (auto it = string_indices.find(string); it != string_indices.end())
+            return it->value;
+        auto index = append_string(string);
+        if (!string_indices.try_set(string, index))
+            return {};
+        return index;
+    };
+
+    // Samples mostly come from a handful of hot stacks, so each distinct stack is only written once.
+    // If two different stacks happen to hash the same, the second one just doesn't get deduplicated.
+    HashMap<unsigned, u32> stack_indices_by_hash;
+    Vector<size_t> first_event_with_stack;
+    auto intern_stack = [&](size_t event_index) -> Optional<u32> {
+        auto& event = at(event_index);
+        auto hash = stack_hash(event);
+        if (auto it = stack_indices_by_hash.find(hash); it != stack_indices_by_hash.end() && stacks_are_equal(at(first_event_with_stack[it->value]), event))
+            return it->value;
+        u32 index = first_event_with_stack.size();
+        if (!first_event_with_stack.try_append(event_index))
+            return {};
+        if (!stack_indices_by_hash.try_set(hash, index))
+            return {};
+
+        builder.append(static_cast<char>(Perfcore::RecordType::Stack));
+        append_varint(builder, event.stack_size);
+        FlatPtr previous_frame = 0;
+        for (size_t i = 0; i < event.stack_size; ++i) {
+            append_varint(builder, Perfcore::zigzag_encode(static_cast<ssize_t>(event.stack[i] - previous_frame)));
+            previous_frame = event.stack[i];
         }
-    }
+        return index;
+    };
 
-    auto array = object.add_array("events");
     bool seen_first_sample = false;
+    u64 previous_timestamp = 0;
     for (size_t i = 0; i < m_count; ++i) {
         auto& event = at(i);
-        auto event_object = array.add_object();
+
+        // Strings and stacks have to be written before the event that refers to them.
+        u32 stack_reference = 0;
+        if (event.stack_size) {
+            auto stack_index = intern_stack(i);
+            if (!stack_index.has_value())
+                return ENOMEM;
+            stack_reference = stack_index.value() + 1;
+        }
+        Optional<u32> string_index = 0;
+        if (event.type == PERF_EVENT_MMAP)
+            string_index = intern_string(event.data.mmap.name);
+        else if (event.type == PERF_EVENT_PROCESS_CREATE)
+            string_index = intern_string(event.data.process_create.executable);
+        else if (event.type == PERF_EVENT_PROCESS_EXEC)
+            string_index = intern_string(event.data.process_exec.executable);
+        if (!string_index.has_value())
+            return ENOMEM;
+
+        builder.append(static_cast<char>(Perfcore::RecordType::Event));
+        append_varint(builder, event.type);
+        append_varint(builder, event.pid);
+        append_varint(builder, event.tid);
+        append_varint(builder, Perfcore::zigzag_encode(static_cast<i64>(event.timestamp - previous_timestamp)));
+        previous_timestamp = event.timestamp;
+        append_varint(builder, seen_first_sample ? event.lost_samples : 0);
+        if (event.type == PERF_EVENT_SAMPLE)
+            seen_first_sample = true;
+        append_varint(builder, stack_reference);
+
         switch (event.type) {
-        case PERF_EVENT_SAMPLE:
-            event_object.add("type", "sample");
-            break;
         case PERF_EVENT_MALLOC:
-            event_object.add("type", "malloc");
-            event_object.add("ptr", static_cast<u64>(event.data.malloc.ptr));
-            event_object.add("size", static_cast<u64>(event.data.malloc.size));
+            append_varint(builder, event.data.malloc.ptr);
+            append_varint(builder, event.data.malloc.size);
             break;
         case PERF_EVENT_FREE:
-            event_object.add("type", "free");
-            event_object.add("ptr", static_cast<u64>(event.data.free.ptr));
+            append_varint(builder, event.data.free.ptr);
             break;
         case PERF_EVENT_MMAP:
-            event_object.add("type", "mmap");
-            event_object.add("ptr", static_cast<u64>(event.data.mmap.ptr));
-            event_object.add("size", static_cast<u64>(event.data.mmap.size));
-            event_object.add("name", event.data.mmap.name);
+            append_varint(builder, event.data.mmap.ptr);
+            append_varint(builder, event.data.mmap.size);
+            append_varint(builder, string_index.value());
             break;
         case PERF_EVENT_MUNMAP:
-            event_object.add("type", "munmap");
-            event_object.add("ptr", static_cast<u64>(event.data.munmap.ptr));
-            event_object.add("size", static_cast<u64>(event.data.munmap.size));
+            append_varint(builder, event.data.munmap.ptr);
+            append_varint(builder, event.data.munmap.size);
             break;
         case PERF_EVENT_PROCESS_CREATE:
-            event_object.add("type", "process_create");
-            event_object.add("parent_pid", static_cast<u64>(event.data.process_create.parent_pid));
-            event_object.add("executable", event.data.process_create.executable);
+            append_varint(builder, event.data.process_create.parent_pid);
+            append_varint(builder, string_index.value());
             break;
         case PERF_EVENT_PROCESS_EXEC:
-            event_object.add("type", "process_exec");
-            event_object.add("executable", event.data.process_exec.executable);
-            break;
-        case PERF_EVENT_PROCESS_EXIT:
-            event_object.add("type", "process_exit");
+            append_varint(builder, string_index.value());
             break;
         case PERF_EVENT_THREAD_CREATE:
-            event_object.add("type", "thread_create");
-            event_object.add("parent_tid", static_cast<u64>(event.data.thread_create.parent_tid));
-            break;
-        case PERF_EVENT_THREAD_EXIT:
-            event_object.add("type", "thread_exit");
+            append_varint(builder, event.data.thread_create.parent_tid);
             break;
         case PERF_EVENT_CONTEXT_SWITCH:
-            event_object.add("type", "context_switch");
-            event_object.add("next_pid", static_cast<u64>(event.data.context_switch.next_pid));
-            event_object.add("next_tid", static_cast<u64>(event.data.context_switch.next_tid));
+            append_varint(builder, event.data.context_switch.next_pid);
+            append_varint(builder, event.data.context_switch.next_tid);
             break;
         case PERF_EVENT_KMALLOC:
-            event_object.add("type", "kmalloc");
-            event_object.add("ptr", static_cast<u64>(event.data.kmalloc.ptr));
-            event_object.add("size", static_cast<u64>(event.data.kmalloc.size));
+            append_varint(builder, event.data.kmalloc.ptr);
+            append_varint(builder, event.data.kmalloc.size);
             break;
         case PERF_EVENT_KFREE:
-            event_object.add("type", "kfree");
-            event_object.add("ptr", static_cast<u64>(event.data.kfree.ptr));
-            event_object.add("size", static_cast<u64>(event.data.kfree.size));
-            break;
-        case PERF_EVENT_PAGE_FAULT:
-            event_object.add("type", "page_fault");
-            break;
-        case PERF_EVENT_SYSCALL:
-            event_object.add("type", "syscall");
+            append_varint(builder, event.data.kfree.ptr);
+            append_varint(builder, event.data.kfree.size);
             break;
         case PERF_EVENT_SIGNPOST:
-            event_object.add("type"sv, "signpost"sv);
-            event_object.add("arg1"sv, event.data.signpost.arg1);
-            event_object.add("arg2"sv, event.data.signpost.arg2);
+            append_varint(builder, event.data.signpost.arg1);
+            append_varint(builder, event.data.signpost.arg2);
             break;
         }
-        event_object.add("pid", event.pid);
-        event_object.add("tid", event.tid);
-        event_object.add("timestamp", event.timestamp);
-        event_object.add("lost_samples", seen_first_sample ? event.lost_samples : 0);
-        if (event.type == PERF_EVENT_SAMPLE)
-            seen_first_sample = true;
-        auto stack_array = event_object.add_array("stack");
-        for (size_t j = 0; j < event.stack_size; ++j) {
-            stack_array.add(event.stack[j]);
-        }
-        stack_array.finish();
-        event_object.finish();
     }
-    array.finish();
-    object.finish();
-    return true;
-}
-
-bool PerformanceEventBuffer::to_json(KBufferBuilder& builder) const
-{
-    JsonObjectSerializer object(builder);
-    return to_json_impl(object);
+    return KSuccess;
 }
 
 OwnPtr<PerformanceEventBuffer> PerformanceEventBuffer::try_create_with_size(size_t buffer_size)
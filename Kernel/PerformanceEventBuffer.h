@@ -116,7 +116,8 @@ public:
         return const_cast<PerformanceEventBuffer&>(*this).at(index);
     }
 
-    bool to_json(KBufferBuilder&) const;
+    // Serializes the events in the binary perfcore format described in Kernel/API/Perfcore.h.
+    KResult to_binary(KBufferBuilder&) const;
 
     void add_process(const Process&, ProcessEventType event_type);
 
@@ -125,9 +126,6 @@ public:
 private:
     explicit PerformanceEventBuffer(NonnullOwnPtr<KBuffer>);
 
-    template<typename Serializer>
-    bool to_json_impl(Serializer&) const;
-
     PerformanceEvent& at(size_t index);
 
     size_t m_count { 0 };
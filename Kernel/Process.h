@@ -315,6 +315,9 @@ public:
     KResultOr<FlatPtr> sys$purge(int mode);
     KResultOr<FlatPtr> sys$select(Userspace<const Syscall::SC_select_params*>);
     KResultOr<FlatPtr> sys$poll(Userspace<const Syscall::SC_poll_params*>);
+    KResultOr<FlatPtr> sys$epoll_create(u32 flags);
+    KResultOr<FlatPtr> sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*>);
+    KResultOr<FlatPtr> sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*>);
     KResultOr<FlatPtr> sys$get_dir_entries(int fd, Userspace<void*>, size_t);
     KResultOr<FlatPtr> sys$getcwd(Userspace<char*>, size_t);
     KResultOr<FlatPtr> sys$chdir(Userspace<const char*>, size_t);
@@ -370,6 +373,7 @@ public:
     KResultOr<FlatPtr> sys$connect(int sockfd, Userspace<const sockaddr*>, socklen_t);
     KResultOr<FlatPtr> sys$shutdown(int sockfd, int how);
     KResultOr<FlatPtr> sys$sendmsg(int sockfd, Userspace<const struct msghdr*>, int flags);
+    KResultOr<FlatPtr> sys$sendfile(Userspace<const Syscall::SC_sendfile_params*>);
     KResultOr<FlatPtr> sys$recvmsg(int sockfd, Userspace<struct msghdr*>, int flags);
     KResultOr<FlatPtr> sys$getsockopt(Userspace<const Syscall::SC_getsockopt_params*>);
     KResultOr<FlatPtr> sys$setsockopt(Userspace<const Syscall::SC_setsockopt_params*>);
@@ -171,7 +171,7 @@ KResult Process::procfs_get_perf_events(KBufferBuilder& builder) const
         dbgln("ProcFS: No perf events for {}", pid());
         return KResult(ENOBUFS);
     }
-    return const_cast<Process&>(*this).perf_events()->to_json(builder) ? KSuccess : KResult(EINVAL);
+    return const_cast<Process&>(*this).perf_events()->to_binary(builder);
 }
 
 KResult Process::procfs_get_fds_stats(KBufferBuilder& builder) const
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+// Upper bound on how many events a single epoll_wait() call will return.
+static constexpr int max_epoll_events_per_wait = 1024;
+
+KResultOr<FlatPtr> Process::sys$epoll_create(u32 flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    auto fd_or_error = m_fds.allocate();
+    if (fd_or_error.is_error())
+        return fd_or_error.error();
+    auto epoll_fd = fd_or_error.release_value();
+
+    auto epoll_or_error = EPoll::create();
+    if (epoll_or_error.is_error())
+        return epoll_or_error.error();
+
+    auto description_or_error = FileDescription::try_create(*epoll_or_error.value());
+    if (description_or_error.is_error())
+        return description_or_error.error();
+
+    m_fds[epoll_fd.fd].set(description_or_error.release_value(), (flags & EPOLL_CLOEXEC) ? FD_CLOEXEC : 0);
+    m_fds[epoll_fd.fd].description()->set_readable(true);
+    return epoll_fd.fd;
+}
+
+KResultOr<FlatPtr> Process::sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_epoll_ctl_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    auto epoll_description = fds().file_description(params.epfd);
+    if (!epoll_description)
+        return EBADF;
+    if (!epoll_description->is_epoll())
+        return EINVAL;
+    auto* epoll = epoll_description->epoll();
+
+    auto description = fds().file_description(params.fd);
+    if (!description)
+        return EBADF;
+    if (description == epoll_description)
+        return EINVAL;
+
+    epoll_event event {};
+    if (params.op != EPOLL_CTL_DEL && !copy_from_user(&event, params.event))
+        return EFAULT;
+
+    switch (params.op) {
+    case EPOLL_CTL_ADD:
+        return epoll->add_watch(params.fd, *description, event);
+    case EPOLL_CTL_MOD:
+        return epoll->modify_watch(params.fd, *description, event);
+    case EPOLL_CTL_DEL:
+        return epoll->remove_watch(params.fd, *description);
+    default:
+        return EINVAL;
+    }
+}
+
+KResultOr<FlatPtr> Process::sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_epoll_wait_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    if (params.maxevents <= 0)
+        return EINVAL;
+
+    auto description = fds().file_description(params.epfd);
+    if (!description)
+        return EBADF;
+    if (!description->is_epoll())
+        return EINVAL;
+    auto* epoll = description->epoll();
+
+    bool should_poll_only = false;
+    Thread::BlockTimeout timeout;
+    if (params.timeout) {
+        auto timeout_time = copy_time_from_user(params.timeout);
+        if (!timeout_time.has_value())
+            return EFAULT;
+        should_poll_only = timeout_time.value() <= Time::zero();
+        timeout = Thread::BlockTimeout(false, &timeout_time.value());
+    }
+
+    auto current_thread = Thread::current();
+
+    u32 previous_signal_mask = 0;
+    if (params.sigmask) {
+        sigset_t sigmask_copy;
+        if (!copy_from_user(&sigmask_copy, params.sigmask))
+            return EFAULT;
+        previous_signal_mask = current_thread->update_signal_mask(sigmask_copy);
+    }
+    ScopeGuard rollback_signal_mask([&]() {
+        if (params.sigmask)
+            current_thread->update_signal_mask(previous_signal_mask);
+    });
+
+    Vector<epoll_event, 32> events;
+    if (!events.try_resize(min(params.maxevents, max_epoll_events_per_wait)))
+        return ENOMEM;
+
+    for (;;) {
+        auto count = epoll->collect_ready_events(events.span());
+        if (count > 0) {
+            if (!copy_to_user(params.events, events.data(), count * sizeof(epoll_event)))
+                return EFAULT;
+            return count;
+        }
+        if (should_poll_only)
+            return 0;
+
+        // The timeout is absolute after construction, so blocking again after a
+        // spurious wakeup (queued watches that turned out not to be ready) doesn't extend it.
+        Thread::SelectBlocker::FDVector fds_info;
+        if (!fds_info.try_append({ *description, BlockFlags::Read }))
+            return ENOMEM;
+
+        dbgln_if(POLL_SELECT_DEBUG, "epoll_wait: blocking on fd {}, timeout={}", params.epfd, params.timeout);
+
+        auto block_result = current_thread->block<Thread::SelectBlocker>(timeout, fds_info);
+        if (block_result.was_interrupted())
+            return EINTR;
+        if (block_result == Thread::BlockResult::InterruptedByTimeout)
+            return 0;
+    }
+}
+
+}
@@ -199,16 +199,32 @@ KResultOr<FlatPtr> Process::sys$mmap(Userspace<const Syscall::SC_mmap_params*> u
     Memory::Region* region = nullptr;
     Optional<Memory::VirtualRange> range;
 
-    if (map_randomized) {
-        range = address_space().page_directory().range_allocator().allocate_randomized(Memory::page_round_up(size), alignment);
-    } else {
-        range = address_space().allocate_range(VirtualAddress(addr), size, alignment);
-        if (!range.has_value()) {
-            if (addr && !map_fixed) {
-                // If there's an address but MAP_FIXED wasn't specified, the address is just a hint.
-                range = address_space().allocate_range({}, size, alignment);
+    auto allocate_range = [&](size_t range_alignment) {
+        if (map_randomized) {
+            range = address_space().page_directory().range_allocator().allocate_randomized(Memory::page_round_up(size), range_alignment);
+        } else {
+            range = address_space().allocate_range(VirtualAddress(addr), size, range_alignment);
+            if (!range.has_value()) {
+                if (addr && !map_fixed) {
+                    // If there's an address but MAP_FIXED wasn't specified, the address is just a hint.
+                    range = address_space().allocate_range({}, size, range_alignment);
+                }
             }
         }
+    };
+
+    // Big anonymous memory gets a large page aligned address, so that it can be backed by large pages.
+    bool could_use_large_pages = map_anonymous;
+    if (!map_anonymous) {
+        if (auto description = fds().file_description(fd))
+            could_use_large_pages = description->file().is_anonymous_file();
+    }
+    if (could_use_large_pages && !addr && !map_stack && Memory::page_round_up(size) >= Memory::large_page_size && alignment < Memory::large_page_size) {
+        allocate_range(Memory::large_page_size);
+        if (!range.has_value())
+            allocate_range(alignment);
+    } else {
+        allocate_range(alignment);
     }
 
     if (!range.has_value())
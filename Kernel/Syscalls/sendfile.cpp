@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+// Large enough to keep a socket's send path busy, small enough that we don't hog memory for huge files.
+static constexpr size_t sendfile_chunk_size = 64 * KiB;
+
+KResultOr<FlatPtr> Process::sys$sendfile(Userspace<const Syscall::SC_sendfile_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    REQUIRE_PROMISE(stdio);
+    Syscall::SC_sendfile_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    auto in_description = fds().file_description(params.in_fd);
+    if (!in_description)
+        return EBADF;
+    if (!in_description->is_readable())
+        return EBADF;
+    // Only inode-backed files have stable contents we can read at an arbitrary offset.
+    if (!in_description->file().is_inode() || in_description->is_directory())
+        return EINVAL;
+
+    auto out_description = fds().file_description(params.out_fd);
+    if (!out_description)
+        return EBADF;
+    if (!out_description->is_writable())
+        return EBADF;
+
+    size_t count = min(params.count, static_cast<size_t>(NumericLimits<ssize_t>::max()));
+    if (count == 0)
+        return 0;
+
+    off_t offset;
+    if (params.offset) {
+        if (!copy_from_user(&offset, params.offset))
+            return EFAULT;
+        if (offset < 0)
+            return EINVAL;
+    } else {
+        offset = in_description->offset();
+    }
+
+    auto chunk = KBuffer::try_create_with_size(min(count, sendfile_chunk_size), Memory::Region::Access::ReadWrite, "sendfile");
+    if (!chunk)
+        return ENOMEM;
+    auto chunk_buffer = UserOrKernelBuffer::for_kernel_buffer(chunk->data());
+
+    size_t total_nsent = 0;
+    KResult error = KSuccess;
+    while (total_nsent < count) {
+        auto nread_or_error = in_description->read(chunk_buffer, offset, min(count - total_nsent, chunk->size()));
+        if (nread_or_error.is_error()) {
+            error = nread_or_error.error();
+            break;
+        }
+        auto nread = nread_or_error.value();
+        if (nread == 0)
+            break;
+
+        // The data never leaves the kernel: it goes straight from the inode into the out file's write path.
+        auto nwritten_or_error = do_write(*out_description, chunk_buffer, nread);
+        if (nwritten_or_error.is_error()) {
+            error = nwritten_or_error.error();
+            break;
+        }
+        auto nwritten = nwritten_or_error.value();
+        total_nsent += nwritten;
+        offset += nwritten;
+        // A short write means a non-blocking out file is full; let the caller come back later.
+        if (nwritten < nread)
+            break;
+    }
+
+    if (params.offset) {
+        if (!copy_to_user(params.offset, &offset))
+            return EFAULT;
+    } else {
+        if (auto result = in_description->seek(offset, SEEK_SET); result.is_error())
+            return result.error();
+    }
+
+    if (total_nsent == 0 && error.is_error())
+        return error;
+    return total_nsent;
+}
+
+}
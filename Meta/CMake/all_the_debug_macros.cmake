@@ -73,6 +73,7 @@ set(HEX_DEBUG ON)
 set(HIGHLIGHT_FOCUSED_FRAME_DEBUG ON)
 set(HPET_COMPARATOR_DEBUG ON)
 set(HPET_DEBUG ON)
+set(HTML_PRELOAD_SCANNER_DEBUG ON)
 set(HTML_SCRIPT_DEBUG ON)
 set(HTTPSJOB_DEBUG ON)
 set(HUNKS_DEBUG ON)
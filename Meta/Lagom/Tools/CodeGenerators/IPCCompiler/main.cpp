@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AnyOf.h>
 #include <AK/Debug.h>
 #include <AK/Function.h>
 #include <AK/GenericLexer.h>
@@ -65,6 +66,17 @@ static bool is_primitive_type(String const& type)
     return type.is_one_of("u8", "i8", "u16", "i16", "u32", "i32", "u64", "i64", "bool", "double", "float", "int", "unsigned", "unsigned int");
 }
 
+// Parameters of these types point into the message they were decoded from instead of owning a copy.
+static bool is_view_type(String const& type)
+{
+    return type.is_one_of("StringView", "ReadonlyBytes");
+}
+
+static bool has_view_parameters(Vector<Parameter> const& parameters)
+{
+    return any_of(parameters.begin(), parameters.end(), [](auto& parameter) { return is_view_type(parameter.type); });
+}
+
 static String message_name(String const& endpoint, String& message, bool is_response)
 {
     StringBuilder builder;
@@ -177,6 +189,12 @@ int main(int argc, char** argv)
             assert_specific('(');
             parse_parameters(message.outputs);
             assert_specific(')');
+
+            // Responses are handed to the caller after the message they were decoded from is gone.
+            if (has_view_parameters(message.outputs)) {
+                warnln("Error: Response of {} cannot have view parameters", message.name);
+                exit(1);
+            }
         }
 
         consume_whitespace();
@@ -379,11 +397,26 @@ public:
    typedef class @message.response_type@ ResponseType;
 )~~~");
 
-            message_generator.append(R"~~~(
+            bool has_views = has_view_parameters(parameters);
+
+            if (has_views) {
+                // A copy's views would point into the original's bytes.
+                message_generator.append(R"~~~(
+    @message.pascal_name@(decltype(nullptr)) : m_ipc_message_valid(false) { }
+    @message.pascal_name@(@message.pascal_name@ const&) = delete;
+    @message.pascal_name@(@message.pascal_name@&&) = default;
+    @message.pascal_name@& operator=(@message.pascal_name@ const&) = delete;
+)~~~");
+            } else {
+                message_generator.append(R"~~~(
     @message.pascal_name@(decltype(nullptr)) : m_ipc_message_valid(false) { }
     @message.pascal_name@(@message.pascal_name@ const&) = default;
     @message.pascal_name@(@message.pascal_name@&&) = default;
     @message.pascal_name@& operator=(@message.pascal_name@ const&) = default;
+)~~~");
+            }
+
+            message_generator.append(R"~~~(
     @message.constructor@
     virtual ~@message.pascal_name@() override {}
 
@@ -394,8 +427,22 @@ public:
 
     static OwnPtr<@message.pascal_name@> decode(InputMemoryStream& stream, [[maybe_unused]] int sockfd)
     {
+)~~~");
+
+            if (has_views) {
+                // Keep a single copy of the message around for the views to point into,
+                // instead of a separate allocation for every string and buffer.
+                message_generator.append(R"~~~(
+        Vector<u8> ipc_message_bytes;
+        ipc_message_bytes.append(stream.bytes().slice(stream.offset()).data(), stream.remaining());
+        InputMemoryStream view_stream { ipc_message_bytes.span() };
+        IPC::Decoder decoder { view_stream, sockfd };
+)~~~");
+            } else {
+                message_generator.append(R"~~~(
         IPC::Decoder decoder { stream, sockfd };
 )~~~");
+            }
 
             for (auto& parameter : parameters) {
                 auto parameter_generator = message_generator.fork();
@@ -434,19 +481,44 @@ public:
 
             message_generator.set("message.constructor_call_parameters", builder.build());
 
-            message_generator.append(R"~~~(
+            if (has_views) {
+                message_generator.append(R"~~~(
+        if (!stream.discard_or_error(view_stream.offset()))
+            return {};
+        auto message = make<@message.pascal_name@>(@message.constructor_call_parameters@);
+        message->m_ipc_message_bytes = move(ipc_message_bytes);
+        return message;
+    }
+)~~~");
+            } else {
+                message_generator.append(R"~~~(
         return make<@message.pascal_name@>(@message.constructor_call_parameters@);
     }
 )~~~");
+            }
 
             message_generator.append(R"~~~(
     virtual bool valid() const { return m_ipc_message_valid; }
 
-    virtual IPC::MessageBuffer encode() const override
+    virtual void encode(IPC::MessageBuffer& buffer) const override
     {
         VERIFY(valid());
 
-        IPC::MessageBuffer buffer;
+        size_t size_hint = sizeof(u32) + sizeof(i32);
+)~~~");
+
+            for (auto& parameter : parameters) {
+                auto parameter_generator = message_generator.fork();
+
+                parameter_generator.set("parameter.name", parameter.name);
+                parameter_generator.append(R"~~~(
+        size_hint += IPC::encoded_size_hint(m_@parameter.name@);
+)~~~");
+            }
+
+            message_generator.append(R"~~~(
+        buffer.data.ensure_capacity(buffer.data.size() + size_hint);
+
         IPC::Encoder stream(buffer);
         stream << endpoint_magic();
         stream << (int)MessageID::@message.pascal_name@;
@@ -462,7 +534,6 @@ public:
             }
 
             message_generator.append(R"~~~(
-        return buffer;
     }
 )~~~");
 
@@ -490,6 +561,12 @@ private:
 )~~~");
             }
 
+            if (has_views) {
+                message_generator.append(R"~~~(
+    Vector<u8> m_ipc_message_bytes;
+)~~~");
+            }
+
             message_generator.append(R"~~~(
 };
             )~~~");
@@ -785,7 +862,9 @@ public:
             [[maybe_unused]] auto& request = static_cast<const Messages::@endpoint.name@::@message.pascal_name@&>(message);
             @handler_name@(@arguments@);
             auto response = Messages::@endpoint.name@::@message.response_type@ { };
-            return make<IPC::MessageBuffer>(response.encode());
+            auto buffer = make<IPC::MessageBuffer>();
+            response.encode(*buffer);
+            return buffer;
 )~~~");
                     } else {
                         message_generator.append(R"~~~(
@@ -793,7 +872,9 @@ public:
             auto response = @handler_name@(@arguments@);
             if (!response.valid())
                 return {};
-            return make<IPC::MessageBuffer>(response.encode());
+            auto buffer = make<IPC::MessageBuffer>();
+            response.encode(*buffer);
+            return buffer;
 )~~~");
                     }
                 } else {
@@ -832,7 +913,7 @@ public:
                 auto make_argument_type = [](String const& type) {
                     StringBuilder builder;
 
-                    bool const_ref = !is_primitive_type(type);
+                    bool const_ref = !is_primitive_type(type) && !is_view_type(type);
 
                     builder.append(type);
                     if (const_ref)
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/BloomFilter.h>
+#include <AK/HashFunctions.h>
+
+TEST_CASE(empty_filter_contains_nothing)
+{
+    BloomFilter<256> filter;
+    for (u32 i = 0; i < 1000; ++i)
+        EXPECT(!filter.may_contain(int_hash(i)));
+}
+
+TEST_CASE(added_hashes_are_always_found)
+{
+    BloomFilter<1024> filter;
+    for (u32 i = 0; i < 100; ++i)
+        filter.add(int_hash(i));
+    for (u32 i = 0; i < 100; ++i)
+        EXPECT(filter.may_contain(int_hash(i)));
+}
+
+TEST_CASE(false_positives_are_rare_when_sparse)
+{
+    BloomFilter<1024> filter;
+    for (u32 i = 0; i < 16; ++i)
+        filter.add(int_hash(i));
+
+    size_t false_positives = 0;
+    for (u32 i = 1000; i < 2000; ++i) {
+        if (filter.may_contain(int_hash(i)))
+            ++false_positives;
+    }
+    EXPECT(false_positives < 10);
+}
+
+TEST_CASE(clear)
+{
+    BloomFilter<64> filter;
+    filter.add(int_hash(42));
+    EXPECT(filter.may_contain(int_hash(42)));
+    filter.clear();
+    EXPECT(!filter.may_contain(int_hash(42)));
+}
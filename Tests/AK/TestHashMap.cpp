@@ -173,3 +173,16 @@ TEST_CASE(basic_contains)
     EXPECT_EQ(map.remove(1), true);
     EXPECT_EQ(map.contains(1), false);
 }
+
+TEST_CASE(try_set)
+{
+    HashMap<int, int> map;
+    for (int i = 0; i < 1000; ++i)
+        EXPECT(map.try_set(i, i * 10));
+    EXPECT_EQ(map.size(), 1000u);
+
+    EXPECT(map.try_set(42, 0));
+    EXPECT_EQ(map.size(), 1000u);
+    EXPECT_EQ(map.get(42).value(), 0);
+    EXPECT_EQ(map.get(999).value(), 9990);
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static String create_temporary_directory()
+{
+    char path[] = "/tmp/dentrycache.XXXXXX";
+    EXPECT(mkdtemp(path) != nullptr);
+    return path;
+}
+
+static bool exists(String const& path)
+{
+    struct stat st;
+    return stat(path.characters(), &st) == 0;
+}
+
+TEST_CASE(negative_lookup_does_not_hide_created_file)
+{
+    auto directory = create_temporary_directory();
+    auto path = String::formatted("{}/file", directory);
+
+    EXPECT(!exists(path));
+    EXPECT(!exists(path));
+    int fd = open(path.characters(), O_CREAT | O_WRONLY, 0644);
+    EXPECT(fd >= 0);
+    close(fd);
+    EXPECT(exists(path));
+
+    EXPECT_EQ(unlink(path.characters()), 0);
+    EXPECT(!exists(path));
+    EXPECT_EQ(rmdir(directory.characters()), 0);
+}
+
+TEST_CASE(rename_is_visible_at_both_names)
+{
+    auto directory = create_temporary_directory();
+    auto old_path = String::formatted("{}/old", directory);
+    auto new_path = String::formatted("{}/new", directory);
+
+    int fd = open(old_path.characters(), O_CREAT | O_WRONLY, 0644);
+    EXPECT(fd >= 0);
+    close(fd);
+    EXPECT(exists(old_path));
+    EXPECT(!exists(new_path));
+
+    EXPECT_EQ(rename(old_path.characters(), new_path.characters()), 0);
+    EXPECT(!exists(old_path));
+    EXPECT(exists(new_path));
+
+    EXPECT_EQ(unlink(new_path.characters()), 0);
+    EXPECT_EQ(rmdir(directory.characters()), 0);
+}
+
+TEST_CASE(removed_directory_is_not_resolved)
+{
+    auto directory = create_temporary_directory();
+    auto subdirectory = String::formatted("{}/sub", directory);
+    auto inner_path = String::formatted("{}/inner", subdirectory);
+
+    EXPECT_EQ(mkdir(subdirectory.characters(), 0755), 0);
+    EXPECT(!exists(inner_path));
+    EXPECT_EQ(rmdir(subdirectory.characters()), 0);
+
+    struct stat st;
+    EXPECT_EQ(stat(inner_path.characters(), &st), -1);
+    EXPECT_EQ(errno, ENOENT);
+    EXPECT(!exists(subdirectory));
+    EXPECT_EQ(rmdir(directory.characters()), 0);
+}
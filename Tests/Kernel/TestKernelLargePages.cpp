@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+static constexpr size_t large_page_size = 2 * MiB;
+
+static u8* map_and_fill(size_t size)
+{
+    auto* ptr = (u8*)mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    EXPECT_NE(ptr, MAP_FAILED);
+    for (size_t i = 0; i < size; i += PAGE_SIZE)
+        ptr[i] = (u8)(i / PAGE_SIZE);
+    return ptr;
+}
+
+static void expect_filled(u8 const* ptr, size_t offset, size_t size)
+{
+    for (size_t i = offset; i < offset + size; i += PAGE_SIZE)
+        EXPECT_EQ(ptr[i], (u8)(i / PAGE_SIZE));
+}
+
+TEST_CASE(big_anonymous_mappings_are_large_page_aligned)
+{
+    auto* ptr = map_and_fill(2 * large_page_size);
+    EXPECT_EQ((uintptr_t)ptr % large_page_size, 0u);
+    expect_filled(ptr, 0, 2 * large_page_size);
+    EXPECT_EQ(munmap(ptr, 2 * large_page_size), 0);
+}
+
+TEST_CASE(partial_mprotect_splits_large_page)
+{
+    auto* ptr = map_and_fill(large_page_size);
+    EXPECT_EQ(mprotect(ptr + 16 * PAGE_SIZE, PAGE_SIZE, PROT_READ), 0);
+    expect_filled(ptr, 0, large_page_size);
+
+    // The rest of the mapping must stay writable.
+    ptr[0] = 0xaa;
+    ptr[large_page_size - PAGE_SIZE] = 0xbb;
+    EXPECT_EQ(ptr[0], 0xaa);
+    EXPECT_EQ(ptr[large_page_size - PAGE_SIZE], 0xbb);
+    EXPECT_EQ(munmap(ptr, large_page_size), 0);
+}
+
+TEST_CASE(partial_munmap_splits_large_page)
+{
+    auto* ptr = map_and_fill(2 * large_page_size);
+    EXPECT_EQ(munmap(ptr + PAGE_SIZE, 4 * PAGE_SIZE), 0);
+    EXPECT_EQ(ptr[0], 0);
+    expect_filled(ptr, 5 * PAGE_SIZE, 2 * large_page_size - 5 * PAGE_SIZE);
+    EXPECT_EQ(munmap(ptr, 2 * large_page_size), 0);
+}
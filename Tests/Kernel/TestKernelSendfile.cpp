@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+
+static int create_temporary_file(char const* contents)
+{
+    char path[] = "/tmp/sendfile.XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT(fd >= 0);
+    unlink(path);
+    size_t length = strlen(contents);
+    EXPECT_EQ(write(fd, contents, length), static_cast<ssize_t>(length));
+    EXPECT_EQ(lseek(fd, 0, SEEK_SET), 0);
+    return fd;
+}
+
+TEST_CASE(sendfile_advances_file_offset)
+{
+    int file_fd = create_temporary_file("hello friends");
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    EXPECT_EQ(sendfile(pipe_fds[1], file_fd, nullptr, 5), 5);
+    EXPECT_EQ(lseek(file_fd, 0, SEEK_CUR), 5);
+    EXPECT_EQ(sendfile(pipe_fds[1], file_fd, nullptr, 100), 8);
+    EXPECT_EQ(sendfile(pipe_fds[1], file_fd, nullptr, 100), 0);
+
+    char buffer[32] {};
+    EXPECT_EQ(read(pipe_fds[0], buffer, sizeof(buffer)), 13);
+    EXPECT_EQ(StringView(buffer), "hello friends");
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(file_fd);
+}
+
+TEST_CASE(sendfile_with_explicit_offset_leaves_file_offset_alone)
+{
+    int file_fd = create_temporary_file("hello friends");
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    off_t offset = 6;
+    EXPECT_EQ(sendfile(pipe_fds[1], file_fd, &offset, 7), 7);
+    EXPECT_EQ(offset, 13);
+    EXPECT_EQ(lseek(file_fd, 0, SEEK_CUR), 0);
+
+    char buffer[32] {};
+    EXPECT_EQ(read(pipe_fds[0], buffer, sizeof(buffer)), 7);
+    EXPECT_EQ(StringView(buffer), "friends");
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(file_fd);
+}
+
+TEST_CASE(sendfile_rejects_non_inode_input)
+{
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    EXPECT_EQ(sendfile(pipe_fds[1], pipe_fds[0], nullptr, 1), -1);
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(sendfile(pipe_fds[1], -1, nullptr, 1), -1);
+    EXPECT_EQ(errno, EBADF);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
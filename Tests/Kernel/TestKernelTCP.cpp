@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
+#include <LibCore/File.h>
+#include <LibTest/TestCase.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Large enough that the transfer can't complete inside an unscaled 64 KiB window.
+static constexpr size_t transfer_size = 1 * MiB;
+
+static u8 pattern_byte(size_t offset)
+{
+    return static_cast<u8>((offset * 7) ^ (offset >> 11));
+}
+
+static u16 socket_port(int fd)
+{
+    sockaddr_in address {};
+    socklen_t address_length = sizeof(address);
+    EXPECT_EQ(getsockname(fd, reinterpret_cast<sockaddr*>(&address), &address_length), 0);
+    return ntohs(address.sin_port);
+}
+
+struct Connection {
+    int listen_fd { -1 };
+    int client_fd { -1 };
+    int server_fd { -1 };
+};
+
+static Connection connect_over_loopback()
+{
+    Connection connection;
+    connection.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT(connection.listen_fd >= 0);
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    EXPECT_EQ(bind(connection.listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    EXPECT_EQ(listen(connection.listen_fd, 1), 0);
+    address.sin_port = htons(socket_port(connection.listen_fd));
+
+    connection.client_fd = socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT(connection.client_fd >= 0);
+    EXPECT_EQ(connect(connection.client_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+
+    connection.server_fd = accept(connection.listen_fd, nullptr, nullptr);
+    EXPECT(connection.server_fd >= 0);
+    return connection;
+}
+
+static void close_connection(Connection const& connection)
+{
+    close(connection.server_fd);
+    close(connection.client_fd);
+    close(connection.listen_fd);
+}
+
+static Optional<JsonObject> find_tcp_socket(u16 local_port, u16 peer_port)
+{
+    auto file = Core::File::construct("/proc/net/tcp");
+    if (!file->open(Core::OpenMode::ReadOnly))
+        return {};
+    auto json = JsonValue::from_string(file->read_all());
+    if (!json.has_value() || !json.value().is_array())
+        return {};
+
+    Optional<JsonObject> result;
+    json.value().as_array().for_each([&](auto& value) {
+        auto& object = value.as_object();
+        if (object.get("local_port").to_u32() == local_port && object.get("peer_port").to_u32() == peer_port)
+            result = object;
+    });
+    return result;
+}
+
+TEST_CASE(loopback_connection_negotiates_window_scaling_and_sack)
+{
+    auto connection = connect_over_loopback();
+
+    auto client = find_tcp_socket(socket_port(connection.client_fd), socket_port(connection.server_fd));
+    EXPECT(client.has_value());
+    if (client.has_value()) {
+        EXPECT(client->get("window_scaling").to_bool());
+        EXPECT(client->get("selective_acks").to_bool());
+        EXPECT(client->get("mss").to_u32() > 0);
+        EXPECT(client->get("congestion_window").to_u32() >= client->get("mss").to_u32());
+        EXPECT(client->get("retransmit_timeout_us").to_u32() > 0);
+    }
+
+    close_connection(connection);
+}
+
+TEST_CASE(loopback_transfer_larger_than_unscaled_window)
+{
+    auto connection = connect_over_loopback();
+
+    pid_t pid = fork();
+    EXPECT(pid >= 0);
+    if (pid == 0) {
+        u8 buffer[4096];
+        for (size_t offset = 0; offset < transfer_size;) {
+            size_t chunk_size = min(sizeof(buffer), transfer_size - offset);
+            for (size_t i = 0; i < chunk_size; ++i)
+                buffer[i] = pattern_byte(offset + i);
+            auto nwritten = write(connection.client_fd, buffer, chunk_size);
+            if (nwritten <= 0)
+                _exit(1);
+            offset += nwritten;
+        }
+        close(connection.client_fd);
+        _exit(0);
+    }
+    close(connection.client_fd);
+
+    size_t total_received = 0;
+    bool contents_match = true;
+    u8 buffer[8192];
+    for (;;) {
+        auto nread = read(connection.server_fd, buffer, sizeof(buffer));
+        EXPECT(nread >= 0);
+        if (nread <= 0)
+            break;
+        for (ssize_t i = 0; i < nread; ++i) {
+            if (buffer[i] != pattern_byte(total_received + i))
+                contents_match = false;
+        }
+        total_received += nread;
+    }
+    EXPECT_EQ(total_received, transfer_size);
+    EXPECT(contents_match);
+
+    int status = 0;
+    EXPECT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    close(connection.server_fd);
+    close(connection.listen_fd);
+}
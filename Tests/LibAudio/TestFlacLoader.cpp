@@ -0,0 +1,472 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/Vector.h>
+#include <LibAudio/FlacLoader.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/WorkerPool.h>
+#include <math.h>
+
+// The streams are put together here, so that the tests know exactly which frames, seek points and predictors they contain.
+
+static constexpr u32 sample_rate = 44100;
+static constexpr size_t block_size = 1024;
+
+class BitWriter {
+public:
+    void write(u64 value, u8 bit_count)
+    {
+        for (u8 i = bit_count; i-- > 0;)
+            write_bit((value >> i) & 1);
+    }
+
+    void write_bit(bool bit)
+    {
+        if (m_bit_count % 8 == 0)
+            m_bytes.append(0);
+        if (bit)
+            m_bytes.last() |= 0x80 >> (m_bit_count % 8);
+        ++m_bit_count;
+    }
+
+    void align_to_byte_boundary()
+    {
+        while (m_bit_count % 8 != 0)
+            write_bit(false);
+    }
+
+    size_t size() const { return m_bytes.size(); }
+    Vector<u8>& bytes() { return m_bytes; }
+
+private:
+    Vector<u8> m_bytes;
+    size_t m_bit_count { 0 };
+};
+
+struct Predictor {
+    u8 order;
+    u8 precision;
+    u8 shift;
+    // Makes every coefficient as large as the precision allows, so the sums get as large as they can.
+    bool largest_coefficients { false };
+};
+
+struct Signal {
+    Vector<i16> left;
+    Vector<i16> right;
+    size_t size() const { return left.size(); }
+};
+
+static Signal make_signal(size_t sample_count, double amplitude)
+{
+    Signal signal;
+    u32 state = 0x5eed;
+    for (size_t i = 0; i < sample_count; ++i) {
+        state = state * 1103515245 + 12345;
+        int noise = static_cast<int>((state >> 16) % 129) - 64;
+        signal.left.append(static_cast<i16>(clamp(amplitude * sin(i * 0.01) + noise, -32768.0, 32767.0)));
+        signal.right.append(static_cast<i16>(clamp(amplitude * sin(i * 0.023 + 1) - noise, -32768.0, 32767.0)));
+    }
+    return signal;
+}
+
+// Roughly a second order predictor, spread over all the coefficients.
+static Vector<i32> make_coefficients(Predictor const& predictor)
+{
+    Vector<i32> coefficients;
+    coefficients.resize(predictor.order);
+    if (predictor.largest_coefficients) {
+        for (auto& coefficient : coefficients)
+            coefficient = (1 << (predictor.precision - 1)) - 1;
+        return coefficients;
+    }
+    for (size_t t = 0; t < predictor.order; ++t)
+        coefficients[t] = static_cast<i32>(t % 3) - 1;
+    coefficients[0] += 2 << predictor.shift;
+    if (predictor.order > 1)
+        coefficients[1] -= 1 << predictor.shift;
+    return coefficients;
+}
+
+static void write_lpc_subframe(BitWriter& writer, Span<i16 const> samples, Predictor const& predictor)
+{
+    auto coefficients = make_coefficients(predictor);
+
+    writer.write(0, 1);
+    writer.write(0b100000 | (predictor.order - 1), 6);
+    writer.write(0, 1);
+    for (size_t i = 0; i < predictor.order; ++i)
+        writer.write(static_cast<u16>(samples[i]), 16);
+    writer.write(predictor.precision - 1, 4);
+    writer.write(predictor.shift, 5);
+    for (auto coefficient : coefficients)
+        writer.write(static_cast<u32>(coefficient) & ((1u << predictor.precision) - 1), predictor.precision);
+
+    // The residual is computed just like the spec predicts samples, with 64-bit sums.
+    Vector<u32> residual;
+    for (size_t i = predictor.order; i < samples.size(); ++i) {
+        i64 prediction = 0;
+        for (size_t t = 0; t < predictor.order; ++t)
+            prediction += static_cast<i64>(coefficients[t]) * samples[i - t - 1];
+        i32 value = samples[i] - static_cast<i32>(prediction >> predictor.shift);
+        residual.append(value >= 0 ? static_cast<u32>(value) << 1 : (static_cast<u32>(-value) << 1) - 1);
+    }
+
+    // A single Rice partition, with a parameter that keeps the unary parts short.
+    u32 largest = 0;
+    for (auto value : residual)
+        largest = max(largest, value);
+    u8 rice_parameter = 0;
+    while ((largest >> rice_parameter) > 200)
+        ++rice_parameter;
+    VERIFY(rice_parameter < 15);
+
+    writer.write(0, 2);
+    writer.write(0, 4);
+    writer.write(rice_parameter, 4);
+    for (auto value : residual) {
+        for (u32 i = 0; i < (value >> rice_parameter); ++i)
+            writer.write_bit(false);
+        writer.write_bit(true);
+        writer.write(value & ((1u << rice_parameter) - 1), rice_parameter);
+    }
+}
+
+static void write_frame(BitWriter& writer, u32 frame_number, Signal const& signal, size_t first_sample, size_t sample_count, Predictor const& predictor)
+{
+    writer.write(0b11111111111110, 14);
+    writer.write(0, 1);
+    writer.write(0, 1); // Fixed block size
+    writer.write(sample_count == block_size ? 10 : 7, 4);
+    writer.write(9, 4); // 44.1 kHz
+    writer.write(1, 4); // Independent left and right channels
+    writer.write(4, 3); // 16 bits per sample
+    writer.write(0, 1);
+    VERIFY(frame_number < 0x800);
+    if (frame_number < 0x80) {
+        writer.write(frame_number, 8);
+    } else {
+        writer.write(0xc0 | (frame_number >> 6), 8);
+        writer.write(0x80 | (frame_number & 0x3f), 8);
+    }
+    if (sample_count != block_size)
+        writer.write(sample_count - 1, 16);
+    writer.write(0, 8); // CRC-8, which isn't checked
+
+    write_lpc_subframe(writer, signal.left.span().slice(first_sample, sample_count), predictor);
+    write_lpc_subframe(writer, signal.right.span().slice(first_sample, sample_count), predictor);
+    writer.align_to_byte_boundary();
+    writer.write(0, 16); // CRC-16, which isn't checked
+}
+
+struct SeekPoint {
+    u64 sample_index;
+    u64 byte_offset;
+};
+
+static ByteBuffer make_stream(Signal const& signal, Vector<Predictor> const& predictors, size_t seek_point_interval_in_frames, bool corrupt_frame_3 = false)
+{
+    size_t frame_count = (signal.size() + block_size - 1) / block_size;
+
+    BitWriter frames;
+    Vector<SeekPoint> seek_points;
+    Vector<size_t> frame_offsets;
+    for (size_t frame = 0; frame < frame_count; ++frame) {
+        if (seek_point_interval_in_frames && frame % seek_point_interval_in_frames == 0)
+            seek_points.append({ frame * block_size, frames.size() });
+        frame_offsets.append(frames.size());
+        auto first_sample = frame * block_size;
+        write_frame(frames, frame, signal, first_sample, min(block_size, signal.size() - first_sample), predictors[frame % predictors.size()]);
+    }
+    if (corrupt_frame_3)
+        frames.bytes()[frame_offsets[3]] = 0;
+
+    BitWriter writer;
+    writer.write(0x664C6143, 32); // "fLaC"
+
+    writer.write(seek_points.is_empty() ? 1 : 0, 1);
+    writer.write(0, 7); // STREAMINFO
+    writer.write(34, 24);
+    writer.write(block_size, 16);
+    writer.write(block_size, 16);
+    writer.write(0, 24);
+    writer.write(0, 24);
+    writer.write(sample_rate, 20);
+    writer.write(2 - 1, 3);
+    writer.write(16 - 1, 5);
+    writer.write(signal.size(), 36);
+    writer.write(0, 64); // MD5
+    writer.write(0, 64);
+
+    if (!seek_points.is_empty()) {
+        // Placeholder seek points go at the end, and have to be skipped.
+        constexpr size_t placeholder_count = 2;
+        writer.write(1, 1);
+        writer.write(3, 7); // SEEKTABLE
+        writer.write((seek_points.size() + placeholder_count) * 18, 24);
+        for (auto& seek_point : seek_points) {
+            writer.write(seek_point.sample_index, 64);
+            writer.write(seek_point.byte_offset, 64);
+            writer.write(block_size, 16);
+        }
+        for (size_t i = 0; i < placeholder_count; ++i) {
+            writer.write(NumericLimits<u64>::max(), 64);
+            writer.write(0, 64);
+            writer.write(0, 16);
+        }
+    }
+
+    writer.bytes().extend(move(frames.bytes()));
+    return ByteBuffer::copy(writer.bytes().data(), writer.bytes().size());
+}
+
+static size_t count_mismatches(Audio::Buffer const& buffer, Signal const& signal, size_t first_sample)
+{
+    if (first_sample + buffer.sample_count() > signal.size())
+        return buffer.sample_count();
+    size_t mismatches = 0;
+    for (int i = 0; i < buffer.sample_count(); ++i) {
+        auto& frame = buffer.samples()[i];
+        if (frame.left != signal.left[first_sample + i] / 32768.0 || frame.right != signal.right[first_sample + i] / 32768.0)
+            ++mismatches;
+    }
+    return mismatches;
+}
+
+static void expect_samples(Audio::FlacLoaderPlugin& loader, Signal const& signal, size_t first_sample, size_t sample_count)
+{
+    auto buffer = loader.get_more_samples(sample_count);
+    EXPECT(!loader.has_error());
+    EXPECT(!buffer.is_null());
+    if (buffer.is_null())
+        return;
+    EXPECT_EQ(static_cast<size_t>(buffer->sample_count()), sample_count);
+    EXPECT_EQ(count_mismatches(*buffer, signal, first_sample), 0u);
+    EXPECT_EQ(static_cast<size_t>(loader.loaded_samples()), first_sample + sample_count);
+}
+
+static Vector<Predictor> const mixed_predictors = {
+    { 8, 12, 9 },
+    { 5, 12, 9 },
+    { 2, 14, 11 },
+    { 32, 10, 7 },
+    { 8, 15, 12 },
+};
+
+// 47 full frames and a short one at the end, with a seek point every 8 frames.
+static constexpr size_t seekable_sample_count = 47 * block_size + 500;
+
+TEST_CASE(decode_whole_stream)
+{
+    auto signal = make_signal(seekable_sample_count, 8000);
+    auto data = make_stream(signal, mixed_predictors, 8);
+    Audio::FlacLoaderPlugin loader(data);
+    EXPECT(loader.sniff());
+    EXPECT_EQ(static_cast<size_t>(loader.total_samples()), seekable_sample_count);
+
+    size_t position = 0;
+    while (auto buffer = loader.get_more_samples(3000)) {
+        EXPECT_EQ(count_mismatches(*buffer, signal, position), 0u);
+        position += buffer->sample_count();
+    }
+    EXPECT(!loader.has_error());
+    EXPECT_EQ(position, seekable_sample_count);
+}
+
+TEST_CASE(seek_uses_seektable)
+{
+    // Frame 3 is broken, so the only way to get past it is to jump straight to a seek point after it.
+    auto signal = make_signal(seekable_sample_count, 8000);
+    auto data = make_stream(signal, mixed_predictors, 8, true);
+    Audio::FlacLoaderPlugin loader(data);
+    EXPECT(loader.sniff());
+
+    loader.seek(20000);
+    expect_samples(loader, signal, 20000, 1000);
+
+    // Without a seek table, seeking has to decode its way there, and runs into the broken frame.
+    auto data_without_seektable = make_stream(signal, mixed_predictors, 0, true);
+    Audio::FlacLoaderPlugin loader_without_seektable(data_without_seektable);
+    EXPECT(loader_without_seektable.sniff());
+    loader_without_seektable.seek(20000);
+    EXPECT(loader_without_seektable.has_error());
+}
+
+TEST_CASE(seek_within_and_between_seek_points)
+{
+    auto signal = make_signal(seekable_sample_count, 8000);
+    auto data = make_stream(signal, mixed_predictors, 8);
+    Audio::FlacLoaderPlugin loader(data);
+    EXPECT(loader.sniff());
+
+    // Into the middle of a frame after the second seek point.
+    loader.seek(9000);
+    expect_samples(loader, signal, 9000, 100);
+
+    // A little further within the same stretch, which just decodes on.
+    loader.seek(9500);
+    expect_samples(loader, signal, 9500, 100);
+
+    // Backwards, to before the seek point.
+    loader.seek(3000);
+    expect_samples(loader, signal, 3000, 100);
+
+    // Exactly onto a seek point, and reading across the next one.
+    loader.seek(16 * block_size);
+    expect_samples(loader, signal, 16 * block_size, 10000);
+
+    // Several seek points ahead, and on to the short frame at the end.
+    loader.seek(40000);
+    expect_samples(loader, signal, 40000, seekable_sample_count - 40000);
+    EXPECT(loader.get_more_samples(100).is_null());
+
+    // The very last sample.
+    loader.seek(seekable_sample_count - 1);
+    expect_samples(loader, signal, seekable_sample_count - 1, 1);
+
+    // Seeking out of bounds leaves the position alone.
+    loader.seek(5000);
+    loader.seek(seekable_sample_count);
+    expect_samples(loader, signal, 5000, 10);
+}
+
+TEST_CASE(reset_rewinds)
+{
+    auto signal = make_signal(seekable_sample_count, 8000);
+    auto data = make_stream(signal, mixed_predictors, 8);
+    Audio::FlacLoaderPlugin loader(data);
+    EXPECT(loader.sniff());
+
+    loader.seek(30000);
+    expect_samples(loader, signal, 30000, 10);
+    loader.reset();
+    EXPECT_EQ(loader.loaded_samples(), 0);
+    expect_samples(loader, signal, 0, 2000);
+}
+
+static void expect_same_samples(Audio::Buffer const& actual, Audio::Buffer const& expected)
+{
+    EXPECT_EQ(actual.sample_count(), expected.sample_count());
+    size_t mismatches = 0;
+    for (int i = 0; i < min(actual.sample_count(), expected.sample_count()); ++i) {
+        auto& actual_frame = actual.samples()[i];
+        auto& expected_frame = expected.samples()[i];
+        if (actual_frame.left != expected_frame.left || actual_frame.right != expected_frame.right)
+            ++mismatches;
+    }
+    EXPECT_EQ(mismatches, 0u);
+}
+
+// Decodes the same stretches of `data` with both loaders, one of them splitting the work at seek points.
+static void expect_parallel_decoding_matches_sequential(ByteBuffer const& data, size_t first_sample, Vector<size_t> const& chunk_sizes)
+{
+    Threading::WorkerPool worker_pool(3, "FlacTest"sv);
+    Audio::FlacLoaderPlugin sequential_loader(data);
+    Audio::FlacLoaderPlugin parallel_loader(data);
+    EXPECT(sequential_loader.sniff());
+    EXPECT(parallel_loader.sniff());
+    if (first_sample) {
+        sequential_loader.seek(first_sample);
+        parallel_loader.seek(first_sample);
+    }
+
+    for (auto chunk_size : chunk_sizes) {
+        auto expected = sequential_loader.get_more_samples(chunk_size);
+        auto actual = parallel_loader.get_more_samples_in_parallel(worker_pool, chunk_size);
+        EXPECT_EQ(actual.is_null(), expected.is_null());
+        EXPECT_EQ(parallel_loader.has_error(), sequential_loader.has_error());
+        if (!actual || !expected)
+            return;
+        expect_same_samples(*actual, *expected);
+        EXPECT_EQ(parallel_loader.loaded_samples(), sequential_loader.loaded_samples());
+    }
+
+    // Wherever the parallel decoding stopped, the loader carries on from there.
+    auto expected = sequential_loader.get_more_samples(5000);
+    auto actual = parallel_loader.get_more_samples(5000);
+    EXPECT_EQ(actual.is_null(), expected.is_null());
+    if (actual && expected)
+        expect_same_samples(*actual, *expected);
+}
+
+TEST_CASE(parallel_decoding_matches_sequential)
+{
+    auto signal = make_signal(seekable_sample_count, 8000);
+    auto data = make_stream(signal, mixed_predictors, 8);
+
+    // From the start, in stretches that span several seek points and end in the middle of frames.
+    expect_parallel_decoding_matches_sequential(data, 0, { 20000, 13000 });
+    // From the middle of a frame, in one go to the end of the stream.
+    expect_parallel_decoding_matches_sequential(data, 1500, { seekable_sample_count });
+    // Ending exactly on a seek point, and then on a frame boundary between two of them.
+    expect_parallel_decoding_matches_sequential(data, 0, { 16 * block_size, 3 * block_size, 17000 });
+    // More seek points than threads.
+    expect_parallel_decoding_matches_sequential(make_stream(signal, mixed_predictors, 1), 700, { 40000 });
+
+    // Without seek points there is nothing to split the work at, so it all happens sequentially.
+    expect_parallel_decoding_matches_sequential(make_stream(signal, mixed_predictors, 0), 0, { 30000 });
+}
+
+TEST_CASE(parallel_decoding_reports_errors)
+{
+    auto signal = make_signal(seekable_sample_count, 8000);
+    auto data = make_stream(signal, mixed_predictors, 8, true);
+    Threading::WorkerPool worker_pool(3, "FlacTest"sv);
+    Audio::FlacLoaderPlugin loader(data);
+    EXPECT(loader.sniff());
+    EXPECT(loader.get_more_samples_in_parallel(worker_pool, seekable_sample_count).is_null());
+    EXPECT(loader.has_error());
+}
+
+TEST_CASE(seektable_out_of_order_is_rejected)
+{
+    auto signal = make_signal(4 * block_size, 8000);
+    auto data = make_stream(signal, mixed_predictors, 1);
+
+    // Swap the sample indices of the second and third seek points. They start right after
+    // the magic, the STREAMINFO block and the SEEKTABLE block header.
+    constexpr size_t first_seek_point_offset = 4 + 4 + 34 + 4;
+    constexpr size_t seek_point_size = 18;
+    for (size_t i = 0; i < sizeof(u64); ++i)
+        swap(data[first_seek_point_offset + seek_point_size + i], data[first_seek_point_offset + 2 * seek_point_size + i]);
+
+    Audio::FlacLoaderPlugin loader(data);
+    EXPECT(!loader.sniff());
+    EXPECT(loader.has_error());
+}
+
+// Depending on whether the products can overflow 32 bits, the LPC prediction either uses 32-bit vectors or a 64-bit scalar loop.
+// Both have to give back exactly the samples that were encoded.
+static void expect_lossless_round_trip(Predictor const& predictor, double amplitude)
+{
+    auto signal = make_signal(2 * block_size, amplitude);
+    auto data = make_stream(signal, { predictor }, 0);
+    Audio::FlacLoaderPlugin loader(data);
+    EXPECT(loader.sniff());
+    expect_samples(loader, signal, 0, 2 * block_size);
+}
+
+TEST_CASE(lpc_vectorized_prediction_matches_scalar)
+{
+    // 16 bits per sample, so these can use vectors: order 1 and 2 fill a single one,
+    // 5 gets padded to 8, and 32 only just fits with 10-bit coefficients.
+    expect_lossless_round_trip({ 1, 14, 11 }, 30000);
+    expect_lossless_round_trip({ 2, 14, 11 }, 30000);
+    expect_lossless_round_trip({ 4, 12, 9 }, 30000);
+    expect_lossless_round_trip({ 5, 12, 9 }, 30000);
+    expect_lossless_round_trip({ 8, 12, 9 }, 30000);
+    expect_lossless_round_trip({ 32, 10, 7 }, 30000);
+}
+
+TEST_CASE(lpc_scalar_prediction_for_wide_coefficients)
+{
+    // These could overflow 32-bit sums on loud input, so they have to take the 64-bit path.
+    expect_lossless_round_trip({ 8, 15, 12 }, 30000);
+    expect_lossless_round_trip({ 32, 15, 12 }, 30000);
+    // And here the sum really doesn't fit into 32 bits.
+    expect_lossless_round_trip({ 8, 15, 12, true }, 30000);
+}
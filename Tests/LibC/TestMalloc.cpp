@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static constexpr size_t sizes_to_test[] = { 1, 8, 16, 24, 32, 64, 100, 128, 500, 1000, 2000, 4000, 8000, 32 * KiB, 128 * KiB };
+
+TEST_CASE(allocations_do_not_overlap)
+{
+    Vector<u8*> pointers;
+    for (int round = 0; round < 64; ++round) {
+        for (size_t i = 0; i < array_size(sizes_to_test); ++i) {
+            auto* ptr = static_cast<u8*>(malloc(sizes_to_test[i]));
+            EXPECT(ptr != nullptr);
+            memset(ptr, static_cast<u8>(pointers.size()), sizes_to_test[i]);
+            pointers.append(ptr);
+        }
+    }
+
+    for (size_t i = 0; i < pointers.size(); ++i) {
+        auto size = sizes_to_test[i % array_size(sizes_to_test)];
+        for (size_t j = 0; j < size; ++j)
+            EXPECT_EQ(pointers[i][j], static_cast<u8>(i));
+        free(pointers[i]);
+    }
+}
+
+TEST_CASE(reuse_after_free)
+{
+    // Freeing more than a thread cache holds and allocating it all again has to go through the shared lists.
+    Vector<void*> pointers;
+    for (int i = 0; i < 2000; ++i)
+        pointers.append(malloc(32));
+    for (auto* ptr : pointers)
+        free(ptr);
+    pointers.clear();
+    for (int i = 0; i < 2000; ++i) {
+        auto* ptr = malloc(32);
+        EXPECT(ptr != nullptr);
+        pointers.append(ptr);
+    }
+    for (auto* ptr : pointers)
+        free(ptr);
+}
+
+static void* allocate_for_other_thread(void* argument)
+{
+    auto& pointers = *static_cast<Vector<void*>*>(argument);
+    for (int i = 0; i < 1000; ++i) {
+        auto* ptr = malloc(sizes_to_test[i % array_size(sizes_to_test)]);
+        memset(ptr, 0x55, sizes_to_test[i % array_size(sizes_to_test)]);
+        pointers.append(ptr);
+    }
+    return nullptr;
+}
+
+TEST_CASE(free_memory_allocated_by_another_thread)
+{
+    Vector<void*> pointers;
+    pthread_t thread;
+    EXPECT_EQ(pthread_create(&thread, nullptr, allocate_for_other_thread, &pointers), 0);
+    EXPECT_EQ(pthread_join(thread, nullptr), 0);
+
+    EXPECT_EQ(pointers.size(), 1000u);
+    for (auto* ptr : pointers)
+        free(ptr);
+
+    // The chunks the other thread had cached when it exited should be usable again.
+    for (int i = 0; i < 1000; ++i)
+        free(malloc(64));
+}
+
+static constexpr size_t operations_per_thread = 1000000;
+
+static void* churn(void*)
+{
+    // A mix of short-lived allocations and a small working set, like most programs have.
+    void* working_set[64] {};
+    for (size_t i = 0; i < operations_per_thread; ++i) {
+        auto slot = i % array_size(working_set);
+        free(working_set[slot]);
+        working_set[slot] = malloc(16 + (i * 7) % 512);
+        free(malloc(32));
+    }
+    for (auto* ptr : working_set)
+        free(ptr);
+    return nullptr;
+}
+
+BENCHMARK_CASE(scalability)
+{
+    long processor_count = max(sysconf(_SC_NPROCESSORS_ONLN), 1l);
+    for (long thread_count = 1; thread_count <= max(processor_count, 4l); thread_count *= 2) {
+        Vector<pthread_t> threads;
+        threads.resize(thread_count);
+
+        Core::ElapsedTimer timer;
+        timer.start();
+        for (auto& thread : threads)
+            EXPECT_EQ(pthread_create(&thread, nullptr, churn, nullptr), 0);
+        for (auto& thread : threads)
+            EXPECT_EQ(pthread_join(thread, nullptr), 0);
+
+        auto elapsed_ms = max(timer.elapsed(), 1);
+        u64 operations = 4 * operations_per_thread * thread_count;
+        outln("{} thread(s): {} ms ({} ops/s)", thread_count, elapsed_ms, operations * 1000 / elapsed_ms);
+    }
+}
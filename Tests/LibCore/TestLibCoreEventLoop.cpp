@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/EventLoop.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Timer.h>
+#include <LibTest/TestCase.h>
+#include <unistd.h>
+
+TEST_CASE(notifier_on_reused_fd_is_watched)
+{
+    Core::EventLoop event_loop;
+
+    int first_pipe[2];
+    EXPECT_EQ(pipe(first_pipe), 0);
+    auto stale_notifier = Core::Notifier::construct(first_pipe[0], Core::Notifier::Read);
+
+    // Close the fd behind the notifier's back, so that the next pipe gets the same fd number.
+    EXPECT_EQ(close(first_pipe[0]), 0);
+    EXPECT_EQ(close(first_pipe[1]), 0);
+    int second_pipe[2];
+    EXPECT_EQ(pipe(second_pipe), 0);
+    EXPECT_EQ(second_pipe[0], first_pipe[0]);
+
+    auto notifier = Core::Notifier::construct(second_pipe[0], Core::Notifier::Read);
+    notifier->on_ready_to_read = [&] {
+        event_loop.quit(0);
+    };
+    auto timeout = Core::Timer::create_single_shot(1000, [&] {
+        event_loop.quit(1);
+    });
+    timeout->start();
+
+    EXPECT_EQ(write(second_pipe[1], "x", 1), 1);
+    EXPECT_EQ(event_loop.exec(), 0);
+
+    stale_notifier->set_enabled(false);
+    notifier->set_enabled(false);
+    close(second_pipe[0]);
+    close(second_pipe[1]);
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/String.h>
+#include <LibC/elf.h>
+#include <LibELF/PrelinkCache.h>
+#include <LibTest/TestCase.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+static String make_temporary_directory()
+{
+    char path[] = "/tmp/prelink-cache.XXXXXX";
+    VERIFY(mkdtemp(path));
+    return path;
+}
+
+static void write_file(const String& path, StringView contents)
+{
+    int fd = open(path.characters(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    VERIFY(fd >= 0);
+    VERIFY(write(fd, contents.characters_without_null_termination(), contents.length()) == static_cast<ssize_t>(contents.length()));
+    close(fd);
+}
+
+// Whole seconds, so that the time can be restored exactly.
+static constexpr time_t initial_modification_time = 1'600'000'000;
+
+static void set_modification_time(const String& path, time_t time)
+{
+    utimbuf times { time, time };
+    VERIFY(utime(path.characters(), &times) == 0);
+}
+
+static ELF::PrelinkCache::Object object_for(const String& path)
+{
+    struct stat stat;
+    VERIFY(::stat(path.characters(), &stat) == 0);
+    return ELF::PrelinkCache::Object::from_stat(path, stat);
+}
+
+// Stand-ins for a program and the two libraries it links against.
+struct Fixture {
+    Fixture()
+        : directory(make_temporary_directory())
+        , program_path(String::formatted("{}/Program", directory))
+        , library_path(String::formatted("{}/libfoo.so", directory))
+        , libc_path(String::formatted("{}/libc.so", directory))
+        , cache_path(String::formatted("{}/cache", directory))
+    {
+        write_file(program_path, "program"sv);
+        write_file(library_path, "library"sv);
+        write_file(libc_path, "libc"sv);
+        for (auto& path : { program_path, library_path, libc_path })
+            set_modification_time(path, initial_modification_time);
+    }
+
+    ~Fixture()
+    {
+        unlink(program_path.characters());
+        unlink(library_path.characters());
+        unlink(libc_path.characters());
+        unlink(cache_path.characters());
+        rmdir(directory.characters());
+    }
+
+    Vector<ELF::PrelinkCache::Object> objects() const
+    {
+        return { object_for(program_path), object_for(library_path), object_for(libc_path) };
+    }
+
+    ELF::PrelinkCache make_cache() const
+    {
+        ELF::PrelinkCache cache { objects() };
+        cache.set_symbols_of(0, {
+                                    { 1, 2, 0x1000, 16, STB_GLOBAL },
+                                    { 4, 1, 0x2040, 8, STB_WEAK },
+                                    { 7, ELF::PrelinkCache::unresolved_object_index, 0, 0, 0 },
+                                });
+        cache.set_symbols_of(1, {
+                                    { 3, 2, 0xffff'ffff'0000'1234, 0, STB_GLOBAL },
+                                });
+        return cache;
+    }
+
+    String directory;
+    String program_path;
+    String library_path;
+    String libc_path;
+    String cache_path;
+};
+
+static void expect_same_symbols(const Vector<ELF::PrelinkCache::Symbol>& a, const Vector<ELF::PrelinkCache::Symbol>& b)
+{
+    EXPECT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < min(a.size(), b.size()); ++i) {
+        EXPECT_EQ(a[i].symbol_index, b[i].symbol_index);
+        EXPECT_EQ(a[i].object_index, b[i].object_index);
+        EXPECT_EQ(a[i].value, b[i].value);
+        EXPECT_EQ(a[i].size, b[i].size);
+        EXPECT_EQ(a[i].bind, b[i].bind);
+    }
+}
+
+TEST_CASE(save_and_load_round_trip)
+{
+    Fixture fixture;
+    auto cache = fixture.make_cache();
+    EXPECT(cache.save(fixture.cache_path));
+
+    auto loaded_cache = ELF::PrelinkCache::try_load(fixture.cache_path);
+    EXPECT(loaded_cache.has_value());
+    if (!loaded_cache.has_value())
+        return;
+
+    EXPECT(loaded_cache->objects() == cache.objects());
+    EXPECT(loaded_cache->is_up_to_date(fixture.objects()));
+    for (size_t i = 0; i < cache.objects().size(); ++i)
+        expect_same_symbols(loaded_cache->symbols_of(i), cache.symbols_of(i));
+}
+
+TEST_CASE(missing_or_malformed_cache_is_not_loaded)
+{
+    Fixture fixture;
+    EXPECT(!ELF::PrelinkCache::try_load(fixture.cache_path).has_value());
+
+    EXPECT(fixture.make_cache().save(fixture.cache_path));
+    struct stat stat;
+    EXPECT_EQ(::stat(fixture.cache_path.characters(), &stat), 0);
+    EXPECT_EQ(truncate(fixture.cache_path.characters(), stat.st_size - 1), 0);
+    EXPECT(!ELF::PrelinkCache::try_load(fixture.cache_path).has_value());
+
+    write_file(fixture.cache_path, "PRELINK"sv);
+    EXPECT(!ELF::PrelinkCache::try_load(fixture.cache_path).has_value());
+}
+
+TEST_CASE(cache_writable_by_others_is_not_loaded)
+{
+    Fixture fixture;
+    EXPECT(fixture.make_cache().save(fixture.cache_path));
+    EXPECT_EQ(chmod(fixture.cache_path.characters(), 0622), 0);
+    EXPECT(!ELF::PrelinkCache::try_load(fixture.cache_path).has_value());
+}
+
+TEST_CASE(cache_is_out_of_date_when_a_library_changes_size)
+{
+    Fixture fixture;
+    EXPECT(fixture.make_cache().save(fixture.cache_path));
+
+    // Keep the modification time, so that only the size differs.
+    write_file(fixture.library_path, "a larger library"sv);
+    set_modification_time(fixture.library_path, initial_modification_time);
+
+    auto loaded_cache = ELF::PrelinkCache::try_load(fixture.cache_path);
+    EXPECT(loaded_cache.has_value());
+    if (loaded_cache.has_value())
+        EXPECT(!loaded_cache->is_up_to_date(fixture.objects()));
+}
+
+TEST_CASE(cache_is_out_of_date_when_a_library_is_modified)
+{
+    Fixture fixture;
+    EXPECT(fixture.make_cache().save(fixture.cache_path));
+
+    // Same size and inode, only the modification time moves.
+    set_modification_time(fixture.libc_path, initial_modification_time + 1);
+
+    auto loaded_cache = ELF::PrelinkCache::try_load(fixture.cache_path);
+    EXPECT(loaded_cache.has_value());
+    if (loaded_cache.has_value())
+        EXPECT(!loaded_cache->is_up_to_date(fixture.objects()));
+}
+
+TEST_CASE(cache_is_out_of_date_when_libraries_are_reordered)
+{
+    Fixture fixture;
+    EXPECT(fixture.make_cache().save(fixture.cache_path));
+
+    auto loaded_cache = ELF::PrelinkCache::try_load(fixture.cache_path);
+    EXPECT(loaded_cache.has_value());
+    if (!loaded_cache.has_value())
+        return;
+
+    auto objects = fixture.objects();
+    swap(objects[1], objects[2]);
+    EXPECT(!loaded_cache->is_up_to_date(objects));
+}
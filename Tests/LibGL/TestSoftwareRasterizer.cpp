@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Vector.h>
+#include <LibGL/SoftwareRasterizer.h>
+#include <LibTest/TestCase.h>
+#include <math.h>
+
+// The rasterizer bins triangles into tiles, walks them in 16x16 blocks, evaluates four pixels at a time
+// and may spread the tiles over several threads. None of that may change which pixels a triangle covers
+// or which triangle wins a pixel, so the framebuffer is compared against a plain per-pixel reference.
+
+static constexpr int target_width = 200;
+static constexpr int target_height = 152;
+static constexpr size_t triangle_count = 300;
+
+static constexpr Gfx::RGBA32 clear_pixel = 0xff000000;
+
+static const FloatVector4 palette[] = {
+    { 1, 0, 0, 1 },
+    { 0, 1, 0, 1 },
+    { 0, 0, 1, 1 },
+    { 1, 1, 0, 1 },
+    { 1, 0, 1, 1 },
+    { 0, 1, 1, 1 },
+    { 1, 1, 1, 1 },
+};
+
+static Gfx::RGBA32 to_pixel(FloatVector4 const& color)
+{
+    return static_cast<u32>(color.w() * 255) << 24 | static_cast<u32>(color.x() * 255) << 16 | static_cast<u32>(color.y() * 255) << 8 | static_cast<u32>(color.z() * 255);
+}
+
+// Small LCG, so the scene is the same on every run.
+static u32 next_random(u32& state)
+{
+    state = state * 1103515245 + 12345;
+    return state >> 8;
+}
+
+static float random_coordinate(u32& state, int limit)
+{
+    // Quarter pixel steps, to exercise the truncation to integer coordinates.
+    return static_cast<float>(next_random(state) % (limit * 4)) / 4;
+}
+
+static Vector<GL::GLTriangle> make_scene(bool distinct_depths)
+{
+    Vector<GL::GLTriangle> triangles;
+    u32 state = 0x5eed;
+    for (size_t i = 0; i < triangle_count; ++i) {
+        // Mix small triangles with ones spanning several tiles.
+        int extent = (i % 4 == 0) ? target_width : 48;
+        float x = random_coordinate(state, target_width);
+        float y = random_coordinate(state, target_height);
+        float z = distinct_depths ? -0.9f + 1.8f * static_cast<float>((i * 97) % triangle_count) / triangle_count : 0;
+
+        GL::GLTriangle triangle;
+        for (auto& vertex : triangle.vertices) {
+            float vx = clamp(x + random_coordinate(state, extent) - extent / 2, 0.0f, target_width - 1.0f);
+            float vy = clamp(y + random_coordinate(state, extent) - extent / 2, 0.0f, target_height - 1.0f);
+            vertex.position = { vx, vy, z, 1 };
+            vertex.color = palette[i % array_size(palette)];
+            vertex.tex_coord = { 0, 0 };
+        }
+        triangles.append(triangle);
+    }
+    return triangles;
+}
+
+static int edge_function(int ax, int ay, int bx, int by, int cx, int cy)
+{
+    return (cx - ax) * (by - ay) - (cy - ay) * (bx - ax);
+}
+
+// Straightforward coverage test with the same top-left fill rule as the rasterizer.
+static bool covers(GL::GLTriangle const& triangle, int x, int y)
+{
+    int vx[3], vy[3];
+    for (int i = 0; i < 3; ++i) {
+        vx[i] = static_cast<int>(triangle.vertices[i].position.x());
+        vy[i] = static_cast<int>(triangle.vertices[i].position.y());
+    }
+    if (edge_function(vx[0], vy[0], vx[1], vy[1], vx[2], vy[2]) == 0)
+        return false;
+
+    for (int i = 0; i < 3; ++i) {
+        int a = (i + 1) % 3;
+        int b = (i + 2) % 3;
+        bool top_left = vy[b] > vy[a] || (vy[b] == vy[a] && vx[b] < vx[a]);
+        if (edge_function(vx[a], vy[a], vx[b], vy[b], x, y) < (top_left ? 0 : 1))
+            return false;
+    }
+    return true;
+}
+
+static void rasterize(GL::SoftwareRasterizer& rasterizer, GL::RasterizerOptions const& options, Vector<GL::GLTriangle> const& triangles)
+{
+    rasterizer.set_options(options);
+    rasterizer.clear_color({ 0, 0, 0, 1 });
+    rasterizer.clear_depth(1);
+    rasterizer.submit_triangles(triangles.span(), {});
+    rasterizer.wait_for_all_threads();
+}
+
+TEST_CASE(coverage_and_submission_order_match_reference)
+{
+    GL::SoftwareRasterizer rasterizer({ target_width, target_height });
+    GL::RasterizerOptions options;
+    options.shade_smooth = false;
+    options.enable_depth_test = false;
+
+    auto triangles = make_scene(false);
+    rasterize(rasterizer, options, triangles);
+
+    size_t mismatches = 0;
+    for (int y = 0; y < target_height; ++y) {
+        for (int x = 0; x < target_width; ++x) {
+            // The last triangle covering the pixel wins.
+            Gfx::RGBA32 expected = clear_pixel;
+            for (auto& triangle : triangles) {
+                if (covers(triangle, x, y))
+                    expected = to_pixel(triangle.vertices[0].color);
+            }
+            if (rasterizer.get_backbuffer_pixel(x, y) != expected)
+                ++mismatches;
+        }
+    }
+    EXPECT_EQ(mismatches, 0u);
+}
+
+TEST_CASE(depth_test_matches_reference)
+{
+    GL::SoftwareRasterizer rasterizer({ target_width, target_height });
+    GL::RasterizerOptions options;
+    options.shade_smooth = false;
+    options.enable_depth_test = true;
+    options.depth_func = GL_LESS;
+
+    auto triangles = make_scene(true);
+    rasterize(rasterizer, options, triangles);
+
+    size_t color_mismatches = 0;
+    size_t depth_mismatches = 0;
+    for (int y = 0; y < target_height; ++y) {
+        for (int x = 0; x < target_width; ++x) {
+            // Every triangle has its own depth, so the nearest covering triangle wins regardless of order.
+            Gfx::RGBA32 expected = clear_pixel;
+            float expected_depth = 1;
+            for (auto& triangle : triangles) {
+                float depth = (triangle.vertices[0].position.z() + 1) / 2;
+                if (depth < expected_depth && covers(triangle, x, y)) {
+                    expected = to_pixel(triangle.vertices[0].color);
+                    expected_depth = depth;
+                }
+            }
+            if (rasterizer.get_backbuffer_pixel(x, y) != expected)
+                ++color_mismatches;
+            if (fabsf(rasterizer.get_depthbuffer_value(x, y) - expected_depth) > 0.001f)
+                ++depth_mismatches;
+        }
+    }
+    EXPECT_EQ(color_mismatches, 0u);
+    EXPECT_EQ(depth_mismatches, 0u);
+}
+
+TEST_CASE(batched_submission_matches_one_triangle_at_a_time)
+{
+    GL::RasterizerOptions options;
+    options.enable_depth_test = true;
+    options.depth_func = GL_LEQUAL;
+    auto triangles = make_scene(true);
+
+    GL::SoftwareRasterizer batched({ target_width, target_height });
+    rasterize(batched, options, triangles);
+
+    GL::SoftwareRasterizer sequential({ target_width, target_height });
+    sequential.set_options(options);
+    sequential.clear_color({ 0, 0, 0, 1 });
+    sequential.clear_depth(1);
+    for (auto& triangle : triangles)
+        sequential.submit_triangles({ &triangle, 1 }, {});
+    sequential.wait_for_all_threads();
+
+    size_t mismatches = 0;
+    for (int y = 0; y < target_height; ++y) {
+        for (int x = 0; x < target_width; ++x) {
+            if (batched.get_backbuffer_pixel(x, y) != sequential.get_backbuffer_pixel(x, y) || batched.get_depthbuffer_value(x, y) != sequential.get_depthbuffer_value(x, y))
+                ++mismatches;
+        }
+    }
+    EXPECT_EQ(mismatches, 0u);
+}
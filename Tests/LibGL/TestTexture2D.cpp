@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NonnullRefPtr.h>
+#include <AK/Vector.h>
+#include <LibGL/Tex/Texture2D.h>
+#include <LibTest/TestCase.h>
+
+// MipMap stores its texels in tiles, so everything here is checked against plain row-major arrays.
+
+static u32 next_random(u32& state)
+{
+    state = state * 1103515245 + 12345;
+    return state;
+}
+
+static Vector<u32> make_texels(GLsizei width, GLsizei height, u32 seed)
+{
+    Vector<u32> texels;
+    for (GLsizei i = 0; i < width * height; ++i)
+        texels.append(next_random(seed));
+    return texels;
+}
+
+// Texture2D::upload_texture_data() takes GL_RGBA bytes, but stores ARGB.
+static Vector<u8> to_rgba_bytes(Vector<u32> const& texels)
+{
+    Vector<u8> bytes;
+    for (auto texel : texels) {
+        bytes.append((texel >> 16) & 0xff);
+        bytes.append((texel >> 8) & 0xff);
+        bytes.append(texel & 0xff);
+        bytes.append(texel >> 24);
+    }
+    return bytes;
+}
+
+static Vector<u32> box_filter(Vector<u32> const& source, GLsizei width, GLsizei height)
+{
+    GLsizei level_width = max(width / 2, 1);
+    GLsizei level_height = max(height / 2, 1);
+    Vector<u32> level;
+    for (GLsizei y = 0; y < level_height; ++y) {
+        for (GLsizei x = 0; x < level_width; ++x) {
+            GLsizei x0 = min(x * 2, width - 1);
+            GLsizei x1 = min(x * 2 + 1, width - 1);
+            GLsizei y0 = min(y * 2, height - 1);
+            GLsizei y1 = min(y * 2 + 1, height - 1);
+            u32 texel = 0;
+            for (unsigned shift = 0; shift < 32; shift += 8) {
+                u32 sum = ((source[y0 * width + x0] >> shift) & 0xff)
+                    + ((source[y0 * width + x1] >> shift) & 0xff)
+                    + ((source[y1 * width + x0] >> shift) & 0xff)
+                    + ((source[y1 * width + x1] >> shift) & 0xff);
+                texel |= ((sum + 2) / 4) << shift;
+            }
+            level.append(texel);
+        }
+    }
+    return level;
+}
+
+static size_t count_mismatches(GL::MipMap const& mip, Vector<u32> const& expected, GLsizei width, GLsizei height)
+{
+    size_t mismatches = 0;
+    for (GLsizei y = 0; y < height; ++y) {
+        for (GLsizei x = 0; x < width; ++x) {
+            if (mip.raw_texel(x, y) != expected[y * width + x])
+                ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+TEST_CASE(tiled_texels_match_linear_reference)
+{
+    // Neither dimension is a multiple of the tile size.
+    constexpr GLsizei width = 13;
+    constexpr GLsizei height = 7;
+    auto texels = make_texels(width, height, 1);
+
+    GL::MipMap mip;
+    mip.resize(width, height);
+    for (GLsizei y = 0; y < height; ++y) {
+        for (GLsizei x = 0; x < width; ++x)
+            mip.set_raw_texel(x, y, texels[y * width + x]);
+    }
+    EXPECT_EQ(count_mismatches(mip, texels, width, height), 0u);
+
+    EXPECT_EQ(mip.raw_texel(width, 0), 0u);
+    EXPECT_EQ(mip.raw_texel(0, height), 0u);
+}
+
+TEST_CASE(uploaded_texels_match_linear_reference)
+{
+    constexpr GLsizei width = 10;
+    constexpr GLsizei height = 6;
+    constexpr size_t pixels_per_row = 16;
+
+    // Upload a sub-rectangle of a wider image, to also cover the row stride.
+    auto image = make_texels(pixels_per_row, height, 2);
+    Vector<u32> texels;
+    for (GLsizei y = 0; y < height; ++y) {
+        for (GLsizei x = 0; x < width; ++x)
+            texels.append(image[y * pixels_per_row + x]);
+    }
+
+    auto texture = adopt_ref(*new GL::Texture2D);
+    auto bytes = to_rgba_bytes(image);
+    texture->upload_texture_data(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, bytes.data(), pixels_per_row);
+
+    EXPECT_EQ(texture->mipmap(0).width(), width);
+    EXPECT_EQ(texture->mipmap(0).height(), height);
+    EXPECT_EQ(count_mismatches(texture->mipmap(0), texels, width, height), 0u);
+}
+
+static void check_generated_mipmaps(GLsizei width, GLsizei height, unsigned expected_count)
+{
+    auto texels = make_texels(width, height, 3);
+    auto texture = adopt_ref(*new GL::Texture2D);
+    auto bytes = to_rgba_bytes(texels);
+    texture->upload_texture_data(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, bytes.data(), 0);
+    texture->generate_mipmaps();
+
+    EXPECT_EQ(texture->mipmap_count(), expected_count);
+
+    auto expected = texels;
+    for (unsigned lod = 1; lod < expected_count; ++lod) {
+        expected = box_filter(expected, width, height);
+        width = max(width / 2, 1);
+        height = max(height / 2, 1);
+
+        auto& mip = texture->mipmap(lod);
+        EXPECT_EQ(mip.width(), width);
+        EXPECT_EQ(mip.height(), height);
+        EXPECT_EQ(count_mismatches(mip, expected, width, height), 0u);
+    }
+}
+
+TEST_CASE(generated_mipmaps_are_box_filtered)
+{
+    check_generated_mipmaps(16, 8, 5);
+    check_generated_mipmaps(5, 3, 3);
+    check_generated_mipmaps(1, 9, 4);
+}
+
+TEST_CASE(sampler_picks_level_from_derivatives)
+{
+    // Every level is a single color, so the sampled color tells which level was used.
+    constexpr GLsizei size = 16;
+    auto texture = adopt_ref(*new GL::Texture2D);
+    for (GLint lod = 0; lod < 5; ++lod) {
+        GLsizei level_size = size >> lod;
+        Vector<u32> texels;
+        for (GLsizei i = 0; i < level_size * level_size; ++i)
+            texels.append(0xff000000 | (lod * 0x20));
+        auto bytes = to_rgba_bytes(texels);
+        texture->upload_texture_data(GL_TEXTURE_2D, lod, GL_RGBA, level_size, level_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, bytes.data(), 0);
+    }
+    EXPECT_EQ(texture->mipmap_count(), 5u);
+
+    auto& sampler = texture->sampler();
+    sampler.set_min_filter(GL_NEAREST_MIPMAP_NEAREST);
+    sampler.set_mag_filter(GL_NEAREST);
+
+    auto sampled_level = [&](float texels_per_pixel) {
+        FloatVector2 derivative { texels_per_pixel / size, 0 };
+        auto color = sampler.sample({ 0.5f, 0.5f }, derivative, derivative);
+        return static_cast<int>(color.z() * 255 + 0.5f) / 0x20;
+    };
+
+    EXPECT_EQ(sampled_level(0.5f), 0);
+    EXPECT_EQ(sampled_level(1), 0);
+    EXPECT_EQ(sampled_level(2), 1);
+    EXPECT_EQ(sampled_level(4), 2);
+    EXPECT_EQ(sampled_level(8), 3);
+    EXPECT_EQ(sampled_level(16), 4);
+    // Past the last level, the smallest one keeps being used.
+    EXPECT_EQ(sampled_level(64), 4);
+}
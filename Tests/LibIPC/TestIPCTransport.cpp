@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/MemoryStream.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/LocalServer.h>
+#include <LibIPC/Connection.h>
+#include <LibIPC/Decoder.h>
+#include <LibIPC/Encoder.h>
+#include <LibIPC/Stub.h>
+#include <LibTest/TestCase.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// A hand-written stand-in for what IPCCompiler would generate from:
+//
+// endpoint TransportTest
+// {
+//     ping(u32 sequence, ByteBuffer payload) =|
+//     echo(u32 sequence, ByteBuffer payload) => (u32 sequence, ByteBuffer payload)
+//     get_statistics() => (u32 ping_count, bool pings_in_order, u32 payload_bytes)
+// }
+
+static constexpr u32 transport_test_magic = 0x1bc0ffee;
+
+enum class TransportTestMessageID : i32 {
+    Ping = 1,
+    Echo,
+    EchoResponse,
+    GetStatistics,
+    GetStatisticsResponse,
+};
+
+template<TransportTestMessageID id>
+class TransportTestMessage : public IPC::Message {
+public:
+    virtual u32 endpoint_magic() const override { return transport_test_magic; }
+    virtual i32 message_id() const override { return (int)id; }
+    static i32 static_message_id() { return (int)id; }
+    virtual const char* message_name() const override { return "TransportTest"; }
+    virtual bool valid() const override { return true; }
+
+protected:
+    static void encode_header(IPC::Encoder& stream) { stream << transport_test_magic << (int)id; }
+};
+
+template<TransportTestMessageID id, typename Response = void>
+class SequencedPayloadMessage final : public TransportTestMessage<id> {
+public:
+    using ResponseType = Response;
+
+    SequencedPayloadMessage(u32 sequence, ByteBuffer payload)
+        : m_sequence(sequence)
+        , m_payload(move(payload))
+    {
+    }
+
+    static OwnPtr<SequencedPayloadMessage> decode(InputMemoryStream& stream, int sockfd)
+    {
+        IPC::Decoder decoder { stream, sockfd };
+        u32 sequence = 0;
+        ByteBuffer payload;
+        if (!decoder.decode(sequence) || !decoder.decode(payload))
+            return {};
+        return make<SequencedPayloadMessage>(sequence, move(payload));
+    }
+
+    virtual void encode(IPC::MessageBuffer& buffer) const override
+    {
+        IPC::Encoder stream(buffer);
+        TransportTestMessage<id>::encode_header(stream);
+        stream << m_sequence << m_payload;
+    }
+
+    u32 sequence() const { return m_sequence; }
+    ByteBuffer const& payload() const { return m_payload; }
+
+private:
+    u32 m_sequence { 0 };
+    ByteBuffer m_payload;
+};
+
+using Ping = SequencedPayloadMessage<TransportTestMessageID::Ping>;
+using EchoResponse = SequencedPayloadMessage<TransportTestMessageID::EchoResponse>;
+using Echo = SequencedPayloadMessage<TransportTestMessageID::Echo, EchoResponse>;
+
+class GetStatisticsResponse final : public TransportTestMessage<TransportTestMessageID::GetStatisticsResponse> {
+public:
+    GetStatisticsResponse(u32 ping_count, bool pings_in_order, u32 payload_bytes)
+        : m_ping_count(ping_count)
+        , m_pings_in_order(pings_in_order)
+        , m_payload_bytes(payload_bytes)
+    {
+    }
+
+    static OwnPtr<GetStatisticsResponse> decode(InputMemoryStream& stream, int sockfd)
+    {
+        IPC::Decoder decoder { stream, sockfd };
+        u32 ping_count = 0;
+        bool pings_in_order = false;
+        u32 payload_bytes = 0;
+        if (!decoder.decode(ping_count) || !decoder.decode(pings_in_order) || !decoder.decode(payload_bytes))
+            return {};
+        return make<GetStatisticsResponse>(ping_count, pings_in_order, payload_bytes);
+    }
+
+    virtual void encode(IPC::MessageBuffer& buffer) const override
+    {
+        IPC::Encoder stream(buffer);
+        encode_header(stream);
+        stream << m_ping_count << m_pings_in_order << m_payload_bytes;
+    }
+
+    u32 ping_count() const { return m_ping_count; }
+    bool pings_in_order() const { return m_pings_in_order; }
+    u32 payload_bytes() const { return m_payload_bytes; }
+
+private:
+    u32 m_ping_count { 0 };
+    bool m_pings_in_order { false };
+    u32 m_payload_bytes { 0 };
+};
+
+class GetStatistics final : public TransportTestMessage<TransportTestMessageID::GetStatistics> {
+public:
+    using ResponseType = GetStatisticsResponse;
+
+    static OwnPtr<GetStatistics> decode(InputMemoryStream&, int) { return make<GetStatistics>(); }
+
+    virtual void encode(IPC::MessageBuffer& buffer) const override
+    {
+        IPC::Encoder stream(buffer);
+        encode_header(stream);
+    }
+};
+
+class TransportTestStub final : public IPC::Stub {
+public:
+    virtual u32 magic() const override { return transport_test_magic; }
+    virtual String name() const override { return "TransportTest"; }
+
+    virtual OwnPtr<IPC::MessageBuffer> handle(IPC::Message const& message) override
+    {
+        switch ((TransportTestMessageID)message.message_id()) {
+        case TransportTestMessageID::Ping: {
+            auto& ping = static_cast<Ping const&>(message);
+            if (ping.sequence() != m_ping_count)
+                m_pings_in_order = false;
+            ++m_ping_count;
+            m_payload_bytes += ping.payload().size();
+            return {};
+        }
+        case TransportTestMessageID::Echo: {
+            auto& echo = static_cast<Echo const&>(message);
+            auto buffer = make<IPC::MessageBuffer>();
+            EchoResponse(echo.sequence(), echo.payload()).encode(*buffer);
+            return buffer;
+        }
+        case TransportTestMessageID::GetStatistics: {
+            auto response = GetStatisticsResponse(m_ping_count, m_pings_in_order, m_payload_bytes);
+            m_ping_count = 0;
+            m_pings_in_order = true;
+            m_payload_bytes = 0;
+            auto buffer = make<IPC::MessageBuffer>();
+            response.encode(*buffer);
+            return buffer;
+        }
+        default:
+            return {};
+        }
+    }
+
+private:
+    u32 m_ping_count { 0 };
+    bool m_pings_in_order { true };
+    u32 m_payload_bytes { 0 };
+};
+
+class TransportTestEndpoint {
+public:
+    using Stub = TransportTestStub;
+
+    static u32 static_magic() { return transport_test_magic; }
+
+    static OwnPtr<IPC::Message> decode_message(ReadonlyBytes buffer, int sockfd)
+    {
+        InputMemoryStream stream { buffer };
+        u32 message_endpoint_magic = 0;
+        i32 message_id = 0;
+        stream >> message_endpoint_magic >> message_id;
+        if (stream.handle_any_error() || message_endpoint_magic != transport_test_magic)
+            return {};
+
+        OwnPtr<IPC::Message> message;
+        switch ((TransportTestMessageID)message_id) {
+        case TransportTestMessageID::Ping:
+            message = Ping::decode(stream, sockfd);
+            break;
+        case TransportTestMessageID::Echo:
+            message = Echo::decode(stream, sockfd);
+            break;
+        case TransportTestMessageID::EchoResponse:
+            message = EchoResponse::decode(stream, sockfd);
+            break;
+        case TransportTestMessageID::GetStatistics:
+            message = GetStatistics::decode(stream, sockfd);
+            break;
+        case TransportTestMessageID::GetStatisticsResponse:
+            message = GetStatisticsResponse::decode(stream, sockfd);
+            break;
+        default:
+            return {};
+        }
+        if (stream.handle_any_error())
+            return {};
+        return message;
+    }
+};
+
+class TransportTestConnection final : public IPC::Connection<TransportTestEndpoint, TransportTestEndpoint> {
+    C_OBJECT(TransportTestConnection);
+
+public:
+    // Only the server ever sees the connection go away; it has nothing left to do then.
+    virtual void die() override { exit(0); }
+
+private:
+    TransportTestConnection(NonnullRefPtr<Core::LocalSocket> socket)
+        : IPC::Connection<TransportTestEndpoint, TransportTestEndpoint>(m_stub, move(socket))
+    {
+    }
+
+    TransportTestStub m_stub;
+};
+
+// Runs the server end in a child process, so that synchronous requests from the test can block.
+class TransportTestPeer {
+public:
+    TransportTestPeer()
+    {
+        // Core::EventLoop never unregisters itself, so all peers share the client side one.
+        static Core::EventLoop s_event_loop;
+
+        auto socket_path = String::formatted("/tmp/ipc-transport-test.{}", getpid());
+        int ready_pipe[2];
+        VERIFY(pipe(ready_pipe) == 0);
+
+        // Don't let the child flush our buffered output a second time.
+        fflush(stdout);
+        m_server_pid = fork();
+        VERIFY(m_server_pid >= 0);
+        if (m_server_pid == 0) {
+            close(ready_pipe[0]);
+            Core::EventLoop::notify_forked(Core::EventLoop::ForkEvent::Child);
+            Core::EventLoop loop;
+            RefPtr<TransportTestConnection> connection;
+            auto server = Core::LocalServer::construct();
+            VERIFY(server->listen(socket_path));
+            server->on_ready_to_accept = [&] {
+                auto client_socket = server->accept();
+                VERIFY(client_socket);
+                connection = TransportTestConnection::construct(client_socket.release_nonnull());
+            };
+            char ready = 1;
+            VERIFY(write(ready_pipe[1], &ready, 1) == 1);
+            close(ready_pipe[1]);
+            exit(loop.exec());
+        }
+
+        close(ready_pipe[1]);
+        char ready = 0;
+        VERIFY(read(ready_pipe[0], &ready, 1) == 1);
+        close(ready_pipe[0]);
+
+        auto socket = Core::LocalSocket::construct();
+        VERIFY(socket->connect(Core::SocketAddress::local(socket_path)));
+        socket->set_blocking(true);
+        unlink(socket_path.characters());
+        m_connection = TransportTestConnection::construct(move(socket));
+    }
+
+    ~TransportTestPeer()
+    {
+        m_connection = nullptr;
+        kill(m_server_pid, SIGTERM);
+        waitpid(m_server_pid, nullptr, 0);
+    }
+
+    TransportTestConnection& connection() { return *m_connection; }
+
+private:
+    RefPtr<TransportTestConnection> m_connection;
+    pid_t m_server_pid { -1 };
+};
+
+static ByteBuffer make_payload(size_t size)
+{
+    auto payload = ByteBuffer::create_uninitialized(size);
+    for (size_t i = 0; i < size; ++i)
+        payload[i] = i & 0xff;
+    return payload;
+}
+
+static void post_pings_and_check(TransportTestConnection& connection, u32 count, size_t payload_size)
+{
+    auto payload = make_payload(payload_size);
+    for (u32 i = 0; i < count; ++i)
+        connection.post_message(Ping(i, payload));
+
+    auto statistics = connection.send_sync<GetStatistics>();
+    EXPECT_EQ(statistics->ping_count(), count);
+    EXPECT(statistics->pings_in_order());
+    EXPECT_EQ(statistics->payload_bytes(), count * payload_size);
+}
+
+TEST_CASE(messages_arrive_in_order)
+{
+    TransportTestPeer peer;
+    post_pings_and_check(peer.connection(), 1000, 16);
+}
+
+TEST_CASE(batched_messages_arrive_in_order)
+{
+    TransportTestPeer peer;
+    peer.connection().set_batching_enabled(true);
+    post_pings_and_check(peer.connection(), 10000, 16);
+}
+
+TEST_CASE(large_messages_arrive_intact)
+{
+    TransportTestPeer peer;
+    auto& connection = peer.connection();
+    connection.set_batching_enabled(true);
+    // Without fd passing we stay on the socket, which has to work just the same.
+    [[maybe_unused]] bool has_shared_memory = connection.enable_shared_memory_transport(4 * KiB, 256 * KiB);
+#ifdef __serenity__
+    EXPECT(has_shared_memory);
+#endif
+
+    // More than fits into the ring at once, so some of these go through the socket after all.
+    post_pings_and_check(connection, 64, 20 * KiB);
+
+    auto payload = make_payload(32 * KiB);
+    for (u32 i = 0; i < 8; ++i) {
+        auto response = connection.send_sync<Echo>(i, payload);
+        EXPECT_EQ(response->sequence(), i);
+        EXPECT(response->payload() == payload);
+    }
+}
+
+static void report(StringView what, u32 count, Core::ElapsedTimer const& timer)
+{
+    auto elapsed_ms = max(timer.elapsed(), 1);
+    outln("{}: {} messages in {} ms ({} messages/s)", what, count, elapsed_ms, count * 1000ull / elapsed_ms);
+}
+
+BENCHMARK_CASE(round_trip_latency)
+{
+    TransportTestPeer peer;
+    auto payload = make_payload(64);
+    constexpr u32 count = 10000;
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (u32 i = 0; i < count; ++i)
+        EXPECT_EQ(peer.connection().send_sync<Echo>(i, payload)->sequence(), i);
+    report("Round trips", count, timer);
+}
+
+static void benchmark_throughput(StringView what, bool batching, bool shared_memory, size_t payload_size, u32 count)
+{
+    TransportTestPeer peer;
+    auto& connection = peer.connection();
+    connection.set_batching_enabled(batching);
+    if (shared_memory)
+        (void)connection.enable_shared_memory_transport(4 * KiB);
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    post_pings_and_check(connection, count, payload_size);
+    report(what, count, timer);
+}
+
+BENCHMARK_CASE(small_message_throughput)
+{
+    benchmark_throughput("Small messages", false, false, 32, 100000);
+}
+
+BENCHMARK_CASE(small_message_throughput_batched)
+{
+    benchmark_throughput("Small messages, batched", true, false, 32, 100000);
+}
+
+BENCHMARK_CASE(large_message_throughput)
+{
+    benchmark_throughput("Large messages", false, false, 32 * KiB, 5000);
+}
+
+BENCHMARK_CASE(large_message_throughput_shared_memory)
+{
+    benchmark_throughput("Large messages, shared memory", true, true, 32 * KiB, 5000);
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/WorkerPool.h>
+
+TEST_CASE(every_index_is_visited_once)
+{
+    Threading::WorkerPool pool(3, "TestWorkerPool");
+    EXPECT_EQ(pool.concurrency(), 4u);
+
+    Array<Atomic<u32>, 1000> visits {};
+    pool.for_each_index(visits.size(), [&](size_t index) {
+        visits[index].fetch_add(1);
+    });
+    for (auto& count : visits)
+        EXPECT_EQ(count.load(), 1u);
+}
+
+TEST_CASE(batches_can_be_submitted_back_to_back)
+{
+    Threading::WorkerPool pool(2, "TestWorkerPool");
+    for (size_t batch = 0; batch < 500; ++batch) {
+        Atomic<size_t> sum { 0 };
+        pool.for_each_index(batch % 17, [&](size_t index) {
+            sum.fetch_add(index + 1);
+        });
+        size_t count = batch % 17;
+        EXPECT_EQ(sum.load(), count * (count + 1) / 2);
+    }
+}
+
+TEST_CASE(pool_without_threads_runs_inline)
+{
+    Threading::WorkerPool pool(0, "TestWorkerPool");
+    EXPECT_EQ(pool.concurrency(), 1u);
+
+    Vector<size_t> order;
+    pool.for_each_index(5, [&](size_t index) {
+        order.append(index);
+    });
+    EXPECT_EQ(order.size(), 5u);
+    for (size_t i = 0; i < order.size(); ++i)
+        EXPECT_EQ(order[i], i);
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Vector.h>
+#include <LibTest/TestCase.h>
+#include <LibVideo/VP9/BitStream.h>
+
+// A boolean encoder as described in the VP9 spec's annex on the encoding process (and as libvpx implements it),
+// so the decoder can be checked against sequences with a known outcome.
+class BoolEncoder {
+public:
+    BoolEncoder()
+    {
+        // The marker bit that init_bool() expects to be zero.
+        write(false, 128);
+    }
+
+    void write(bool value, u8 probability)
+    {
+        u32 split = 1 + (((m_range - 1) * probability) >> 8);
+        if (value) {
+            m_low_value += split;
+            m_range -= split;
+        } else {
+            m_range = split;
+        }
+
+        int shift = __builtin_clz(m_range) - 24;
+        m_range <<= shift;
+        m_count += shift;
+        if (m_count >= 0) {
+            int offset = shift - m_count;
+            if ((m_low_value << (offset - 1)) & 0x80000000)
+                propagate_carry();
+            m_data.append(static_cast<u8>(m_low_value >> (24 - offset)));
+            m_low_value <<= offset;
+            shift = m_count;
+            m_low_value &= 0xffffff;
+            m_count -= 8;
+        }
+        m_low_value <<= shift;
+    }
+
+    Vector<u8> finish()
+    {
+        for (int i = 0; i < 32; ++i)
+            write(false, 128);
+        return move(m_data);
+    }
+
+private:
+    void propagate_carry()
+    {
+        for (size_t i = m_data.size(); i-- > 0;) {
+            if (m_data[i] != 0xff) {
+                m_data[i]++;
+                return;
+            }
+            m_data[i] = 0;
+        }
+    }
+
+    Vector<u8> m_data;
+    u32 m_low_value { 0 };
+    u32 m_range { 255 };
+    int m_count { -24 };
+};
+
+struct CodedBool {
+    bool value;
+    u8 probability;
+};
+
+static u32 next_random(u32& state)
+{
+    state = state * 1103515245 + 12345;
+    return state >> 8;
+}
+
+static Vector<CodedBool> make_bools(size_t count, u32 seed)
+{
+    Vector<CodedBool> bools;
+    for (size_t i = 0; i < count; ++i) {
+        // Skewed probabilities make the range shrink by many bits at once, which pulls more bits out of the window per bool.
+        u8 probability = (i % 3 == 0) ? 1 + next_random(seed) % 255 : ((i % 3 == 1) ? 1 : 255);
+        bool value = next_random(seed) % 256 >= probability;
+        bools.append({ value, probability });
+    }
+    return bools;
+}
+
+TEST_CASE(bool_decoder_round_trip_across_window_refills)
+{
+    // Hundreds of bytes of coded data, so the 64-bit read-ahead window is refilled many times,
+    // including with the last partial refill at the end of the data.
+    auto bools = make_bools(4000, 1);
+    BoolEncoder encoder;
+    for (auto& coded : bools)
+        encoder.write(coded.value, coded.probability);
+    auto data = encoder.finish();
+    EXPECT(data.size() > 2 * sizeof(u64));
+
+    Video::VP9::BitStream stream(data.data(), data.size());
+    EXPECT(stream.init_bool(data.size()));
+    size_t mismatches = 0;
+    for (auto& coded : bools) {
+        if (stream.read_bool(coded.probability) != coded.value)
+            ++mismatches;
+    }
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT(stream.exit_bool());
+    EXPECT_EQ(stream.bytes_remaining(), 0u);
+}
+
+TEST_CASE(bool_decoder_reads_literals)
+{
+    BoolEncoder encoder;
+    for (u8 literal : { 0x00, 0xff, 0x5a, 0x81 }) {
+        for (int bit = 7; bit >= 0; --bit)
+            encoder.write((literal >> bit) & 1, 128);
+    }
+    auto data = encoder.finish();
+
+    Video::VP9::BitStream stream(data.data(), data.size());
+    EXPECT(stream.init_bool(data.size()));
+    EXPECT_EQ(stream.read_literal(8), 0x00);
+    EXPECT_EQ(stream.read_literal(8), 0xff);
+    EXPECT_EQ(stream.read_literal(8), 0x5a);
+    EXPECT_EQ(stream.read_literal(8), 0x81);
+    EXPECT(stream.exit_bool());
+}
+
+TEST_CASE(bool_decoder_data_followed_by_more_fields)
+{
+    // The bool decoder must not read past the bytes it was given, so fields after it are still in place.
+    BoolEncoder encoder;
+    for (int i = 0; i < 100; ++i)
+        encoder.write(i % 7 == 0, 200);
+    auto data = encoder.finish();
+    auto bool_data_size = data.size();
+    data.append(0xab);
+    data.append(0xcd);
+
+    Video::VP9::BitStream stream(data.data(), data.size());
+    EXPECT(stream.init_bool(bool_data_size));
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(stream.read_bool(200), i % 7 == 0);
+    EXPECT(stream.exit_bool());
+    EXPECT_EQ(stream.read_f16(), 0xabcd);
+}
+
+TEST_CASE(read_f_wider_than_a_byte)
+{
+    u8 const data[] = { 0b10110011, 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0 };
+    Video::VP9::BitStream stream(data, sizeof(data));
+
+    // Start off unaligned, so every wider field straddles byte boundaries.
+    EXPECT_EQ(stream.read_f(3), 0b101u);
+    EXPECT_EQ(stream.read_f(13), 0b1001100010010u);
+    EXPECT_EQ(stream.read_f(16), 0x3456u);
+    EXPECT_EQ(stream.read_f(4), 0x7u);
+    EXPECT_EQ(stream.read_f(32), 0x89abcdefu);
+    EXPECT_EQ(stream.read_f(4), 0x0u);
+    EXPECT_EQ(stream.bytes_remaining(), 0u);
+}
+
+TEST_CASE(read_f_full_32_bit_field)
+{
+    // Tile sizes are 32-bit fields, which used to be truncated to their low 8 bits.
+    u8 const data[] = { 0x00, 0x01, 0x02, 0x03 };
+    Video::VP9::BitStream stream(data, sizeof(data));
+    EXPECT_EQ(stream.read_f(32), 0x00010203u);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibCore/EventLoop.h>
+#include <LibWeb/DOM/Document.h>
+#include <LibWeb/HTML/Parser/HTMLDocumentParser.h>
+#include <LibWeb/Layout/InitialContainingBlockBox.h>
+#include <LibWeb/Layout/TreeBuilder.h>
+
+// WebContent only reuses the pixels of the last paint when scrolling if this says there is nothing that stays put.
+static bool has_fixed_position_boxes(StringView html)
+{
+    // The document's timers need an event loop, even though we never run it.
+    Core::EventLoop event_loop;
+    auto document = Web::DOM::Document::create();
+    Web::HTML::HTMLDocumentParser parser(document, html, "utf-8");
+    parser.run(URL("about:blank"));
+    document->invalidate_style();
+    document->update_style();
+
+    Web::Layout::TreeBuilder tree_builder;
+    auto layout_root = tree_builder.build(document);
+    VERIFY(layout_root);
+    return verify_cast<Web::Layout::InitialContainingBlockBox>(*layout_root).has_fixed_position_boxes();
+}
+
+TEST_CASE(page_without_fixed_position_boxes)
+{
+    EXPECT(!has_fixed_position_boxes(R"(
+        <div style="position: absolute; top: 0">absolute</div>
+        <div style="position: relative">relative</div>
+        <p>text</p>
+    )"sv));
+}
+
+TEST_CASE(page_with_fixed_position_box)
+{
+    EXPECT(has_fixed_position_boxes(R"(
+        <div style="position: fixed; top: 0; height: 50px">header</div>
+        <p>text</p>
+    )"sv));
+}
+
+TEST_CASE(page_with_nested_fixed_position_box)
+{
+    EXPECT(has_fixed_position_boxes(R"(
+        <div><div><div style="position: fixed; bottom: 0">footer</div></div></div>
+    )"sv));
+}
+
+TEST_CASE(page_with_fixed_position_from_style_sheet)
+{
+    EXPECT(has_fixed_position_boxes(R"(
+        <style>.banner { position: fixed }</style>
+        <div class="banner">banner</div>
+    )"sv));
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
+
+using PreloadScanner = Web::HTML::HTMLPreloadScanner;
+using ResourceKind = PreloadScanner::ResourceKind;
+
+TEST_CASE(finds_subresources)
+{
+    auto requests = PreloadScanner::scan(R"(
+        <html><head>
+        <link rel="stylesheet" href="style.css">
+        <script src="script.js"></script>
+        </head><body>
+        <p>Some text <img src="image.png"></p>
+        </body></html>
+    )"sv);
+    EXPECT_EQ(requests.size(), 3u);
+    EXPECT_EQ(requests[0].kind, ResourceKind::StyleSheet);
+    EXPECT_EQ(requests[0].url, "style.css");
+    EXPECT_EQ(requests[1].kind, ResourceKind::Script);
+    EXPECT_EQ(requests[1].url, "script.js");
+    EXPECT_EQ(requests[2].kind, ResourceKind::Image);
+    EXPECT_EQ(requests[2].url, "image.png");
+}
+
+TEST_CASE(ignores_markup_in_raw_text)
+{
+    auto requests = PreloadScanner::scan(R"(
+        <script>document.write('<img src="from-script.png">');</script>
+        <style>/* <img src="from-style.png"> */</style>
+        <textarea><img src="from-textarea.png"></textarea>
+        <!-- <img src="from-comment.png"> -->
+        <img src="real.png">
+    )"sv);
+    EXPECT_EQ(requests.size(), 1u);
+    EXPECT_EQ(requests[0].url, "real.png");
+}
+
+TEST_CASE(skips_duplicates_and_alternate_stylesheets)
+{
+    auto requests = PreloadScanner::scan(R"(
+        <link rel="alternate stylesheet" href="alternate.css">
+        <link rel="icon" href="favicon.ico">
+        <img src="image.png"><img src="image.png"><img>
+    )"sv);
+    EXPECT_EQ(requests.size(), 1u);
+    EXPECT_EQ(requests[0].url, "image.png");
+}
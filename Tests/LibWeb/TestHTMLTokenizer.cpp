@@ -197,6 +197,72 @@ TEST_CASE(doctype)
     EXPECT_END_TAG_TOKEN(html);
 }
 
+TEST_CASE(long_text)
+{
+    auto tokens = run_tokenizer("<p>Text that is longer than a word &amp; goes\nover two lines, with ünïcode.</p>"sv);
+    BEGIN_ENUMERATION(tokens);
+    EXPECT_START_TAG_TOKEN(p);
+    for (auto code_point : Utf8View("Text that is longer than a word & goes\nover two lines, with ünïcode."sv)) {
+        EXPECT_CHARACTER_TOKEN(code_point);
+    }
+    EXPECT_END_TAG_TOKEN(p);
+    EXPECT_END_OF_FILE_TOKEN();
+    END_ENUMERATION();
+}
+
+TEST_CASE(text_with_null_character)
+{
+    auto tokens = run_tokenizer("<p>abcdefgh\0ijklmnop</p>"sv);
+    BEGIN_ENUMERATION(tokens);
+    EXPECT_START_TAG_TOKEN(p);
+    for (auto c : "abcdefgh\0ijklmnop"sv) {
+        EXPECT_CHARACTER_TOKEN(c);
+    }
+    EXPECT_END_TAG_TOKEN(p);
+    EXPECT_END_OF_FILE_TOKEN();
+    END_ENUMERATION();
+}
+
+TEST_CASE(tag_position_after_text)
+{
+    auto tokens = run_tokenizer("<p>Some text\nand some more text\n<b>bold</b></p>"sv);
+    auto bold_start_tag = tokens.find_if([](auto& token) {
+        return token.is_start_tag() && token.tag_name() == "b";
+    });
+    VERIFY(!bold_start_tag.is_end());
+    EXPECT_EQ(bold_start_tag->start_position().line, 2u);
+    EXPECT_EQ(bold_start_tag->start_position().column, 1u);
+}
+
+TEST_CASE(plain_text_run)
+{
+    Tokenizer tokenizer { "<p>Text that is longer than sixteen bytes\nand spans two lines<b>ünïcode &amp; more</b>"sv, "UTF-8"sv };
+    EXPECT(tokenizer.consume_plain_text_run().is_empty());
+    auto paragraph_start_tag = tokenizer.next_token();
+    EXPECT(paragraph_start_tag.has_value() && paragraph_start_tag->is_start_tag());
+
+    EXPECT_EQ(tokenizer.consume_plain_text_run(), "Text that is longer than sixteen bytes\nand spans two lines"sv);
+    EXPECT(tokenizer.consume_plain_text_run().is_empty());
+    auto bold_start_tag = tokenizer.next_token();
+    VERIFY(bold_start_tag.has_value());
+    EXPECT_EQ(bold_start_tag->tag_name(), "b");
+    EXPECT_EQ(bold_start_tag->start_position().line, 1u);
+    EXPECT_EQ(bold_start_tag->start_position().column, 20u);
+
+    // Non-ASCII text and character references are left to the state machine.
+    EXPECT(tokenizer.consume_plain_text_run().is_empty());
+    for (auto code_point : Utf8View("ünïc"sv)) {
+        auto token = tokenizer.next_token();
+        EXPECT(token.has_value() && token->is_character() && token->code_point() == code_point);
+    }
+    EXPECT_EQ(tokenizer.consume_plain_text_run(), "ode "sv);
+    auto ampersand = tokenizer.next_token();
+    EXPECT(ampersand.has_value() && ampersand->is_character() && ampersand->code_point() == '&');
+    EXPECT_EQ(tokenizer.consume_plain_text_run(), " more"sv);
+    auto bold_end_tag = tokenizer.next_token();
+    EXPECT(bold_end_tag.has_value() && bold_end_tag->is_end_tag());
+}
+
 // NOTE: This relies on the format of HTMLToken::to_string() staying the same.
 //       If that changes, or something is added to the test HTML, the hash needs to be adjusted.
 TEST_CASE(regression)
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibCore/EventLoop.h>
+#include <LibWeb/CSS/StyleProperties.h>
+#include <LibWeb/DOM/Document.h>
+#include <LibWeb/DOM/Element.h>
+#include <LibWeb/HTML/Parser/HTMLDocumentParser.h>
+
+static NonnullRefPtr<Web::DOM::Document> parse_document(StringView html)
+{
+    auto document = Web::DOM::Document::create();
+    Web::HTML::HTMLDocumentParser parser(document, html, "utf-8");
+    parser.run(URL("about:blank"));
+    document->invalidate_style();
+    document->update_style();
+    return document;
+}
+
+static Color color_of(Web::DOM::Element const& element)
+{
+    return element.specified_css_values()->color_or_fallback(Web::CSS::PropertyID::Color, element.document(), Color::Black);
+}
+
+TEST_CASE(hover_restyles_children_that_inherit_from_the_hovered_element)
+{
+    // The document's timers need an event loop, even though we never run it.
+    Core::EventLoop event_loop;
+    auto document = parse_document(R"(
+        <style>div:hover { color: red }</style>
+        <div id="parent"><p id="child">text</p></div>
+        <p id="outside">text</p>
+    )"sv);
+
+    auto parent = document->query_selector("#parent");
+    auto child = document->query_selector("#child");
+    auto outside = document->query_selector("#outside");
+    VERIFY(parent && child && outside);
+    auto default_color = color_of(*outside);
+    EXPECT_NE(default_color, Color(Color::Red));
+    EXPECT_EQ(color_of(*child), default_color);
+
+    document->set_hovered_node(parent);
+    document->update_style();
+    EXPECT_EQ(color_of(*parent), Color(Color::Red));
+    EXPECT_EQ(color_of(*child), Color(Color::Red));
+    EXPECT_EQ(color_of(*outside), default_color);
+
+    document->set_hovered_node(nullptr);
+    document->update_style();
+    EXPECT_EQ(color_of(*parent), default_color);
+    EXPECT_EQ(color_of(*child), default_color);
+}
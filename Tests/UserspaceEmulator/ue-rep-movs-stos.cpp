@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Assertions.h>
+#include <AK/Types.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+// REP MOVS and REP STOS take a bulk path in UserspaceEmulator when the whole range lies in one region,
+// and go element by element otherwise. Both have to give the same results as the real instructions,
+// including when a copy crosses a page or region boundary, or overlaps itself.
+
+template<typename T>
+static void rep_movs(T* destination, T const* source, size_t count)
+{
+    if constexpr (sizeof(T) == 1)
+        asm volatile("cld\nrep movsb"
+                     : "+D"(destination), "+S"(source), "+c"(count)
+                     :
+                     : "memory");
+    else if constexpr (sizeof(T) == 2)
+        asm volatile("cld\nrep movsw"
+                     : "+D"(destination), "+S"(source), "+c"(count)
+                     :
+                     : "memory");
+    else
+        asm volatile("cld\nrep movsl"
+                     : "+D"(destination), "+S"(source), "+c"(count)
+                     :
+                     : "memory");
+}
+
+template<typename T>
+static void rep_stos(T* destination, T value, size_t count)
+{
+    if constexpr (sizeof(T) == 1)
+        asm volatile("cld\nrep stosb"
+                     : "+D"(destination), "+c"(count)
+                     : "a"(value)
+                     : "memory");
+    else if constexpr (sizeof(T) == 2)
+        asm volatile("cld\nrep stosw"
+                     : "+D"(destination), "+c"(count)
+                     : "a"(value)
+                     : "memory");
+    else
+        asm volatile("cld\nrep stosl"
+                     : "+D"(destination), "+c"(count)
+                     : "a"(value)
+                     : "memory");
+}
+
+// What the instructions are specified to do, one element at a time.
+template<typename T>
+static void reference_movs(T volatile* destination, T const volatile* source, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        destination[i] = source[i];
+}
+
+static void fill_with_pattern(u8* data, size_t size, u8 seed)
+{
+    for (size_t i = 0; i < size; ++i)
+        data[i] = static_cast<u8>(seed + i * 7);
+}
+
+static int failures = 0;
+
+static void expect_equal(char const* what, u8 const* actual, u8 const* expected, size_t size)
+{
+    if (memcmp(actual, expected, size) == 0)
+        return;
+    printf("FAIL: %s\n", what);
+    ++failures;
+}
+
+// Two pages that are either one region, or two regions that happen to be next to each other.
+static u8* map_two_pages(bool as_separate_regions)
+{
+    auto* pages = (u8*)mmap(nullptr, 2 * PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    VERIFY(pages != MAP_FAILED);
+    if (as_separate_regions) {
+        auto* second_page = (u8*)mmap(pages + PAGE_SIZE, PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED, 0, 0);
+        VERIFY(second_page == pages + PAGE_SIZE);
+    }
+    return pages;
+}
+
+template<typename T>
+static void test_copies_across_page_boundary(u8* pages)
+{
+    constexpr size_t size = 1024;
+    u8 expected[2 * PAGE_SIZE];
+
+    // Source straddles the boundary, destination doesn't, and the other way around.
+    struct {
+        size_t source_offset;
+        size_t destination_offset;
+    } const cases[] = { { PAGE_SIZE - 256, 64 }, { 64, PAGE_SIZE - 256 } };
+    for (auto [source_offset, destination_offset] : cases) {
+        fill_with_pattern(pages, 2 * PAGE_SIZE, 1);
+        memcpy(expected, pages, sizeof(expected));
+        reference_movs((T volatile*)(expected + destination_offset), (T const volatile*)(expected + source_offset), size / sizeof(T));
+        rep_movs((T*)(pages + destination_offset), (T const*)(pages + source_offset), size / sizeof(T));
+        expect_equal("rep movs across a page boundary", pages, expected, sizeof(expected));
+    }
+
+    // Overlapping copies move one element at a time, so a forward copy onto itself smears the start of the source.
+    constexpr ssize_t element_size = sizeof(T);
+    constexpr ssize_t distances[] = { element_size, 3 * element_size, -element_size, -64 };
+    for (ssize_t distance : distances) {
+        size_t source_offset = PAGE_SIZE - 512;
+        size_t destination_offset = source_offset + distance;
+        fill_with_pattern(pages, 2 * PAGE_SIZE, 2);
+        memcpy(expected, pages, sizeof(expected));
+        reference_movs((T volatile*)(expected + destination_offset), (T const volatile*)(expected + source_offset), size / sizeof(T));
+        rep_movs((T*)(pages + destination_offset), (T const*)(pages + source_offset), size / sizeof(T));
+        expect_equal("overlapping rep movs across a page boundary", pages, expected, sizeof(expected));
+    }
+}
+
+template<typename T>
+static void test_fill_across_page_boundary(u8* pages)
+{
+    constexpr size_t size = 1024;
+    u8 expected[2 * PAGE_SIZE];
+    size_t offset = PAGE_SIZE - 300;
+    T value = static_cast<T>(0xa5c3e1f7);
+
+    fill_with_pattern(pages, 2 * PAGE_SIZE, 3);
+    memcpy(expected, pages, sizeof(expected));
+    for (size_t i = 0; i < size / sizeof(T); ++i)
+        memcpy(expected + offset + i * sizeof(T), &value, sizeof(T));
+    rep_stos((T*)(pages + offset), value, size / sizeof(T));
+    expect_equal("rep stos across a page boundary", pages, expected, sizeof(expected));
+}
+
+int main()
+{
+    for (int as_separate_regions = 0; as_separate_regions < 2; ++as_separate_regions) {
+        auto* pages = map_two_pages(as_separate_regions);
+        test_copies_across_page_boundary<u8>(pages);
+        test_copies_across_page_boundary<u16>(pages);
+        test_copies_across_page_boundary<u32>(pages);
+        test_fill_across_page_boundary<u8>(pages);
+        test_fill_across_page_boundary<u16>(pages);
+        test_fill_across_page_boundary<u32>(pages);
+        munmap(pages, 2 * PAGE_SIZE);
+    }
+
+    if (failures) {
+        printf("FAIL: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
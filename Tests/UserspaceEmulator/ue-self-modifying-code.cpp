@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Assertions.h>
+#include <AK/Types.h>
+#include <LibCore/ElapsedTimer.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+// Code that UserspaceEmulator has already executed must not be reused after it changes,
+// and tight loops should be fast since they don't have to be decoded over and over.
+
+using Function = int (*)();
+
+static void emit_return_constant(u8* code, u32 value)
+{
+    // mov eax, value; ret
+    code[0] = 0xb8;
+    memcpy(code + 1, &value, sizeof(value));
+    code[5] = 0xc3;
+}
+
+static int test_rewritten_code()
+{
+    auto* code = (u8*)mmap(nullptr, PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+    VERIFY(code != MAP_FAILED);
+    auto function = reinterpret_cast<Function>(code);
+
+    int failures = 0;
+    for (u32 value = 1; value <= 3; ++value) {
+        emit_return_constant(code, value);
+        if (mprotect(code, PAGE_SIZE, PROT_READ | PROT_EXEC) < 0) {
+            perror("mprotect");
+            return 1;
+        }
+        for (int i = 0; i < 10; ++i) {
+            if (function() != (int)value)
+                ++failures;
+        }
+        if (mprotect(code, PAGE_SIZE, PROT_READ | PROT_WRITE) < 0) {
+            perror("mprotect");
+            return 1;
+        }
+    }
+    munmap(code, PAGE_SIZE);
+    return failures;
+}
+
+static u32 hot_loop(u32 iterations)
+{
+    volatile u32 sum = 0;
+    for (u32 i = 0; i < iterations; ++i)
+        sum = sum + (i ^ (i >> 3));
+    return sum;
+}
+
+int main()
+{
+    if (int failures = test_rewritten_code(); failures > 0) {
+        printf("FAIL: %d calls ran stale code\n", failures);
+        return 1;
+    }
+
+    constexpr u32 iterations = 10'000'000;
+    Core::ElapsedTimer timer;
+    timer.start();
+    hot_loop(iterations);
+    printf("Ran %u loop iterations in %d ms\n", iterations, timer.elapsed());
+
+    printf("PASS\n");
+    return 0;
+}
@@ -330,6 +330,11 @@ void BrowserWindow::build_menus()
             active_tab().m_web_content_view->debug_request("dump-style-sheets");
         },
         this));
+    debug_menu.add_action(GUI::Action::create(
+        "Dump Style &Update Statistics", [this](auto&) {
+            active_tab().m_web_content_view->debug_request("dump-style-statistics");
+        },
+        this));
     debug_menu.add_action(GUI::Action::create("Dump &History", { Mod_Ctrl, Key_H }, [this](auto&) {
         active_tab().m_history.dump();
     }));
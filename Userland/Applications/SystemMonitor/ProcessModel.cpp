@@ -88,6 +88,8 @@ String ProcessModel::column_name(int column) const
         return "Purg:V";
     case Column::PurgeableNonvolatile:
         return "Purg:N";
+    case Column::LargePages:
+        return "Large";
     case Column::CPU:
         return "CPU";
     case Column::Processor:
@@ -102,6 +104,8 @@ String ProcessModel::column_name(int column) const
         return "F:Zero";
     case Column::CowFaults:
         return "F:CoW";
+    case Column::LargePageFaults:
+        return "F:Large";
     case Column::IPv4SocketReadBytes:
         return "IPv4 In";
     case Column::IPv4SocketWriteBytes:
@@ -153,12 +157,14 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, GUI::ModelRole rol
         case Column::CleanInode:
         case Column::PurgeableVolatile:
         case Column::PurgeableNonvolatile:
+        case Column::LargePages:
         case Column::CPU:
         case Column::Processor:
         case Column::Syscalls:
         case Column::InodeFaults:
         case Column::ZeroFaults:
         case Column::CowFaults:
+        case Column::LargePageFaults:
         case Column::FileReadBytes:
         case Column::FileWriteBytes:
         case Column::UnixSocketReadBytes:
@@ -206,6 +212,8 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, GUI::ModelRole rol
             return (int)thread.current_state.amount_purgeable_volatile;
         case Column::PurgeableNonvolatile:
             return (int)thread.current_state.amount_purgeable_nonvolatile;
+        case Column::LargePages:
+            return (int)thread.current_state.amount_large_pages;
         case Column::CPU:
             return thread.current_state.cpu_percent;
         case Column::Processor:
@@ -220,6 +228,8 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, GUI::ModelRole rol
             return thread.current_state.zero_faults;
         case Column::CowFaults:
             return thread.current_state.cow_faults;
+        case Column::LargePageFaults:
+            return thread.current_state.large_page_faults;
         case Column::IPv4SocketReadBytes:
             return thread.current_state.ipv4_socket_read_bytes;
         case Column::IPv4SocketWriteBytes:
@@ -275,6 +285,8 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, GUI::ModelRole rol
             return pretty_byte_size(thread.current_state.amount_purgeable_volatile);
         case Column::PurgeableNonvolatile:
             return pretty_byte_size(thread.current_state.amount_purgeable_nonvolatile);
+        case Column::LargePages:
+            return pretty_byte_size(thread.current_state.amount_large_pages);
         case Column::CPU:
             return String::formatted("{:.2}", thread.current_state.cpu_percent);
         case Column::Processor:
@@ -291,6 +303,8 @@ GUI::Variant ProcessModel::data(const GUI::ModelIndex& index, GUI::ModelRole rol
             return thread.current_state.zero_faults;
         case Column::CowFaults:
             return thread.current_state.cow_faults;
+        case Column::LargePageFaults:
+            return thread.current_state.large_page_faults;
         case Column::IPv4SocketReadBytes:
             return thread.current_state.ipv4_socket_read_bytes;
         case Column::IPv4SocketWriteBytes:
@@ -341,6 +355,7 @@ void ProcessModel::update()
                 state.inode_faults = thread.inode_faults;
                 state.zero_faults = thread.zero_faults;
                 state.cow_faults = thread.cow_faults;
+                state.large_page_faults = thread.large_page_faults;
                 state.unix_socket_read_bytes = thread.unix_socket_read_bytes;
                 state.unix_socket_write_bytes = thread.unix_socket_write_bytes;
                 state.ipv4_socket_read_bytes = thread.ipv4_socket_read_bytes;
@@ -353,6 +368,7 @@ void ProcessModel::update()
                 state.amount_clean_inode = process.amount_clean_inode;
                 state.amount_purgeable_volatile = process.amount_purgeable_volatile;
                 state.amount_purgeable_nonvolatile = process.amount_purgeable_nonvolatile;
+                state.amount_large_pages = process.amount_large_pages;
 
                 state.name = thread.name;
                 state.executable = process.executable;
@@ -31,6 +31,7 @@ public:
         CleanInode,
         PurgeableVolatile,
         PurgeableNonvolatile,
+        LargePages,
         Veil,
         Processor,
         Priority,
@@ -42,6 +43,7 @@ public:
         InodeFaults,
         ZeroFaults,
         CowFaults,
+        LargePageFaults,
         FileReadBytes,
         FileWriteBytes,
         UnixSocketReadBytes,
@@ -105,10 +107,12 @@ private:
         size_t amount_clean_inode;
         size_t amount_purgeable_volatile;
         size_t amount_purgeable_nonvolatile;
+        size_t amount_large_pages;
         unsigned syscall_count;
         unsigned inode_faults;
         unsigned zero_faults;
         unsigned cow_faults;
+        unsigned large_page_faults;
         unsigned unix_socket_read_bytes;
         unsigned unix_socket_write_bytes;
         unsigned ipv4_socket_read_bytes;
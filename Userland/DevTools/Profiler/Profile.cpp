@@ -14,9 +14,11 @@
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/QuickSort.h>
 #include <AK/RefPtr.h>
+#include <Kernel/API/Perfcore.h>
 #include <LibCore/File.h>
 #include <LibELF/Image.h>
 #include <LibSymbolication/Symbolication.h>
+#include <serenity.h>
 #include <sys/stat.h>
 
 namespace Profiler {
@@ -211,23 +213,255 @@ void Profile::rebuild_tree()
     m_model->invalidate();
 }
 
-Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const StringView& path)
+namespace {
+
+// Reads the integers of a binary perfcore. Running past the end sets a sticky error instead of failing every read.
+class PerfcoreReader {
+public:
+    explicit PerfcoreReader(ReadonlyBytes bytes)
+        : m_bytes(bytes)
+    {
+    }
+
+    bool is_eof() const { return m_offset >= m_bytes.size(); }
+    bool has_error() const { return m_has_error; }
+
+    u8 read_u8()
+    {
+        if (is_eof()) {
+            m_has_error = true;
+            return 0;
+        }
+        return m_bytes[m_offset++];
+    }
+
+    u32 read_u32()
+    {
+        if (m_bytes.size() - m_offset < sizeof(u32)) {
+            m_has_error = true;
+            return 0;
+        }
+        u32 value;
+        memcpy(&value, m_bytes.offset_pointer(m_offset), sizeof(value));
+        m_offset += sizeof(value);
+        return value;
+    }
+
+    u64 read_varint()
+    {
+        u64 value = 0;
+        for (size_t shift = 0; shift < 64; shift += 7) {
+            u8 byte = read_u8();
+            value |= static_cast<u64>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        m_has_error = true;
+        return 0;
+    }
+
+    StringView read_string()
+    {
+        auto length = read_varint();
+        if (length > m_bytes.size() - m_offset) {
+            m_has_error = true;
+            return {};
+        }
+        StringView string { m_bytes.offset_pointer(m_offset), length };
+        m_offset += length;
+        return string;
+    }
+
+private:
+    ReadonlyBytes m_bytes;
+    size_t m_offset { 0 };
+    bool m_has_error { false };
+};
+
+// Turns perfcore events into profile events in a single pass, keeping track of processes and the libraries they have mapped.
+class PerfcoreLoader {
+public:
+    using Event = Profile::Event;
+    using Frame = Profile::Frame;
+
+    PerfcoreLoader()
+        : m_kernel_base(Symbolication::kernel_base())
+    {
+        auto file_or_error = MappedFile::map("/boot/Kernel.debug");
+        if (!file_or_error.is_error()) {
+            m_kernel_file = file_or_error.release_value();
+            m_kernel_elf = make<ELF::Image>(m_kernel_file->bytes());
+        }
+    }
+
+    Result<void, String> load_json(ReadonlyBytes);
+    Result<void, String> load_binary(ReadonlyBytes);
+
+    Vector<Process> take_processes();
+    Vector<Event> take_events() { return move(m_events); }
+
+private:
+    // Returns false for events that only change the state of the processes, and aren't kept in the profile.
+    Result<bool, String> handle_event(int type, Event&);
+    Vector<Frame> symbolicate(pid_t, Span<FlatPtr const> stack);
+    void add_event(Event&&, Vector<Frame>);
+
+    Optional<FlatPtr> m_kernel_base;
+    RefPtr<MappedFile> m_kernel_file;
+    OwnPtr<ELF::Image> m_kernel_elf;
+
+    NonnullOwnPtrVector<Process> m_all_processes;
+    HashMap<pid_t, Process*> m_current_processes;
+    Vector<Event> m_events;
+    EventSerialNumber m_next_serial;
+
+    // Bumped whenever an address may start symbolicating differently, i.e. on every mmap and whenever a process comes or goes.
+    u32 m_symbolication_generation { 0 };
+};
+
+Result<bool, String> PerfcoreLoader::handle_event(int type, Event& event)
+{
+    event.serial = m_next_serial;
+    m_next_serial.increment();
+
+    switch (type) {
+    case PERF_EVENT_SAMPLE:
+    case PERF_EVENT_MALLOC:
+    case PERF_EVENT_FREE:
+    case PERF_EVENT_SIGNPOST:
+        return true;
+    case PERF_EVENT_MMAP: {
+        auto& data = event.data.get<Event::MmapData>();
+        auto it = m_current_processes.find(event.pid);
+        if (it != m_current_processes.end())
+            it->value->library_metadata.handle_mmap(data.ptr, data.size, data.name);
+        ++m_symbolication_generation;
+        return false;
+    }
+    case PERF_EVENT_MUNMAP:
+        return false;
+    case PERF_EVENT_PROCESS_CREATE:
+    case PERF_EVENT_PROCESS_EXEC: {
+        String executable;
+        if (type == PERF_EVENT_PROCESS_EXEC) {
+            executable = event.data.get<Event::ProcessExecData>().executable;
+
+            auto old_process = m_current_processes.get(event.pid).value();
+            old_process->end_valid = event.serial;
+
+            m_current_processes.remove(event.pid);
+        } else {
+            executable = event.data.get<Event::ProcessCreateData>().executable;
+        }
+
+        auto sampled_process = adopt_own(*new Process {
+            .pid = event.pid,
+            .executable = executable,
+            .basename = LexicalPath::basename(executable),
+            .start_valid = event.serial,
+            .end_valid = {},
+        });
+
+        m_current_processes.set(sampled_process->pid, sampled_process);
+        m_all_processes.append(move(sampled_process));
+        ++m_symbolication_generation;
+        return false;
+    }
+    case PERF_EVENT_PROCESS_EXIT: {
+        auto old_process = m_current_processes.get(event.pid).value();
+        old_process->end_valid = event.serial;
+
+        m_current_processes.remove(event.pid);
+        ++m_symbolication_generation;
+        return false;
+    }
+    case PERF_EVENT_THREAD_CREATE: {
+        auto it = m_current_processes.find(event.pid);
+        if (it != m_current_processes.end())
+            it->value->handle_thread_create(event.tid, event.serial);
+        return false;
+    }
+    case PERF_EVENT_THREAD_EXIT: {
+        auto it = m_current_processes.find(event.pid);
+        if (it != m_current_processes.end())
+            it->value->handle_thread_exit(event.tid, event.serial);
+        return false;
+    }
+    default:
+        return String::formatted("Unknown event type {}", type);
+    }
+}
+
+Vector<Profile::Frame> PerfcoreLoader::symbolicate(pid_t pid, Span<FlatPtr const> stack)
+{
+    Vector<Frame> frames;
+    frames.ensure_capacity(stack.size());
+    for (ssize_t i = stack.size() - 1; i >= 0; --i) {
+        auto ptr = stack[i];
+        u32 offset = 0;
+        FlyString object_name;
+        String symbol;
+
+        if (m_kernel_base.has_value() && ptr >= m_kernel_base.value()) {
+            if (m_kernel_elf) {
+                symbol = m_kernel_elf->symbolicate(ptr - m_kernel_base.value(), &offset);
+            } else {
+                symbol = String::formatted("?? <{:p}>", ptr);
+            }
+        } else {
+            auto it = m_current_processes.find(pid);
+            // FIXME: This logic is kinda gnarly, find a way to clean it up.
+            LibraryMetadata* library_metadata {};
+            if (it != m_current_processes.end())
+                library_metadata = &it->value->library_metadata;
+            if (auto* library = library_metadata ? library_metadata->library_containing(ptr) : nullptr) {
+                object_name = library->name;
+                symbol = library->symbolicate(ptr, &offset);
+            } else {
+                symbol = String::formatted("?? <{:p}>", ptr);
+            }
+        }
+
+        frames.unchecked_append({ object_name, symbol, ptr, offset });
+    }
+    return frames;
+}
+
+void PerfcoreLoader::add_event(Event&& event, Vector<Frame> frames)
+{
+    if (frames.size() < 2)
+        return;
+
+    event.frames = move(frames);
+    FlatPtr innermost_frame_address = event.frames.at(1).address;
+    event.in_kernel = m_kernel_base.has_value() && innermost_frame_address >= m_kernel_base.value();
+
+    m_events.append(move(event));
+}
+
+Vector<Process> PerfcoreLoader::take_processes()
 {
-    auto file = Core::File::construct(path);
-    if (!file->open(Core::OpenMode::ReadOnly))
-        return String::formatted("Unable to open {}, error: {}", path, file->error_string());
+    quick_sort(m_all_processes, [](auto& a, auto& b) {
+        if (a.pid == b.pid)
+            return a.start_valid < b.start_valid;
+        else
+            return a.pid < b.pid;
+    });
 
-    auto json = JsonValue::from_string(file->read_all());
+    Vector<Process> processes;
+    for (auto& it : m_all_processes)
+        processes.append(move(it));
+    return processes;
+}
+
+Result<void, String> PerfcoreLoader::load_json(ReadonlyBytes bytes)
+{
+    auto json = JsonValue::from_string(StringView { bytes });
     if (!json.has_value() || !json.value().is_object())
         return String { "Invalid perfcore format (not a JSON object)" };
 
     auto& object = json.value().as_object();
 
-    auto file_or_error = MappedFile::map("/boot/Kernel.debug");
-    OwnPtr<ELF::Image> kernel_elf;
-    if (!file_or_error.is_error())
-        kernel_elf = make<ELF::Image>(file_or_error.value()->bytes());
-
     auto strings_value = object.get_ptr("strings"sv);
     if (!strings_value || !strings_value->is_array())
         return String { "Malformed profile (strings is not an array)" };
@@ -244,188 +478,258 @@ Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const St
 
     auto& perf_events = events_value->as_array();
 
-    NonnullOwnPtrVector<Process> all_processes;
-    HashMap<pid_t, Process*> current_processes;
-    Vector<Event> events;
-    EventSerialNumber next_serial;
-
     for (auto& perf_event_value : perf_events.values()) {
         auto& perf_event = perf_event_value.as_object();
 
         Event event;
 
-        event.serial = next_serial;
-        next_serial.increment();
         event.timestamp = perf_event.get("timestamp").to_number<u64>();
         event.lost_samples = perf_event.get("lost_samples").to_number<u32>();
         event.pid = perf_event.get("pid").to_i32();
         event.tid = perf_event.get("tid").to_i32();
 
         auto type_string = perf_event.get("type").to_string();
+        int type = 0;
 
         if (type_string == "sample"sv) {
+            type = PERF_EVENT_SAMPLE;
             event.data = Event::SampleData {};
         } else if (type_string == "malloc"sv) {
+            type = PERF_EVENT_MALLOC;
             event.data = Event::MallocData {
                 .ptr = perf_event.get("ptr"sv).to_number<FlatPtr>(),
                 .size = perf_event.get("size"sv).to_number<size_t>(),
             };
         } else if (type_string == "free"sv) {
+            type = PERF_EVENT_FREE;
             event.data = Event::FreeData {
                 .ptr = perf_event.get("ptr"sv).to_number<FlatPtr>(),
             };
         } else if (type_string == "signpost"sv) {
+            type = PERF_EVENT_SIGNPOST;
             auto string_id = perf_event.get("arg1"sv).to_number<FlatPtr>();
             event.data = Event::SignpostData {
                 .string = profile_strings.get(string_id).value_or(String::formatted("Signpost #{}", string_id)),
                 .arg = perf_event.get("arg2"sv).to_number<FlatPtr>(),
             };
         } else if (type_string == "mmap"sv) {
-            auto ptr = perf_event.get("ptr"sv).to_number<FlatPtr>();
-            auto size = perf_event.get("size"sv).to_number<size_t>();
-            auto name = perf_event.get("name"sv).to_string();
-
+            type = PERF_EVENT_MMAP;
             event.data = Event::MmapData {
-                .ptr = ptr,
-                .size = size,
-                .name = name,
+                .ptr = perf_event.get("ptr"sv).to_number<FlatPtr>(),
+                .size = perf_event.get("size"sv).to_number<size_t>(),
+                .name = perf_event.get("name"sv).to_string(),
             };
-
-            auto it = current_processes.find(event.pid);
-            if (it != current_processes.end())
-                it->value->library_metadata.handle_mmap(ptr, size, name);
-            continue;
         } else if (type_string == "munmap"sv) {
+            type = PERF_EVENT_MUNMAP;
             event.data = Event::MunmapData {
                 .ptr = perf_event.get("ptr"sv).to_number<FlatPtr>(),
                 .size = perf_event.get("size"sv).to_number<size_t>(),
             };
-            continue;
         } else if (type_string == "process_create"sv) {
-            auto parent_pid = perf_event.get("parent_pid"sv).to_number<pid_t>();
-            auto executable = perf_event.get("executable"sv).to_string();
+            type = PERF_EVENT_PROCESS_CREATE;
             event.data = Event::ProcessCreateData {
-                .parent_pid = parent_pid,
-                .executable = executable,
+                .parent_pid = perf_event.get("parent_pid"sv).to_number<pid_t>(),
+                .executable = perf_event.get("executable"sv).to_string(),
             };
-
-            auto sampled_process = adopt_own(*new Process {
-                .pid = event.pid,
-                .executable = executable,
-                .basename = LexicalPath::basename(executable),
-                .start_valid = event.serial,
-                .end_valid = {},
-            });
-
-            current_processes.set(sampled_process->pid, sampled_process);
-            all_processes.append(move(sampled_process));
-            continue;
         } else if (type_string == "process_exec"sv) {
-            auto executable = perf_event.get("executable"sv).to_string();
+            type = PERF_EVENT_PROCESS_EXEC;
             event.data = Event::ProcessExecData {
-                .executable = executable,
+                .executable = perf_event.get("executable"sv).to_string(),
             };
-
-            auto old_process = current_processes.get(event.pid).value();
-            old_process->end_valid = event.serial;
-
-            current_processes.remove(event.pid);
-
-            auto sampled_process = adopt_own(*new Process {
-                .pid = event.pid,
-                .executable = executable,
-                .basename = LexicalPath::basename(executable),
-                .start_valid = event.serial,
-                .end_valid = {},
-            });
-
-            current_processes.set(sampled_process->pid, sampled_process);
-            all_processes.append(move(sampled_process));
-            continue;
         } else if (type_string == "process_exit"sv) {
-            auto old_process = current_processes.get(event.pid).value();
-            old_process->end_valid = event.serial;
-
-            current_processes.remove(event.pid);
-            continue;
+            type = PERF_EVENT_PROCESS_EXIT;
         } else if (type_string == "thread_create"sv) {
-            auto parent_tid = perf_event.get("parent_tid"sv).to_number<pid_t>();
+            type = PERF_EVENT_THREAD_CREATE;
             event.data = Event::ThreadCreateData {
-                .parent_tid = parent_tid,
+                .parent_tid = perf_event.get("parent_tid"sv).to_number<pid_t>(),
             };
-            auto it = current_processes.find(event.pid);
-            if (it != current_processes.end())
-                it->value->handle_thread_create(event.tid, event.serial);
-            continue;
         } else if (type_string == "thread_exit"sv) {
-            auto it = current_processes.find(event.pid);
-            if (it != current_processes.end())
-                it->value->handle_thread_exit(event.tid, event.serial);
-            continue;
+            type = PERF_EVENT_THREAD_EXIT;
         } else {
-            dbgln("Unknown event type '{}'", type_string);
-            VERIFY_NOT_REACHED();
+            return String::formatted("Unknown event type '{}'", type_string);
         }
 
-        auto maybe_kernel_base = Symbolication::kernel_base();
+        auto should_keep_event = handle_event(type, event);
+        if (should_keep_event.is_error())
+            return should_keep_event.release_error();
+        if (!should_keep_event.value())
+            continue;
 
         auto* stack = perf_event.get_ptr("stack");
-        VERIFY(stack);
-        auto& stack_array = stack->as_array();
-        for (ssize_t i = stack_array.values().size() - 1; i >= 0; --i) {
-            auto& frame = stack_array.at(i);
-            auto ptr = frame.to_number<u64>();
-            u32 offset = 0;
-            FlyString object_name;
-            String symbol;
-
-            if (maybe_kernel_base.has_value() && ptr >= maybe_kernel_base.value()) {
-                if (kernel_elf) {
-                    symbol = kernel_elf->symbolicate(ptr - maybe_kernel_base.value(), &offset);
-                } else {
-                    symbol = String::formatted("?? <{:p}>", ptr);
-                }
-            } else {
-                auto it = current_processes.find(event.pid);
-                // FIXME: This logic is kinda gnarly, find a way to clean it up.
-                LibraryMetadata* library_metadata {};
-                if (it != current_processes.end())
-                    library_metadata = &it->value->library_metadata;
-                if (auto* library = library_metadata ? library_metadata->library_containing(ptr) : nullptr) {
-                    object_name = library->name;
-                    symbol = library->symbolicate(ptr, &offset);
-                } else {
-                    symbol = String::formatted("?? <{:p}>", ptr);
-                }
-            }
+        if (!stack || !stack->is_array())
+            return String { "Malformed profile (stack is not an array)" };
+        Vector<FlatPtr, 64> stack_addresses;
+        for (auto& frame : stack->as_array().values())
+            stack_addresses.append(frame.to_number<u64>());
+
+        auto frames = symbolicate(event.pid, stack_addresses);
+        add_event(move(event), move(frames));
+    }
+    return {};
+}
+
+Result<void, String> PerfcoreLoader::load_binary(ReadonlyBytes bytes)
+{
+    PerfcoreReader reader(bytes.slice(sizeof(Perfcore::magic)));
+    auto version = reader.read_u32();
+    if (version != Perfcore::version)
+        return String::formatted("Unsupported perfcore version {}", version);
+
+    Vector<String> strings;
+    auto string_at = [&](u64 index) {
+        return index < strings.size() ? strings[index] : String::empty();
+    };
 
-            event.frames.append({ object_name, symbol, (FlatPtr)ptr, offset });
+    struct Stack {
+        Vector<FlatPtr> addresses;
+        // Most samples hit a stack that was already seen, so the frames from last time can usually be reused.
+        Vector<Frame> frames;
+        pid_t frames_pid { 0 };
+        Optional<u32> frames_generation;
+    };
+    Vector<Stack> stacks;
+
+    u64 timestamp = 0;
+    while (!reader.is_eof()) {
+        auto record_type = static_cast<Perfcore::RecordType>(reader.read_u8());
+        switch (record_type) {
+        case Perfcore::RecordType::String:
+            strings.append(reader.read_string());
+            break;
+        case Perfcore::RecordType::Stack: {
+            Stack stack;
+            auto frame_count = reader.read_varint();
+            FlatPtr address = 0;
+            for (u64 i = 0; i < frame_count && !reader.has_error(); ++i) {
+                address += Perfcore::zigzag_decode(reader.read_varint());
+                stack.addresses.append(address);
+            }
+            stacks.append(move(stack));
+            break;
+        }
+        case Perfcore::RecordType::Event: {
+            Event event;
+            auto type = static_cast<int>(reader.read_varint());
+            event.pid = reader.read_varint();
+            event.tid = reader.read_varint();
+            timestamp += Perfcore::zigzag_decode(reader.read_varint());
+            event.timestamp = timestamp;
+            event.lost_samples = reader.read_varint();
+            auto stack_reference = reader.read_varint();
+
+            switch (type) {
+            case PERF_EVENT_SAMPLE:
+                event.data = Event::SampleData {};
+                break;
+            case PERF_EVENT_MALLOC:
+                event.data = Event::MallocData {
+                    .ptr = static_cast<FlatPtr>(reader.read_varint()),
+                    .size = static_cast<size_t>(reader.read_varint()),
+                };
+                break;
+            case PERF_EVENT_FREE:
+                event.data = Event::FreeData {
+                    .ptr = static_cast<FlatPtr>(reader.read_varint()),
+                };
+                break;
+            case PERF_EVENT_SIGNPOST: {
+                auto string_id = reader.read_varint();
+                event.data = Event::SignpostData {
+                    .string = string_id < strings.size() ? strings[string_id] : String::formatted("Signpost #{}", string_id),
+                    .arg = static_cast<FlatPtr>(reader.read_varint()),
+                };
+                break;
+            }
+            case PERF_EVENT_MMAP:
+                event.data = Event::MmapData {
+                    .ptr = static_cast<FlatPtr>(reader.read_varint()),
+                    .size = static_cast<size_t>(reader.read_varint()),
+                    .name = string_at(reader.read_varint()),
+                };
+                break;
+            case PERF_EVENT_MUNMAP:
+                event.data = Event::MunmapData {
+                    .ptr = static_cast<FlatPtr>(reader.read_varint()),
+                    .size = static_cast<size_t>(reader.read_varint()),
+                };
+                break;
+            case PERF_EVENT_PROCESS_CREATE:
+                event.data = Event::ProcessCreateData {
+                    .parent_pid = static_cast<pid_t>(reader.read_varint()),
+                    .executable = string_at(reader.read_varint()),
+                };
+                break;
+            case PERF_EVENT_PROCESS_EXEC:
+                event.data = Event::ProcessExecData {
+                    .executable = string_at(reader.read_varint()),
+                };
+                break;
+            case PERF_EVENT_THREAD_CREATE:
+                event.data = Event::ThreadCreateData {
+                    .parent_tid = static_cast<pid_t>(reader.read_varint()),
+                };
+                break;
+            }
+            if (reader.has_error())
+                break;
+
+            auto should_keep_event = handle_event(type, event);
+            if (should_keep_event.is_error())
+                return should_keep_event.release_error();
+            if (!should_keep_event.value() || !stack_reference)
+                break;
+
+            if (stack_reference > stacks.size())
+                return String { "Malformed profile (event refers to an unknown stack)" };
+            auto& stack = stacks[stack_reference - 1];
+            if (stack.frames_pid != event.pid || stack.frames_generation != m_symbolication_generation) {
+                stack.frames = symbolicate(event.pid, stack.addresses);
+                stack.frames_pid = event.pid;
+                stack.frames_generation = m_symbolication_generation;
+            }
+            add_event(move(event), stack.frames);
+            break;
+        }
+        default:
+            return String::formatted("Malformed profile (unknown record type {})", to_underlying(record_type));
         }
 
-        if (event.frames.size() < 2)
-            continue;
+        if (reader.has_error())
+            return String { "Malformed profile (truncated record)" };
+    }
+    return {};
+}
 
-        FlatPtr innermost_frame_address = event.frames.at(1).address;
-        event.in_kernel = maybe_kernel_base.has_value() && innermost_frame_address >= maybe_kernel_base.value();
+}
 
-        events.append(move(event));
+Result<NonnullOwnPtr<Profile>, String> Profile::load_from_perfcore_file(const StringView& path)
+{
+    // Perfcores on disk are mapped instead of read, but files in /proc can't be mapped, so those are read as usual.
+    RefPtr<MappedFile> mapped_file;
+    ByteBuffer file_contents;
+    ReadonlyBytes bytes;
+    if (auto mapped_file_or_error = MappedFile::map(path); !mapped_file_or_error.is_error() && mapped_file_or_error.value()->size()) {
+        mapped_file = mapped_file_or_error.release_value();
+        bytes = mapped_file->bytes();
+    } else {
+        auto file = Core::File::construct(path);
+        if (!file->open(Core::OpenMode::ReadOnly))
+            return String::formatted("Unable to open {}, error: {}", path, file->error_string());
+        file_contents = file->read_all();
+        bytes = file_contents;
     }
 
+    PerfcoreLoader loader;
+    bool is_binary = bytes.size() >= sizeof(Perfcore::magic) && !memcmp(bytes.data(), Perfcore::magic, sizeof(Perfcore::magic));
+    auto result = is_binary ? loader.load_binary(bytes) : loader.load_json(bytes);
+    if (result.is_error())
+        return result.release_error();
+
+    auto events = loader.take_events();
     if (events.is_empty())
         return String { "No events captured (targeted process was never on CPU)" };
 
-    quick_sort(all_processes, [](auto& a, auto& b) {
-        if (a.pid == b.pid)
-            return a.start_valid < b.start_valid;
-        else
-            return a.pid < b.pid;
-    });
-
-    Vector<Process> processes;
-    for (auto& it : all_processes)
-        processes.append(move(it));
-
-    return adopt_own(*new Profile(move(processes), move(events)));
+    return adopt_own(*new Profile(loader.take_processes(), move(events)));
 }
 
 void ProfileNode::sort_children()
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "BasicBlockCache.h"
+#include "SoftCPU.h"
+#include "SoftMMU.h"
+
+namespace UserspaceEmulator {
+
+static constexpr size_t max_instructions_per_block = 64;
+static constexpr size_t user_page_count = 0xc0000000 / PAGE_SIZE;
+
+static bool ends_basic_block(X86::Instruction const& insn)
+{
+    if (insn.has_sub_op()) {
+        auto sub_op = insn.sub_op();
+        // Jcc rel32, SYSCALL, SYSENTER, UD2
+        return (sub_op >= 0x80 && sub_op <= 0x8f) || sub_op == 0x05 || sub_op == 0x34 || sub_op == 0x0b;
+    }
+
+    auto op = insn.op();
+    if (op >= 0x70 && op <= 0x7f)
+        return true;
+    switch (op) {
+    case 0x9a: // CALL far
+    case 0xc2: // RET imm16
+    case 0xc3: // RET
+    case 0xca: // RETF imm16
+    case 0xcb: // RETF
+    case 0xcc: // INT3
+    case 0xcd: // INT imm8
+    case 0xce: // INTO
+    case 0xcf: // IRET
+    case 0xe0: // LOOPNZ
+    case 0xe1: // LOOPZ
+    case 0xe2: // LOOP
+    case 0xe3: // JCXZ
+    case 0xe8: // CALL rel
+    case 0xe9: // JMP rel
+    case 0xea: // JMP far
+    case 0xeb: // JMP rel8
+    case 0xf4: // HLT
+        return true;
+    case 0xff:
+        // CALL, CALL far, JMP, JMP far
+        return insn.slash() >= 2 && insn.slash() <= 5;
+    default:
+        return false;
+    }
+}
+
+BasicBlockCache::BasicBlockCache(SoftMMU& mmu)
+    : m_mmu(mmu)
+    , m_pages_with_code(user_page_count, false)
+{
+}
+
+CachedInstruction const& BasicBlockCache::next_instruction(SoftCPU& cpu)
+{
+    // Instructions don't have to be looked up while execution falls through the current block.
+    // Anything else (taken branches, signals, the REPL moving EIP) ends up in a lookup by EIP.
+    if (!m_current_block || m_current_index == m_current_block->instructions.size() || cpu.eip() != m_expected_eip) [[unlikely]] {
+        m_retired_blocks.clear();
+        m_current_block = &find_or_create_block(cpu);
+        m_current_index = 0;
+    }
+
+    auto& cached = m_current_block->instructions[m_current_index++];
+    m_expected_eip = cached.next_eip;
+    cpu.set_eip(cached.next_eip);
+    return cached;
+}
+
+BasicBlock& BasicBlockCache::find_or_create_block(SoftCPU& cpu)
+{
+    auto eip = cpu.eip();
+    if (auto it = m_blocks.find(eip); it != m_blocks.end())
+        return *it->value;
+
+    auto block = make<BasicBlock>();
+    block->start_eip = eip;
+
+    // Blocks never continue into another region, since the code there may be unmapped or changed independently.
+    u32 region_end = 0;
+    if (auto* region = m_mmu.find_region({ cpu.cs(), eip }))
+        region_end = region->end();
+
+    while (true) {
+        auto insn = X86::Instruction::from_stream(cpu, true, true);
+        auto next_eip = cpu.eip();
+        // An invalid instruction is only decoded to fail when executing it, so don't let it end up in the middle of a block.
+        if (!insn.is_valid() && !block->instructions.is_empty())
+            break;
+        bool is_last = !insn.is_valid() || ends_basic_block(insn)
+            || block->instructions.size() + 1 == max_instructions_per_block || next_eip >= region_end;
+        auto handler = insn.is_valid() ? insn.handler() : nullptr;
+        block->instructions.append({ move(insn), handler, next_eip });
+        block->end_eip = next_eip;
+        if (is_last)
+            break;
+    }
+    cpu.set_eip(eip);
+
+    for (u32 page = block->start_eip / PAGE_SIZE; page <= (block->end_eip - 1) / PAGE_SIZE && page < user_page_count; ++page)
+        m_pages_with_code.set(page, true);
+
+    auto& result = *block;
+    m_blocks.set(eip, move(block));
+    return result;
+}
+
+void BasicBlockCache::invalidate(u32 base, u32 size)
+{
+    u32 end = base + size;
+    Vector<u32> invalidated_eips;
+    for (auto& it : m_blocks) {
+        if (it.value->start_eip < end && it.value->end_eip > base)
+            invalidated_eips.append(it.key);
+    }
+    for (auto eip : invalidated_eips) {
+        auto it = m_blocks.find(eip);
+        m_retired_blocks.append(it->value.release_nonnull());
+        m_blocks.remove(it);
+    }
+
+    // Every block that touched a page in the range is gone now, so pages that are entirely in the range have no code left.
+    for (u32 page = ceil_div(base, PAGE_SIZE); page < end / PAGE_SIZE && page < user_page_count; ++page)
+        m_pages_with_code.set(page, false);
+
+    m_current_block = nullptr;
+}
+
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Bitmap.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibX86/Instruction.h>
+
+namespace UserspaceEmulator {
+
+class SoftCPU;
+class SoftMMU;
+
+struct CachedInstruction {
+    X86::Instruction instruction;
+    X86::InstructionHandler handler { nullptr };
+    u32 next_eip { 0 };
+};
+
+// A run of instructions up to the next branch, decoded once and then executed straight from the cache.
+struct BasicBlock {
+    u32 start_eip { 0 };
+    u32 end_eip { 0 };
+    Vector<CachedInstruction> instructions;
+};
+
+class BasicBlockCache {
+public:
+    explicit BasicBlockCache(SoftMMU&);
+
+    // Returns the instruction at the CPU's EIP and moves EIP past it, just like decoding it with X86::Instruction::from_stream() would.
+    CachedInstruction const& next_instruction(SoftCPU&);
+
+    // Drops all blocks with code in the given range. Must be called whenever that code may have changed.
+    void invalidate(u32 base, u32 size);
+
+    ALWAYS_INLINE void did_write(u32 address, u32 size)
+    {
+        for (u32 page = address / PAGE_SIZE; page <= (address + size - 1) / PAGE_SIZE; ++page) {
+            if (m_pages_with_code.get(page)) [[unlikely]] {
+                invalidate(address, size);
+                return;
+            }
+        }
+    }
+
+private:
+    BasicBlock& find_or_create_block(SoftCPU&);
+
+    SoftMMU& m_mmu;
+
+    HashMap<u32, OwnPtr<BasicBlock>> m_blocks;
+    Bitmap m_pages_with_code;
+
+    BasicBlock* m_current_block { nullptr };
+    size_t m_current_index { 0 };
+    u32 m_expected_eip { 0 };
+
+    // The instruction that is executing may write over its own block, so invalidated blocks live until the next lookup.
+    NonnullOwnPtrVector<BasicBlock> m_retired_blocks;
+};
+
+}
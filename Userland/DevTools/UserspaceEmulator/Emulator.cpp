@@ -46,6 +46,7 @@ Emulator::Emulator(String const& executable_path, Vector<String> const& argument
     , m_environment(environment)
     , m_mmu(*this)
     , m_cpu(*this)
+    , m_basic_block_cache(m_mmu)
     , m_editor(Line::Editor::construct())
 {
     m_malloc_tracer = make<MallocTracer>(*this);
@@ -226,13 +227,14 @@ int Emulator::exec()
     while (!m_shutdown) {
         if (m_steps_til_pause) [[likely]] {
             m_cpu.save_base_eip();
-            auto insn = X86::Instruction::from_stream(m_cpu, true, true);
+            auto& cached = m_basic_block_cache.next_instruction(m_cpu);
+            auto& insn = cached.instruction;
             // Exec cycle
             if constexpr (trace) {
                 outln("{:p}  \033[33;1m{}\033[0m", m_cpu.base_eip(), insn.to_string(m_cpu.base_eip(), symbol_provider));
             }
 
-            (m_cpu.*insn.handler())(insn);
+            (m_cpu.*cached.handler)(insn);
 
             if (is_profiling()) {
                 if (instructions_until_next_profile_dump == 0) {
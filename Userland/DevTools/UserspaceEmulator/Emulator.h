@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "BasicBlockCache.h"
 #include "MallocTracer.h"
 #include "RangeAllocator.h"
 #include "Report.h"
@@ -61,6 +62,7 @@ public:
     u32 virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3);
 
     SoftMMU& mmu() { return m_mmu; }
+    BasicBlockCache& basic_block_cache() { return m_basic_block_cache; }
 
     MallocTracer* malloc_tracer() { return m_malloc_tracer; }
 
@@ -113,6 +115,7 @@ private:
 
     SoftMMU m_mmu;
     SoftCPU m_cpu;
+    BasicBlockCache m_basic_block_cache;
 
     OwnPtr<MallocTracer> m_malloc_tracer;
 
@@ -192,11 +195,15 @@ private:
     int virt$getsockname(FlatPtr);
     int virt$getpeername(FlatPtr);
     int virt$select(FlatPtr);
+    int virt$epoll_create(u32 flags);
+    int virt$epoll_ctl(FlatPtr);
+    int virt$epoll_wait(FlatPtr);
     int virt$get_stack_bounds(FlatPtr, FlatPtr);
     int virt$accept4(FlatPtr);
     int virt$bind(int sockfd, FlatPtr address, socklen_t address_length);
     int virt$recvmsg(int sockfd, FlatPtr msg_addr, int flags);
     int virt$sendmsg(int sockfd, FlatPtr msg_addr, int flags);
+    int virt$sendfile(FlatPtr);
     int virt$connect(int sockfd, FlatPtr address, socklen_t address_size);
     int virt$shutdown(int sockfd, int how);
     void virt$sync();
@@ -305,6 +305,31 @@ void MallocTracer::audit_write(const Region& region, FlatPtr address, size_t siz
     }
 }
 
+Optional<FlatPtr> MallocTracer::find_first_unusable_address(const Region& region, FlatPtr address, size_t size)
+{
+    // Step from one mallocation to the next instead of checking each byte.
+    auto end = address + size;
+    while (address < end) {
+        auto* mallocation = find_mallocation(region, address);
+        if (!mallocation || mallocation->freed)
+            return address;
+        address = mallocation->address + mallocation->size;
+    }
+    return {};
+}
+
+void MallocTracer::audit_read_range(const Region& region, FlatPtr address, size_t size)
+{
+    if (auto bad_address = find_first_unusable_address(region, address, size); bad_address.has_value())
+        audit_read(region, bad_address.value(), address + size - bad_address.value());
+}
+
+void MallocTracer::audit_write_range(const Region& region, FlatPtr address, size_t size)
+{
+    if (auto bad_address = find_first_unusable_address(region, address, size); bad_address.has_value())
+        audit_write(region, bad_address.value(), address + size - bad_address.value());
+}
+
 void MallocTracer::populate_memory_graph()
 {
     // Create Node for each live Mallocation
@@ -10,6 +10,7 @@
 #include "SoftMMU.h"
 #include <AK/Badge.h>
 #include <AK/HashMap.h>
+#include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
@@ -66,6 +67,10 @@ public:
     void audit_read(const Region&, FlatPtr address, size_t);
     void audit_write(const Region&, FlatPtr address, size_t);
 
+    // Audit every byte in a range, reporting only the first bad address.
+    void audit_read_range(const Region&, FlatPtr address, size_t);
+    void audit_write_range(const Region&, FlatPtr address, size_t);
+
     void dump_leak_report();
 
 private:
@@ -76,6 +81,7 @@ private:
     Mallocation* find_mallocation(FlatPtr);
     Mallocation* find_mallocation_before(FlatPtr);
     Mallocation* find_mallocation_after(FlatPtr);
+    Optional<FlatPtr> find_first_unusable_address(const Region&, FlatPtr address, size_t);
 
     void dump_memory_graph();
     void populate_memory_graph();
@@ -102,7 +102,6 @@ void SoftCPU::update_code_cache()
         TODO();
     }
 
-    // FIXME: This cache needs to be invalidated if the code region is ever unmapped.
     m_cached_code_region = region;
     m_cached_code_base_ptr = region->data();
 }
@@ -1933,18 +1932,56 @@ ALWAYS_INLINE static void do_movs(SoftCPU& cpu, const X86::Instruction& insn)
     });
 }
 
+bool SoftCPU::fast_movs(const X86::Instruction& insn, size_t element_size)
+{
+    if (!insn.has_rep_prefix() || df())
+        return false;
+
+    // Fast path for forward memory copies.
+    auto src_segment = segment(insn.segment_prefix().value_or(X86::SegmentRegister::DS));
+    u64 source = source_index(insn.a32()).value();
+    u64 destination = destination_index(insn.a32()).value();
+    u64 size = (u64)loop_index(insn.a32()).value() * element_size;
+
+    // The index registers wrap around at the end of the address space, a single copy doesn't.
+    // Leave copies that reach the end (and with that, counts too large to make sense) to the element-by-element path.
+    u64 address_space_size = insn.a32() ? 0x1'0000'0000ull : 0x1'0000ull;
+    if (source + size >= address_space_size || destination + size >= address_space_size)
+        return false;
+
+    if (!m_emulator.mmu().fast_copy_memory({ es(), (u32)destination }, { src_segment, (u32)source }, size))
+        return false;
+
+    if (insn.a32()) {
+        set_esi({ (u32)(source + size), esi().shadow() });
+        set_edi({ (u32)(destination + size), edi().shadow() });
+        set_ecx(shadow_wrap_as_initialized<u32>(0));
+    } else {
+        set_si({ (u16)(source + size), si().shadow() });
+        set_di({ (u16)(destination + size), di().shadow() });
+        set_cx(shadow_wrap_as_initialized<u16>(0));
+    }
+    return true;
+}
+
 void SoftCPU::MOVSB(const X86::Instruction& insn)
 {
+    if (fast_movs(insn, sizeof(u8)))
+        return;
     do_movs<u8>(*this, insn);
 }
 
 void SoftCPU::MOVSD(const X86::Instruction& insn)
 {
+    if (fast_movs(insn, sizeof(u32)))
+        return;
     do_movs<u32>(*this, insn);
 }
 
 void SoftCPU::MOVSW(const X86::Instruction& insn)
 {
+    if (fast_movs(insn, sizeof(u16)))
+        return;
     do_movs<u16>(*this, insn);
 }
 
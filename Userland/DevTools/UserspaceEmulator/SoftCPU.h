@@ -58,6 +58,13 @@ public:
         m_eip = eip;
     }
 
+    // Must be called when the region that code is being read from may have been unmapped or made non-executable.
+    void invalidate_code_cache()
+    {
+        m_cached_code_region = nullptr;
+        m_cached_code_base_ptr = nullptr;
+    }
+
     struct Flags {
         enum Flag {
             CF = 0x0001, // 0b0000'0000'0000'0001
@@ -1169,6 +1176,8 @@ private:
 
     void update_code_cache();
 
+    bool fast_movs(const X86::Instruction&, size_t element_size);
+
 private:
     Emulator& m_emulator;
     SoftFPU m_fpu;
@@ -26,7 +26,7 @@ void SoftMMU::add_region(NonnullOwnPtr<Region> region)
     size_t first_page_in_region = region->base() / PAGE_SIZE;
     size_t last_page_in_region = (region->base() + region->size() - 1) / PAGE_SIZE;
     for (size_t page = first_page_in_region; page <= last_page_in_region; ++page) {
-        m_page_to_region_map[page] = region.ptr();
+        set_region_for_page(page, region.ptr());
     }
 
     m_regions.append(move(region));
@@ -37,7 +37,7 @@ void SoftMMU::remove_region(Region& region)
 {
     size_t first_page_in_region = region.base() / PAGE_SIZE;
     for (size_t i = 0; i < ceil_div(region.size(), PAGE_SIZE); ++i) {
-        m_page_to_region_map[first_page_in_region + i] = nullptr;
+        set_region_for_page(first_page_in_region + i, nullptr);
     }
 
     m_regions.remove_first_matching([&](auto& entry) { return entry.ptr() == &region; });
@@ -54,14 +54,14 @@ void SoftMMU::ensure_split_at(X86::LogicalAddress address)
 
     if (!page_index)
         return;
-    if (m_page_to_region_map[page_index - 1] != m_page_to_region_map[page_index])
+    if (region_for_page(page_index - 1) != region_for_page(page_index))
         return;
-    if (!m_page_to_region_map[page_index])
+    if (!region_for_page(page_index))
         return;
 
     // If we get here, we know that the page exists and belongs to a region, that there is
     // a previous page, and that it belongs to the same region.
-    auto* old_region = verify_cast<MmapRegion>(m_page_to_region_map[page_index]);
+    auto* old_region = verify_cast<MmapRegion>(region_for_page(page_index));
 
     //dbgln("splitting at {:p}", address.offset());
     //dbgln("    old region: {:p}-{:p}", old_region->base(), old_region->end() - 1);
@@ -76,14 +76,25 @@ void SoftMMU::ensure_split_at(X86::LogicalAddress address)
     //dbgln("  @ remapping pages {} thru {}", first_page_in_region, last_page_in_region);
 
     for (size_t page = first_page_in_region; page <= last_page_in_region; ++page) {
-        VERIFY(m_page_to_region_map[page] == old_region);
-        m_page_to_region_map[page] = new_region.ptr();
+        VERIFY(region_for_page(page) == old_region);
+        set_region_for_page(page, new_region.ptr());
     }
 
     m_regions.append(move(new_region));
     quick_sort((Vector<OwnPtr<Region>>&)m_regions, [](auto& a, auto& b) { return a->base() < b->base(); });
 }
 
+void SoftMMU::set_region_for_page(size_t page, Region* region)
+{
+    auto& table = m_page_directory[page / pages_per_table];
+    if (!table) {
+        if (!region)
+            return;
+        table = make<PageTable>();
+    }
+    table->regions[page % pages_per_table] = region;
+}
+
 void SoftMMU::set_tls_region(NonnullOwnPtr<Region> region)
 {
     VERIFY(!m_tls_region);
@@ -213,6 +224,7 @@ void SoftMMU::write8(X86::LogicalAddress address, ValueWithShadow<u8> value)
         TODO();
     }
     region->write8(address.offset() - region->base(), value);
+    m_emulator.basic_block_cache().did_write(address.offset(), 1);
 }
 
 void SoftMMU::write16(X86::LogicalAddress address, ValueWithShadow<u16> value)
@@ -231,6 +243,7 @@ void SoftMMU::write16(X86::LogicalAddress address, ValueWithShadow<u16> value)
     }
 
     region->write16(address.offset() - region->base(), value);
+    m_emulator.basic_block_cache().did_write(address.offset(), 2);
 }
 
 void SoftMMU::write32(X86::LogicalAddress address, ValueWithShadow<u32> value)
@@ -249,6 +262,7 @@ void SoftMMU::write32(X86::LogicalAddress address, ValueWithShadow<u32> value)
     }
 
     region->write32(address.offset() - region->base(), value);
+    m_emulator.basic_block_cache().did_write(address.offset(), 4);
 }
 
 void SoftMMU::write64(X86::LogicalAddress address, ValueWithShadow<u64> value)
@@ -267,6 +281,7 @@ void SoftMMU::write64(X86::LogicalAddress address, ValueWithShadow<u64> value)
     }
 
     region->write64(address.offset() - region->base(), value);
+    m_emulator.basic_block_cache().did_write(address.offset(), 8);
 }
 
 void SoftMMU::write128(X86::LogicalAddress address, ValueWithShadow<u128> value)
@@ -285,6 +300,7 @@ void SoftMMU::write128(X86::LogicalAddress address, ValueWithShadow<u128> value)
     }
 
     region->write128(address.offset() - region->base(), value);
+    m_emulator.basic_block_cache().did_write(address.offset(), 16);
 }
 
 void SoftMMU::write256(X86::LogicalAddress address, ValueWithShadow<u256> value)
@@ -303,6 +319,7 @@ void SoftMMU::write256(X86::LogicalAddress address, ValueWithShadow<u256> value)
     }
 
     region->write256(address.offset() - region->base(), value);
+    m_emulator.basic_block_cache().did_write(address.offset(), 32);
 }
 
 void SoftMMU::copy_to_vm(FlatPtr destination, const void* source, size_t size)
@@ -337,17 +354,14 @@ bool SoftMMU::fast_fill_memory8(X86::LogicalAddress address, size_t size, ValueW
         return false;
 
     if (is<MmapRegion>(*region) && static_cast<const MmapRegion&>(*region).is_malloc_block()) {
-        if (auto* tracer = m_emulator.malloc_tracer()) {
-            // FIXME: Add a way to audit an entire range of memory instead of looping here!
-            for (size_t i = 0; i < size; ++i) {
-                tracer->audit_write(*region, address.offset() + (i * sizeof(u8)), sizeof(u8));
-            }
-        }
+        if (auto* tracer = m_emulator.malloc_tracer())
+            tracer->audit_write_range(*region, address.offset(), size);
     }
 
     size_t offset_in_region = address.offset() - region->base();
     memset(region->data() + offset_in_region, value.value(), size);
     memset(region->shadow_data() + offset_in_region, value.shadow(), size);
+    m_emulator.basic_block_cache().did_write(address.offset(), size);
     return true;
 }
 
@@ -362,17 +376,46 @@ bool SoftMMU::fast_fill_memory32(X86::LogicalAddress address, size_t count, Valu
         return false;
 
     if (is<MmapRegion>(*region) && static_cast<const MmapRegion&>(*region).is_malloc_block()) {
-        if (auto* tracer = m_emulator.malloc_tracer()) {
-            // FIXME: Add a way to audit an entire range of memory instead of looping here!
-            for (size_t i = 0; i < count; ++i) {
-                tracer->audit_write(*region, address.offset() + (i * sizeof(u32)), sizeof(u32));
-            }
-        }
+        if (auto* tracer = m_emulator.malloc_tracer())
+            tracer->audit_write_range(*region, address.offset(), count * sizeof(u32));
     }
 
     size_t offset_in_region = address.offset() - region->base();
     fast_u32_fill((u32*)(region->data() + offset_in_region), value.value(), count);
     fast_u32_fill((u32*)(region->shadow_data() + offset_in_region), value.shadow(), count);
+    m_emulator.basic_block_cache().did_write(address.offset(), count * sizeof(u32));
+    return true;
+}
+
+bool SoftMMU::fast_copy_memory(X86::LogicalAddress destination, X86::LogicalAddress source, size_t size)
+{
+    if (!size)
+        return true;
+    auto* destination_region = find_region(destination);
+    auto* source_region = find_region(source);
+    if (!destination_region || !source_region)
+        return false;
+    if (!destination_region->contains(destination.offset() + size - 1) || !source_region->contains(source.offset() + size - 1))
+        return false;
+    if (!destination_region->is_writable() || !source_region->is_readable())
+        return false;
+
+    // A forward element-by-element copy only matches memmove() if the destination doesn't start inside the source.
+    if (destination_region == source_region && destination.offset() > source.offset() && destination.offset() < source.offset() + size)
+        return false;
+
+    if (auto* tracer = m_emulator.malloc_tracer()) {
+        if (is<MmapRegion>(*source_region) && static_cast<const MmapRegion&>(*source_region).is_malloc_block())
+            tracer->audit_read_range(*source_region, source.offset(), size);
+        if (is<MmapRegion>(*destination_region) && static_cast<const MmapRegion&>(*destination_region).is_malloc_block())
+            tracer->audit_write_range(*destination_region, destination.offset(), size);
+    }
+
+    size_t source_offset = source.offset() - source_region->base();
+    size_t destination_offset = destination.offset() - destination_region->base();
+    memmove(destination_region->data() + destination_offset, source_region->data() + source_offset, size);
+    memmove(destination_region->shadow_data() + destination_offset, source_region->shadow_data() + source_offset, size);
+    m_emulator.basic_block_cache().did_write(destination.offset(), size);
     return true;
 }
 
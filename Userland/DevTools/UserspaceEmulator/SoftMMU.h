@@ -8,6 +8,7 @@
 
 #include "Region.h"
 #include "ValueWithShadow.h"
+#include <AK/Array.h>
 #include <AK/HashMap.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/OwnPtr.h>
@@ -41,8 +42,7 @@ public:
         if (address.selector() == 0x2b)
             return m_tls_region.ptr();
 
-        size_t page_index = address.offset() / PAGE_SIZE;
-        return m_page_to_region_map[page_index];
+        return region_for_page(address.offset() / PAGE_SIZE);
     }
 
     void add_region(NonnullOwnPtr<Region>);
@@ -53,6 +53,7 @@ public:
 
     bool fast_fill_memory8(X86::LogicalAddress, size_t size, ValueWithShadow<u8>);
     bool fast_fill_memory32(X86::LogicalAddress, size_t size, ValueWithShadow<u32>);
+    bool fast_copy_memory(X86::LogicalAddress destination, X86::LogicalAddress source, size_t size);
 
     void copy_to_vm(FlatPtr destination, const void* source, size_t);
     void copy_from_vm(void* destination, const FlatPtr source, size_t);
@@ -94,7 +95,7 @@ public:
         size_t last_page = (address_end.offset() - 1) / PAGE_SIZE;
         Region* last_reported = nullptr;
         for (size_t page = first_page; page <= last_page; ++page) {
-            Region* current_region = m_page_to_region_map[page];
+            Region* current_region = region_for_page(page);
             if (page != first_page && current_region == last_reported)
                 continue;
             if (callback(current_region) == IterationDecision::Break)
@@ -104,9 +105,27 @@ public:
     }
 
 private:
+    // Regions are found through a two-level table, like the one the CPU uses. That way the whole address space
+    // is covered, but tables only have to be allocated for the parts of it that are actually mapped.
+    static constexpr size_t pages_per_table = 1024;
+    static constexpr size_t table_count = 1024;
+
+    struct PageTable {
+        Region* regions[pages_per_table] {};
+    };
+
+    ALWAYS_INLINE Region* region_for_page(size_t page) const
+    {
+        auto* table = m_page_directory[page / pages_per_table].ptr();
+        if (!table)
+            return nullptr;
+        return table->regions[page % pages_per_table];
+    }
+    void set_region_for_page(size_t page, Region*);
+
     Emulator& m_emulator;
 
-    Region* m_page_to_region_map[786432] = { nullptr };
+    Array<OwnPtr<PageTable>, table_count> m_page_directory;
 
     OwnPtr<Region> m_tls_region;
     NonnullOwnPtrVector<Region> m_regions;
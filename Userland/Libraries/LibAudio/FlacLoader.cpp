@@ -6,12 +6,14 @@
 
 #include "FlacLoader.h"
 #include "Buffer.h"
+#include <AK/Array.h>
 #include <AK/BitStream.h>
 #include <AK/Debug.h>
 #include <AK/FlyString.h>
 #include <AK/Format.h>
 #include <AK/Math.h>
 #include <AK/ScopeGuard.h>
+#include <AK/SIMD.h>
 #include <AK/Stream.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
@@ -58,6 +60,23 @@ FlacLoaderPlugin::FlacLoaderPlugin(const ByteBuffer& buffer)
         return;
 }
 
+FlacLoaderPlugin::FlacLoaderPlugin(FlacLoaderPlugin const& stream, ReadonlyBytes frames, u64 first_sample_index)
+    : m_valid(true)
+    , m_sample_rate(stream.m_sample_rate)
+    , m_num_channels(stream.m_num_channels)
+    , m_sample_format(stream.m_sample_format)
+    , m_min_block_size(stream.m_min_block_size)
+    , m_max_block_size(stream.m_max_block_size)
+    , m_min_frame_size(stream.m_min_frame_size)
+    , m_max_frame_size(stream.m_max_frame_size)
+    , m_total_samples(stream.m_total_samples)
+    , m_loaded_samples(first_sample_index)
+    , m_stream(make<FlacInputStream>(InputMemoryStream(frames)))
+    , m_current_frame_start { first_sample_index, 0 }
+{
+    memcpy(m_md5_checksum, stream.m_md5_checksum, sizeof(m_md5_checksum));
+}
+
 bool FlacLoaderPlugin::sniff()
 {
     return m_valid;
@@ -141,8 +160,7 @@ bool FlacLoaderPlugin::parse_header()
     md5_checksum.bytes().copy_to({ m_md5_checksum, sizeof(m_md5_checksum) });
 
     // Parse other blocks
-    // TODO: For a simple first implementation, all other blocks are skipped as allowed by the FLAC specification.
-    // Especially the SEEKTABLE block may become useful in a more sophisticated version.
+    // Apart from the SEEKTABLE, all other blocks are skipped as allowed by the FLAC specification.
     [[maybe_unused]] u16 meta_blocks_parsed = 1;
     [[maybe_unused]] u16 total_meta_blocks = meta_blocks_parsed;
     FlacRawMetadataBlock block = streaminfo;
@@ -151,6 +169,11 @@ bool FlacLoaderPlugin::parse_header()
         ++total_meta_blocks;
         ok = ok && m_error_string.is_empty();
         CHECK_OK(m_error_string);
+        if (block.type == FlacMetadataBlockType::SEEKTABLE) {
+            ok = ok && parse_seektable(block);
+            CHECK_OK("Seektable");
+            ++meta_blocks_parsed;
+        }
     }
 
     if (m_stream->handle_any_error()) {
@@ -171,6 +194,34 @@ bool FlacLoaderPlugin::parse_header()
 #undef CHECK_OK
 }
 
+bool FlacLoaderPlugin::parse_seektable(FlacRawMetadataBlock const& block)
+{
+    // Every seek point is a 64-bit sample index, a 64-bit byte offset and the 16-bit sample count of the frame there.
+    constexpr size_t seek_point_size = 18;
+    if (block.data.size() % seek_point_size != 0)
+        return false;
+
+    InputMemoryStream seektable_memory(block.data.bytes());
+    InputBitStream seektable_data(seektable_memory);
+    ScopeGuard clear_seektable_errors([&seektable_data] { seektable_data.handle_any_error(); });
+
+    m_seek_points.ensure_capacity(block.data.size() / seek_point_size);
+    for (size_t i = 0; i < block.data.size() / seek_point_size; ++i) {
+        u64 sample_index = seektable_data.read_bits_big_endian(64);
+        u64 byte_offset = seektable_data.read_bits_big_endian(64);
+        [[maybe_unused]] u16 sample_count = seektable_data.read_bits_big_endian(16);
+        // Placeholders come last, and the other seek points have to be in ascending order.
+        if (sample_index == NumericLimits<u64>::max())
+            continue;
+        if (!m_seek_points.is_empty() && m_seek_points.last().sample_index >= sample_index)
+            return false;
+        m_seek_points.unchecked_append({ sample_index, byte_offset });
+    }
+
+    dbgln_if(AFLACLOADER_DEBUG, "Seektable with {} seek points", m_seek_points.size());
+    return !seektable_data.handle_any_error();
+}
+
 FlacRawMetadataBlock FlacLoaderPlugin::next_meta_block(InputBitStream& bit_input)
 {
 #define CHECK_IO_ERROR()                    \
@@ -212,16 +263,103 @@ FlacRawMetadataBlock FlacLoaderPlugin::next_meta_block(InputBitStream& bit_input
 
 void FlacLoaderPlugin::reset()
 {
-    seek(m_data_start_location);
-    m_current_frame.clear();
+    seek_to_frame({ 0, 0 });
 }
 
-void FlacLoaderPlugin::seek(const int position)
+void FlacLoaderPlugin::seek(const int sample_index)
 {
-    if (!m_stream->seek(position)) {
-        m_error_string = String::formatted("Invalid seek position {}", position);
+    if (sample_index < 0 || static_cast<u64>(sample_index) >= m_total_samples)
+        return;
+
+    auto seek_point = seek_point_before(sample_index);
+    // Just keep decoding if that gets us there quicker than starting over at the seek point.
+    if (m_loaded_samples > static_cast<u64>(sample_index) || m_loaded_samples < seek_point.sample_index) {
+        if (!seek_to_frame(seek_point))
+            return;
+    }
+    skip_samples(sample_index - m_loaded_samples);
+}
+
+size_t FlacLoaderPlugin::first_seek_point_after(u64 sample_index) const
+{
+    size_t low = 0;
+    size_t high = m_seek_points.size();
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (m_seek_points[middle].sample_index <= sample_index)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+FlacSeekPoint FlacLoaderPlugin::seek_point_before(u64 sample_index) const
+{
+    auto index = first_seek_point_after(sample_index);
+    if (index == 0)
+        return { 0, 0 };
+    return m_seek_points[index - 1];
+}
+
+void FlacLoaderPlugin::add_seek_point(FlacSeekPoint seek_point)
+{
+    // Seek points that we find ourselves don't need to be closer than a second apart.
+    u64 minimum_distance = max(m_sample_rate, 1u);
+    if (seek_point.sample_index < minimum_distance)
+        return;
+
+    auto index = first_seek_point_after(seek_point.sample_index);
+    if (index > 0 && seek_point.sample_index - m_seek_points[index - 1].sample_index < minimum_distance)
+        return;
+    if (index < m_seek_points.size() && m_seek_points[index].sample_index - seek_point.sample_index < minimum_distance)
+        return;
+    m_seek_points.insert(index, seek_point);
+}
+
+Optional<u64> FlacLoaderPlugin::stream_position()
+{
+    if (m_file) {
+        off_t position;
+        if (!m_file->seek(0, Core::SeekMode::FromCurrentPosition, &position))
+            return {};
+        return position;
+    }
+    return m_stream->get<InputMemoryStream>().offset();
+}
+
+bool FlacLoaderPlugin::seek_to_frame(FlacSeekPoint seek_point)
+{
+    if (!m_stream->seek(m_data_start_location + seek_point.byte_offset)) {
+        m_error_string = String::formatted("Invalid seek position {}", m_data_start_location + seek_point.byte_offset);
         m_valid = false;
+        return false;
     }
+    m_loaded_samples = seek_point.sample_index;
+    m_current_frame.clear();
+    m_current_frame_data.clear_with_capacity();
+    m_current_frame_position = 0;
+    return true;
+}
+
+bool FlacLoaderPlugin::skip_samples(u64 sample_count)
+{
+    while (sample_count > 0) {
+        if (!m_current_frame.has_value()) {
+            next_frame();
+            if (!m_error_string.is_empty()) {
+                m_error_string = String::formatted("Frame parsing error: {}", m_error_string);
+                return false;
+            }
+        }
+        auto samples_to_skip = min(sample_count, m_current_frame_data.size() - m_current_frame_position);
+        m_current_frame_position += samples_to_skip;
+        m_loaded_samples += samples_to_skip;
+        sample_count -= samples_to_skip;
+        if (m_current_frame_position == m_current_frame_data.size())
+            m_current_frame.clear();
+    }
+    return true;
 }
 
 RefPtr<Buffer> FlacLoaderPlugin::get_more_samples(size_t max_bytes_to_read_from_input)
@@ -233,7 +371,8 @@ RefPtr<Buffer> FlacLoaderPlugin::get_more_samples(size_t max_bytes_to_read_from_
     }
 
     size_t samples_to_read = min(max_bytes_to_read_from_input, remaining_samples);
-    while (samples_to_read > 0) {
+    samples.ensure_capacity(samples_to_read);
+    while (samples.size() < samples_to_read) {
         if (!m_current_frame.has_value()) {
             next_frame();
             if (!m_error_string.is_empty()) {
@@ -241,19 +380,144 @@ RefPtr<Buffer> FlacLoaderPlugin::get_more_samples(size_t max_bytes_to_read_from_
                 return nullptr;
             }
         }
-        samples.append(m_current_frame_data.take_first());
-        if (m_current_frame_data.size() == 0) {
+        auto samples_from_frame = min(samples_to_read - samples.size(), m_current_frame_data.size() - m_current_frame_position);
+        samples.append(m_current_frame_data.data() + m_current_frame_position, samples_from_frame);
+        m_current_frame_position += samples_from_frame;
+        m_loaded_samples += samples_from_frame;
+        if (m_current_frame_position == m_current_frame_data.size())
             m_current_frame.clear();
+    }
+
+    return Buffer::create_with_samples(move(samples));
+}
+
+RefPtr<Buffer> FlacLoaderPlugin::get_more_samples_in_parallel(Threading::WorkerPool& worker_pool, size_t max_samples)
+{
+    ssize_t remaining_samples = m_total_samples - m_loaded_samples;
+    if (remaining_samples <= 0)
+        return nullptr;
+    u64 end_sample_index = m_loaded_samples + min(max_samples, remaining_samples);
+
+    // Frames don't depend on each other, but we only know where they start at seek points.
+    // So we split the work there, and decode every run of frames between two of them on its own.
+    u64 next_frame_sample_index = m_loaded_samples;
+    if (m_current_frame.has_value())
+        next_frame_sample_index += m_current_frame_data.size() - m_current_frame_position;
+
+    struct Run {
+        FlacSeekPoint start;
+        u64 end_sample_index;
+        ByteBuffer data {};
+        RefPtr<Buffer> samples {};
+        FlacSeekPoint last_frame_start { 0, 0 };
+        bool ended_mid_frame { false };
+        u64 end_byte_offset { 0 };
+        String error_string {};
+        Vector<FlacSeekPoint> seek_points {};
+    };
+    Vector<Run> runs;
+    for (auto& seek_point : m_seek_points) {
+        if (seek_point.sample_index <= next_frame_sample_index)
+            continue;
+        if (seek_point.sample_index >= end_sample_index)
+            break;
+        if (runs.is_empty()) {
+            auto position = stream_position();
+            if (!position.has_value())
+                break;
+            runs.append({ { next_frame_sample_index, position.value() - m_data_start_location }, 0 });
+        }
+        runs.last().end_sample_index = seek_point.sample_index;
+        runs.append({ seek_point, 0 });
+    }
+    if (runs.is_empty() || worker_pool.concurrency() <= 1)
+        return get_more_samples(max_samples);
+    runs.last().end_sample_index = end_sample_index;
+
+    // We don't know where the last run ends, but it's no further than the next seek point (or the end of the file).
+    Optional<u64> end_byte_offset;
+    if (auto index = first_seek_point_after(end_sample_index - 1); index < m_seek_points.size())
+        end_byte_offset = m_seek_points[index].byte_offset;
+
+    // Gather the frames of every run up front, so the workers only ever touch memory.
+    for (size_t i = 0; i < runs.size(); ++i) {
+        auto start = m_data_start_location + runs[i].start.byte_offset;
+        Optional<u64> end;
+        if (i + 1 < runs.size())
+            end = m_data_start_location + runs[i + 1].start.byte_offset;
+        else if (end_byte_offset.has_value())
+            end = m_data_start_location + end_byte_offset.value();
+
+        if (m_file) {
+            if (!m_file->seek(start)) {
+                m_error_string = String::formatted("Invalid seek position {}", start);
+                return nullptr;
+            }
+            runs[i].data = end.has_value() ? m_file->read(end.value() - start) : m_file->read_all();
+            if (end.has_value() && runs[i].data.size() != end.value() - start) {
+                m_error_string = "Read error";
+                return nullptr;
+            }
+        } else {
+            auto bytes = m_stream->get<InputMemoryStream>().bytes();
+            if (start > bytes.size() || (end.has_value() && end.value() > bytes.size())) {
+                m_error_string = "Seek point out of bounds";
+                return nullptr;
+            }
+            runs[i].data = ByteBuffer::copy(bytes.slice(start, end.value_or(bytes.size()) - start));
         }
-        --samples_to_read;
     }
 
-    m_loaded_samples += samples.size();
+    Vector<Frame> samples;
+    samples.ensure_capacity(end_sample_index - m_loaded_samples);
+    if (m_current_frame.has_value())
+        samples.append(m_current_frame_data.data() + m_current_frame_position, m_current_frame_data.size() - m_current_frame_position);
+
+    worker_pool.for_each_index(runs.size(), [&](size_t i) {
+        auto& run = runs[i];
+        FlacLoaderPlugin run_loader(*this, run.data, run.start.sample_index);
+        run.samples = run_loader.get_more_samples(run.end_sample_index - run.start.sample_index);
+        run.error_string = run_loader.m_error_string;
+        run.last_frame_start = run_loader.m_current_frame_start;
+        run.ended_mid_frame = run_loader.m_current_frame.has_value();
+        run.end_byte_offset = run_loader.m_stream->get<InputMemoryStream>().offset();
+        run.seek_points = move(run_loader.m_seek_points);
+    });
+
+    for (auto& run : runs) {
+        if (!run.samples) {
+            m_error_string = run.error_string;
+            return nullptr;
+        }
+        samples.append(run.samples->samples(), run.samples->sample_count());
+        for (auto& seek_point : run.seek_points)
+            add_seek_point({ seek_point.sample_index, run.start.byte_offset + seek_point.byte_offset });
+    }
+
+    // Continue after the last decoded sample, which may be in the middle of the last run's final frame.
+    auto& last_run = runs.last();
+    if (end_sample_index == m_total_samples) {
+        m_loaded_samples = end_sample_index;
+        m_current_frame.clear();
+    } else if (last_run.ended_mid_frame) {
+        if (!seek_to_frame({ last_run.last_frame_start.sample_index, last_run.start.byte_offset + last_run.last_frame_start.byte_offset }))
+            return nullptr;
+        if (!skip_samples(end_sample_index - m_loaded_samples))
+            return nullptr;
+    } else if (!seek_to_frame({ end_sample_index, last_run.start.byte_offset + last_run.end_byte_offset })) {
+        return nullptr;
+    }
+
     return Buffer::create_with_samples(move(samples));
 }
 
 void FlacLoaderPlugin::next_frame()
 {
+    if (auto position = stream_position(); position.has_value()) {
+        m_current_frame_start = { m_loaded_samples, position.value() - m_data_start_location };
+        add_seek_point(m_current_frame_start);
+    }
+
     bool ok = true;
     InputBitStream bit_stream = m_stream->bit_stream();
 #define CHECK_OK(msg)                                                                                                      \
@@ -410,6 +674,7 @@ void FlacLoaderPlugin::next_frame()
 
     m_current_frame_data.clear_with_capacity();
     m_current_frame_data.ensure_capacity(left.size());
+    m_current_frame_position = 0;
     // zip together channels
     for (size_t i = 0; i < left.size(); ++i) {
         Frame frame = { left[i] / sample_rescale, right[i] / sample_rescale };
@@ -670,9 +935,21 @@ Vector<i32> FlacLoaderPlugin::decode_custom_lpc(FlacSubframeHeader& subframe, In
     // decode residual
     // FIXME: This order may be incorrect, the LPC is applied to the residual, probably leading to incorrect results.
     decoded = decode_residual(decoded, subframe, bit_input);
+    if (!m_error_string.is_empty())
+        return {};
+    if (decoded.size() != m_current_frame->sample_count) {
+        m_error_string = "Residual sample count";
+        return {};
+    }
 
     // approximate the waveform with the predictor
-    for (size_t i = subframe.order; i < m_current_frame->sample_count; ++i) {
+    size_t first_vectorized_sample = m_current_frame->sample_count;
+    // The predicted sample can't overflow 32 bits if the samples, the coefficients and the number of terms together have no more bits than that.
+    u8 order_bits = 32 - __builtin_clz(subframe.order);
+    if (lpc_shift >= 0 && subframe.bits_per_sample + lpc_precision + order_bits <= 32)
+        first_vectorized_sample = min<size_t>(round_up_to_power_of_two(subframe.order, 4), first_vectorized_sample);
+
+    for (size_t i = subframe.order; i < first_vectorized_sample; ++i) {
         i64 sample = 0;
         for (size_t t = 0; t < subframe.order; ++t) {
             sample += static_cast<i64>(coefficients[t]) * static_cast<i64>(decoded[i - t - 1]);
@@ -680,6 +957,28 @@ Vector<i32> FlacLoaderPlugin::decode_custom_lpc(FlacSubframeHeader& subframe, In
         decoded[i] += sample >> lpc_shift;
     }
 
+    if (first_vectorized_sample < m_current_frame->sample_count) {
+        // Line the coefficients up with the samples they apply to, padded with zeros at the front to a multiple of four.
+        // That way, every prediction is a dot product of whole vectors with the samples right before it.
+        size_t padded_order = first_vectorized_sample;
+        Array<i32, 32> padded_coefficients {};
+        for (size_t t = 0; t < subframe.order; ++t)
+            padded_coefficients[padded_order - t - 1] = coefficients[t];
+
+        for (size_t i = first_vectorized_sample; i < m_current_frame->sample_count; ++i) {
+            auto* history = decoded.data() + i - padded_order;
+            AK::SIMD::i32x4 sums {};
+            for (size_t t = 0; t < padded_order; t += 4) {
+                AK::SIMD::i32x4 samples;
+                AK::SIMD::i32x4 weights;
+                memcpy(&samples, history + t, sizeof(samples));
+                memcpy(&weights, padded_coefficients.data() + t, sizeof(weights));
+                sums += samples * weights;
+            }
+            decoded[i] += (sums[0] + sums[1] + sums[2] + sums[3]) >> lpc_shift;
+        }
+    }
+
     return decoded;
 }
 
@@ -14,6 +14,7 @@
 #include <AK/Types.h>
 #include <AK/Variant.h>
 #include <LibCore/FileStream.h>
+#include <LibThreading/WorkerPool.h>
 
 namespace Audio {
 
@@ -83,9 +84,10 @@ public:
     virtual const String& error_string() override { return m_error_string; }
 
     virtual RefPtr<Buffer> get_more_samples(size_t max_bytes_to_read_from_input = 128 * KiB) override;
+    virtual RefPtr<Buffer> get_more_samples_in_parallel(Threading::WorkerPool&, size_t max_samples) override;
 
     virtual void reset() override;
-    virtual void seek(const int position) override;
+    virtual void seek(const int sample_index) override;
 
     virtual int loaded_samples() override { return m_loaded_samples; }
     virtual int total_samples() override { return m_total_samples; }
@@ -98,7 +100,20 @@ public:
     bool sample_count_unknown() const { return m_total_samples == 0; }
 
 private:
+    // Decodes the frames in `frames`, the first one of which starts at `first_sample_index`, with the stream info of `stream`.
+    FlacLoaderPlugin(FlacLoaderPlugin const& stream, ReadonlyBytes frames, u64 first_sample_index);
+
     bool parse_header();
+    bool parse_seektable(FlacRawMetadataBlock const&);
+    size_t first_seek_point_after(u64 sample_index) const;
+    // Returns the last known frame start at or before the given sample.
+    FlacSeekPoint seek_point_before(u64 sample_index) const;
+    // Remembers a frame start, unless we already know one close to it.
+    void add_seek_point(FlacSeekPoint);
+    // Only valid on frame boundaries, since the bit stream may hold on to part of a byte.
+    Optional<u64> stream_position();
+    bool seek_to_frame(FlacSeekPoint);
+    bool skip_samples(u64 sample_count);
     // Either returns the metadata block or sets error message.
     // Additionally, increments m_data_start_location past the read meta block.
     FlacRawMetadataBlock next_meta_block(InputBitStream& bit_input);
@@ -143,8 +158,13 @@ private:
     u64 m_data_start_location { 0 };
     OwnPtr<FlacInputStream> m_stream;
     Optional<FlacFrameHeader> m_current_frame;
+    FlacSeekPoint m_current_frame_start { 0, 0 };
     Vector<Frame> m_current_frame_data;
+    size_t m_current_frame_position { 0 };
     u64 m_current_sample_or_frame { 0 };
+
+    // Sorted by sample index.
+    Vector<FlacSeekPoint> m_seek_points;
 };
 
 }
@@ -25,7 +25,7 @@ enum FlacMetadataBlockType : u8 {
     STREAMINFO = 0,     // Important data about the audio format
     PADDING = 1,        // Non-data block to be ignored
     APPLICATION = 2,    // Ignored
-    SEEKTABLE = 3,      // Seeking info, maybe to be used later
+    SEEKTABLE = 3,      // Seeking info
     VORBIS_COMMENT = 4, // Ignored
     CUESHEET = 5,       // Ignored
     PICTURE = 6,        // Ignored
@@ -79,6 +79,13 @@ struct FlacFrameHeader {
     PcmSampleFormat bit_depth;
 };
 
+// A known frame start, either from the SEEKTABLE or found while decoding
+struct FlacSeekPoint {
+    u64 sample_index;
+    // Relative to the first frame header
+    u64 byte_offset;
+};
+
 struct FlacSubframeHeader {
     FlacSubframeType type;
     // order for fixed and LPC subframes
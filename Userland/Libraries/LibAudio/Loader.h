@@ -13,6 +13,10 @@
 #include <LibAudio/Buffer.h>
 #include <LibCore/File.h>
 
+namespace Threading {
+class WorkerPool;
+}
+
 namespace Audio {
 
 static const String empty_string = "";
@@ -29,6 +33,9 @@ public:
 
     virtual RefPtr<Buffer> get_more_samples(size_t max_bytes_to_read_from_input = 128 * KiB) = 0;
 
+    // Formats whose frames can be decoded independently may split this work between the threads of the pool.
+    virtual RefPtr<Buffer> get_more_samples_in_parallel(Threading::WorkerPool&, size_t max_samples) { return get_more_samples(max_samples); }
+
     virtual void reset() = 0;
 
     virtual void seek(const int sample_index) = 0;
@@ -58,16 +65,17 @@ public:
     const String& error_string() const { return m_plugin ? m_plugin->error_string() : no_plugin_error; }
 
     RefPtr<Buffer> get_more_samples(size_t max_bytes_to_read_from_input = 128 * KiB) const { return m_plugin ? m_plugin->get_more_samples(max_bytes_to_read_from_input) : nullptr; }
+    RefPtr<Buffer> get_more_samples_in_parallel(Threading::WorkerPool& worker_pool, size_t max_samples) const { return m_plugin ? m_plugin->get_more_samples_in_parallel(worker_pool, max_samples) : nullptr; }
 
     void reset() const
     {
         if (m_plugin)
             m_plugin->reset();
     }
-    void seek(const int position) const
+    void seek(const int sample_index) const
     {
         if (m_plugin)
-            m_plugin->seek(position);
+            m_plugin->seek(sample_index);
     }
 
     int loaded_samples() const { return m_plugin ? m_plugin->loaded_samples() : 0; }
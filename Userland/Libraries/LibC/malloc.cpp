@@ -43,11 +43,19 @@ constexpr size_t number_of_hot_chunked_blocks_to_keep_around = 16;
 constexpr size_t number_of_cold_chunked_blocks_to_keep_around = 16;
 constexpr size_t number_of_big_blocks_to_keep_around_per_size_class = 8;
 
+// Each thread keeps some free chunks of the smaller size classes to itself, so most malloc() and free() calls don't need s_malloc_mutex.
+// Chunks in a thread cache still count as used in their ChunkedBlock, so they can be freed into any thread's cache and returned from there.
+constexpr size_t largest_thread_cached_chunk_size = 4080;
+constexpr size_t thread_cache_bytes_per_size_class = 16 * KiB;
+constexpr size_t min_thread_cached_chunks_per_size_class = 8;
+constexpr size_t max_thread_cached_chunks_per_size_class = 256;
+
 static bool s_log_malloc = false;
 static bool s_scrub_malloc = true;
 static bool s_scrub_free = true;
 static bool s_profiling = false;
 static bool s_in_userspace_emulator = false;
+static bool s_use_thread_cache = true;
 
 ALWAYS_INLINE static void ue_notify_malloc(const void* ptr, size_t size)
 {
@@ -108,6 +116,9 @@ struct MallocStats {
     size_t number_of_hot_keeps;
     size_t number_of_cold_keeps;
     size_t number_of_frees;
+
+    size_t number_of_thread_cache_refills;
+    size_t number_of_thread_cache_flushes;
 };
 static MallocStats g_malloc_stats = {};
 
@@ -158,6 +169,34 @@ static Allocator* allocator_for_size(size_t size, size_t& good_size)
     return nullptr;
 }
 
+static constexpr size_t thread_cache_capacity(size_t size_class)
+{
+    return clamp(thread_cache_bytes_per_size_class / size_classes[size_class], min_thread_cached_chunks_per_size_class, max_thread_cached_chunks_per_size_class);
+}
+
+static constexpr size_t number_of_thread_cached_size_classes()
+{
+    size_t count = 0;
+    while (size_classes[count] && size_classes[count] <= largest_thread_cached_chunk_size)
+        ++count;
+    return count;
+}
+
+struct ThreadCache {
+    struct Bin {
+        FreelistEntry* chunks;
+        size_t count;
+    };
+    Bin bins[number_of_thread_cached_size_classes()];
+    bool is_disabled;
+};
+
+#ifdef NO_TLS
+static ThreadCache t_thread_cache;
+#else
+static __thread ThreadCache t_thread_cache;
+#endif
+
 #ifdef RECYCLE_BIG_ALLOCATIONS
 static BigAllocator* big_allocator_for_size(size_t size)
 {
@@ -191,6 +230,9 @@ enum class CallerWillInitializeMemory {
     Yes,
 };
 
+static void* allocate_chunk(Allocator&, size_t good_size);
+static void* allocate_from_thread_cache(size_t size_class);
+
 static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
 {
     if (s_log_malloc)
@@ -207,42 +249,64 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
     size_t good_size;
     auto* allocator = allocator_for_size(size, good_size);
 
+    if (allocator) {
+        void* ptr = nullptr;
+        size_t size_class = allocator - allocators();
+        if (size_class < number_of_thread_cached_size_classes() && s_use_thread_cache && !t_thread_cache.is_disabled) {
+            ptr = allocate_from_thread_cache(size_class);
+        } else {
+            PthreadMutexLocker locker(s_malloc_mutex);
+            ptr = allocate_chunk(*allocator, good_size);
+        }
+
+        dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (size {})", ptr, good_size);
+
+        if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
+            memset(ptr, MALLOC_SCRUB_BYTE, good_size);
+
+        ue_notify_malloc(ptr, size);
+        return ptr;
+    }
+
     PthreadMutexLocker locker(s_malloc_mutex);
 
-    if (!allocator) {
-        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
+    size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
 #ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(real_size)) {
-            if (!allocator->blocks.is_empty()) {
-                g_malloc_stats.number_of_big_allocator_hits++;
-                auto* block = allocator->blocks.take_last();
-                int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
-                bool this_block_was_purged = rc == 1;
-                if (rc < 0) {
-                    perror("madvise");
-                    VERIFY_NOT_REACHED();
-                }
-                if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
-                    perror("mprotect");
-                    VERIFY_NOT_REACHED();
-                }
-                if (this_block_was_purged) {
-                    g_malloc_stats.number_of_big_allocator_purge_hits++;
-                    new (block) BigAllocationBlock(real_size);
-                }
-
-                ue_notify_malloc(&block->m_slot[0], size);
-                return &block->m_slot[0];
+    if (auto* allocator = big_allocator_for_size(real_size)) {
+        if (!allocator->blocks.is_empty()) {
+            g_malloc_stats.number_of_big_allocator_hits++;
+            auto* block = allocator->blocks.take_last();
+            int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
+            bool this_block_was_purged = rc == 1;
+            if (rc < 0) {
+                perror("madvise");
+                VERIFY_NOT_REACHED();
+            }
+            if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
+                perror("mprotect");
+                VERIFY_NOT_REACHED();
             }
+            if (this_block_was_purged) {
+                g_malloc_stats.number_of_big_allocator_purge_hits++;
+                new (block) BigAllocationBlock(real_size);
+            }
+
+            ue_notify_malloc(&block->m_slot[0], size);
+            return &block->m_slot[0];
         }
-#endif
-        g_malloc_stats.number_of_big_allocs++;
-        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
-        new (block) BigAllocationBlock(real_size);
-        ue_notify_malloc(&block->m_slot[0], size);
-        return &block->m_slot[0];
     }
+#endif
+    g_malloc_stats.number_of_big_allocs++;
+    auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
+    new (block) BigAllocationBlock(real_size);
+    ue_notify_malloc(&block->m_slot[0], size);
+    return &block->m_slot[0];
+}
 
+// Takes a chunk out of the allocator's blocks. Must be called with s_malloc_mutex held.
+static void* allocate_chunk(Allocator& allocator_ref, size_t good_size)
+{
+    auto* allocator = &allocator_ref;
     ChunkedBlock* block = nullptr;
     for (auto& current : allocator->usable_blocks) {
         if (current.free_chunks()) {
@@ -312,13 +376,58 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
         allocator->usable_blocks.remove(*block);
         allocator->full_blocks.append(*block);
     }
-    dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, block, block->bytes_per_chunk());
+    return ptr;
+}
 
-    if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
-        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
+static void* allocate_from_thread_cache(size_t size_class)
+{
+    auto& bin = t_thread_cache.bins[size_class];
+    if (!bin.chunks) {
+        // Grab half a cache's worth at once, so the next few allocations don't have to take the lock.
+        PthreadMutexLocker locker(s_malloc_mutex);
+        g_malloc_stats.number_of_thread_cache_refills++;
+        auto& allocator = allocators()[size_class];
+        for (size_t i = 0; i < thread_cache_capacity(size_class) / 2; ++i) {
+            auto* entry = (FreelistEntry*)allocate_chunk(allocator, size_classes[size_class]);
+            entry->next = bin.chunks;
+            bin.chunks = entry;
+            ++bin.count;
+        }
+    }
 
-    ue_notify_malloc(ptr, size);
-    return ptr;
+    auto* entry = bin.chunks;
+    bin.chunks = entry->next;
+    --bin.count;
+    return entry;
+}
+
+static void free_chunk(ChunkedBlock*, void* ptr);
+
+// Gives `count` chunks from the bin back to their blocks. Must be called with s_malloc_mutex held.
+static void flush_thread_cache_bin(ThreadCache::Bin& bin, size_t count)
+{
+    g_malloc_stats.number_of_thread_cache_flushes++;
+    for (size_t i = 0; i < count && bin.chunks; ++i) {
+        auto* entry = bin.chunks;
+        bin.chunks = entry->next;
+        --bin.count;
+        free_chunk((ChunkedBlock*)((FlatPtr)entry & ChunkedBlock::block_mask), entry);
+    }
+}
+
+static void free_to_thread_cache(size_t size_class, void* ptr)
+{
+    auto& bin = t_thread_cache.bins[size_class];
+    auto* entry = (FreelistEntry*)ptr;
+    entry->next = bin.chunks;
+    bin.chunks = entry;
+    ++bin.count;
+
+    if (bin.count > thread_cache_capacity(size_class)) {
+        // Keep half, so that a thread that keeps freeing doesn't take the lock on every call.
+        PthreadMutexLocker locker(s_malloc_mutex);
+        flush_thread_cache_bin(bin, bin.count - thread_cache_capacity(size_class) / 2);
+    }
 }
 
 static void free_impl(void* ptr)
@@ -333,9 +442,8 @@ static void free_impl(void* ptr)
     void* block_base = (void*)((FlatPtr)ptr & ChunkedBlock::ChunkedBlock::block_mask);
     size_t magic = *(size_t*)block_base;
 
-    PthreadMutexLocker locker(s_malloc_mutex);
-
     if (magic == MAGIC_BIGALLOC_HEADER) {
+        PthreadMutexLocker locker(s_malloc_mutex);
         auto* block = (BigAllocationBlock*)block_base;
 #ifdef RECYCLE_BIG_ALLOCATIONS
         if (auto* allocator = big_allocator_for_size(block->m_size)) {
@@ -363,11 +471,25 @@ static void free_impl(void* ptr)
     assert(magic == MAGIC_PAGE_HEADER);
     auto* block = (ChunkedBlock*)block_base;
 
-    dbgln_if(MALLOC_DEBUG, "LibC: freeing {:p} in allocator {:p} (size={}, used={})", ptr, block, block->bytes_per_chunk(), block->used_chunks());
+    dbgln_if(MALLOC_DEBUG, "LibC: freeing {:p} in allocator {:p} (size={})", ptr, block, block->bytes_per_chunk());
 
     if (s_scrub_free)
         memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
 
+    size_t good_size;
+    size_t size_class = allocator_for_size(block->bytes_per_chunk(), good_size) - allocators();
+    if (size_class < number_of_thread_cached_size_classes() && s_use_thread_cache && !t_thread_cache.is_disabled) {
+        free_to_thread_cache(size_class, ptr);
+        return;
+    }
+
+    PthreadMutexLocker locker(s_malloc_mutex);
+    free_chunk(block, ptr);
+}
+
+// Puts a chunk back into its block. Must be called with s_malloc_mutex held.
+static void free_chunk(ChunkedBlock* block, void* ptr)
+{
     auto* entry = (FreelistEntry*)ptr;
     entry->next = block->m_freelist;
     block->m_freelist = entry;
@@ -496,6 +618,8 @@ void __malloc_init()
         // keeps track of heap memory anyway.
         s_scrub_malloc = false;
         s_scrub_free = false;
+        // UE tracks every malloc() and free(), so chunks sitting in a thread cache would look like use-after-free.
+        s_use_thread_cache = false;
     }
 
     if (secure_getenv("LIBC_NOSCRUB_MALLOC"))
@@ -506,6 +630,8 @@ void __malloc_init()
         s_log_malloc = true;
     if (secure_getenv("LIBC_PROFILE_MALLOC"))
         s_profiling = true;
+    if (secure_getenv("LIBC_NO_MALLOC_THREAD_CACHE"))
+        s_use_thread_cache = false;
 
     for (size_t i = 0; i < num_size_classes; ++i) {
         new (&allocators()[i]) Allocator();
@@ -515,6 +641,15 @@ void __malloc_init()
     new (&big_allocators()[0])(BigAllocator);
 }
 
+void __malloc_flush_thread_cache()
+{
+    PthreadMutexLocker locker(s_malloc_mutex);
+    for (auto& bin : t_thread_cache.bins)
+        flush_thread_cache_bin(bin, bin.count);
+    // Anything this thread frees from now on (e.g. in TLS destructors) should go straight back to its block.
+    t_thread_cache.is_disabled = true;
+}
+
 void serenity_dump_malloc_stats()
 {
     dbgln("# malloc() calls: {}", g_malloc_stats.number_of_malloc_calls);
@@ -538,5 +673,8 @@ void serenity_dump_malloc_stats()
     dbgln("number of hot keeps: {}", g_malloc_stats.number_of_hot_keeps);
     dbgln("number of cold keeps: {}", g_malloc_stats.number_of_cold_keeps);
     dbgln("number of frees: {}", g_malloc_stats.number_of_frees);
+    dbgln();
+    dbgln("thread cache refills: {}", g_malloc_stats.number_of_thread_cache_refills);
+    dbgln("thread cache flushes: {}", g_malloc_stats.number_of_thread_cache_flushes);
 }
 }
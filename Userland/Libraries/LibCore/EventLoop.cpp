@@ -32,6 +32,11 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__serenity__) || defined(__linux__)
+#    define EVENTLOOP_USE_EPOLL
+#    include <sys/epoll.h>
+#endif
+
 namespace Core {
 
 class InspectorServerConnection;
@@ -60,6 +65,22 @@ static NeverDestroyed<IDAllocator> s_id_allocator;
 static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
 static HashTable<Notifier*>* s_notifiers;
 int EventLoop::s_wake_pipe_fds[2];
+
+#ifdef EVENTLOOP_USE_EPOLL
+// All notifiers watching the same fd share one entry in the epoll interest set.
+struct NotifierRegistration {
+    Vector<Notifier*, 1> notifiers;
+    u32 registered_events { 0 };
+    // Some files (e.g. regular files on Linux) can't be watched with epoll,
+    // but they are always ready, just like select() would report them.
+    bool is_always_ready { false };
+};
+
+static constexpr size_t max_epoll_events_per_wait = 64;
+static int s_epoll_fd = -1;
+static HashMap<int, NotifierRegistration>* s_notifier_registrations;
+static HashTable<int>* s_always_ready_fds;
+#endif
 static RefPtr<InspectorServerConnection> s_inspector_server_connection;
 
 bool EventLoop::has_been_instantiated()
@@ -262,6 +283,10 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef EVENTLOOP_USE_EPOLL
+        s_notifier_registrations = new HashMap<int, NotifierRegistration>;
+        s_always_ready_fds = new HashTable<int>;
+#endif
     }
 
     if (!s_main_event_loop) {
@@ -276,6 +301,17 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
 
 #endif
         VERIFY(rc == 0);
+
+#ifdef EVENTLOOP_USE_EPOLL
+        s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        VERIFY(s_epoll_fd >= 0);
+        epoll_event wake_event {};
+        wake_event.events = EPOLLIN;
+        wake_event.data.fd = s_wake_pipe_fds[0];
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, s_wake_pipe_fds[0], &wake_event);
+        VERIFY(rc == 0);
+#endif
+
         s_event_loop_stack->append(*this);
 
 #ifdef __serenity__
@@ -557,6 +593,14 @@ void EventLoop::notify_forked(ForkEvent event)
         s_event_loop_stack->clear();
         s_timers->clear();
         s_notifiers->clear();
+#ifdef EVENTLOOP_USE_EPOLL
+        // The epoll instance is shared with the parent, so we must not touch its interest set.
+        if (s_epoll_fd >= 0)
+            close(s_epoll_fd);
+        s_epoll_fd = -1;
+        s_notifier_registrations->clear();
+        s_always_ready_fds->clear();
+#endif
         if (auto* info = signals_info<false>()) {
             info->signal_handlers.clear();
             info->next_signal_id = 0;
@@ -573,6 +617,10 @@ void EventLoop::notify_forked(ForkEvent event)
 
 void EventLoop::wait_for_event(WaitMode mode)
 {
+#ifdef EVENTLOOP_USE_EPOLL
+    epoll_event ready_events[max_epoll_events_per_wait];
+retry:
+#else
     fd_set rfds;
     fd_set wfds;
 retry:
@@ -597,6 +645,7 @@ retry:
         if (notifier->event_mask() & Notifier::Exceptional)
             VERIFY_NOT_REACHED();
     }
+#endif
 
     bool queued_events_is_empty;
     {
@@ -620,8 +669,19 @@ retry:
         }
     }
 
+#ifdef EVENTLOOP_USE_EPOLL
+    int timeout_ms = -1;
+    if (!s_always_ready_fds->is_empty())
+        timeout_ms = 0;
+    else if (!should_wait_forever)
+        timeout_ms = Time::from_timeval(timeout).to_milliseconds();
+
+try_select_again:
+    int marked_fd_count = epoll_wait(s_epoll_fd, ready_events, max_epoll_events_per_wait, timeout_ms);
+#else
 try_select_again:
     int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+#endif
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
@@ -632,7 +692,17 @@ try_select_again:
         dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop::wait_for_event: {} ({}: {})", marked_fd_count, saved_errno, strerror(saved_errno));
         VERIFY_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+
+#ifdef EVENTLOOP_USE_EPOLL
+    bool wake_pipe_is_readable = false;
+    for (int i = 0; i < marked_fd_count; ++i) {
+        if (ready_events[i].data.fd == s_wake_pipe_fds[0])
+            wake_pipe_is_readable = true;
+    }
+#else
+    bool wake_pipe_is_readable = FD_ISSET(s_wake_pipe_fds[0], &rfds);
+#endif
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         auto nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
         if (nread < 0) {
@@ -679,6 +749,33 @@ try_select_again:
         }
     }
 
+#ifdef EVENTLOOP_USE_EPOLL
+    auto post_notifier_events = [this](NotifierRegistration const& registration, u32 events) {
+        for (auto* notifier : registration.notifiers) {
+            // Like select(), treat errors and hangups as readiness so the owner gets to see them.
+            if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && (notifier->event_mask() & Notifier::Event::Read))
+                post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
+            if ((events & (EPOLLOUT | EPOLLERR)) && (notifier->event_mask() & Notifier::Event::Write))
+                post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
+        }
+    };
+
+    for (int i = 0; i < marked_fd_count; ++i) {
+        int fd = ready_events[i].data.fd;
+        if (fd == s_wake_pipe_fds[0])
+            continue;
+        auto it = s_notifier_registrations->find(fd);
+        if (it == s_notifier_registrations->end())
+            continue;
+        post_notifier_events(it->value, ready_events[i].events);
+    }
+
+    for (int fd : *s_always_ready_fds) {
+        auto it = s_notifier_registrations->find(fd);
+        VERIFY(it != s_notifier_registrations->end());
+        post_notifier_events(it->value, EPOLLIN | EPOLLOUT);
+    }
+#else
     if (!marked_fd_count)
         return;
 
@@ -692,6 +789,7 @@ try_select_again:
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
+#endif
 }
 
 bool EventLoopTimer::has_expired(const Time& now) const
@@ -745,14 +843,114 @@ bool EventLoop::unregister_timer(int timer_id)
     return true;
 }
 
+#ifdef EVENTLOOP_USE_EPOLL
+enum class ShouldResyncWithKernel {
+    No,
+    Yes,
+};
+
+static void update_epoll_interest(int fd, NotifierRegistration& registration, ShouldResyncWithKernel should_resync = ShouldResyncWithKernel::No)
+{
+    u32 events = 0;
+    for (auto* notifier : registration.notifiers) {
+        if (notifier->event_mask() & Notifier::Read)
+            events |= EPOLLIN;
+        if (notifier->event_mask() & Notifier::Write)
+            events |= EPOLLOUT;
+        if (notifier->event_mask() & Notifier::Exceptional)
+            VERIFY_NOT_REACHED();
+    }
+
+    // The fd number may have been closed and reused for another file since we registered it,
+    // in which case the kernel has already dropped (or is still watching) the old file.
+    // Going through epoll_ctl() again lets the kernel sort it out, since it keys watches on the file description.
+    if (should_resync == ShouldResyncWithKernel::Yes && events != 0) {
+        if (registration.is_always_ready) {
+            registration.is_always_ready = false;
+            s_always_ready_fds->remove(fd);
+            registration.registered_events = 0;
+        }
+    } else if (events == registration.registered_events) {
+        return;
+    }
+
+    if (registration.is_always_ready) {
+        registration.registered_events = events;
+        if (events == 0) {
+            registration.is_always_ready = false;
+            s_always_ready_fds->remove(fd);
+        }
+        return;
+    }
+
+    if (events == 0) {
+        // The fd may already have been closed, which drops it from the interest set on its own.
+        (void)epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        registration.registered_events = 0;
+        return;
+    }
+
+    epoll_event event {};
+    event.events = events;
+    event.data.fd = fd;
+    int op = registration.registered_events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    int rc = epoll_ctl(s_epoll_fd, op, fd, &event);
+    // If the fd was closed and reused behind our back, our idea of what is registered is stale.
+    if (rc < 0 && errno == EEXIST)
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+    else if (rc < 0 && errno == ENOENT)
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    if (rc < 0 && errno == EPERM) {
+        registration.is_always_ready = true;
+        s_always_ready_fds->set(fd);
+        rc = 0;
+    }
+    if (rc < 0) {
+        perror("Core::EventLoop: epoll_ctl");
+        VERIFY_NOT_REACHED();
+    }
+    registration.registered_events = events;
+}
+#endif
+
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
     s_notifiers->set(&notifier);
+#ifdef EVENTLOOP_USE_EPOLL
+    auto& registration = s_notifier_registrations->ensure(notifier.fd());
+    auto should_resync = ShouldResyncWithKernel::No;
+    if (!registration.notifiers.contains_slow(&notifier)) {
+        registration.notifiers.append(&notifier);
+        should_resync = ShouldResyncWithKernel::Yes;
+    }
+    update_epoll_interest(notifier.fd(), registration, should_resync);
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
     s_notifiers->remove(&notifier);
+#ifdef EVENTLOOP_USE_EPOLL
+    auto it = s_notifier_registrations->find(notifier.fd());
+    if (it == s_notifier_registrations->end())
+        return;
+    auto& registration = it->value;
+    registration.notifiers.remove_first_matching([&](auto* other) { return other == &notifier; });
+    update_epoll_interest(notifier.fd(), registration);
+    if (registration.notifiers.is_empty())
+        s_notifier_registrations->remove(it);
+#endif
+}
+
+void EventLoop::notifier_event_mask_did_change(Badge<Notifier>, [[maybe_unused]] Notifier& notifier)
+{
+#ifdef EVENTLOOP_USE_EPOLL
+    if (!s_notifiers->contains(&notifier))
+        return;
+    auto it = s_notifier_registrations->find(notifier.fd());
+    VERIFY(it != s_notifier_registrations->end());
+    update_epoll_interest(notifier.fd(), it->value);
+#endif
 }
 
 void EventLoop::wake()
@@ -65,6 +65,8 @@ Optional<AllProcessesStatistics> ProcessStatisticsReader::get_all(RefPtr<Core::F
         process.amount_clean_inode = process_object.get("amount_clean_inode").to_u32();
         process.amount_purgeable_volatile = process_object.get("amount_purgeable_volatile").to_u32();
         process.amount_purgeable_nonvolatile = process_object.get("amount_purgeable_nonvolatile").to_u32();
+        process.amount_large_pages = process_object.get("amount_large_pages").to_u32();
+        process.large_page_splits = process_object.get("large_page_splits").to_u32();
 
         auto& thread_array = process_object.get_ptr("threads")->as_array();
         process.threads.ensure_capacity(thread_array.size());
@@ -83,6 +85,7 @@ Optional<AllProcessesStatistics> ProcessStatisticsReader::get_all(RefPtr<Core::F
             thread.inode_faults = thread_object.get("inode_faults").to_u32();
             thread.zero_faults = thread_object.get("zero_faults").to_u32();
             thread.cow_faults = thread_object.get("cow_faults").to_u32();
+            thread.large_page_faults = thread_object.get("large_page_faults").to_u32();
             thread.unix_socket_read_bytes = thread_object.get("unix_socket_read_bytes").to_u32();
             thread.unix_socket_write_bytes = thread_object.get("unix_socket_write_bytes").to_u32();
             thread.ipv4_socket_read_bytes = thread_object.get("ipv4_socket_read_bytes").to_u32();
@@ -21,6 +21,7 @@ struct ThreadStatistics {
     unsigned inode_faults;
     unsigned zero_faults;
     unsigned cow_faults;
+    unsigned large_page_faults;
     unsigned unix_socket_read_bytes;
     unsigned unix_socket_write_bytes;
     unsigned ipv4_socket_read_bytes;
@@ -57,6 +58,8 @@ struct ProcessStatistics {
     size_t amount_clean_inode;
     size_t amount_purgeable_volatile;
     size_t amount_purgeable_nonvolatile;
+    size_t amount_large_pages;
+    size_t large_page_splits;
 
     Vector<Core::ThreadStatistics> threads;
 
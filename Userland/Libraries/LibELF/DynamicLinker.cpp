@@ -12,6 +12,7 @@
 #include <AK/HashTable.h>
 #include <AK/LexicalPath.h>
 #include <AK/NonnullRefPtrVector.h>
+#include <AK/QuickSort.h>
 #include <AK/ScopeGuard.h>
 #include <AK/Vector.h>
 #include <LibC/bits/pthread_integration.h>
@@ -25,10 +26,12 @@
 #include <LibELF/DynamicLoader.h>
 #include <LibELF/DynamicObject.h>
 #include <LibELF/Hashes.h>
+#include <LibELF/PrelinkCache.h>
 #include <fcntl.h>
 #include <string.h>
 #include <sys/types.h>
 #include <syscall.h>
+#include <time.h>
 
 namespace ELF {
 
@@ -52,17 +55,55 @@ static __pthread_mutex_t s_loader_lock = __PTHREAD_MUTEX_INITIALIZER;
 
 static bool s_allowed_to_check_environment_variables { false };
 static bool s_do_breakpoint_trap_before_entry { false };
+static bool s_bind_now { false };
+static bool s_print_statistics { false };
+static String s_prelink_cache_directory;
+// Only set while the program itself is being linked, objects loaded with dlopen() are never prelinked.
+static String s_prelink_cache_path;
+
+struct HashSymbolTraits : public GenericTraits<DynamicObject::HashSymbol> {
+    static unsigned hash(const DynamicObject::HashSymbol& symbol) { return symbol.gnu_hash(); }
+    static bool equals(const DynamicObject::HashSymbol& a, const DynamicObject::HashSymbol& b) { return a.name() == b.name(); }
+};
+
+// Results of lookup_global_symbol(), including the ones that found nothing.
+// The keys point into the string tables of loaded objects, which are never unmapped.
+// Like s_global_objects, this is only modified while objects are being loaded, which happens
+// before the program starts or with s_loader_lock held.
+static HashMap<DynamicObject::HashSymbol, Optional<DynamicObject::SymbolLookupResult>, HashSymbolTraits> s_symbol_cache;
+// Lazy PLT binding reads s_symbol_cache and s_global_objects on any thread, even while dlopen() is modifying them.
+// Modifications and lazy lookups hold this lock. The loader reads them without it, since it's the only writer.
+// NOTE: This is separate from s_loader_lock, since that is held while running a dlopen()ed object's initializers,
+//       which may call into functions that still need to be bound.
+static __pthread_mutex_t s_symbol_cache_lock = __PTHREAD_MUTEX_INITIALIZER;
+
+struct LoaderStatistics {
+    u64 start_time_in_us { 0 };
+    u64 mapping_time_in_us { 0 };
+    u64 relocation_time_in_us { 0 };
+    u64 initialization_time_in_us { 0 };
+    size_t object_count { 0 };
+    size_t symbol_lookup_count { 0 };
+    size_t symbol_cache_hit_count { 0 };
+    bool used_prelink_cache { false };
+};
+static LoaderStatistics s_statistics;
 
 static Result<void, DlErrorMessage> __dlclose(void* handle);
 static Result<void*, DlErrorMessage> __dlopen(const char* filename, int flags);
 static Result<void*, DlErrorMessage> __dlsym(void* handle, const char* symbol_name);
 static Result<void, DlErrorMessage> __dladdr(void* addr, Dl_info* info);
 
-Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol(const StringView& name)
+static u64 current_time_in_us()
 {
-    Optional<DynamicObject::SymbolLookupResult> weak_result;
+    timespec now {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<u64>(now.tv_sec) * 1'000'000 + now.tv_nsec / 1000;
+}
 
-    auto symbol = DynamicObject::HashSymbol { name };
+static Optional<DynamicObject::SymbolLookupResult> lookup_global_symbol_in_objects(const DynamicObject::HashSymbol& symbol)
+{
+    Optional<DynamicObject::SymbolLookupResult> weak_result;
 
     for (auto& lib : s_global_objects) {
         auto res = lib.value->lookup_symbol(symbol);
@@ -77,6 +118,55 @@ Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol(
     return weak_result;
 }
 
+Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol(const StringView& name)
+{
+    // The hashes computed for the cache lookup are reused for every object's hash table on a miss.
+    auto symbol = DynamicObject::HashSymbol { name };
+
+    ++s_statistics.symbol_lookup_count;
+    if (auto cached_result = s_symbol_cache.get(symbol); cached_result.has_value()) {
+        ++s_statistics.symbol_cache_hit_count;
+        return cached_result.value();
+    }
+
+    auto result = lookup_global_symbol_in_objects(symbol);
+    __pthread_mutex_lock(&s_symbol_cache_lock);
+    s_symbol_cache.set(symbol, result);
+    __pthread_mutex_unlock(&s_symbol_cache_lock);
+    return result;
+}
+
+Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol_for_lazy_binding(const StringView& name)
+{
+    __pthread_mutex_lock(&s_symbol_cache_lock);
+    ScopeGuard unlock_guard = [] { __pthread_mutex_unlock(&s_symbol_cache_lock); };
+
+    // This can run on any thread, so it only probes the cache and never inserts into it.
+    // Most symbols have been looked up while relocating already, the rest are searched for without caching the result.
+    auto symbol = DynamicObject::HashSymbol { name };
+    if (auto cached_result = s_symbol_cache.get(symbol); cached_result.has_value())
+        return cached_result.value();
+    return lookup_global_symbol_in_objects(symbol);
+}
+
+static void add_global_object(const String& name, DynamicObject& object)
+{
+    __pthread_mutex_lock(&s_symbol_cache_lock);
+    ScopeGuard unlock_guard = [] { __pthread_mutex_unlock(&s_symbol_cache_lock); };
+
+    s_global_objects.set(name, object);
+
+    // A global definition found earlier still wins, but the new object may provide
+    // symbols that were missing or only weakly defined so far.
+    Vector<DynamicObject::HashSymbol> stale_symbols;
+    for (auto& it : s_symbol_cache) {
+        if (!it.value.has_value() || it.value->bind != STB_GLOBAL)
+            stale_symbols.append(it.key);
+    }
+    for (auto& symbol : stale_symbols)
+        s_symbol_cache.remove(symbol);
+}
+
 static String get_library_name(String path)
 {
     return LexicalPath::basename(move(path));
@@ -250,6 +340,103 @@ static void initialize_libc(DynamicObject& libc)
     ((libc_init_func*)res.value().address.as_ptr())();
 }
 
+static Vector<PrelinkCache::Object> prelink_cache_objects()
+{
+    Vector<PrelinkCache::Object> objects;
+    for (auto& it : s_global_objects) {
+        auto& stat = s_loaders.get(get_library_name(it.key)).value()->file_stat();
+        objects.append(PrelinkCache::Object::from_stat(it.key, stat));
+    }
+    return objects;
+}
+
+static bool apply_prelink_cache(NonnullRefPtrVector<DynamicLoader>& loaders)
+{
+    auto cache = PrelinkCache::try_load(s_prelink_cache_path);
+    if (!cache.has_value() || !cache->is_up_to_date(prelink_cache_objects())) {
+        dbgln_if(DYNAMIC_LOAD_DEBUG, "Prelink cache {} is missing or out of date", s_prelink_cache_path);
+        return false;
+    }
+
+    Vector<DynamicObject const*> objects;
+    HashMap<String, size_t> object_indices;
+    for (auto& it : s_global_objects) {
+        object_indices.set(get_library_name(it.key), objects.size());
+        objects.append(it.value.ptr());
+    }
+
+    for (auto& loader : loaders) {
+        auto object_index = object_indices.get(get_library_name(loader.filename()));
+        VERIFY(object_index.has_value());
+
+        Vector<DynamicLoader::ResolvedSymbol> resolved_symbols;
+        for (auto& symbol : cache->symbols_of(object_index.value())) {
+            if (symbol.object_index == PrelinkCache::unresolved_object_index) {
+                resolved_symbols.append({ symbol.symbol_index, {} });
+                continue;
+            }
+            auto& object = *objects[symbol.object_index];
+            auto address = object.elf_is_dynamic() ? object.base_address().offset(symbol.value) : VirtualAddress { static_cast<FlatPtr>(symbol.value) };
+            resolved_symbols.append({ symbol.symbol_index, DynamicObject::SymbolLookupResult { static_cast<FlatPtr>(symbol.value), static_cast<size_t>(symbol.size), address, symbol.bind, &object } });
+        }
+        loader.set_prelinked_symbols(move(resolved_symbols));
+    }
+    return true;
+}
+
+static void save_prelink_cache(NonnullRefPtrVector<DynamicLoader>& loaders)
+{
+    PrelinkCache cache { prelink_cache_objects() };
+
+    HashMap<DynamicObject const*, u32> object_indices;
+    HashMap<String, u32> object_indices_by_name;
+    for (auto& it : s_global_objects) {
+        object_indices_by_name.set(get_library_name(it.key), object_indices.size());
+        object_indices.set(it.value.ptr(), object_indices.size());
+    }
+
+    for (auto& loader : loaders) {
+        auto& resolved_symbols = loader.resolved_symbols();
+
+        // Weak symbols that weren't found are looked up again after all other relocations, and the last lookup is the one that counts.
+        // quick_sort() isn't stable, so lookups of the same symbol are kept in the order they happened by comparing their positions.
+        Vector<size_t> lookup_order;
+        lookup_order.ensure_capacity(resolved_symbols.size());
+        for (size_t i = 0; i < resolved_symbols.size(); ++i)
+            lookup_order.unchecked_append(i);
+        quick_sort(lookup_order, [&](size_t a, size_t b) {
+            if (resolved_symbols[a].symbol_index != resolved_symbols[b].symbol_index)
+                return resolved_symbols[a].symbol_index < resolved_symbols[b].symbol_index;
+            return a < b;
+        });
+
+        Vector<PrelinkCache::Symbol> symbols;
+        for (auto index : lookup_order) {
+            auto& resolved_symbol = resolved_symbols[index];
+            if (!symbols.is_empty() && symbols.last().symbol_index == resolved_symbol.symbol_index)
+                symbols.take_last();
+
+            PrelinkCache::Symbol symbol;
+            symbol.symbol_index = resolved_symbol.symbol_index;
+            if (resolved_symbol.result.has_value()) {
+                auto& result = resolved_symbol.result.value();
+                auto object_index = object_indices.get(result.dynamic_object);
+                if (!object_index.has_value())
+                    return;
+                symbol.object_index = object_index.value();
+                symbol.value = result.value;
+                symbol.size = result.size;
+                symbol.bind = result.bind;
+            }
+            symbols.append(symbol);
+        }
+        cache.set_symbols_of(object_indices_by_name.get(get_library_name(loader.filename())).value(), move(symbols));
+    }
+
+    if (!cache.save(s_prelink_cache_path))
+        dbgln("Loader.so: Could not write prelink cache {}", s_prelink_cache_path);
+}
+
 template<typename Callback>
 static void for_each_unfinished_dependency_of(const String& name, HashTable<String>& seen_names, Callback callback)
 {
@@ -278,17 +465,38 @@ static NonnullRefPtrVector<DynamicLoader> collect_loaders_for_library(const Stri
 
 static Result<NonnullRefPtr<DynamicLoader>, DlErrorMessage> load_main_library(const String& name, int flags)
 {
+    auto timestamp = s_print_statistics ? current_time_in_us() : 0;
+    auto account_time = [&](u64& time_in_us) {
+        if (!s_print_statistics)
+            return;
+        auto now = current_time_in_us();
+        time_in_us += now - timestamp;
+        timestamp = now;
+    };
+
     auto main_library_loader = *s_loaders.get(name);
     auto main_library_object = main_library_loader->map();
-    s_global_objects.set(name, *main_library_object);
+    add_global_object(name, *main_library_object);
 
     auto loaders = collect_loaders_for_library(name);
 
     for (auto& loader : loaders) {
         auto dynamic_object = loader.map();
         if (dynamic_object)
-            s_global_objects.set(dynamic_object->filename(), *dynamic_object);
+            add_global_object(dynamic_object->filename(), *dynamic_object);
     }
+    s_statistics.object_count += loaders.size();
+
+    bool should_save_prelink_cache = false;
+    if (!s_prelink_cache_path.is_null()) {
+        s_statistics.used_prelink_cache = apply_prelink_cache(loaders);
+        if (!s_statistics.used_prelink_cache) {
+            should_save_prelink_cache = true;
+            for (auto& loader : loaders)
+                loader.set_should_record_resolved_symbols(true);
+        }
+    }
+    account_time(s_statistics.mapping_time_in_us);
 
     for (auto& loader : loaders) {
         bool success = loader.link(flags);
@@ -315,10 +523,14 @@ static Result<NonnullRefPtr<DynamicLoader>, DlErrorMessage> load_main_library(co
             initialize_libc(*object);
         }
     }
+    if (should_save_prelink_cache)
+        save_prelink_cache(loaders);
+    account_time(s_statistics.relocation_time_in_us);
 
     for (auto& loader : loaders) {
         loader.load_stage_4();
     }
+    account_time(s_statistics.initialization_time_in_us);
 
     return NonnullRefPtr<DynamicLoader>(*main_library_loader);
 }
@@ -485,9 +697,15 @@ static Result<void, DlErrorMessage> __dladdr(void* addr, Dl_info* info)
 static void read_environment_variables()
 {
     for (char** env = s_envp; *env; ++env) {
-        if (StringView { *env } == "_LOADER_BREAKPOINT=1"sv) {
+        StringView env_string { *env };
+        if (env_string == "_LOADER_BREAKPOINT=1"sv)
             s_do_breakpoint_trap_before_entry = true;
-        }
+        else if (env_string == "_LOADER_STATISTICS=1"sv)
+            s_print_statistics = true;
+        else if (env_string == "LD_BIND_NOW=1"sv)
+            s_bind_now = true;
+        else if (env_string.starts_with("_LOADER_PRELINK_CACHE="sv))
+            s_prelink_cache_directory = env_string.substring_view("_LOADER_PRELINK_CACHE="sv.length());
     }
 }
 
@@ -499,6 +717,9 @@ void ELF::DynamicLinker::linker_main(String&& main_program_name, int main_progra
     if (s_allowed_to_check_environment_variables)
         read_environment_variables();
 
+    if (s_print_statistics)
+        s_statistics.start_time_in_us = current_time_in_us();
+
     s_main_program_name = main_program_name;
 
     auto library_name = get_library_name(main_program_name);
@@ -511,6 +732,10 @@ void ELF::DynamicLinker::linker_main(String&& main_program_name, int main_progra
         fflush(stderr);
         _exit(1);
     }
+    if (!s_prelink_cache_directory.is_empty()) {
+        auto& stat = result1.value()->file_stat();
+        s_prelink_cache_path = String::formatted("{}/{}-{}", s_prelink_cache_directory, stat.st_dev, stat.st_ino);
+    }
     result1.release_value();
 
     auto result2 = map_dependencies(library_name);
@@ -529,7 +754,7 @@ void ELF::DynamicLinker::linker_main(String&& main_program_name, int main_progra
 
     auto entry_point_function = [&main_program_name] {
         auto library_name = get_library_name(main_program_name);
-        auto result = load_main_library(library_name, RTLD_GLOBAL | RTLD_LAZY);
+        auto result = load_main_library(library_name, RTLD_GLOBAL | (s_bind_now ? RTLD_NOW : RTLD_LAZY));
         if (result.is_error()) {
             warnln("{}", result.error().text);
             _exit(1);
@@ -542,12 +767,22 @@ void ELF::DynamicLinker::linker_main(String&& main_program_name, int main_progra
     }();
 
     s_loaders.clear();
+    s_prelink_cache_path = {};
 
     int rc = syscall(SC_msyscall, nullptr);
     if (rc < 0) {
         VERIFY_NOT_REACHED();
     }
 
+    if (s_print_statistics) {
+        dbgln("Loader.so: {}: {} objects loaded in {} us (mapping: {} us, relocation: {} us, initializers: {} us)",
+            main_program_name, s_statistics.object_count, current_time_in_us() - s_statistics.start_time_in_us,
+            s_statistics.mapping_time_in_us, s_statistics.relocation_time_in_us, s_statistics.initialization_time_in_us);
+        dbgln("Loader.so: {}: {} global symbol lookups, {} cache hits", main_program_name, s_statistics.symbol_lookup_count, s_statistics.symbol_cache_hit_count);
+        if (!s_prelink_cache_directory.is_empty())
+            dbgln("Loader.so: {}: prelink cache {}", main_program_name, s_statistics.used_prelink_cache ? "applied" : "rebuilt");
+    }
+
     dbgln_if(DYNAMIC_LOAD_DEBUG, "Jumping to entry point: {:p}", entry_point_function);
     if (s_do_breakpoint_trap_before_entry) {
         asm("int3");
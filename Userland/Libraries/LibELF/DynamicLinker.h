@@ -15,6 +15,7 @@ namespace ELF {
 class DynamicLinker {
 public:
     static Optional<DynamicObject::SymbolLookupResult> lookup_global_symbol(const StringView& symbol);
+    static Optional<DynamicObject::SymbolLookupResult> lookup_global_symbol_for_lazy_binding(const StringView& symbol);
     [[noreturn]] static void linker_main(String&& main_program_name, int fd, bool is_secure, int argc, char** argv, char** envp);
 
 private:
@@ -6,6 +6,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BinarySearch.h>
 #include <AK/Debug.h>
 #include <AK/Optional.h>
 #include <AK/QuickSort.h>
@@ -57,6 +58,7 @@ Result<NonnullRefPtr<DynamicLoader>, DlErrorMessage> DynamicLoader::try_create(i
     auto loader = adopt_ref(*new DynamicLoader(fd, move(filename), data, size));
     if (!loader->is_valid())
         return DlErrorMessage { "ELF image validation failed" };
+    loader->m_file_stat = stat;
     return loader;
 }
 
@@ -159,6 +161,8 @@ bool DynamicLoader::load_stage_2(unsigned flags)
 {
     VERIFY(flags & RTLD_GLOBAL);
 
+    m_bind_now = !(flags & RTLD_LAZY) || m_dynamic_object->must_bind_now();
+
     if (m_dynamic_object->has_text_relocations()) {
         for (auto& text_segment : m_text_segments) {
             VERIFY(text_segment.address().get() != 0);
@@ -195,7 +199,29 @@ void DynamicLoader::do_main_relocations()
             break;
         }
     };
-    m_dynamic_object->relocation_section().for_each_relocation(do_single_relocation);
+
+    m_last_symbol_lookup_index = 0;
+
+    // Relocations without a symbol (which includes all the RELATIVE ones) are applied first and in order.
+    // The others are applied grouped by symbol, so that every symbol is only resolved once per object.
+    Vector<DynamicObject::Relocation> symbol_relocations;
+    m_dynamic_object->relocation_section().for_each_relocation([&](const DynamicObject::Relocation& relocation) {
+        if (relocation.symbol_index() == 0)
+            do_single_relocation(relocation);
+        else
+            symbol_relocations.append(relocation);
+    });
+
+    Vector<size_t> relocation_order;
+    relocation_order.ensure_capacity(symbol_relocations.size());
+    for (size_t i = 0; i < symbol_relocations.size(); ++i)
+        relocation_order.unchecked_append(i);
+    quick_sort(relocation_order, [&](size_t a, size_t b) {
+        return symbol_relocations[a].symbol_index() < symbol_relocations[b].symbol_index();
+    });
+    for (auto index : relocation_order)
+        do_single_relocation(symbol_relocations[index]);
+
     m_dynamic_object->plt_relocation_section().for_each_relocation(do_single_relocation);
 }
 
@@ -235,6 +261,7 @@ void DynamicLoader::load_stage_4()
 
 void DynamicLoader::do_lazy_relocations()
 {
+    m_last_symbol_lookup_index = 0;
     for (const auto& relocation : m_unresolved_relocations) {
         if (auto res = do_relocation(relocation, ShouldInitializeWeak::Yes); res != RelocationResult::Success) {
             dbgln("Loader.so: {} unresolved symbol '{}'", m_filename, relocation.symbol().name());
@@ -412,7 +439,7 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
     case R_X86_64_64: {
 #endif
         auto symbol = relocation.symbol();
-        auto res = lookup_symbol(symbol);
+        auto res = lookup_symbol_for_relocation(relocation);
         if (!res.has_value()) {
             if (symbol.bind() == STB_WEAK)
                 return RelocationResult::ResolveLater;
@@ -428,8 +455,7 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
     }
 #if ARCH(I386)
     case R_386_PC32: {
-        auto symbol = relocation.symbol();
-        auto result = lookup_symbol(symbol);
+        auto result = lookup_symbol_for_relocation(relocation);
         if (!result.has_value())
             return RelocationResult::Failed;
         auto relative_offset = result.value().address - m_dynamic_object->base_address().offset(relocation.offset());
@@ -441,7 +467,7 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
     case R_X86_64_GLOB_DAT: {
 #endif
         auto symbol = relocation.symbol();
-        auto res = lookup_symbol(symbol);
+        auto res = lookup_symbol_for_relocation(relocation);
         VirtualAddress symbol_location;
         if (!res.has_value()) {
             if (symbol.bind() == STB_WEAK) {
@@ -464,9 +490,8 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
 #else
     case R_X86_64_RELATIVE: {
 #endif
-        // FIXME: According to the spec, R_386_relative ones must be done first.
-        //     We could explicitly do them first using m_number_of_relocations from DT_RELCOUNT
-        //     However, our compiler is nice enough to put them at the front of the relocations for us :)
+        // NOTE: According to the spec, R_386_relative ones must be done first.
+        //       do_main_relocations() applies all relocations without a symbol before the others.
         if (relocation.addend_used())
             *patch_ptr = m_dynamic_object->base_address().offset(relocation.addend()).get();
         else
@@ -479,11 +504,10 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
 #else
     case R_X86_64_TPOFF64: {
 #endif
-        auto symbol = relocation.symbol();
         FlatPtr symbol_value;
         DynamicObject const* dynamic_object_of_symbol;
         if (relocation.symbol_index() != 0) {
-            auto res = lookup_symbol(symbol);
+            auto res = lookup_symbol_for_relocation(relocation);
             if (!res.has_value())
                 break;
             symbol_value = res.value().value;
@@ -502,11 +526,20 @@ DynamicLoader::RelocationResult DynamicLoader::do_relocation(const ELF::DynamicO
 #else
     case R_X86_64_JUMP_SLOT: {
 #endif
-        // FIXME: Or BIND_NOW flag passed in?
-        if (m_dynamic_object->must_bind_now()) {
-            // Eagerly BIND_NOW the PLT entries, doing all the symbol looking goodness
-            // The patch method returns the address for the LAZY fixup path, but we don't need it here
-            m_dynamic_object->patch_plt_entry(relocation.offset_in_section());
+        if (m_bind_now) {
+            // Eagerly BIND_NOW the PLT entries, doing all the symbol looking goodness.
+            // This goes through the same lookup as the other relocations, so the result is cached,
+            // and patch_plt_entry() is left to the lazy fixup path.
+            auto symbol = relocation.symbol();
+            auto res = lookup_symbol_for_relocation(relocation);
+            VirtualAddress symbol_location;
+            if (res.has_value()) {
+                symbol_location = res.value().address;
+            } else if (symbol.bind() != STB_WEAK) {
+                dbgln("did not find symbol while doing relocations for library {}: {}", m_filename, symbol.name());
+                return RelocationResult::Failed;
+            }
+            *(FlatPtr*)relocation.address().as_ptr() = symbol_location.get();
         } else {
             auto relocation_address = (FlatPtr*)relocation.address().as_ptr();
 
@@ -608,6 +641,27 @@ void DynamicLoader::call_object_init_functions()
     }
 }
 
+Optional<DynamicObject::SymbolLookupResult> DynamicLoader::lookup_symbol_for_relocation(const DynamicObject::Relocation& relocation)
+{
+    if (relocation.symbol_index() == m_last_symbol_lookup_index)
+        return m_last_symbol_lookup_result;
+
+    m_last_symbol_lookup_index = relocation.symbol_index();
+
+    auto* prelinked_symbol = binary_search(m_prelinked_symbols, ResolvedSymbol { relocation.symbol_index(), {} }, nullptr, [](auto& a, auto& b) {
+        return static_cast<int>(a.symbol_index) - static_cast<int>(b.symbol_index);
+    });
+    if (prelinked_symbol) {
+        m_last_symbol_lookup_result = prelinked_symbol->result;
+        return m_last_symbol_lookup_result;
+    }
+
+    m_last_symbol_lookup_result = lookup_symbol(relocation.symbol());
+    if (m_should_record_resolved_symbols)
+        m_resolved_symbols.append({ relocation.symbol_index(), m_last_symbol_lookup_result });
+    return m_last_symbol_lookup_result;
+}
+
 Optional<DynamicObject::SymbolLookupResult> DynamicLoader::lookup_symbol(const ELF::DynamicObject::Symbol& symbol)
 {
     if (symbol.is_undefined() || symbol.bind() == STB_WEAK)
@@ -616,4 +670,12 @@ Optional<DynamicObject::SymbolLookupResult> DynamicLoader::lookup_symbol(const E
     return DynamicObject::SymbolLookupResult { symbol.value(), symbol.size(), symbol.address(), symbol.bind(), &symbol.object() };
 }
 
+Optional<DynamicObject::SymbolLookupResult> DynamicLoader::lookup_symbol_for_lazy_binding(const ELF::DynamicObject::Symbol& symbol)
+{
+    if (symbol.is_undefined() || symbol.bind() == STB_WEAK)
+        return DynamicLinker::lookup_global_symbol_for_lazy_binding(symbol.name());
+
+    return DynamicObject::SymbolLookupResult { symbol.value(), symbol.size(), symbol.address(), symbol.bind(), &symbol.object() };
+}
+
 } // end namespace ELF
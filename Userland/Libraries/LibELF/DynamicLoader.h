@@ -16,6 +16,7 @@
 #include <LibELF/DynamicObject.h>
 #include <LibELF/Image.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace ELF {
 
@@ -78,8 +79,24 @@ public:
     bool is_dynamic() const { return m_elf_image.is_dynamic(); }
 
     static Optional<DynamicObject::SymbolLookupResult> lookup_symbol(const ELF::DynamicObject::Symbol&);
+    // Runs on any thread whenever a PLT entry is first called. It doesn't allocate, and only takes the symbol cache lock.
+    static Optional<DynamicObject::SymbolLookupResult> lookup_symbol_for_lazy_binding(const ELF::DynamicObject::Symbol&);
     void copy_initial_tls_data_into(ByteBuffer& buffer) const;
 
+    const struct stat& file_stat() const { return m_file_stat; }
+
+    struct ResolvedSymbol {
+        unsigned symbol_index { 0 };
+        Optional<DynamicObject::SymbolLookupResult> result;
+    };
+
+    // Resolve symbols for relocations from this list (sorted by symbol index) instead of looking them up.
+    void set_prelinked_symbols(Vector<ResolvedSymbol> symbols) { m_prelinked_symbols = move(symbols); }
+
+    // Keep track of the symbols resolved for relocations, so they can be prelinked next time.
+    void set_should_record_resolved_symbols(bool value) { m_should_record_resolved_symbols = value; }
+    const Vector<ResolvedSymbol>& resolved_symbols() const { return m_resolved_symbols; }
+
 private:
     DynamicLoader(int fd, String filename, void* file_data, size_t file_size);
 
@@ -130,6 +147,7 @@ private:
         ResolveLater = 2,
     };
     RelocationResult do_relocation(const DynamicObject::Relocation&, ShouldInitializeWeak should_initialize_weak);
+    Optional<DynamicObject::SymbolLookupResult> lookup_symbol_for_relocation(const DynamicObject::Relocation&);
     size_t calculate_tls_size() const;
     ssize_t negative_offset_from_tls_block_end(ssize_t tls_offset, size_t value_of_symbol) const;
 
@@ -156,6 +174,18 @@ private:
 
     Vector<DynamicObject::Relocation> m_unresolved_relocations;
 
+    bool m_bind_now { false };
+
+    // Relocations are applied grouped by symbol, so remembering the last lookup saves most of them.
+    unsigned m_last_symbol_lookup_index { 0 };
+    Optional<DynamicObject::SymbolLookupResult> m_last_symbol_lookup_result;
+
+    Vector<ResolvedSymbol> m_prelinked_symbols;
+    bool m_should_record_resolved_symbols { false };
+    Vector<ResolvedSymbol> m_resolved_symbols;
+
+    struct stat m_file_stat {};
+
     mutable RefPtr<DynamicObject> m_cached_dynamic_object;
 };
 
@@ -463,7 +463,7 @@ VirtualAddress DynamicObject::patch_plt_entry(u32 relocation_offset)
     auto relocation_address = (FlatPtr*)relocation.address().as_ptr();
 
     VirtualAddress symbol_location;
-    auto result = DynamicLoader::lookup_symbol(symbol);
+    auto result = DynamicLoader::lookup_symbol_for_lazy_binding(symbol);
     if (result.has_value()) {
         symbol_location = result.value().address;
     } else if (symbol.bind() != STB_WEAK) {
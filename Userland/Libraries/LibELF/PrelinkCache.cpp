@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/MemoryStream.h>
+#include <AK/ScopeGuard.h>
+#include <LibELF/PrelinkCache.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ELF {
+
+// The cache is only ever read on the machine that wrote it, so everything is stored in native byte order.
+static constexpr u8 prelink_cache_magic[] = { 'P', 'R', 'E', 'L', 'I', 'N', 'K', 0 };
+static constexpr u32 prelink_cache_version = 1;
+
+static constexpr size_t serialized_object_size = sizeof(u32) + 5 * sizeof(u64) + sizeof(u32);
+static constexpr size_t serialized_symbol_size = 2 * sizeof(u32) + 2 * sizeof(u64) + sizeof(u8);
+
+PrelinkCache::Object PrelinkCache::Object::from_stat(String name, const struct stat& stat)
+{
+    return { move(name), static_cast<u64>(stat.st_dev), static_cast<u64>(stat.st_ino), stat.st_mtim.tv_sec, stat.st_mtim.tv_nsec, static_cast<u64>(stat.st_size) };
+}
+
+PrelinkCache::PrelinkCache(Vector<Object> objects)
+    : m_objects(move(objects))
+{
+    m_symbols.resize(m_objects.size());
+}
+
+Optional<PrelinkCache> PrelinkCache::try_load(const String& path)
+{
+    int fd = open(path.characters(), O_RDONLY);
+    if (fd < 0)
+        return {};
+    ScopeGuard close_guard = [fd] { close(fd); };
+
+    struct stat stat;
+    if (fstat(fd, &stat) < 0)
+        return {};
+
+    // Whoever can write the cache gets to decide what the program's symbols resolve to.
+    if (!S_ISREG(stat.st_mode) || stat.st_uid != geteuid() || (stat.st_mode & (S_IWGRP | S_IWOTH)))
+        return {};
+
+    auto buffer = ByteBuffer::create_uninitialized(stat.st_size);
+    size_t nread = 0;
+    while (nread < buffer.size()) {
+        auto rc = read(fd, buffer.data() + nread, buffer.size() - nread);
+        if (rc <= 0)
+            return {};
+        nread += rc;
+    }
+
+    InputMemoryStream stream { buffer };
+
+    u8 magic[sizeof(prelink_cache_magic)];
+    u32 version = 0;
+    u32 object_count = 0;
+    stream >> Bytes { magic, sizeof(magic) } >> version >> object_count;
+    if (stream.handle_any_error() || memcmp(magic, prelink_cache_magic, sizeof(magic)) != 0 || version != prelink_cache_version)
+        return {};
+    if (object_count > stream.remaining() / serialized_object_size)
+        return {};
+
+    Vector<Object> objects;
+    Vector<u32> symbol_counts;
+    objects.ensure_capacity(object_count);
+    symbol_counts.ensure_capacity(object_count);
+    for (u32 i = 0; i < object_count; ++i) {
+        u32 name_length = 0;
+        stream >> name_length;
+        if (stream.handle_any_error() || name_length > stream.remaining())
+            return {};
+        Object object;
+        object.name = String { stream.bytes().slice(stream.offset(), name_length) };
+        stream.discard_or_error(name_length);
+
+        u32 symbol_count = 0;
+        stream >> object.device >> object.inode >> object.modification_time_seconds >> object.modification_time_nanoseconds >> object.size >> symbol_count;
+        if (stream.handle_any_error())
+            return {};
+        objects.unchecked_append(move(object));
+        symbol_counts.unchecked_append(symbol_count);
+    }
+
+    PrelinkCache cache { move(objects) };
+    for (u32 i = 0; i < object_count; ++i) {
+        if (symbol_counts[i] > stream.remaining() / serialized_symbol_size)
+            return {};
+
+        Vector<Symbol> symbols;
+        symbols.ensure_capacity(symbol_counts[i]);
+        for (u32 j = 0; j < symbol_counts[i]; ++j) {
+            Symbol symbol;
+            stream >> symbol.symbol_index >> symbol.object_index >> symbol.value >> symbol.size >> symbol.bind;
+            if (symbol.object_index >= object_count && symbol.object_index != unresolved_object_index)
+                return {};
+            if (!symbols.is_empty() && symbols.last().symbol_index >= symbol.symbol_index)
+                return {};
+            symbols.unchecked_append(symbol);
+        }
+        cache.set_symbols_of(i, move(symbols));
+    }
+
+    if (stream.handle_any_error() || !stream.eof())
+        return {};
+    return cache;
+}
+
+bool PrelinkCache::save(const String& path) const
+{
+    DuplexMemoryStream stream;
+    stream << ReadonlyBytes { prelink_cache_magic, sizeof(prelink_cache_magic) } << prelink_cache_version << static_cast<u32>(m_objects.size());
+    for (size_t i = 0; i < m_objects.size(); ++i) {
+        auto& object = m_objects[i];
+        stream << static_cast<u32>(object.name.length()) << object.name.bytes();
+        stream << object.device << object.inode << object.modification_time_seconds << object.modification_time_nanoseconds << object.size;
+        stream << static_cast<u32>(m_symbols[i].size());
+    }
+    for (auto& symbols : m_symbols) {
+        for (auto& symbol : symbols)
+            stream << symbol.symbol_index << symbol.object_index << symbol.value << symbol.size << symbol.bind;
+    }
+    auto buffer = stream.copy_into_contiguous_buffer();
+
+    // Write to a temporary file first, so that nobody ever sees a partially written cache.
+    auto temporary_path = String::formatted("{}.{}", path, getpid());
+    int fd = open(temporary_path.characters(), O_WRONLY | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        return false;
+
+    size_t nwritten = 0;
+    while (nwritten < buffer.size()) {
+        auto rc = write(fd, buffer.data() + nwritten, buffer.size() - nwritten);
+        if (rc <= 0) {
+            close(fd);
+            unlink(temporary_path.characters());
+            return false;
+        }
+        nwritten += rc;
+    }
+    close(fd);
+
+    if (rename(temporary_path.characters(), path.characters()) < 0) {
+        unlink(temporary_path.characters());
+        return false;
+    }
+    return true;
+}
+
+}
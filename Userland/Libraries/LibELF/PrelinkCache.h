@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <sys/stat.h>
+
+namespace ELF {
+
+// The symbol bindings from the last time a program was linked, along with the identity of every object that took part.
+// Objects are mapped at randomized addresses, so the bindings refer to the defining object by its index in the load
+// order and are applied against wherever the objects end up this time.
+class PrelinkCache {
+public:
+    struct Object {
+        String name;
+        u64 device { 0 };
+        u64 inode { 0 };
+        i64 modification_time_seconds { 0 };
+        i64 modification_time_nanoseconds { 0 };
+        u64 size { 0 };
+
+        static Object from_stat(String name, const struct stat&);
+
+        bool operator==(const Object&) const = default;
+    };
+
+    static constexpr u32 unresolved_object_index = NumericLimits<u32>::max();
+
+    struct Symbol {
+        u32 symbol_index { 0 };
+        // The object the symbol is defined in, or unresolved_object_index for weak symbols that were not found.
+        u32 object_index { unresolved_object_index };
+        u64 value { 0 };
+        u64 size { 0 };
+        u8 bind { 0 };
+    };
+
+    explicit PrelinkCache(Vector<Object> objects);
+
+    // Returns nothing if the file doesn't exist, is malformed, or could have been written by someone else.
+    static Optional<PrelinkCache> try_load(const String& path);
+    bool save(const String& path) const;
+
+    const Vector<Object>& objects() const { return m_objects; }
+
+    // The bindings can only be reused if the same files are linked in the same order, and none of them has changed since.
+    bool is_up_to_date(const Vector<Object>& objects) const { return m_objects == objects; }
+
+    // Sorted by symbol index.
+    const Vector<Symbol>& symbols_of(size_t object_index) const { return m_symbols[object_index]; }
+    void set_symbols_of(size_t object_index, Vector<Symbol> symbols) { m_symbols[object_index] = move(symbols); }
+
+private:
+    Vector<Object> m_objects;
+    Vector<Vector<Symbol>> m_symbols;
+};
+
+}
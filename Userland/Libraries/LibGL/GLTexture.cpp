@@ -25,6 +25,11 @@ void glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei widt
     g_gl_context->gl_tex_image_2d(target, level, internalFormat, width, height, border, format, type, data);
 }
 
+void glGenerateMipmap(GLenum target)
+{
+    g_gl_context->gl_generate_mipmap(target);
+}
+
 void glBindTexture(GLenum target, GLuint texture)
 {
     g_gl_context->gl_bind_texture(target, texture);
@@ -231,6 +231,7 @@ void SoftwareGLContext::gl_end()
         }
     }
 
+    size_t visible_triangle_count = 0;
     for (size_t i = 0; i < processed_triangles.size(); i++) {
         GLTriangle& triangle = processed_triangles.at(i);
 
@@ -259,9 +260,12 @@ void SoftwareGLContext::gl_end()
             swap(triangle.vertices[0], triangle.vertices[1]);
         }
 
-        m_rasterizer.submit_triangle(triangle, m_texture_units);
+        processed_triangles.at(visible_triangle_count++) = triangle;
     }
 
+    processed_triangles.shrink(visible_triangle_count, true);
+    m_rasterizer.submit_triangles(processed_triangles, m_texture_units);
+
     m_in_draw_state = false;
 }
 
@@ -653,6 +657,20 @@ void SoftwareGLContext::gl_tex_image_2d(GLenum target, GLint level, GLint intern
     m_active_texture_unit->bound_texture_2d()->upload_texture_data(target, level, internal_format, width, height, border, format, type, data, m_unpack_row_length);
 }
 
+void SoftwareGLContext::gl_generate_mipmap(GLenum target)
+{
+    RETURN_WITH_ERROR_IF(m_in_draw_state, GL_INVALID_OPERATION);
+
+    // We only support GL_TEXTURE_2D for now
+    RETURN_WITH_ERROR_IF(target != GL_TEXTURE_2D, GL_INVALID_ENUM);
+
+    auto texture2d = m_active_texture_unit->bound_texture_2d();
+    if (texture2d.is_null())
+        return;
+
+    texture2d->generate_mipmaps();
+}
+
 void SoftwareGLContext::gl_tex_parameter(GLenum target, GLenum pname, GLfloat param)
 {
     APPEND_TO_CALL_LIST_AND_RETURN_IF_NEEDED(gl_tex_parameter, target, pname, param);
@@ -6,17 +6,39 @@
 
 #include "SoftwareRasterizer.h"
 #include <AK/Function.h>
+#include <AK/SIMD.h>
 #include <LibGfx/Painter.h>
 #include <LibGfx/Vector2.h>
 #include <LibGfx/Vector3.h>
+#include <LibThreading/WorkerPool.h>
+#include <unistd.h>
 
 namespace GL {
 
 using IntVector2 = Gfx::Vector2<int>;
 using IntVector3 = Gfx::Vector3<int>;
+using AK::SIMD::f32x4;
+using AK::SIMD::i32x4;
 
 static constexpr int RASTERIZER_BLOCK_SIZE = 16;
 
+// Triangles are sorted into square tiles of this size, which are then rasterized in parallel.
+static constexpr int RASTERIZER_TILE_SIZE = 4 * RASTERIZER_BLOCK_SIZE;
+
+static constexpr size_t max_rasterizer_worker_threads = 15;
+
+// Coverage and depth are evaluated for this many horizontally adjacent pixels at a time.
+static constexpr int RASTERIZER_LANE_COUNT = 4;
+static_assert(RASTERIZER_BLOCK_SIZE % RASTERIZER_LANE_COUNT == 0);
+
+static constexpr i32x4 lane_offsets { 0, 1, 2, 3 };
+
+// Vector comparisons yield -1 in the lanes where they hold and 0 in the others.
+static ALWAYS_INLINE int lane_mask(i32x4 lanes)
+{
+    return (lanes[0] & 1) | (lanes[1] & 2) | (lanes[2] & 4) | (lanes[3] & 8);
+}
+
 constexpr static int edge_function(const IntVector2& a, const IntVector2& b, const IntVector2& c)
 {
     return ((c.x() - a.x()) * (b.y() - a.y()) - (c.y() - a.y()) * (b.x() - a.x()));
@@ -104,8 +126,9 @@ static constexpr void setup_blend_factors(GLenum mode, FloatVector4& constant, f
     }
 }
 
+// Only the blocks within `tile` are touched, so triangles can be rasterized into different tiles at the same time.
 template<typename PS>
-static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& render_target, DepthBuffer& depth_buffer, const GLTriangle& triangle, PS pixel_shader)
+static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& render_target, DepthBuffer& depth_buffer, const GLTriangle& triangle, const Gfx::IntRect& tile, PS pixel_shader)
 {
     // Since the algorithm is based on blocks of uniform size, we need
     // to ensure that our render_target size is actually a multiple of the block size
@@ -182,12 +205,50 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
             && edges.z() >= zero.z();
     };
 
+    struct Fragment {
+        FloatVector4 color;
+        FloatVector2 uv;
+        float z;
+    };
+
+    // This function interpolates the vertex attributes for the pixel with the given edge values.
+    auto interpolate_fragment = [&](const IntVector3& coords) -> Fragment {
+        // Perspective correct barycentric coordinates
+        auto barycentric = FloatVector3(coords.x(), coords.y(), coords.z()) * one_over_area;
+        float interpolated_reciprocal_w = interpolate(triangle.vertices[0].position.w(), triangle.vertices[1].position.w(), triangle.vertices[2].position.w(), barycentric);
+        float interpolated_w = 1 / interpolated_reciprocal_w;
+        barycentric = barycentric * FloatVector3(triangle.vertices[0].position.w(), triangle.vertices[1].position.w(), triangle.vertices[2].position.w()) * interpolated_w;
+
+        // FIXME: make this more generic. We want to interpolate more than just color and uv
+        Fragment fragment;
+        if (options.shade_smooth) {
+            fragment.color = interpolate(
+                triangle.vertices[0].color,
+                triangle.vertices[1].color,
+                triangle.vertices[2].color,
+                barycentric);
+        } else {
+            fragment.color = triangle.vertices[0].color;
+        }
+
+        fragment.uv = interpolate(
+            triangle.vertices[0].tex_coord,
+            triangle.vertices[1].tex_coord,
+            triangle.vertices[2].tex_coord,
+            barycentric);
+
+        // Calculate depth of fragment for fog
+        fragment.z = interpolate(triangle.vertices[0].position.z(), triangle.vertices[1].position.z(), triangle.vertices[2].position.z(), barycentric);
+        fragment.z = options.depth_min + (options.depth_max - options.depth_min) * (fragment.z + 1) / 2;
+        return fragment;
+    };
+
     // Calculate block-based bounds
     // clang-format off
-    const int bx0 = max(0,                      min(min(v0.x(), v1.x()), v2.x())                            ) / RASTERIZER_BLOCK_SIZE;
-    const int bx1 = min(render_target.width(),  max(max(v0.x(), v1.x()), v2.x()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
-    const int by0 = max(0,                      min(min(v0.y(), v1.y()), v2.y())                            ) / RASTERIZER_BLOCK_SIZE;
-    const int by1 = min(render_target.height(), max(max(v0.y(), v1.y()), v2.y()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
+    const int bx0 = max(tile.left(),       min(min(v0.x(), v1.x()), v2.x())                            ) / RASTERIZER_BLOCK_SIZE;
+    const int bx1 = min(tile.right() + 1,  max(max(v0.x(), v1.x()), v2.x()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
+    const int by0 = max(tile.top(),        min(min(v0.y(), v1.y()), v2.y())                            ) / RASTERIZER_BLOCK_SIZE;
+    const int by1 = min(tile.bottom() + 1, max(max(v0.y(), v1.y()), v2.y()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
     // clang-format on
 
     static_assert(RASTERIZER_BLOCK_SIZE < sizeof(int) * 8, "RASTERIZER_BLOCK_SIZE must be smaller than the pixel_mask's width in bits");
@@ -222,8 +283,6 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
             // edge value derivatives
             auto dbdx = (b1 - b0) / RASTERIZER_BLOCK_SIZE;
             auto dbdy = (b2 - b0) / RASTERIZER_BLOCK_SIZE;
-            // step edge value after each horizontal span: 1 down, BLOCK_SIZE left
-            auto step_y = dbdy - dbdx * RASTERIZER_BLOCK_SIZE;
 
             int x0 = bx * RASTERIZER_BLOCK_SIZE;
             int y0 = by * RASTERIZER_BLOCK_SIZE;
@@ -238,98 +297,115 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
                 // The block overlaps at least one triangle edge.
                 // We need to test coverage of every pixel within the block.
                 auto coords = b0;
-                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += step_y) {
+                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += dbdy) {
                     pixel_mask[y] = 0;
 
-                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x++, coords += dbdx) {
-                        if (test_point(coords))
-                            pixel_mask[y] |= 1 << x;
+                    i32x4 edge_x = coords.x() + lane_offsets * dbdx.x();
+                    i32x4 edge_y = coords.y() + lane_offsets * dbdx.y();
+                    i32x4 edge_z = coords.z() + lane_offsets * dbdx.z();
+                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x += RASTERIZER_LANE_COUNT) {
+                        pixel_mask[y] |= lane_mask((edge_x >= zero.x()) & (edge_y >= zero.y()) & (edge_z >= zero.z())) << x;
+                        edge_x += dbdx.x() * RASTERIZER_LANE_COUNT;
+                        edge_y += dbdx.y() * RASTERIZER_LANE_COUNT;
+                        edge_z += dbdx.z() * RASTERIZER_LANE_COUNT;
                     }
                 }
             }
 
             // AND the depth mask onto the coverage mask
             if (options.enable_depth_test) {
-                int z_pass_count = 0;
+                bool any_pixel_passed = false;
                 auto coords = b0;
 
-                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += step_y) {
-                    if (pixel_mask[y] == 0) {
-                        coords += dbdx * RASTERIZER_BLOCK_SIZE;
+                for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += dbdy) {
+                    if (pixel_mask[y] == 0)
                         continue;
-                    }
 
                     auto* depth = &depth_buffer.scanline(y0 + y)[x0];
-                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x++, coords += dbdx, depth++) {
-                        if (~pixel_mask[y] & (1 << x))
-                            continue;
-
-                        auto barycentric = FloatVector3(coords.x(), coords.y(), coords.z()) * one_over_area;
-                        float z = interpolate(triangle.vertices[0].position.z(), triangle.vertices[1].position.z(), triangle.vertices[2].position.z(), barycentric);
-
-                        z = options.depth_min + (options.depth_max - options.depth_min) * (z + 1) / 2;
-
-                        bool pass = false;
-                        switch (options.depth_func) {
-                        case GL_ALWAYS:
-                            pass = true;
-                            break;
-                        case GL_NEVER:
-                            pass = false;
-                            break;
-                        case GL_GREATER:
-                            pass = z > *depth;
-                            break;
-                        case GL_GEQUAL:
-                            pass = z >= *depth;
-                            break;
-                        case GL_NOTEQUAL:
+                    i32x4 edge_x = coords.x() + lane_offsets * dbdx.x();
+                    i32x4 edge_y = coords.y() + lane_offsets * dbdx.y();
+                    i32x4 edge_z = coords.z() + lane_offsets * dbdx.z();
+                    for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x += RASTERIZER_LANE_COUNT, depth += RASTERIZER_LANE_COUNT) {
+                        int coverage = (pixel_mask[y] >> x) & 0xf;
+                        if (coverage) {
+                            f32x4 barycentric_x = __builtin_convertvector(edge_x, f32x4) * one_over_area;
+                            f32x4 barycentric_y = __builtin_convertvector(edge_y, f32x4) * one_over_area;
+                            f32x4 barycentric_z = __builtin_convertvector(edge_z, f32x4) * one_over_area;
+                            f32x4 z = triangle.vertices[0].position.z() * barycentric_x + triangle.vertices[1].position.z() * barycentric_y + triangle.vertices[2].position.z() * barycentric_z;
+
+                            z = options.depth_min + (options.depth_max - options.depth_min) * (z + 1) / 2;
+
+                            f32x4 stored_depth;
+                            __builtin_memcpy(&stored_depth, depth, sizeof(stored_depth));
+
+                            i32x4 pass {};
+                            switch (options.depth_func) {
+                            case GL_ALWAYS:
+                                pass = i32x4 { -1, -1, -1, -1 };
+                                break;
+                            case GL_NEVER:
+                                break;
+                            case GL_GREATER:
+                                pass = z > stored_depth;
+                                break;
+                            case GL_GEQUAL:
+                                pass = z >= stored_depth;
+                                break;
+                            case GL_NOTEQUAL:
 #ifdef __SSE__
-                            pass = z != *depth;
+                                pass = z != stored_depth;
 #else
-                            pass = bit_cast<u32>(z) != bit_cast<u32>(*depth);
+                                pass = (i32x4)z != (i32x4)stored_depth;
 #endif
-                            break;
-                        case GL_EQUAL:
+                                break;
+                            case GL_EQUAL:
 #ifdef __SSE__
-                            pass = z == *depth;
+                                pass = z == stored_depth;
 #else
-                            //
-                            // This is an interesting quirk that occurs due to us using the x87 FPU when Serenity is
-                            // compiled for the i386 target. When we calculate our depth value to be stored in the buffer,
-                            // it is an 80-bit x87 floating point number, however, when stored into the DepthBuffer, this is
-                            // truncated to 32 bits. This 38 bit loss of precision means that when x87 `FCOMP` is eventually
-                            // used here the comparison fails.
-                            // This could be solved by using a `long double` for the depth buffer, however this would take
-                            // up significantly more space and is completely overkill for a depth buffer. As such, comparing
-                            // the first 32-bits of this depth value is "good enough" that if we get a hit on it being
-                            // equal, we can pretty much guarantee that it's actually equal.
-                            //
-                            pass = bit_cast<u32>(z) == bit_cast<u32>(*depth);
+                                //
+                                // This is an interesting quirk that occurs due to us using the x87 FPU when Serenity is
+                                // compiled for the i386 target. When we calculate our depth value to be stored in the buffer,
+                                // it is an 80-bit x87 floating point number, however, when stored into the DepthBuffer, this is
+                                // truncated to 32 bits. This 38 bit loss of precision means that when x87 `FCOMP` is eventually
+                                // used here the comparison fails.
+                                // This could be solved by using a `long double` for the depth buffer, however this would take
+                                // up significantly more space and is completely overkill for a depth buffer. As such, comparing
+                                // the first 32-bits of this depth value is "good enough" that if we get a hit on it being
+                                // equal, we can pretty much guarantee that it's actually equal.
+                                //
+                                pass = (i32x4)z == (i32x4)stored_depth;
 #endif
-                            break;
-                        case GL_LEQUAL:
-                            pass = z <= *depth;
-                            break;
-                        case GL_LESS:
-                            pass = z < *depth;
-                            break;
-                        }
-
-                        if (!pass) {
-                            pixel_mask[y] ^= 1 << x;
-                            continue;
+                                break;
+                            case GL_LEQUAL:
+                                pass = z <= stored_depth;
+                                break;
+                            case GL_LESS:
+                                pass = z < stored_depth;
+                                break;
+                            }
+
+                            int passed = lane_mask(pass) & coverage;
+                            pixel_mask[y] &= ~((coverage & ~passed) << x);
+
+                            if (passed) {
+                                if (options.enable_depth_write) {
+                                    for (int lane = 0; lane < RASTERIZER_LANE_COUNT; lane++) {
+                                        if (passed & (1 << lane))
+                                            depth[lane] = z[lane];
+                                    }
+                                }
+                                any_pixel_passed = true;
+                            }
                         }
 
-                        if (options.enable_depth_write)
-                            *depth = z;
-
-                        z_pass_count++;
+                        edge_x += dbdx.x() * RASTERIZER_LANE_COUNT;
+                        edge_y += dbdx.y() * RASTERIZER_LANE_COUNT;
+                        edge_z += dbdx.z() * RASTERIZER_LANE_COUNT;
                     }
                 }
 
                 // Nice, no pixels passed the depth test -> block rejected by early z
-                if (z_pass_count == 0)
+                if (!any_pixel_passed)
                     continue;
             }
 
@@ -337,48 +413,36 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
             if (!options.color_mask)
                 continue;
 
-            // Draw the pixels according to the previously generated mask
-            auto coords = b0;
-            for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y++, coords += step_y) {
-                if (pixel_mask[y] == 0) {
-                    coords += dbdx * RASTERIZER_BLOCK_SIZE;
+            // Draw the pixels according to the previously generated mask.
+            // They are shaded in 2x2 quads, so that the texture coordinate derivatives can be taken across each quad.
+            for (int y = 0; y < RASTERIZER_BLOCK_SIZE; y += 2) {
+                int quad_rows_mask = pixel_mask[y] | pixel_mask[y + 1];
+                if (quad_rows_mask == 0)
                     continue;
-                }
 
-                auto* pixel = pixel_buffer[y];
-                for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x++, coords += dbdx, pixel++) {
-                    if (~pixel_mask[y] & (1 << x))
+                for (int x = 0; x < RASTERIZER_BLOCK_SIZE; x += 2) {
+                    if (((quad_rows_mask >> x) & 3) == 0)
                         continue;
 
-                    // Perspective correct barycentric coordinates
-                    auto barycentric = FloatVector3(coords.x(), coords.y(), coords.z()) * one_over_area;
-                    float interpolated_reciprocal_w = interpolate(triangle.vertices[0].position.w(), triangle.vertices[1].position.w(), triangle.vertices[2].position.w(), barycentric);
-                    float interpolated_w = 1 / interpolated_reciprocal_w;
-                    barycentric = barycentric * FloatVector3(triangle.vertices[0].position.w(), triangle.vertices[1].position.w(), triangle.vertices[2].position.w()) * interpolated_w;
-
-                    // FIXME: make this more generic. We want to interpolate more than just color and uv
-                    FloatVector4 vertex_color;
-                    if (options.shade_smooth) {
-                        vertex_color = interpolate(
-                            triangle.vertices[0].color,
-                            triangle.vertices[1].color,
-                            triangle.vertices[2].color,
-                            barycentric);
-                    } else {
-                        vertex_color = triangle.vertices[0].color;
-                    }
-
-                    auto uv = interpolate(
-                        triangle.vertices[0].tex_coord,
-                        triangle.vertices[1].tex_coord,
-                        triangle.vertices[2].tex_coord,
-                        barycentric);
-
-                    // Calculate depth of fragment for fog
-                    float z = interpolate(triangle.vertices[0].position.z(), triangle.vertices[1].position.z(), triangle.vertices[2].position.z(), barycentric);
-                    z = options.depth_min + (options.depth_max - options.depth_min) * (z + 1) / 2;
+                    // Uncovered pixels of the quad are still interpolated, since the derivatives need all four of them.
+                    Fragment quad[4];
+                    auto quad_coords = b0 + dbdx * x + dbdy * y;
+                    quad[0] = interpolate_fragment(quad_coords);
+                    quad[1] = interpolate_fragment(quad_coords + dbdx);
+                    quad[2] = interpolate_fragment(quad_coords + dbdy);
+                    quad[3] = interpolate_fragment(quad_coords + dbdx + dbdy);
+
+                    auto duv_dx = quad[1].uv - quad[0].uv;
+                    auto duv_dy = quad[2].uv - quad[0].uv;
+
+                    for (int i = 0; i < 4; i++) {
+                        int pixel_x = x + (i & 1);
+                        int pixel_y = y + (i >> 1);
+                        if (~pixel_mask[pixel_y] & (1 << pixel_x))
+                            continue;
 
-                    *pixel = pixel_shader(uv, vertex_color, z);
+                        pixel_buffer[pixel_y][pixel_x] = pixel_shader(quad[i].uv, duv_dx, duv_dy, quad[i].color, quad[i].z);
+                    }
                 }
             }
 
@@ -478,11 +542,74 @@ SoftwareRasterizer::SoftwareRasterizer(const Gfx::IntSize& min_size)
     : m_render_target { Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, closest_multiple(min_size, RASTERIZER_BLOCK_SIZE)) }
     , m_depth_buffer { adopt_own(*new DepthBuffer(closest_multiple(min_size, RASTERIZER_BLOCK_SIZE))) }
 {
+    if (auto processor_count = sysconf(_SC_NPROCESSORS_ONLN); processor_count > 1)
+        m_worker_pool = make<Threading::WorkerPool>(min(static_cast<size_t>(processor_count - 1), max_rasterizer_worker_threads), "Rasterizer");
+
+    resize_tile_bins();
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+}
+
+void SoftwareRasterizer::resize_tile_bins()
+{
+    m_tile_columns = (m_render_target->width() + RASTERIZER_TILE_SIZE - 1) / RASTERIZER_TILE_SIZE;
+    int tile_rows = (m_render_target->height() + RASTERIZER_TILE_SIZE - 1) / RASTERIZER_TILE_SIZE;
+    m_tile_bins.clear();
+    m_tile_bins.resize(m_tile_columns * tile_rows);
+}
+
+void SoftwareRasterizer::bin_triangles(Span<GLTriangle const> triangles)
+{
+    for (auto& bin : m_tile_bins)
+        bin.clear_with_capacity();
+
+    int width = m_render_target->width();
+    int height = m_render_target->height();
+
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        auto& vertices = triangles[i].vertices;
+        // NOTE: These have to be truncated the same way rasterize_triangle() does it.
+        int min_x = min(min((int)vertices[0].position.x(), (int)vertices[1].position.x()), (int)vertices[2].position.x());
+        int max_x = max(max((int)vertices[0].position.x(), (int)vertices[1].position.x()), (int)vertices[2].position.x());
+        int min_y = min(min((int)vertices[0].position.y(), (int)vertices[1].position.y()), (int)vertices[2].position.y());
+        int max_y = max(max((int)vertices[0].position.y(), (int)vertices[1].position.y()), (int)vertices[2].position.y());
+        if (max_x < 0 || max_y < 0 || min_x >= width || min_y >= height)
+            continue;
+
+        int first_column = max(min_x, 0) / RASTERIZER_TILE_SIZE;
+        int last_column = min(max_x, width - 1) / RASTERIZER_TILE_SIZE;
+        int first_row = max(min_y, 0) / RASTERIZER_TILE_SIZE;
+        int last_row = min(max_y, height - 1) / RASTERIZER_TILE_SIZE;
+        for (int row = first_row; row <= last_row; ++row) {
+            for (int column = first_column; column <= last_column; ++column)
+                m_tile_bins[row * m_tile_columns + column].append(i);
+        }
+    }
+
+    m_occupied_tiles.clear_with_capacity();
+    for (size_t tile = 0; tile < m_tile_bins.size(); ++tile) {
+        if (!m_tile_bins[tile].is_empty())
+            m_occupied_tiles.append(tile);
+    }
 }
 
 void SoftwareRasterizer::submit_triangle(const GLTriangle& triangle, const Array<TextureUnit, 32>& texture_units)
 {
-    rasterize_triangle(m_options, *m_render_target, *m_depth_buffer, triangle, [this, &texture_units](const FloatVector2& uv, const FloatVector4& color, float z) -> FloatVector4 {
+    submit_triangles({ &triangle, 1 }, texture_units);
+}
+
+void SoftwareRasterizer::submit_triangles(Span<GLTriangle const> triangles, const Array<TextureUnit, 32>& texture_units)
+{
+    if (triangles.is_empty())
+        return;
+
+    // Every tile keeps its triangles in submission order, so overlapping triangles are still drawn in order,
+    // while different tiles never touch the same pixels and can be rasterized by different threads.
+    bin_triangles(triangles);
+
+    auto pixel_shader = [this, &texture_units](const FloatVector2& uv, const FloatVector2& duv_dx, const FloatVector2& duv_dy, const FloatVector4& color, float z) -> FloatVector4 {
         FloatVector4 fragment = color;
 
         for (const auto& texture_unit : texture_units) {
@@ -492,7 +619,7 @@ void SoftwareRasterizer::submit_triangle(const GLTriangle& triangle, const Array
                 continue;
 
             // FIXME: Don't assume Texture2D
-            auto texel = texture_unit.bound_texture_2d()->sampler().sample(uv);
+            auto texel = texture_unit.bound_texture_2d()->sampler().sample(uv, duv_dx, duv_dy);
 
             // FIXME: Implement more blend modes
             switch (texture_unit.env_mode()) {
@@ -537,7 +664,27 @@ void SoftwareRasterizer::submit_triangle(const GLTriangle& triangle, const Array
         }
 
         return fragment;
-    });
+    };
+
+    auto rasterize_tile = [&](size_t index) {
+        auto tile = m_occupied_tiles[index];
+        Gfx::IntRect tile_rect {
+            static_cast<int>(tile % m_tile_columns) * RASTERIZER_TILE_SIZE,
+            static_cast<int>(tile / m_tile_columns) * RASTERIZER_TILE_SIZE,
+            RASTERIZER_TILE_SIZE,
+            RASTERIZER_TILE_SIZE,
+        };
+        tile_rect.intersect(m_render_target->rect());
+        for (auto triangle_index : m_tile_bins[tile])
+            rasterize_triangle(m_options, *m_render_target, *m_depth_buffer, triangles[triangle_index], tile_rect, pixel_shader);
+    };
+
+    if (m_worker_pool) {
+        m_worker_pool->for_each_index(m_occupied_tiles.size(), [&](size_t index) { rasterize_tile(index); });
+    } else {
+        for (size_t i = 0; i < m_occupied_tiles.size(); ++i)
+            rasterize_tile(i);
+    }
 }
 
 void SoftwareRasterizer::resize(const Gfx::IntSize& min_size)
@@ -546,6 +693,7 @@ void SoftwareRasterizer::resize(const Gfx::IntSize& min_size)
 
     m_render_target = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, closest_multiple(min_size, RASTERIZER_BLOCK_SIZE));
     m_depth_buffer = adopt_own(*new DepthBuffer(m_render_target->size()));
+    resize_tile_bins();
 }
 
 void SoftwareRasterizer::clear_color(const FloatVector4& color)
@@ -577,7 +725,7 @@ void SoftwareRasterizer::blit_to(Gfx::Bitmap& target)
 
 void SoftwareRasterizer::wait_for_all_threads() const
 {
-    // FIXME: Wait for all render threads to finish when multithreading is being implemented
+    // NOTE: submit_triangles() only returns once all tiles have been rasterized, so there is nothing to wait for.
 }
 
 void SoftwareRasterizer::set_options(const RasterizerOptions& options)
@@ -585,8 +733,6 @@ void SoftwareRasterizer::set_options(const RasterizerOptions& options)
     wait_for_all_threads();
 
     m_options = options;
-
-    // FIXME: Recreate or reinitialize render threads here when multithreading is being implemented
 }
 
 Gfx::RGBA32 SoftwareRasterizer::get_backbuffer_pixel(int x, int y)
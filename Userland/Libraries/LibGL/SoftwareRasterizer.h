@@ -13,9 +13,15 @@
 #include "Tex/TextureUnit.h"
 #include <AK/Array.h>
 #include <AK/OwnPtr.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Vector4.h>
 
+namespace Threading {
+class WorkerPool;
+}
+
 namespace GL {
 
 struct RasterizerOptions {
@@ -49,8 +55,10 @@ struct RasterizerOptions {
 class SoftwareRasterizer final {
 public:
     SoftwareRasterizer(const Gfx::IntSize& min_size);
+    ~SoftwareRasterizer();
 
     void submit_triangle(const GLTriangle& triangle, const Array<TextureUnit, 32>& texture_units);
+    void submit_triangles(Span<GLTriangle const> triangles, const Array<TextureUnit, 32>& texture_units);
     void submit_triangle(const GLTriangle& triangle);
     void resize(const Gfx::IntSize& min_size);
     void clear_color(const FloatVector4&);
@@ -63,9 +71,17 @@ public:
     float get_depthbuffer_value(int x, int y);
 
 private:
+    void resize_tile_bins();
+    void bin_triangles(Span<GLTriangle const>);
+
     RefPtr<Gfx::Bitmap> m_render_target;
     OwnPtr<DepthBuffer> m_depth_buffer;
     RasterizerOptions m_options;
+
+    OwnPtr<Threading::WorkerPool> m_worker_pool;
+    int m_tile_columns { 0 };
+    Vector<Vector<u32>> m_tile_bins;
+    Vector<size_t> m_occupied_tiles;
 };
 
 }
@@ -13,25 +13,41 @@
 
 namespace GL {
 
+// Texels are stored in tiles of 4x4, so that the texels a bilinear sample (or a whole 2x2 quad of them)
+// needs usually share a cache line instead of being spread across several rows.
 class MipMap {
 public:
     MipMap() = default;
     ~MipMap() = default;
 
-    void set_width(GLsizei width) { m_width = width; }
-    void set_height(GLsizei height) { m_height = height; }
+    void resize(GLsizei width, GLsizei height)
+    {
+        m_width = width;
+        m_height = height;
+        m_tiles_per_row = (width + tile_size - 1) / tile_size;
+        m_pixel_data.resize(m_tiles_per_row * ((height + tile_size - 1) / tile_size) * tile_size * tile_size);
+    }
+
     GLsizei width() const { return m_width; }
     GLsizei height() const { return m_height; }
 
-    Vector<u32>& pixel_data() { return m_pixel_data; }
-    const Vector<u32>& pixel_data() const { return m_pixel_data; }
-
-    FloatVector4 texel(unsigned x, unsigned y) const
+    // Returns 0 for texels outside of the mipmap.
+    u32 raw_texel(unsigned x, unsigned y) const
     {
         if (x >= (unsigned)m_width || y >= (unsigned)m_height)
-            return { 0, 0, 0, 0 };
+            return 0;
+        return m_pixel_data[texel_index(x, y)];
+    }
 
-        u32 texel = m_pixel_data.at(y * m_width + x);
+    void set_raw_texel(unsigned x, unsigned y, u32 texel)
+    {
+        VERIFY(x < (unsigned)m_width && y < (unsigned)m_height);
+        m_pixel_data[texel_index(x, y)] = texel;
+    }
+
+    FloatVector4 texel(unsigned x, unsigned y) const
+    {
+        u32 texel = raw_texel(x, y);
 
         return {
             ((texel >> 16) & 0xff) / 255.f,
@@ -42,8 +58,17 @@ public:
     }
 
 private:
+    static constexpr unsigned tile_size = 4;
+
+    size_t texel_index(unsigned x, unsigned y) const
+    {
+        size_t tile = (y / tile_size) * m_tiles_per_row + x / tile_size;
+        return tile * tile_size * tile_size + (y % tile_size) * tile_size + x % tile_size;
+    }
+
     GLsizei m_width { 0 };
     GLsizei m_height { 0 };
+    size_t m_tiles_per_row { 0 };
     Vector<u32> m_pixel_data;
 };
 }
@@ -6,11 +6,14 @@
 
 #include "Sampler2D.h"
 
+#include <AK/SIMD.h>
 #include <LibGL/Tex/Texture2D.h>
 #include <math.h>
 
 namespace GL {
 
+using AK::SIMD::f32x4;
+
 static constexpr float wrap_repeat(float value)
 {
     return value - floorf(value);
@@ -50,16 +53,65 @@ static constexpr float wrap(float value, GLint mode)
     }
 }
 
-FloatVector4 Sampler2D::sample(FloatVector2 const& uv) const
+// NOTE: This doesn't return the vector, since that would change the ABI depending on whether SSE is enabled.
+static ALWAYS_INLINE void unpack_texel(u32 texel, f32x4& components)
 {
-    // FIXME: Calculate the correct mipmap level here, need to receive uv derivatives for that
-    unsigned lod = 0;
+    components = f32x4 {
+        static_cast<float>((texel >> 16) & 0xff),
+        static_cast<float>((texel >> 8) & 0xff),
+        static_cast<float>(texel & 0xff),
+        static_cast<float>((texel >> 24) & 0xff),
+    };
+    components /= 255.f;
+}
 
-    MipMap const& mip = m_texture.mipmap(lod);
+FloatVector4 Sampler2D::sample(FloatVector2 const& uv, FloatVector2 const& duv_dx, FloatVector2 const& duv_dy) const
+{
+    MipMap const& base = m_texture.mipmap(0);
 
-    if (mip.width() < 1 || mip.height() < 1)
+    if (base.width() < 1 || base.height() < 1)
         return { 1, 1, 1, 1 };
 
+    // Level of detail according to https://www.khronos.org/registry/OpenGL/specs/gl/glspec121.pdf Chapter 3.8.8,
+    // computed from the squared lengths to save a square root.
+    float scale_x = duv_dx.x() * base.width() * duv_dx.x() * base.width() + duv_dx.y() * base.height() * duv_dx.y() * base.height();
+    float scale_y = duv_dy.x() * base.width() * duv_dy.x() * base.width() + duv_dy.y() * base.height() * duv_dy.y() * base.height();
+    float lod = log2f(max(scale_x, scale_y)) / 2;
+
+    if (!(lod > 0))
+        return sample_level(base, uv, m_mag_filter);
+
+    // NOTE: Instead of treating a texture without a complete set of mipmaps as incomplete, we just use the levels it has.
+    unsigned max_level = m_texture.mipmap_count() - 1;
+
+    switch (m_min_filter) {
+    case GL_NEAREST:
+    case GL_LINEAR:
+        return sample_level(base, uv, m_min_filter);
+    case GL_NEAREST_MIPMAP_NEAREST:
+    case GL_LINEAR_MIPMAP_NEAREST: {
+        unsigned level = min(static_cast<unsigned>(lod + 0.5f), max_level);
+        return sample_level(m_texture.mipmap(level), uv, m_min_filter == GL_NEAREST_MIPMAP_NEAREST ? GL_NEAREST : GL_LINEAR);
+    }
+    case GL_NEAREST_MIPMAP_LINEAR:
+    case GL_LINEAR_MIPMAP_LINEAR: {
+        GLint filter = m_min_filter == GL_NEAREST_MIPMAP_LINEAR ? GL_NEAREST : GL_LINEAR;
+        unsigned level = static_cast<unsigned>(lod);
+        if (level >= max_level)
+            return sample_level(m_texture.mipmap(max_level), uv, filter);
+
+        float frac = lod - level;
+        auto t0 = sample_level(m_texture.mipmap(level), uv, filter);
+        auto t1 = sample_level(m_texture.mipmap(level + 1), uv, filter);
+        return t0 * (1 - frac) + t1 * frac;
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+FloatVector4 Sampler2D::sample_level(MipMap const& mip, FloatVector2 const& uv, GLint filter) const
+{
     float x = wrap(uv.x(), m_wrap_t_mode);
     float y = wrap(uv.y(), m_wrap_s_mode);
 
@@ -67,9 +119,9 @@ FloatVector4 Sampler2D::sample(FloatVector2 const& uv) const
     y *= mip.height() - 1;
 
     // Sampling implemented according to https://www.khronos.org/registry/OpenGL/specs/gl/glspec121.pdf Chapter 3.8
-    if (m_mag_filter == GL_NEAREST) {
+    if (filter == GL_NEAREST) {
         return mip.texel(static_cast<unsigned>(x), static_cast<unsigned>(y));
-    } else if (m_mag_filter == GL_LINEAR) {
+    } else if (filter == GL_LINEAR) {
         // FIXME: Implement different sampling points for wrap modes other than GL_REPEAT
 
         x -= 0.5f;
@@ -81,10 +133,12 @@ FloatVector4 Sampler2D::sample(FloatVector2 const& uv) const
         unsigned i1 = (i0 + 1) % mip.width();
         unsigned j1 = (j0 + 1) % mip.height();
 
-        auto t0 = mip.texel(i0, j0);
-        auto t1 = mip.texel(i1, j0);
-        auto t2 = mip.texel(i0, j1);
-        auto t3 = mip.texel(i1, j1);
+        // All four channels of a texel are filtered at once.
+        f32x4 t0, t1, t2, t3;
+        unpack_texel(mip.raw_texel(i0, j0), t0);
+        unpack_texel(mip.raw_texel(i1, j0), t1);
+        unpack_texel(mip.raw_texel(i0, j1), t2);
+        unpack_texel(mip.raw_texel(i1, j1), t3);
 
         float frac_x = x - floorf(x);
         float frac_y = y - floorf(y);
@@ -92,7 +146,8 @@ FloatVector4 Sampler2D::sample(FloatVector2 const& uv) const
 
         auto h1 = t0 * one_minus_frac_x + t1 * frac_x;
         auto h2 = t2 * one_minus_frac_x + t3 * frac_x;
-        return h1 * (1 - frac_y) + h2 * frac_y;
+        f32x4 result = h1 * (1 - frac_y) + h2 * frac_y;
+        return { result[0], result[1], result[2], result[3] };
     } else {
         VERIFY_NOT_REACHED();
     }
@@ -12,6 +12,7 @@
 
 namespace GL {
 
+class MipMap;
 class Texture2D;
 
 class Sampler2D final {
@@ -31,9 +32,12 @@ public:
     void set_wrap_s_mode(GLint value) { m_wrap_s_mode = value; }
     void set_wrap_t_mode(GLint value) { m_wrap_t_mode = value; }
 
-    FloatVector4 sample(FloatVector2 const& uv) const;
+    // The derivatives of the texture coordinates along the screen's x and y axes determine which mipmap level is used.
+    FloatVector4 sample(FloatVector2 const& uv, FloatVector2 const& duv_dx, FloatVector2 const& duv_dy) const;
 
 private:
+    FloatVector4 sample_level(MipMap const&, FloatVector2 const& uv, GLint filter) const;
+
     Texture2D const& m_texture;
 
     GLint m_min_filter { GL_NEAREST_MIPMAP_LINEAR };
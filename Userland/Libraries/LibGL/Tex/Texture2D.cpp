@@ -19,20 +19,16 @@ void Texture2D::upload_texture_data(GLenum, GLint lod, GLint internal_format, GL
     // checks here to see if we support them; the program will simply fail to compile..
 
     auto& mip = m_mipmaps[lod];
-    mip.set_width(width);
-    mip.set_height(height);
+    mip.resize(width, height);
 
     // No pixel data was supplied. Just allocate texture memory and leave it uninitialized.
-    if (pixels == nullptr) {
-        mip.pixel_data().resize(width * height);
+    if (pixels == nullptr)
         return;
-    }
 
     m_internal_format = internal_format;
 
     const u8* pixel_byte_array = reinterpret_cast<const u8*>(pixels);
 
-    mip.pixel_data().clear();
     if (format == GL_RGBA) {
         for (auto y = 0; y < height; y++) {
             for (auto x = 0; x < width; x++) {
@@ -42,7 +38,7 @@ void Texture2D::upload_texture_data(GLenum, GLint lod, GLint internal_format, GL
                 u32 a = *pixel_byte_array++;
 
                 u32 pixel = ((a << 24) | (r << 16) | (g << 8) | b);
-                mip.pixel_data().append(pixel);
+                mip.set_raw_texel(x, y, pixel);
             }
 
             if (pixels_per_row > 0) {
@@ -58,7 +54,7 @@ void Texture2D::upload_texture_data(GLenum, GLint lod, GLint internal_format, GL
                 u32 a = *pixel_byte_array++;
 
                 u32 pixel = ((a << 24) | (r << 16) | (g << 8) | b);
-                mip.pixel_data().append(pixel);
+                mip.set_raw_texel(x, y, pixel);
             }
 
             if (pixels_per_row > 0) {
@@ -74,7 +70,7 @@ void Texture2D::upload_texture_data(GLenum, GLint lod, GLint internal_format, GL
                 u32 a = 255;
 
                 u32 pixel = ((a << 24) | (r << 16) | (g << 8) | b);
-                mip.pixel_data().append(pixel);
+                mip.set_raw_texel(x, y, pixel);
             }
 
             if (pixels_per_row > 0) {
@@ -90,7 +86,7 @@ void Texture2D::upload_texture_data(GLenum, GLint lod, GLint internal_format, GL
                 u32 a = 255;
 
                 u32 pixel = ((a << 24) | (r << 16) | (g << 8) | b);
-                mip.pixel_data().append(pixel);
+                mip.set_raw_texel(x, y, pixel);
             }
 
             if (pixels_per_row > 0) {
@@ -102,6 +98,46 @@ void Texture2D::upload_texture_data(GLenum, GLint lod, GLint internal_format, GL
     }
 }
 
+void Texture2D::generate_mipmaps()
+{
+    // Every level is a 2x2 box filtered version of the one before it, down to 1x1.
+    for (size_t lod = 1; lod < m_mipmaps.size(); lod++) {
+        auto const& source = m_mipmaps[lod - 1];
+        if (source.width() <= 1 && source.height() <= 1)
+            break;
+
+        auto& mip = m_mipmaps[lod];
+        mip.resize(max(source.width() / 2, 1), max(source.height() / 2, 1));
+
+        for (GLsizei y = 0; y < mip.height(); y++) {
+            unsigned y0 = min(y * 2, source.height() - 1);
+            unsigned y1 = min(y * 2 + 1, source.height() - 1);
+            for (GLsizei x = 0; x < mip.width(); x++) {
+                unsigned x0 = min(x * 2, source.width() - 1);
+                unsigned x1 = min(x * 2 + 1, source.width() - 1);
+                u32 texels[] = { source.raw_texel(x0, y0), source.raw_texel(x1, y0), source.raw_texel(x0, y1), source.raw_texel(x1, y1) };
+
+                u32 pixel = 0;
+                for (unsigned shift = 0; shift < 32; shift += 8) {
+                    u32 sum = 2;
+                    for (auto texel : texels)
+                        sum += (texel >> shift) & 0xff;
+                    pixel |= (sum / 4) << shift;
+                }
+                mip.set_raw_texel(x, y, pixel);
+            }
+        }
+    }
+}
+
+unsigned Texture2D::mipmap_count() const
+{
+    unsigned count = 0;
+    while (count < m_mipmaps.size() && m_mipmaps[count].width() > 0 && m_mipmaps[count].height() > 0)
+        count++;
+    return count;
+}
+
 MipMap const& Texture2D::mipmap(unsigned lod) const
 {
     if (lod >= m_mipmaps.size())
@@ -40,6 +40,12 @@ public:
 
     MipMap const& mipmap(unsigned lod) const;
 
+    // Fills in all levels after the first one from the first one.
+    void generate_mipmaps();
+
+    // The number of levels, starting with the first one, that contain texels.
+    unsigned mipmap_count() const;
+
     GLenum internal_format() const { return m_internal_format; }
     Sampler2D const& sampler() const { return m_sampler; }
     Sampler2D& sampler() { return m_sampler; }
@@ -53,7 +59,6 @@ private:
     }
 
 private:
-    // FIXME: Mipmaps are currently unused, but we have the plumbing for it at least
     Array<MipMap, LOG2_MAX_TEXTURE_SIZE> m_mipmaps;
     GLenum m_internal_format;
     Sampler2D m_sampler;
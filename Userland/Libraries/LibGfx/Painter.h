@@ -125,12 +125,12 @@ public:
     }
 
     IntRect clip_rect() const { return state().clip_rect; }
+    IntPoint translation() const { return state().translation; }
+    int scale() const { return state().scale; }
 
 protected:
-    IntPoint translation() const { return state().translation; }
     IntRect to_physical(const IntRect& r) const { return r.translated(translation()) * scale(); }
     IntPoint to_physical(const IntPoint& p) const { return p.translated(translation()) * scale(); }
-    int scale() const { return state().scale; }
     void set_physical_pixel_with_draw_op(u32& pixel, const Color&);
     void fill_physical_scanline_with_draw_op(int y, int x, int width, const Color& color);
     void fill_rect_with_draw_op(const IntRect&, Color);
@@ -14,7 +14,9 @@
 #include <LibCore/Notifier.h>
 #include <LibCore/Timer.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/SharedMemoryRing.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -49,57 +51,144 @@ public:
         return wait_for_specific_endpoint_message<MessageType, LocalEndpoint>();
     }
 
+    virtual ~Connection() override
+    {
+        // Best effort, so the peer still hears about whatever was batched up in this event loop iteration.
+        if (!m_outgoing_bytes.is_empty() && m_socket->is_open())
+            (void)write(m_socket->fd(), m_outgoing_bytes.data(), m_outgoing_bytes.size());
+    }
+
     void post_message(const Message& message)
     {
-        post_message(message.encode());
+        // Encode into the same buffer every time, but don't hold on to the memory of an unusually large message.
+        if (m_encode_buffer.data.capacity() > max_retained_encode_buffer_size)
+            m_encode_buffer.data.clear();
+        else
+            m_encode_buffer.data.clear_with_capacity();
+        message.encode(m_encode_buffer);
+
+        // The descriptors are closed once they have been sent. Take them out of the buffer first,
+        // since sending may shut down (and destroy) this connection.
+        auto fds = move(m_encode_buffer.fds);
+        post_message(m_encode_buffer.data.span(), fds);
+    }
+
+    void post_message(MessageBuffer const& buffer)
+    {
+        post_message(buffer.data.span(), buffer.fds);
     }
 
-    // FIXME: unnecessary copy
-    void post_message(MessageBuffer buffer)
+    void post_message(ReadonlyBytes data, Vector<RefPtr<AutoCloseFileDescriptor>> const& fds)
     {
         // NOTE: If this connection is being shut down, but has not yet been destroyed,
         //       the socket will be closed. Don't try to send more messages.
         if (!m_socket->is_open())
             return;
 
-        // Prepend the message size.
-        uint32_t message_size = buffer.data.size();
-        buffer.data.prepend(reinterpret_cast<const u8*>(&message_size), sizeof(message_size));
-
 #ifdef __serenity__
-        for (auto& fd : buffer.fds) {
+        for (auto& fd : fds) {
             auto rc = sendfd(m_socket->fd(), fd->value());
             if (rc < 0) {
                 perror("sendfd");
                 shutdown();
+                return;
             }
         }
 #else
-        if (!buffer.fds.is_empty())
+        if (!fds.is_empty())
             warnln("fd passing is not supported on this platform, sorry :(");
 #endif
 
+        bool sent_through_shared_memory = false;
+        if (m_outgoing_ring && data.size() >= m_shared_memory_threshold) {
+            // If the peer hasn't caught up with the ring yet, the message simply goes through the socket.
+            if (auto offset = m_outgoing_ring->try_write(data); offset.has_value()) {
+                append_outgoing_bytes(to_underlying(ControlFrame::SharedMemoryRingMessage));
+                append_outgoing_bytes(offset.value());
+                append_outgoing_bytes(static_cast<u32>(data.size()));
+                sent_through_shared_memory = true;
+            }
+        }
+        if (!sent_through_shared_memory) {
+            // Prepend the message size.
+            append_outgoing_bytes(static_cast<u32>(data.size()));
+            m_outgoing_bytes.append(data.data(), data.size());
+        }
+
+        did_queue_outgoing_bytes();
+    }
+
+    // Coalesce outgoing messages and write them to the socket once per event loop iteration.
+    // Waiting for a synchronous response flushes everything queued before the request.
+    // NOTE: Messages that are still queued when the process exits are lost.
+    void set_batching_enabled(bool enabled)
+    {
+        m_batching_enabled = enabled;
+        if (!enabled)
+            flush_outgoing_messages();
+    }
+
+    // Send messages of at least `threshold` bytes through a ring in shared memory rather than the socket.
+    // The receiving side of every connection understands this, so only the sender has to opt in.
+    bool enable_shared_memory_transport(size_t threshold = default_shared_memory_threshold, size_t ring_size = SharedMemoryRing::default_size)
+    {
+        if (m_outgoing_ring)
+            return true;
+#ifdef __serenity__
+        auto ring = SharedMemoryRing::try_create(ring_size);
+        if (!ring)
+            return false;
+        if (sendfd(m_socket->fd(), ring->fd()) < 0) {
+            perror("sendfd");
+            return false;
+        }
+        append_outgoing_bytes(to_underlying(ControlFrame::SharedMemoryRingSetup));
+        append_outgoing_bytes(static_cast<u32>(ring_size));
+        m_outgoing_ring = move(ring);
+        m_shared_memory_threshold = threshold;
+        did_queue_outgoing_bytes();
+        return true;
+#else
+        // We can't hand the ring's file descriptor to the peer on this platform.
+        (void)threshold;
+        (void)ring_size;
+        return false;
+#endif
+    }
+
+    void flush_outgoing_messages()
+    {
+        m_flush_scheduled = false;
+        if (m_outgoing_bytes.is_empty())
+            return;
+        if (!m_socket->is_open()) {
+            m_outgoing_bytes.clear_with_capacity();
+            return;
+        }
+
         size_t total_nwritten = 0;
-        while (total_nwritten < buffer.data.size()) {
-            auto nwritten = write(m_socket->fd(), buffer.data.data() + total_nwritten, buffer.data.size() - total_nwritten);
+        while (total_nwritten < m_outgoing_bytes.size()) {
+            auto nwritten = write(m_socket->fd(), m_outgoing_bytes.data() + total_nwritten, m_outgoing_bytes.size() - total_nwritten);
             if (nwritten < 0) {
+                m_outgoing_bytes.clear_with_capacity();
                 switch (errno) {
                 case EPIPE:
-                    dbgln("{}::post_message: Disconnected from peer", *this);
+                    dbgln("{}::flush_outgoing_messages: Disconnected from peer", *this);
                     shutdown();
                     return;
                 case EAGAIN:
-                    dbgln("{}::post_message: Peer buffer overflowed", *this);
+                    dbgln("{}::flush_outgoing_messages: Peer buffer overflowed", *this);
                     shutdown();
                     return;
                 default:
-                    perror("Connection::post_message write");
+                    perror("Connection::flush_outgoing_messages write");
                     shutdown();
                     return;
                 }
             }
             total_nwritten += nwritten;
         }
+        m_outgoing_bytes.clear_with_capacity();
 
         m_responsiveness_timer->start();
     }
@@ -125,6 +214,7 @@ public:
 
     void shutdown()
     {
+        m_outgoing_bytes.clear_with_capacity();
         m_notifier->close();
         m_socket->close();
         die();
@@ -140,6 +230,7 @@ protected:
     template<typename MessageType, typename Endpoint>
     OwnPtr<MessageType> wait_for_specific_endpoint_message()
     {
+        flush_outgoing_messages();
         for (;;) {
             // Double check we don't already have the event waiting for us.
             // Otherwise we might end up blocked for a while for no reason.
@@ -177,13 +268,7 @@ protected:
 
     bool drain_messages_from_peer()
     {
-        Vector<u8> bytes;
-
-        if (!m_unprocessed_bytes.is_empty()) {
-            bytes.append(m_unprocessed_bytes.data(), m_unprocessed_bytes.size());
-            m_unprocessed_bytes.clear();
-        }
-
+        bool did_receive_bytes = false;
         while (m_socket->is_open()) {
             u8 buffer[4096];
             ssize_t nread = recv(m_socket->fd(), buffer, sizeof(buffer), MSG_DONTWAIT);
@@ -195,50 +280,35 @@ protected:
                 return false;
             }
             if (nread == 0) {
-                if (bytes.is_empty()) {
+                if (m_incoming_bytes.is_empty()) {
                     deferred_invoke([this](auto&) { shutdown(); });
                     return false;
                 }
                 break;
             }
-            bytes.append(buffer, nread);
+            m_incoming_bytes.append(buffer, nread);
+            did_receive_bytes = true;
         }
 
-        if (!bytes.is_empty()) {
+        if (did_receive_bytes) {
             m_responsiveness_timer->stop();
             did_become_responsive();
         }
 
         size_t index = 0;
-        u32 message_size = 0;
-        for (; index + sizeof(message_size) < bytes.size(); index += message_size) {
-            memcpy(&message_size, bytes.data() + index, sizeof(message_size));
-            if (message_size == 0 || bytes.size() - index - sizeof(uint32_t) < message_size)
-                break;
-            index += sizeof(message_size);
-            auto remaining_bytes = ReadonlyBytes { bytes.data() + index, message_size };
-            if (auto message = LocalEndpoint::decode_message(remaining_bytes, m_socket->fd())) {
-                m_unprocessed_messages.append(message.release_nonnull());
-            } else if (auto message = PeerEndpoint::decode_message(remaining_bytes, m_socket->fd())) {
-                m_unprocessed_messages.append(message.release_nonnull());
-            } else {
+        while (index < m_incoming_bytes.size()) {
+            auto frame_size = try_parse_frame(m_incoming_bytes.span().slice(index));
+            if (!frame_size.has_value()) {
                 dbgln("Failed to parse a message");
                 break;
             }
+            // Sometimes we might receive a partial message. That's okay, the rest of it
+            // stays in m_incoming_bytes until the next run of this function.
+            if (frame_size.value() == 0)
+                break;
+            index += frame_size.value();
         }
-
-        if (index < bytes.size()) {
-            // Sometimes we might receive a partial message. That's okay, just stash away
-            // the unprocessed bytes and we'll prepend them to the next incoming message
-            // in the next run of this function.
-            auto remaining_bytes = ByteBuffer::copy(bytes.data() + index, bytes.size() - index);
-            if (!m_unprocessed_bytes.is_empty()) {
-                dbgln("{}::drain_messages_from_peer: Already have unprocessed bytes", *this);
-                shutdown();
-                return false;
-            }
-            m_unprocessed_bytes = remaining_bytes;
-        }
+        m_incoming_bytes.remove(0, index);
 
         if (!m_unprocessed_messages.is_empty()) {
             deferred_invoke([this](auto&) {
@@ -251,11 +321,130 @@ protected:
     void handle_messages()
     {
         auto messages = move(m_unprocessed_messages);
+        bool did_post_response = false;
         for (auto& message : messages) {
-            if (message.endpoint_magic() == LocalEndpoint::static_magic())
-                if (auto response = m_local_stub.handle(message))
+            if (message.endpoint_magic() == LocalEndpoint::static_magic()) {
+                if (auto response = m_local_stub.handle(message)) {
                     post_message(*response);
+                    did_post_response = true;
+                }
+            }
+        }
+        // The peer is blocked waiting for these, so don't hold them back until the end of the event loop iteration.
+        if (did_post_response)
+            flush_outgoing_messages();
+    }
+
+private:
+    static constexpr size_t default_shared_memory_threshold = 16 * KiB;
+    static constexpr size_t max_batch_size = 64 * KiB;
+    static constexpr size_t max_retained_encode_buffer_size = 64 * KiB;
+
+    template<typename T>
+    void append_outgoing_bytes(T value)
+    {
+        m_outgoing_bytes.append(reinterpret_cast<u8 const*>(&value), sizeof(value));
+    }
+
+    void did_queue_outgoing_bytes()
+    {
+        if (!m_batching_enabled || m_outgoing_bytes.size() >= max_batch_size) {
+            flush_outgoing_messages();
+            return;
         }
+        if (m_flush_scheduled)
+            return;
+        m_flush_scheduled = true;
+        deferred_invoke([this](auto&) {
+            flush_outgoing_messages();
+        });
+    }
+
+    template<typename T>
+    static T read_from_frame(ReadonlyBytes bytes, size_t offset)
+    {
+        T value;
+        memcpy(&value, bytes.data() + offset, sizeof(value));
+        return value;
+    }
+
+    // Returns the number of bytes the frame at the start of `bytes` takes up, 0 if it hasn't fully arrived yet,
+    // or nothing if it's malformed.
+    Optional<size_t> try_parse_frame(ReadonlyBytes bytes)
+    {
+        if (bytes.size() < sizeof(u32))
+            return 0;
+        auto header = read_from_frame<u32>(bytes, 0);
+
+        if (!(header & control_frame_bit)) {
+            auto message_size = header;
+            if (message_size == 0)
+                return {};
+            if (bytes.size() - sizeof(u32) < message_size)
+                return 0;
+            if (!decode_message(bytes.slice(sizeof(u32), message_size)))
+                return {};
+            return sizeof(u32) + message_size;
+        }
+
+        switch (static_cast<ControlFrame>(header)) {
+        case ControlFrame::SharedMemoryRingSetup: {
+            constexpr size_t frame_size = sizeof(u32) + sizeof(u32);
+            if (bytes.size() < frame_size)
+                return 0;
+            if (!set_up_incoming_ring(read_from_frame<u32>(bytes, sizeof(u32))))
+                return {};
+            return frame_size;
+        }
+        case ControlFrame::SharedMemoryRingMessage: {
+            constexpr size_t frame_size = sizeof(u32) + sizeof(u64) + sizeof(u32);
+            if (bytes.size() < frame_size)
+                return 0;
+            if (!m_incoming_ring)
+                return {};
+            auto offset = read_from_frame<u64>(bytes, sizeof(u32));
+            auto message_size = read_from_frame<u32>(bytes, sizeof(u32) + sizeof(u64));
+            auto message_bytes = m_incoming_ring->bytes_at(offset, message_size);
+            if (!message_bytes.has_value() || !decode_message(message_bytes.value()))
+                return {};
+            // Decoded messages own copies of their data, so the producer can reuse this space right away.
+            m_incoming_ring->did_consume(offset, message_size);
+            return frame_size;
+        }
+        }
+        return {};
+    }
+
+    bool decode_message(ReadonlyBytes bytes)
+    {
+        if (auto message = LocalEndpoint::decode_message(bytes, m_socket->fd())) {
+            m_unprocessed_messages.append(message.release_nonnull());
+            return true;
+        }
+        if (auto message = PeerEndpoint::decode_message(bytes, m_socket->fd())) {
+            m_unprocessed_messages.append(message.release_nonnull());
+            return true;
+        }
+        return false;
+    }
+
+    bool set_up_incoming_ring([[maybe_unused]] size_t ring_size)
+    {
+#ifdef __serenity__
+        int fd = recvfd(m_socket->fd(), O_CLOEXEC);
+        if (fd < 0) {
+            dbgln("recvfd: {}", strerror(errno));
+            return false;
+        }
+        m_incoming_ring = SharedMemoryRing::try_create_from_anon_fd(fd, ring_size);
+        if (!m_incoming_ring) {
+            close(fd);
+            return false;
+        }
+        return true;
+#else
+        return false;
+#endif
     }
 
 protected:
@@ -265,7 +454,16 @@ protected:
 
     RefPtr<Core::Notifier> m_notifier;
     NonnullOwnPtrVector<Message> m_unprocessed_messages;
-    ByteBuffer m_unprocessed_bytes;
+    Vector<u8> m_incoming_bytes;
+
+    MessageBuffer m_encode_buffer;
+    Vector<u8> m_outgoing_bytes;
+    bool m_batching_enabled { false };
+    bool m_flush_scheduled { false };
+
+    OwnPtr<SharedMemoryRing> m_outgoing_ring;
+    OwnPtr<SharedMemoryRing> m_incoming_ring;
+    size_t m_shared_memory_threshold { default_shared_memory_threshold };
 };
 
 }
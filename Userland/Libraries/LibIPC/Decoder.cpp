@@ -18,6 +18,11 @@
 
 namespace IPC {
 
+size_t Decoder::remaining_bytes() const
+{
+    return m_stream.remaining();
+}
+
 bool Decoder::decode(bool& value)
 {
     m_stream >> value;
@@ -118,6 +123,38 @@ bool Decoder::decode(ByteBuffer& value)
     return !m_stream.handle_any_error();
 }
 
+bool Decoder::decode(StringView& value)
+{
+    i32 length = 0;
+    m_stream >> length;
+    if (m_stream.handle_any_error())
+        return false;
+    if (length < 0) {
+        value = {};
+        return true;
+    }
+    if (static_cast<size_t>(length) > m_stream.remaining())
+        return false;
+    value = StringView { m_stream.bytes().slice(m_stream.offset(), length) };
+    return m_stream.discard_or_error(length);
+}
+
+bool Decoder::decode(ReadonlyBytes& value)
+{
+    i32 length = 0;
+    m_stream >> length;
+    if (m_stream.handle_any_error())
+        return false;
+    if (length < 0) {
+        value = {};
+        return true;
+    }
+    if (static_cast<size_t>(length) > m_stream.remaining())
+        return false;
+    value = m_stream.bytes().slice(m_stream.offset(), length);
+    return m_stream.discard_or_error(length);
+}
+
 bool Decoder::decode(URL& value)
 {
     String string;
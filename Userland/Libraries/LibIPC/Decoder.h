@@ -43,6 +43,9 @@ public:
     bool decode(float&);
     bool decode(String&);
     bool decode(ByteBuffer&);
+    // NOTE: These point into the bytes being decoded, so they are only valid for as long as those are.
+    bool decode(StringView&);
+    bool decode(ReadonlyBytes&);
     bool decode(URL&);
     bool decode(Dictionary&);
     bool decode(File&);
@@ -90,6 +93,8 @@ public:
         u64 size;
         if (!decode(size) || size > NumericLimits<i32>::max())
             return false;
+        // The size comes from the peer, so don't trust it further than the bytes we actually have.
+        vector.ensure_capacity(vector.size() + static_cast<size_t>(min<u64>(size, remaining_bytes())));
         for (size_t i = 0; i < size; ++i) {
             T value;
             if (!decode(value))
@@ -117,6 +122,8 @@ public:
     }
 
 private:
+    size_t remaining_bytes() const;
+
     InputMemoryStream& m_stream;
     int m_sockfd { -1 };
 };
@@ -113,25 +113,32 @@ Encoder& Encoder::operator<<(const char* value)
 
 Encoder& Encoder::operator<<(const StringView& value)
 {
+    // NOTE: This matches the encoding of String, so either side of a message can use views.
+    if (value.is_null())
+        return *this << (i32)-1;
+    *this << static_cast<i32>(value.length());
     m_buffer.data.append((const u8*)value.characters_without_null_termination(), value.length());
     return *this;
 }
 
 Encoder& Encoder::operator<<(const String& value)
 {
-    if (value.is_null())
-        return *this << (i32)-1;
-    *this << static_cast<i32>(value.length());
     return *this << value.view();
 }
 
-Encoder& Encoder::operator<<(const ByteBuffer& value)
+Encoder& Encoder::operator<<(ReadonlyBytes value)
 {
+    // NOTE: This matches the encoding of ByteBuffer.
     *this << static_cast<i32>(value.size());
     m_buffer.data.append(value.data(), value.size());
     return *this;
 }
 
+Encoder& Encoder::operator<<(const ByteBuffer& value)
+{
+    return *this << value.bytes();
+}
+
 Encoder& Encoder::operator<<(const URL& value)
 {
     return *this << value.to_string();
@@ -161,6 +168,35 @@ Encoder& Encoder::operator<<(const File& file)
     return *this;
 }
 
+size_t encoded_size_hint(StringView const& value)
+{
+    return sizeof(i32) + value.length();
+}
+
+size_t encoded_size_hint(String const& value)
+{
+    return sizeof(i32) + value.length();
+}
+
+size_t encoded_size_hint(ReadonlyBytes value)
+{
+    return sizeof(i32) + value.size();
+}
+
+size_t encoded_size_hint(ByteBuffer const& value)
+{
+    return sizeof(i32) + value.size();
+}
+
+size_t encoded_size_hint(Dictionary const& dictionary)
+{
+    size_t size = sizeof(u64);
+    dictionary.for_each_entry([&](auto& key, auto& value) {
+        size += encoded_size_hint(key) + encoded_size_hint(value);
+    });
+    return size;
+}
+
 bool encode(Encoder& encoder, const Core::AnonymousBuffer& buffer)
 {
     encoder << buffer.is_valid();
@@ -40,6 +40,7 @@ public:
     Encoder& operator<<(const char*);
     Encoder& operator<<(const StringView&);
     Encoder& operator<<(const String&);
+    Encoder& operator<<(ReadonlyBytes);
     Encoder& operator<<(const ByteBuffer&);
     Encoder& operator<<(const URL&);
     Encoder& operator<<(const Dictionary&);
@@ -97,4 +98,64 @@ private:
     MessageBuffer& m_buffer;
 };
 
+// A cheap upper-bound-ish guess of how many bytes a value will take up once encoded,
+// which lets generated messages size their buffer once instead of growing it field by field.
+size_t encoded_size_hint(StringView const&);
+size_t encoded_size_hint(String const&);
+size_t encoded_size_hint(ReadonlyBytes);
+size_t encoded_size_hint(ByteBuffer const&);
+size_t encoded_size_hint(Dictionary const&);
+
+template<typename T>
+requires(IsTriviallyCopyable<T>) size_t encoded_size_hint(T const&);
+template<typename T>
+requires(!IsTriviallyCopyable<T>) size_t encoded_size_hint(T const&);
+template<typename T>
+size_t encoded_size_hint(Vector<T> const&);
+template<typename K, typename V>
+size_t encoded_size_hint(HashMap<K, V> const&);
+template<typename T>
+size_t encoded_size_hint(Optional<T> const&);
+
+template<typename T>
+requires(IsTriviallyCopyable<T>) size_t encoded_size_hint(T const&)
+{
+    return sizeof(T);
+}
+
+// Anything else encodes itself through IPC::encode(), and only it knows how much it writes.
+// Hint nothing for those and let the buffer grow, but don't let a container silently do the same.
+template<typename T>
+requires(!IsTriviallyCopyable<T>) size_t encoded_size_hint(T const&)
+{
+    static_assert(!IterableContainer<T>, "encoded_size_hint() needs an overload for this container");
+    return 0;
+}
+
+template<typename T>
+size_t encoded_size_hint(Vector<T> const& vector)
+{
+    size_t size = sizeof(u64);
+    for (auto& value : vector)
+        size += encoded_size_hint(value);
+    return size;
+}
+
+template<typename K, typename V>
+size_t encoded_size_hint(HashMap<K, V> const& hashmap)
+{
+    size_t size = sizeof(u32);
+    for (auto& it : hashmap)
+        size += encoded_size_hint(it.key) + encoded_size_hint(it.value);
+    return size;
+}
+
+template<typename T>
+size_t encoded_size_hint(Optional<T> const& optional)
+{
+    if (!optional.has_value())
+        return sizeof(bool);
+    return sizeof(bool) + encoded_size_hint(optional.value());
+}
+
 }
@@ -49,7 +49,8 @@ public:
     virtual int message_id() const = 0;
     virtual const char* message_name() const = 0;
     virtual bool valid() const = 0;
-    virtual MessageBuffer encode() const = 0;
+    // Appends the encoded message to `buffer`, so that callers can reuse its storage.
+    virtual void encode(MessageBuffer& buffer) const = 0;
 
 protected:
     Message();
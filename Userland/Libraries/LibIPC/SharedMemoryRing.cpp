@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibIPC/SharedMemoryRing.h>
+#include <string.h>
+
+namespace IPC {
+
+OwnPtr<SharedMemoryRing> SharedMemoryRing::try_create(size_t size)
+{
+    VERIFY(size > 0 && size <= max_size);
+    auto buffer = Core::AnonymousBuffer::create_with_size(header_size + size);
+    if (!buffer.is_valid())
+        return {};
+    return adopt_own_if_nonnull(new (nothrow) SharedMemoryRing(move(buffer), size));
+}
+
+OwnPtr<SharedMemoryRing> SharedMemoryRing::try_create_from_anon_fd(int fd, size_t size)
+{
+    if (size == 0 || size > max_size)
+        return {};
+    auto buffer = Core::AnonymousBuffer::create_from_anon_fd(fd, header_size + size);
+    if (!buffer.is_valid())
+        return {};
+    return adopt_own_if_nonnull(new (nothrow) SharedMemoryRing(move(buffer), size));
+}
+
+SharedMemoryRing::SharedMemoryRing(Core::AnonymousBuffer buffer, size_t size)
+    : m_buffer(move(buffer))
+    , m_size(size)
+{
+}
+
+Optional<u64> SharedMemoryRing::try_write(ReadonlyBytes bytes)
+{
+    if (bytes.size() > m_size)
+        return {};
+
+    // Messages are never split, so skip to the start of the ring if this one doesn't fit at the end.
+    u64 offset = m_produced_offset;
+    size_t space_until_end = m_size - offset % m_size;
+    if (bytes.size() > space_until_end)
+        offset += space_until_end;
+
+    auto consumed_offset = header().consumed_offset.load(AK::MemoryOrder::memory_order_acquire);
+    if (offset + bytes.size() - consumed_offset > m_size)
+        return {};
+
+    memcpy(ring_data() + offset % m_size, bytes.data(), bytes.size());
+    m_produced_offset = offset + bytes.size();
+    return offset;
+}
+
+Optional<ReadonlyBytes> SharedMemoryRing::bytes_at(u64 offset, size_t size) const
+{
+    auto offset_in_ring = offset % m_size;
+    if (size > m_size - offset_in_ring)
+        return {};
+    return ReadonlyBytes { ring_data() + offset_in_ring, size };
+}
+
+void SharedMemoryRing::did_consume(u64 offset, size_t size)
+{
+    header().consumed_offset.store(offset + size, AK::MemoryOrder::memory_order_release);
+}
+
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/Span.h>
+#include <LibCore/AnonymousBuffer.h>
+
+namespace IPC {
+
+// Frames on a connection's socket normally start with the size of the message that follows.
+// Sizes with the top bit set are reserved for frames that the transport handles itself.
+static constexpr u32 control_frame_bit = 0x80000000;
+
+enum class ControlFrame : u32 {
+    // Followed by the u32 ring size. The ring's anonymous file is passed along like any other fd.
+    SharedMemoryRingSetup = control_frame_bit | 1,
+    // Followed by the u64 offset and u32 size of a message that lives in the shared memory ring.
+    SharedMemoryRingMessage = control_frame_bit | 2,
+};
+
+// A single-producer, single-consumer byte ring in shared memory.
+// The producer tells the consumer where each message lives through the socket,
+// so the only state the two sides have to share is how far the consumer has read.
+class SharedMemoryRing {
+public:
+    static constexpr size_t default_size = 1 * MiB;
+    static constexpr size_t max_size = 64 * MiB;
+
+    static OwnPtr<SharedMemoryRing> try_create(size_t size);
+    static OwnPtr<SharedMemoryRing> try_create_from_anon_fd(int fd, size_t size);
+
+    int fd() const { return m_buffer.fd(); }
+    size_t size() const { return m_size; }
+
+    // Producer side. Returns the offset of the copied message, or nothing if the ring is full.
+    Optional<u64> try_write(ReadonlyBytes);
+
+    // Consumer side. Offsets and sizes come from the peer, so they are validated here.
+    Optional<ReadonlyBytes> bytes_at(u64 offset, size_t size) const;
+    void did_consume(u64 offset, size_t size);
+
+private:
+    struct Header {
+        Atomic<u64> consumed_offset;
+    };
+
+    static constexpr size_t header_size = 64;
+
+    explicit SharedMemoryRing(Core::AnonymousBuffer, size_t size);
+
+    Header& header() { return *reinterpret_cast<Header*>(m_buffer.data<void>()); }
+    u8* ring_data() { return m_buffer.data<u8>() + header_size; }
+    u8 const* ring_data() const { return m_buffer.data<u8>() + header_size; }
+
+    Core::AnonymousBuffer m_buffer;
+    size_t m_size { 0 };
+    u64 m_produced_offset { 0 };
+};
+
+}
@@ -21,7 +21,9 @@ Threading::Thread::Thread(Function<intptr_t()> action, StringView thread_name)
 Threading::Thread::~Thread()
 {
     if (m_tid && !m_detached) {
-        dbgln("Destroying thread \"{}\"({}) while it is still running!", m_thread_name, m_tid);
+        // A thread that has already finished only has to be joined to release its resources.
+        if (!m_has_finished.load(AK::MemoryOrder::memory_order_acquire))
+            dbgln("Destroying thread \"{}\"({}) while it is still running!", m_thread_name, m_tid);
         [[maybe_unused]] auto res = join();
     }
 }
@@ -34,7 +36,8 @@ void Threading::Thread::start()
         [](void* arg) -> void* {
             Thread* self = static_cast<Thread*>(arg);
             auto exit_code = self->m_action();
-            self->m_tid = 0;
+            self->m_has_finished.store(true, AK::MemoryOrder::memory_order_release);
+            // NOTE: m_tid stays valid until the thread is joined or detached, even if it has already exited.
             return reinterpret_cast<void*>(exit_code);
         },
         static_cast<void*>(this));
@@ -7,11 +7,13 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/DistinctNumeric.h>
 #include <AK/Function.h>
 #include <AK/Result.h>
 #include <AK/String.h>
 #include <LibCore/Object.h>
+#include <errno.h>
 #include <pthread.h>
 
 namespace Threading {
@@ -39,11 +41,16 @@ private:
     pthread_t m_tid { 0 };
     String m_thread_name;
     bool m_detached { false };
+    Atomic<bool> m_has_finished { false };
 };
 
 template<typename T>
 Result<T, ThreadError> Thread::join()
 {
+    // A detached thread's ID may already belong to another thread.
+    if (m_detached)
+        return ThreadError { EINVAL };
+
     void* thread_return = nullptr;
     int rc = pthread_join(m_tid, &thread_return);
     if (rc != 0) {
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Format.h>
+#include <AK/String.h>
+#include <LibThreading/WorkerPool.h>
+#include <string.h>
+
+namespace Threading {
+
+WorkerPool::WorkerPool(size_t thread_count, StringView name)
+{
+    pthread_mutex_init(&m_mutex, nullptr);
+    pthread_cond_init(&m_work_available, nullptr);
+    pthread_cond_init(&m_work_done, nullptr);
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        pthread_t thread;
+        int rc = pthread_create(
+            &thread, nullptr, [](void* pool) -> void* {
+                static_cast<WorkerPool*>(pool)->worker_main();
+                return nullptr;
+            },
+            this);
+        if (rc != 0) {
+            dbgln("WorkerPool: Failed to create a thread: {}", strerror(rc));
+            break;
+        }
+        auto thread_name = String::formatted("{} #{}", name, i);
+        (void)pthread_setname_np(thread, thread_name.characters());
+        m_threads.append(thread);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_exiting = true;
+    pthread_cond_broadcast(&m_work_available);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (auto thread : m_threads)
+        pthread_join(thread, nullptr);
+
+    pthread_cond_destroy(&m_work_done);
+    pthread_cond_destroy(&m_work_available);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void WorkerPool::run_work_items(Function<void(size_t)> const& work, size_t count)
+{
+    for (;;) {
+        auto index = m_next_index.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        if (index >= count)
+            return;
+        work(index);
+    }
+}
+
+void WorkerPool::worker_main()
+{
+    u64 last_seen_generation = 0;
+    pthread_mutex_lock(&m_mutex);
+    for (;;) {
+        while (!m_exiting && (!m_work || m_generation == last_seen_generation))
+            pthread_cond_wait(&m_work_available, &m_mutex);
+        if (m_exiting)
+            break;
+
+        // The submitting thread waits for every busy worker before it retires a batch,
+        // so the work can't go away underneath us after we let go of the lock.
+        last_seen_generation = m_generation;
+        auto& work = *m_work;
+        auto count = m_count;
+        ++m_busy_workers;
+        pthread_mutex_unlock(&m_mutex);
+
+        run_work_items(work, count);
+
+        pthread_mutex_lock(&m_mutex);
+        if (--m_busy_workers == 0)
+            pthread_cond_signal(&m_work_done);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void WorkerPool::for_each_index(size_t count, Function<void(size_t)> const& work)
+{
+    if (count == 0)
+        return;
+    if (count == 1 || m_threads.is_empty()) {
+        for (size_t i = 0; i < count; ++i)
+            work(i);
+        return;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    VERIFY(!m_work);
+    m_work = &work;
+    m_count = count;
+    m_next_index.store(0, AK::MemoryOrder::memory_order_relaxed);
+    ++m_generation;
+    pthread_cond_broadcast(&m_work_available);
+    pthread_mutex_unlock(&m_mutex);
+
+    run_work_items(work, count);
+
+    pthread_mutex_lock(&m_mutex);
+    while (m_busy_workers > 0)
+        pthread_cond_wait(&m_work_done, &m_mutex);
+    m_work = nullptr;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <pthread.h>
+
+namespace Threading {
+
+// A fixed set of threads that split up batches of independent work items between them.
+// Only one thread may hand work to the pool at a time, and it helps out until the batch is done.
+class WorkerPool {
+    AK_MAKE_NONCOPYABLE(WorkerPool);
+    AK_MAKE_NONMOVABLE(WorkerPool);
+
+public:
+    WorkerPool(size_t thread_count, StringView name);
+    ~WorkerPool();
+
+    // The number of threads that work on a batch, including the one that submits it.
+    size_t concurrency() const { return m_threads.size() + 1; }
+
+    // Calls `work` once for every index in [0, count), and returns once all of those calls have returned.
+    void for_each_index(size_t count, Function<void(size_t)> const& work);
+
+private:
+    void worker_main();
+    void run_work_items(Function<void(size_t)> const& work, size_t count);
+
+    // NOTE: These are plain pthreads rather than Threading::Thread, since the pool has to be able
+    //       to reliably join them before it goes away.
+    Vector<pthread_t> m_threads;
+
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_work_available;
+    pthread_cond_t m_work_done;
+
+    // These are protected by m_mutex, except for m_next_index.
+    Function<void(size_t)> const* m_work { nullptr };
+    size_t m_count { 0 };
+    u64 m_generation { 0 };
+    size_t m_busy_workers { 0 };
+    bool m_exiting { false };
+
+    Atomic<size_t> m_next_index { 0 };
+};
+
+}
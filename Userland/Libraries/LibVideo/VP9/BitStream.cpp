@@ -28,11 +28,25 @@ bool BitStream::read_bit()
     return bit_value;
 }
 
-u8 BitStream::read_f(size_t n)
+u32 BitStream::read_f(size_t n)
 {
-    u8 result = 0;
-    for (size_t i = 0; i < n; i++) {
-        result = (2 * result) + read_bit();
+    u32 result = 0;
+    while (n > 0) {
+        if (!m_current_byte.has_value()) {
+            m_current_byte = read_byte();
+            m_current_bit_position = 7;
+        }
+
+        // Take as many of the bits we need as the current byte has left in one go.
+        size_t bits_left_in_byte = m_current_bit_position + 1;
+        size_t bit_count = min(n, bits_left_in_byte);
+        u32 bits = (m_current_byte.value() >> (bits_left_in_byte - bit_count)) & ((1u << bit_count) - 1);
+        result = (result << bit_count) | bits;
+        n -= bit_count;
+
+        m_current_bit_position -= bit_count;
+        if (m_current_bit_position < 0)
+            m_current_byte.clear();
     }
     return result;
 }
@@ -64,9 +78,22 @@ bool BitStream::init_bool(size_t bytes)
     m_bool_value = read_f8();
     m_bool_range = 255;
     m_bool_max_bits = (8 * bytes) - 8;
+    m_bool_window = 0;
+    m_bool_window_bits = 0;
     return !read_bool(128);
 }
 
+void BitStream::fill_bool_window()
+{
+    while (m_bool_window_bits <= 56 && m_bool_max_bits > 0) {
+        u8 bit_count = min<u64>(8, m_bool_max_bits);
+        u64 bits = read_f(bit_count);
+        m_bool_window |= bits << (64 - m_bool_window_bits - bit_count);
+        m_bool_window_bits += bit_count;
+        m_bool_max_bits -= bit_count;
+    }
+}
+
 /* 9.2.2 */
 bool BitStream::read_bool(u8 probability)
 {
@@ -82,16 +109,16 @@ bool BitStream::read_bool(u8 probability)
         return_bool = true;
     }
 
-    while (m_bool_range < 128) {
-        bool new_bit;
-        if (m_bool_max_bits) {
-            new_bit = read_bit();
-            m_bool_max_bits--;
-        } else {
-            new_bit = false;
-        }
-        m_bool_range *= 2;
-        m_bool_value = (m_bool_value << 1u) + new_bit;
+    if (m_bool_range < 128) {
+        // Shift in all the bits it takes to get the range back to at least 128 at once, instead of one at a time.
+        // Once the bool-coded data runs out, the window only has zeroes left to shift in.
+        u8 bits_needed = __builtin_clz(m_bool_range) - 24;
+        if (m_bool_window_bits < bits_needed)
+            fill_bool_window();
+        m_bool_range <<= bits_needed;
+        m_bool_value = (m_bool_value << bits_needed) | (m_bool_window >> (64 - bits_needed));
+        m_bool_window <<= bits_needed;
+        m_bool_window_bits -= min(bits_needed, m_bool_window_bits);
     }
 
     return return_bool;
@@ -100,12 +127,17 @@ bool BitStream::read_bool(u8 probability)
 /* 9.2.3 */
 bool BitStream::exit_bool()
 {
+    // The bits we've already taken into the window are padding as well.
+    bool window_is_zero = m_bool_window == 0;
+    m_bool_window = 0;
+    m_bool_window_bits = 0;
+
     // FIXME: I'm not sure if this call to min is spec compliant, or if there is an issue elsewhere earlier in the parser.
     auto padding_element = read_f(min(m_bool_max_bits, (u64)bits_remaining()));
 
     // FIXME: It is a requirement of bitstream conformance that enough padding bits are inserted to ensure that the final coded byte of a frame is not equal to a superframe marker.
     //  A byte b is equal to a superframe marker if and only if (b & 0xe0)is equal to 0xc0, i.e. if the most significant 3 bits are equal to 0b110.
-    return padding_element == 0;
+    return window_is_zero && padding_element == 0;
 }
 
 u8 BitStream::read_literal(size_t n)
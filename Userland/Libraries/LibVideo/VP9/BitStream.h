@@ -23,7 +23,7 @@ public:
     bool read_bit();
 
     /* (9.1) */
-    u8 read_f(size_t n);
+    u32 read_f(size_t n);
     u8 read_f8();
     u16 read_f16();
 
@@ -41,6 +41,8 @@ public:
     size_t bits_remaining();
 
 private:
+    void fill_bool_window();
+
     u8 const* m_data_ptr { nullptr };
     size_t m_bytes_remaining { 0 };
     Optional<u8> m_current_byte;
@@ -50,6 +52,10 @@ private:
     u8 m_bool_value { 0 };
     u8 m_bool_range { 0 };
     u64 m_bool_max_bits { 0 };
+
+    // Bool-coded bits that have been read ahead, starting at the most significant bit.
+    u64 m_bool_window { 0 };
+    u8 m_bool_window_bits { 0 };
 };
 
 }
@@ -4,52 +4,74 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
-#include <LibWeb/CSS/CSSStyleRule.h>
 #include <LibWeb/CSS/StyleInvalidator.h>
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
+#include <LibWeb/HTML/AttributeNames.h>
 
 namespace Web::CSS {
 
-StyleInvalidator::StyleInvalidator(DOM::Document& document)
-    : m_document(document)
+StyleInvalidator::StyleInvalidator(DOM::Element& element, FlyString const& attribute_name)
+    : m_element(element)
+    , m_attribute_name(attribute_name)
 {
-    if (!m_document.should_invalidate_styles_on_attribute_changes())
+    if (!m_element.document().should_invalidate_styles_on_attribute_changes())
         return;
-    auto& style_resolver = m_document.style_resolver();
-    m_document.for_each_in_inclusive_subtree_of_type<DOM::Element>([&](auto& element) {
-        m_elements_and_matching_rules_before.set(&element, style_resolver.collect_matching_rules(element));
-        return IterationDecision::Continue;
-    });
+    m_old_value = m_element.attribute(m_attribute_name);
 }
 
 StyleInvalidator::~StyleInvalidator()
 {
-    if (!m_document.should_invalidate_styles_on_attribute_changes())
+    auto& document = m_element.document();
+    if (!document.should_invalidate_styles_on_attribute_changes())
         return;
-    auto& style_resolver = m_document.style_resolver();
-    m_document.for_each_in_inclusive_subtree_of_type<DOM::Element>([&](auto& element) {
-        auto maybe_matching_rules_before = m_elements_and_matching_rules_before.get(&element);
-        if (!maybe_matching_rules_before.has_value()) {
-            element.set_needs_style_update(true);
-            return IterationDecision::Continue;
-        }
-        auto& matching_rules_before = maybe_matching_rules_before.value();
-        auto matching_rules_after = style_resolver.collect_matching_rules(element);
-        if (matching_rules_before.size() != matching_rules_after.size()) {
-            element.set_needs_style_update(true);
-            return IterationDecision::Continue;
+
+    auto new_value = m_element.attribute(m_attribute_name);
+    if (new_value.is_null() == m_old_value.is_null() && new_value == m_old_value)
+        return;
+
+    // Attributes can also affect an element through presentational hints, or its intrinsic size.
+    if (auto* layout_node = m_element.layout_node()) {
+        layout_node->set_needs_layout();
+        document.schedule_layout_update();
+    }
+
+    auto& style_resolver = document.style_resolver();
+    auto scope = style_resolver.invalidation_scope_for_attribute(m_attribute_name) | StyleInvalidationScope::Self;
+
+    if (m_attribute_name == HTML::AttributeNames::id) {
+        if (!m_old_value.is_empty())
+            scope |= style_resolver.invalidation_scope_for_id(m_old_value);
+        if (!new_value.is_empty())
+            scope |= style_resolver.invalidation_scope_for_id(new_value);
+    } else if (m_attribute_name == HTML::AttributeNames::class_) {
+        // Only the classes that were added or removed matter.
+        auto old_classes = m_old_value.split_view(' ');
+        auto new_classes = new_value.split_view(' ');
+        for (auto& class_name : old_classes) {
+            if (!new_classes.contains_slow(class_name))
+                scope |= style_resolver.invalidation_scope_for_class(class_name);
         }
-        style_resolver.sort_matching_rules(matching_rules_before);
-        style_resolver.sort_matching_rules(matching_rules_after);
-        for (size_t i = 0; i < matching_rules_before.size(); ++i) {
-            if (matching_rules_before[i].rule != matching_rules_after[i].rule) {
-                element.set_needs_style_update(true);
-                break;
-            }
+        for (auto& class_name : new_classes) {
+            if (!old_classes.contains_slow(class_name))
+                scope |= style_resolver.invalidation_scope_for_class(class_name);
         }
-        return IterationDecision::Continue;
-    });
+    }
+
+    invalidate(m_element, scope);
+}
+
+void StyleInvalidator::invalidate(DOM::Element& element, StyleInvalidationScope scope)
+{
+    if (has_flag(scope, StyleInvalidationScope::Descendants))
+        element.invalidate_style();
+    else if (has_flag(scope, StyleInvalidationScope::Self))
+        element.set_needs_style_update(true);
+
+    if (has_flag(scope, StyleInvalidationScope::LaterSiblings)) {
+        for (auto* sibling = element.next_element_sibling(); sibling; sibling = sibling->next_element_sibling())
+            sibling->invalidate_style();
+    }
 }
 
 }
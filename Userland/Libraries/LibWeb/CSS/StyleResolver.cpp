@@ -6,6 +6,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BloomFilter.h>
 #include <AK/QuickSort.h>
 #include <LibWeb/CSS/CSSStyleRule.h>
 #include <LibWeb/CSS/Parser/Parser.h>
@@ -15,6 +16,7 @@
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
 #include <LibWeb/Dump.h>
+#include <LibWeb/HTML/AttributeNames.h>
 #include <ctype.h>
 #include <stdio.h>
 
@@ -62,9 +64,138 @@ void StyleResolver::for_each_stylesheet(Callback callback) const
     }
 }
 
-Vector<MatchingRule> StyleResolver::collect_matching_rules(DOM::Element const& element) const
+// Ids, classes and tag names are hashed into the same ancestor filter, so they're salted to keep them apart.
+enum class AncestorHashKind : u32 {
+    Id = 1,
+    Class,
+    TagName,
+};
+
+static unsigned ancestor_hash(AncestorHashKind kind, unsigned string_hash)
 {
-    Vector<MatchingRule> matching_rules;
+    // Zero marks an unused slot in RuleCache::Entry::ancestor_hashes.
+    auto hash = pair_int_hash(string_hash, to_underlying(kind));
+    return hash ? hash : 1;
+}
+
+using AncestorFilter = BloomFilter<1024>;
+
+static AncestorFilter build_ancestor_filter(DOM::Element const& element)
+{
+    AncestorFilter filter;
+    for (auto* ancestor = element.parent_element(); ancestor; ancestor = ancestor->parent_element()) {
+        filter.add(ancestor_hash(AncestorHashKind::TagName, ancestor->local_name().hash()));
+        if (auto id = ancestor->attribute(HTML::AttributeNames::id); !id.is_null())
+            filter.add(ancestor_hash(AncestorHashKind::Id, id.hash()));
+        for (auto& class_name : ancestor->class_names())
+            filter.add(ancestor_hash(AncestorHashKind::Class, class_name.hash()));
+    }
+    return filter;
+}
+
+void StyleResolver::invalidate_rule_cache()
+{
+    m_rule_cache = nullptr;
+    // Any element may match a different set of rules now.
+    m_document.invalidate_style();
+}
+
+StyleResolver::RuleCache const& StyleResolver::rule_cache() const
+{
+    if (!m_rule_cache || m_rule_cache->built_in_quirks_mode != document().in_quirks_mode())
+        build_rule_cache();
+    return *m_rule_cache;
+}
+
+static void add_invalidation_scope(HashMap<FlyString, StyleInvalidationScope>& scopes, FlyString const& name, StyleInvalidationScope scope)
+{
+    scopes.ensure(name) |= scope;
+}
+
+void StyleResolver::collect_invalidation_scopes(RuleCache& rule_cache, Selector const& selector, StyleInvalidationScope subject_scope)
+{
+    auto& compound_selectors = selector.compound_selectors();
+    bool has_sibling_combinator_to_the_right = false;
+    for (size_t i = compound_selectors.size(); i-- > 0;) {
+        // A change to an element matched by a compound selector that isn't the rightmost one
+        // can change the style of anything that is reached from it through the combinators.
+        auto scope = subject_scope;
+        if (i != compound_selectors.size() - 1) {
+            scope |= StyleInvalidationScope::Descendants;
+            if (has_sibling_combinator_to_the_right)
+                scope |= StyleInvalidationScope::LaterSiblings;
+        }
+
+        for (auto& simple_selector : compound_selectors[i].simple_selectors) {
+            switch (simple_selector.type) {
+            case Selector::SimpleSelector::Type::Id:
+                add_invalidation_scope(rule_cache.id_invalidation_scopes, simple_selector.value, scope);
+                break;
+            case Selector::SimpleSelector::Type::Class:
+                add_invalidation_scope(rule_cache.class_invalidation_scopes, simple_selector.value, scope);
+                break;
+            case Selector::SimpleSelector::Type::Attribute:
+                add_invalidation_scope(rule_cache.attribute_invalidation_scopes, simple_selector.attribute.name, scope);
+                break;
+            case Selector::SimpleSelector::Type::PseudoClass:
+                switch (simple_selector.pseudo_class.type) {
+                case Selector::SimpleSelector::PseudoClass::Type::Hover:
+                    rule_cache.hover_invalidation_scope |= scope;
+                    break;
+                case Selector::SimpleSelector::PseudoClass::Type::Link:
+                    // Everything inside a link is a link as well.
+                    add_invalidation_scope(rule_cache.attribute_invalidation_scopes, HTML::AttributeNames::href, scope | StyleInvalidationScope::Descendants);
+                    break;
+                case Selector::SimpleSelector::PseudoClass::Type::Disabled:
+                case Selector::SimpleSelector::PseudoClass::Type::Enabled:
+                    add_invalidation_scope(rule_cache.attribute_invalidation_scopes, HTML::AttributeNames::disabled, scope);
+                    break;
+                case Selector::SimpleSelector::PseudoClass::Type::Checked:
+                    add_invalidation_scope(rule_cache.attribute_invalidation_scopes, HTML::AttributeNames::checked, scope);
+                    break;
+                case Selector::SimpleSelector::PseudoClass::Type::Not:
+                    for (auto& not_selector : simple_selector.pseudo_class.not_selector)
+                        collect_invalidation_scopes(rule_cache, not_selector, scope);
+                    break;
+                default:
+                    break;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        auto combinator = compound_selectors[i].combinator;
+        if (combinator == Selector::Combinator::NextSibling || combinator == Selector::Combinator::SubsequentSibling)
+            has_sibling_combinator_to_the_right = true;
+    }
+}
+
+StyleInvalidationScope StyleResolver::invalidation_scope_for_id(FlyString const& id) const
+{
+    return rule_cache().id_invalidation_scopes.get(id).value_or(StyleInvalidationScope::None);
+}
+
+StyleInvalidationScope StyleResolver::invalidation_scope_for_class(FlyString const& class_name) const
+{
+    return rule_cache().class_invalidation_scopes.get(class_name).value_or(StyleInvalidationScope::None);
+}
+
+StyleInvalidationScope StyleResolver::invalidation_scope_for_attribute(FlyString const& attribute_name) const
+{
+    return rule_cache().attribute_invalidation_scopes.get(attribute_name).value_or(StyleInvalidationScope::None);
+}
+
+StyleInvalidationScope StyleResolver::invalidation_scope_for_hover() const
+{
+    return rule_cache().hover_invalidation_scope;
+}
+
+void StyleResolver::build_rule_cache() const
+{
+    auto rule_cache = make<RuleCache>();
+    rule_cache->built_in_quirks_mode = document().in_quirks_mode();
 
     size_t style_sheet_index = 0;
     for_each_stylesheet([&](auto& sheet) {
@@ -72,10 +203,50 @@ Vector<MatchingRule> StyleResolver::collect_matching_rules(DOM::Element const& e
         static_cast<CSSStyleSheet const&>(sheet).for_each_effective_style_rule([&](auto& rule) {
             size_t selector_index = 0;
             for (auto& selector : rule.selectors()) {
-                if (SelectorEngine::matches(selector, element)) {
-                    matching_rules.append({ rule, style_sheet_index, rule_index, selector_index, selector.specificity() });
-                    break;
+                RuleCache::Entry entry { { rule, style_sheet_index, rule_index, selector_index, selector.specificity() }, {} };
+
+                // Compound selectors that are reached through a descendant or child combinator have to match an ancestor.
+                auto& compound_selectors = selector.compound_selectors();
+                size_t ancestor_hash_count = 0;
+                for (size_t i = compound_selectors.size() - 1; i > 0 && ancestor_hash_count < RuleCache::max_ancestor_hashes; --i) {
+                    auto combinator = compound_selectors[i].combinator;
+                    if (combinator != Selector::Combinator::Descendant && combinator != Selector::Combinator::ImmediateChild)
+                        continue;
+                    for (auto& simple_selector : compound_selectors[i - 1].simple_selectors) {
+                        if (ancestor_hash_count == RuleCache::max_ancestor_hashes)
+                            break;
+                        if (simple_selector.type == Selector::SimpleSelector::Type::Id)
+                            entry.ancestor_hashes[ancestor_hash_count++] = ancestor_hash(AncestorHashKind::Id, simple_selector.value.hash());
+                        else if (simple_selector.type == Selector::SimpleSelector::Type::Class)
+                            entry.ancestor_hashes[ancestor_hash_count++] = ancestor_hash(AncestorHashKind::Class, simple_selector.value.hash());
+                        else if (simple_selector.type == Selector::SimpleSelector::Type::TagName)
+                            entry.ancestor_hashes[ancestor_hash_count++] = ancestor_hash(AncestorHashKind::TagName, simple_selector.value.hash());
+                    }
+                }
+
+                collect_invalidation_scopes(*rule_cache, selector, StyleInvalidationScope::Self);
+
+                Selector::SimpleSelector const* id_selector = nullptr;
+                Selector::SimpleSelector const* class_selector = nullptr;
+                Selector::SimpleSelector const* tag_name_selector = nullptr;
+                for (auto& simple_selector : compound_selectors.last().simple_selectors) {
+                    if (simple_selector.type == Selector::SimpleSelector::Type::Id && !id_selector)
+                        id_selector = &simple_selector;
+                    else if (simple_selector.type == Selector::SimpleSelector::Type::Class && !class_selector)
+                        class_selector = &simple_selector;
+                    else if (simple_selector.type == Selector::SimpleSelector::Type::TagName && !tag_name_selector)
+                        tag_name_selector = &simple_selector;
                 }
+
+                if (id_selector)
+                    rule_cache->rules_by_id.ensure(id_selector->value).append(move(entry));
+                else if (class_selector)
+                    rule_cache->rules_by_class.ensure(class_selector->value).append(move(entry));
+                else if (tag_name_selector)
+                    rule_cache->rules_by_tag_name.ensure(tag_name_selector->value).append(move(entry));
+                else
+                    rule_cache->other_rules.append(move(entry));
+
                 ++selector_index;
             }
             ++rule_index;
@@ -83,6 +254,68 @@ Vector<MatchingRule> StyleResolver::collect_matching_rules(DOM::Element const& e
         ++style_sheet_index;
     });
 
+    m_rule_cache = move(rule_cache);
+}
+
+Vector<MatchingRule> StyleResolver::collect_matching_rules(DOM::Element const& element) const
+{
+    auto& rule_cache = this->rule_cache();
+    Vector<MatchingRule> matching_rules;
+    Optional<AncestorFilter> ancestor_filter;
+
+    auto add_matching_rules = [&](Vector<RuleCache::Entry> const& entries) {
+        for (auto& entry : entries) {
+            if (entry.ancestor_hashes[0]) {
+                if (!ancestor_filter.has_value())
+                    ancestor_filter = build_ancestor_filter(element);
+                bool rejected = false;
+                for (auto hash : entry.ancestor_hashes) {
+                    if (hash && !ancestor_filter->may_contain(hash)) {
+                        rejected = true;
+                        break;
+                    }
+                }
+                if (rejected)
+                    continue;
+            }
+            auto& matching_rule = entry.matching_rule;
+            if (SelectorEngine::matches(matching_rule.rule->selectors()[matching_rule.selector_index], element))
+                matching_rules.append(matching_rule);
+        }
+    };
+
+    if (auto id = element.attribute(HTML::AttributeNames::id); !id.is_null()) {
+        if (auto it = rule_cache.rules_by_id.find(id); it != rule_cache.rules_by_id.end())
+            add_matching_rules(it->value);
+    }
+    for (auto& class_name : element.class_names()) {
+        if (auto it = rule_cache.rules_by_class.find(class_name); it != rule_cache.rules_by_class.end())
+            add_matching_rules(it->value);
+    }
+    if (auto it = rule_cache.rules_by_tag_name.find(element.local_name()); it != rule_cache.rules_by_tag_name.end())
+        add_matching_rules(it->value);
+    add_matching_rules(rule_cache.other_rules);
+
+    // A rule can be found through several of its selectors (or through a class that's listed twice),
+    // but only its first matching selector counts.
+    if (matching_rules.size() > 1) {
+        quick_sort(matching_rules, [](MatchingRule const& a, MatchingRule const& b) {
+            if (a.style_sheet_index != b.style_sheet_index)
+                return a.style_sheet_index < b.style_sheet_index;
+            if (a.rule_index != b.rule_index)
+                return a.rule_index < b.rule_index;
+            return a.selector_index < b.selector_index;
+        });
+        size_t unique_count = 1;
+        for (size_t i = 1; i < matching_rules.size(); ++i) {
+            auto& previous = matching_rules[unique_count - 1];
+            if (matching_rules[i].style_sheet_index == previous.style_sheet_index && matching_rules[i].rule_index == previous.rule_index)
+                continue;
+            matching_rules[unique_count++] = move(matching_rules[i]);
+        }
+        matching_rules.shrink(unique_count);
+    }
+
     return matching_rules;
 }
 
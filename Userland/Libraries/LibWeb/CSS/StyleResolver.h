@@ -6,6 +6,10 @@
 
 #pragma once
 
+#include <AK/Array.h>
+#include <AK/EnumBits.h>
+#include <AK/FlyString.h>
+#include <AK/HashMap.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <LibWeb/CSS/CSSStyleDeclaration.h>
@@ -22,6 +26,17 @@ struct MatchingRule {
     u32 specificity { 0 };
 };
 
+// Which elements may need their style recomputed when something about an element changes.
+enum class StyleInvalidationScope : u8 {
+    None = 0,
+    Self = 1 << 0,
+    Descendants = 1 << 1,
+    // The element's later siblings, and everything below them.
+    LaterSiblings = 1 << 2,
+};
+
+AK_ENUM_BITWISE_OPERATORS(StyleInvalidationScope);
+
 class StyleResolver {
 public:
     explicit StyleResolver(DOM::Document&);
@@ -41,11 +56,50 @@ public:
     CustomPropertyResolutionTuple resolve_custom_property_with_specificity(DOM::Element&, String const&) const;
     Optional<StyleProperty> resolve_custom_property(DOM::Element&, String const&) const;
 
+    // Must be called whenever the set of style rules that apply to the document changes.
+    void invalidate_rule_cache();
+
+    // Derived from the selectors that mention the given id, class, attribute or pseudo-class.
+    StyleInvalidationScope invalidation_scope_for_id(FlyString const&) const;
+    StyleInvalidationScope invalidation_scope_for_class(FlyString const&) const;
+    StyleInvalidationScope invalidation_scope_for_attribute(FlyString const&) const;
+    StyleInvalidationScope invalidation_scope_for_hover() const;
+
 private:
     template<typename Callback>
     void for_each_stylesheet(Callback) const;
 
+    // Every selector of every style rule, bucketed by the most specific part of its rightmost compound selector,
+    // so that matching an element only needs to look at the rules that could possibly apply to it.
+    struct RuleCache {
+        static constexpr size_t max_ancestor_hashes = 4;
+
+        struct Entry {
+            MatchingRule matching_rule;
+            // Hashes of ids, classes and tag names that some ancestor of a matching element must have.
+            // Unused slots are zero.
+            Array<unsigned, max_ancestor_hashes> ancestor_hashes {};
+        };
+
+        HashMap<FlyString, Vector<Entry>> rules_by_id;
+        HashMap<FlyString, Vector<Entry>> rules_by_class;
+        HashMap<FlyString, Vector<Entry>> rules_by_tag_name;
+        Vector<Entry> other_rules;
+
+        HashMap<FlyString, StyleInvalidationScope> id_invalidation_scopes;
+        HashMap<FlyString, StyleInvalidationScope> class_invalidation_scopes;
+        HashMap<FlyString, StyleInvalidationScope> attribute_invalidation_scopes;
+        StyleInvalidationScope hover_invalidation_scope { StyleInvalidationScope::None };
+
+        bool built_in_quirks_mode { false };
+    };
+
+    RuleCache const& rule_cache() const;
+    void build_rule_cache() const;
+    static void collect_invalidation_scopes(RuleCache&, Selector const&, StyleInvalidationScope subject_scope);
+
     DOM::Document& m_document;
+    mutable OwnPtr<RuleCache> m_rule_cache;
 };
 
 }
@@ -15,6 +15,7 @@
 #include <LibJS/Runtime/FunctionObject.h>
 #include <LibWeb/Bindings/MainThreadVM.h>
 #include <LibWeb/Bindings/WindowObject.h>
+#include <LibWeb/CSS/StyleInvalidator.h>
 #include <LibWeb/CSS/StyleResolver.h>
 #include <LibWeb/Cookie/ParsedCookie.h>
 #include <LibWeb/DOM/Comment.h>
@@ -72,6 +73,10 @@ Document::Document(const URL& url)
     m_forced_layout_timer = Core::Timer::create_single_shot(0, [this] {
         force_layout();
     });
+
+    m_layout_update_timer = Core::Timer::create_single_shot(0, [this] {
+        update_layout();
+    });
 }
 
 Document::~Document()
@@ -157,6 +162,13 @@ void Document::schedule_forced_layout()
     m_forced_layout_timer->start();
 }
 
+void Document::schedule_layout_update()
+{
+    if (m_layout_update_timer->is_active())
+        return;
+    m_layout_update_timer->start();
+}
+
 bool Document::is_child_allowed(const Node& node) const
 {
     switch (node.type()) {
@@ -407,8 +419,19 @@ void Document::update_layout()
         m_layout_root = static_ptr_cast<Layout::InitialContainingBlockBox>(tree_builder.build(*this));
     }
 
+    auto viewport_size = browsing_context()->viewport_rect().size();
+    if (viewport_size != m_last_layout_viewport_size) {
+        m_last_layout_viewport_size = viewport_size;
+        m_layout_root->set_needs_layout();
+    }
+
+    // Nothing has changed since the last layout.
+    if (!m_layout_root->needs_layout() && !m_layout_root->child_needs_layout())
+        return;
+
     Layout::BlockFormattingContext root_formatting_context(*m_layout_root, nullptr);
     root_formatting_context.run(*m_layout_root, Layout::LayoutMode::Default);
+    m_layout_root->clear_needs_layout_in_subtree();
 
     m_layout_root->set_needs_display();
 
@@ -418,25 +441,38 @@ void Document::update_layout()
     }
 }
 
-static void update_style_recursively(DOM::Node& node)
+static void update_style_recursively(DOM::Node& node, bool update_whole_subtree, size_t& restyled_element_count)
 {
     node.for_each_child([&](auto& child) {
-        if (child.needs_style_update()) {
-            if (is<Element>(child))
+        bool update_child_subtree = update_whole_subtree || child.subtree_needs_style_update();
+        if (update_child_subtree || child.needs_style_update()) {
+            if (is<Element>(child)) {
                 verify_cast<Element>(child).recompute_style();
+                ++restyled_element_count;
+            }
             child.set_needs_style_update(false);
         }
-        if (child.child_needs_style_update()) {
-            update_style_recursively(child);
+        if (update_child_subtree || child.child_needs_style_update()) {
+            update_style_recursively(child, update_child_subtree, restyled_element_count);
             child.set_child_needs_style_update(false);
         }
+        child.set_subtree_needs_style_update(false);
         return IterationDecision::Continue;
     });
 }
 
 void Document::update_style()
 {
-    update_style_recursively(*this);
+    size_t restyled_element_count = 0;
+    update_style_recursively(*this, subtree_needs_style_update(), restyled_element_count);
+    set_subtree_needs_style_update(false);
+    set_child_needs_style_update(false);
+
+    ++m_style_update_statistics.style_updates;
+    m_style_update_statistics.elements_restyled_in_last_update = restyled_element_count;
+    m_style_update_statistics.max_elements_restyled_in_one_update = max(m_style_update_statistics.max_elements_restyled_in_one_update, restyled_element_count);
+    m_style_update_statistics.total_elements_restyled += restyled_element_count;
+
     update_layout();
 }
 
@@ -492,7 +528,28 @@ void Document::set_hovered_node(Node* node)
     RefPtr<Node> old_hovered_node = move(m_hovered_node);
     m_hovered_node = node;
 
-    invalidate_style();
+    auto scope = style_resolver().invalidation_scope_for_hover();
+    if (scope == CSS::StyleInvalidationScope::None)
+        return;
+
+    // An element is hovered if the hovered node is one of its inclusive descendants,
+    // so only elements above one of the two nodes, but not both, change their hover state.
+    auto inclusive_ancestor_element = [](Node* node) -> Element* {
+        if (!node || is<Element>(*node))
+            return static_cast<Element*>(node);
+        return node->parent_element();
+    };
+    auto is_inclusive_ancestor_of = [](Element& element, Node* node) {
+        return node && (&element == node || element.is_ancestor_of(*node));
+    };
+    for (auto* element = inclusive_ancestor_element(old_hovered_node); element; element = element->parent_element()) {
+        if (!is_inclusive_ancestor_of(*element, m_hovered_node))
+            CSS::StyleInvalidator::invalidate(*element, scope);
+    }
+    for (auto* element = inclusive_ancestor_element(m_hovered_node); element; element = element->parent_element()) {
+        if (!is_inclusive_ancestor_of(*element, old_hovered_node))
+            CSS::StyleInvalidator::invalidate(*element, scope);
+    }
 }
 
 NonnullRefPtr<HTMLCollection> Document::get_elements_by_name(String const& name)
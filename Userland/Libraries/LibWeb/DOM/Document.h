@@ -144,6 +144,14 @@ public:
     void update_style();
     void update_layout();
 
+    struct StyleUpdateStatistics {
+        u64 style_updates { 0 };
+        u64 total_elements_restyled { 0 };
+        size_t elements_restyled_in_last_update { 0 };
+        size_t max_elements_restyled_in_one_update { 0 };
+    };
+    StyleUpdateStatistics const& style_update_statistics() const { return m_style_update_statistics; }
+
     virtual bool is_child_allowed(const Node&) const override;
 
     const Layout::InitialContainingBlockBox* layout_node() const;
@@ -151,6 +159,7 @@ public:
 
     void schedule_style_update();
     void schedule_forced_layout();
+    void schedule_layout_update();
 
     NonnullRefPtr<HTMLCollection> get_elements_by_name(String const&);
     NonnullRefPtr<HTMLCollection> get_elements_by_tag_name(FlyString const&);
@@ -316,6 +325,8 @@ private:
 
     RefPtr<Core::Timer> m_style_update_timer;
     RefPtr<Core::Timer> m_forced_layout_timer;
+    RefPtr<Core::Timer> m_layout_update_timer;
+    Gfx::IntSize m_last_layout_viewport_size;
 
     String m_source;
 
@@ -345,6 +356,8 @@ private:
 
     bool m_should_invalidate_styles_on_attribute_changes { true };
 
+    StyleUpdateStatistics m_style_update_statistics;
+
     u32 m_ignore_destructive_writes_counter { 0 };
 };
 
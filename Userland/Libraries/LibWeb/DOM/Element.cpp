@@ -71,7 +71,7 @@ ExceptionOr<void> Element::set_attribute(const FlyString& name, const String& va
     if (name.is_empty())
         return InvalidCharacterError::create("Attribute name must not be empty");
 
-    CSS::StyleInvalidator style_invalidator(document());
+    CSS::StyleInvalidator style_invalidator(*this, name);
 
     if (auto* attribute = find_attribute(name))
         attribute->set_value(value);
@@ -84,7 +84,7 @@ ExceptionOr<void> Element::set_attribute(const FlyString& name, const String& va
 
 void Element::remove_attribute(const FlyString& name)
 {
-    CSS::StyleInvalidator style_invalidator(document());
+    CSS::StyleInvalidator style_invalidator(*this, name);
 
     m_attributes.remove_first_matching([&](auto& attribute) { return attribute.name() == name; });
 }
@@ -170,29 +170,46 @@ enum class StyleDifference {
     None,
     NeedsRepaint,
     NeedsRelayout,
+    NeedsLayoutTreeRebuild,
 };
 
-static StyleDifference compute_style_difference(const CSS::StyleProperties& old_style, const CSS::StyleProperties& new_style, const Document& document)
+static StyleDifference compute_style_difference(const CSS::StyleProperties& old_style, const CSS::StyleProperties& new_style)
 {
     if (old_style == new_style)
         return StyleDifference::None;
 
-    bool needs_repaint = false;
-    bool needs_relayout = false;
-
+    // A different display type may need a different kind of layout node.
     if (new_style.display() != old_style.display())
-        needs_relayout = true;
+        return StyleDifference::NeedsLayoutTreeRebuild;
+
+    // If nothing but the colors changed, the existing layout is still good.
+    auto old_style_without_colors = old_style.clone();
+    auto new_style_without_colors = new_style.clone();
+    for (auto property_id : { CSS::PropertyID::Color, CSS::PropertyID::BackgroundColor }) {
+        old_style_without_colors->set_property(property_id, CSS::InitialStyleValue::the());
+        new_style_without_colors->set_property(property_id, CSS::InitialStyleValue::the());
+    }
+    if (*old_style_without_colors == *new_style_without_colors)
+        return StyleDifference::NeedsRepaint;
 
-    if (new_style.color_or_fallback(CSS::PropertyID::Color, document, Color::Black) != old_style.color_or_fallback(CSS::PropertyID::Color, document, Color::Black))
-        needs_repaint = true;
-    else if (new_style.color_or_fallback(CSS::PropertyID::BackgroundColor, document, Color::Black) != old_style.color_or_fallback(CSS::PropertyID::BackgroundColor, document, Color::Black))
-        needs_repaint = true;
+    return StyleDifference::NeedsRelayout;
+}
 
-    if (needs_relayout)
-        return StyleDifference::NeedsRelayout;
-    if (needs_repaint)
-        return StyleDifference::NeedsRepaint;
-    return StyleDifference::None;
+static bool inherited_properties_differ(const CSS::StyleProperties& old_style, const CSS::StyleProperties& new_style)
+{
+    bool differ = false;
+    auto compare_against = [&](const CSS::StyleProperties& style, const CSS::StyleProperties& other_style) {
+        style.for_each_property([&](auto property_id, auto& value) {
+            if (differ || !CSS::is_inherited_property(property_id))
+                return;
+            auto other_value = other_style.property(property_id);
+            if (!other_value.has_value() || *other_value.value() != value)
+                differ = true;
+        });
+    };
+    compare_against(old_style, new_style);
+    compare_against(new_style, old_style);
+    return differ;
 }
 
 void Element::recompute_style()
@@ -202,6 +219,15 @@ void Element::recompute_style()
     auto old_specified_css_values = m_specified_css_values;
     auto new_specified_css_values = document().style_resolver().resolve_style(*this);
     m_specified_css_values = new_specified_css_values;
+
+    // Our children resolve their inherited properties from our specified values, so they have to follow along.
+    if (old_specified_css_values && inherited_properties_differ(*old_specified_css_values, *new_specified_css_values)) {
+        for_each_child_of_type<Element>([](auto& child) {
+            child.set_needs_style_update(true);
+            return IterationDecision::Continue;
+        });
+    }
+
     if (!layout_node()) {
         if (new_specified_css_values->display() == CSS::Display::None)
             return;
@@ -211,14 +237,19 @@ void Element::recompute_style()
         return;
     }
 
-    auto diff = StyleDifference::NeedsRelayout;
+    auto diff = StyleDifference::NeedsLayoutTreeRebuild;
     if (old_specified_css_values)
-        diff = compute_style_difference(*old_specified_css_values, *new_specified_css_values, document());
+        diff = compute_style_difference(*old_specified_css_values, *new_specified_css_values);
     if (diff == StyleDifference::None)
         return;
+    if (diff == StyleDifference::NeedsLayoutTreeRebuild) {
+        document().schedule_forced_layout();
+        return;
+    }
     layout_node()->apply_style(*new_specified_css_values);
     if (diff == StyleDifference::NeedsRelayout) {
-        document().schedule_forced_layout();
+        // Document::update_style() updates the layout right after this.
+        layout_node()->set_needs_layout();
         return;
     }
     if (diff == StyleDifference::NeedsRepaint) {
@@ -101,11 +101,7 @@ RefPtr<Layout::Node> Node::create_layout_node()
 
 void Node::invalidate_style()
 {
-    for_each_in_inclusive_subtree_of_type<Element>([&](auto& element) {
-        element.set_needs_style_update(true);
-        return IterationDecision::Continue;
-    });
-    document().schedule_style_update();
+    set_subtree_needs_style_update(true);
 }
 
 bool Node::is_link() const
@@ -531,6 +527,19 @@ void Node::set_needs_style_update(bool value)
     }
 }
 
+void Node::set_subtree_needs_style_update(bool value)
+{
+    if (m_subtree_needs_style_update == value)
+        return;
+    m_subtree_needs_style_update = value;
+
+    if (m_subtree_needs_style_update) {
+        for (auto* ancestor = parent(); ancestor; ancestor = ancestor->parent())
+            ancestor->m_child_needs_style_update = true;
+        document().schedule_style_update();
+    }
+}
+
 void Node::inserted()
 {
     set_needs_style_update(true);
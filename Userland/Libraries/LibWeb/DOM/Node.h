@@ -152,6 +152,11 @@ public:
     bool child_needs_style_update() const { return m_child_needs_style_update; }
     void set_child_needs_style_update(bool b) { m_child_needs_style_update = b; }
 
+    // Set when every element in this node's inclusive subtree needs its style updated,
+    // so that we don't have to walk the subtree just to mark it.
+    bool subtree_needs_style_update() const { return m_subtree_needs_style_update; }
+    void set_subtree_needs_style_update(bool);
+
     void invalidate_style();
 
     bool is_link() const;
@@ -182,6 +187,7 @@ protected:
     NodeType m_type { NodeType::INVALID };
     bool m_needs_style_update { false };
     bool m_child_needs_style_update { false };
+    bool m_subtree_needs_style_update { false };
 };
 
 }
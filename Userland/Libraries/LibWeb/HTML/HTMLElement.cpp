@@ -123,6 +123,8 @@ String HTMLElement::inner_text()
 
 unsigned HTMLElement::offset_top() const
 {
+    // The offsets come from the layout tree, so make sure it reflects any pending changes first.
+    const_cast<DOM::Document&>(document()).update_layout();
     if (is<HTML::HTMLBodyElement>(this) || !layout_node() || !parent_element() || !parent_element()->layout_node())
         return 0;
     auto position = layout_node()->box_type_agnostic_position();
@@ -132,6 +134,8 @@ unsigned HTMLElement::offset_top() const
 
 unsigned HTMLElement::offset_left() const
 {
+    // The offsets come from the layout tree, so make sure it reflects any pending changes first.
+    const_cast<DOM::Document&>(document()).update_layout();
     if (is<HTML::HTMLBodyElement>(this) || !layout_node() || !parent_element() || !parent_element()->layout_node())
         return 0;
     auto position = layout_node()->box_type_agnostic_position();
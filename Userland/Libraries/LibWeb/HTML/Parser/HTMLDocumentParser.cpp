@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AnyOf.h>
 #include <AK/Debug.h>
 #include <AK/SourceLocation.h>
 #include <AK/Utf32View.h>
@@ -23,6 +24,7 @@
 #include <LibWeb/HTML/HTMLTemplateElement.h>
 #include <LibWeb/HTML/Parser/HTMLDocumentParser.h>
 #include <LibWeb/HTML/Parser/HTMLEncodingDetection.h>
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
 #include <LibWeb/HTML/Parser/HTMLToken.h>
 #include <LibWeb/Namespace.h>
 #include <LibWeb/SVG/TagNames.h>
@@ -120,7 +122,20 @@ void HTMLDocumentParser::run(const URL& url)
     m_document->set_url(url);
     m_document->set_source(m_tokenizer.source());
 
+    // Subresources further down the document can start loading while we're blocked on scripts.
+    if (m_document->page())
+        HTMLPreloadScanner::start(*m_document, m_tokenizer.source());
+
     for (;;) {
+        // Most of a typical document is text in the body, so take that from the tokenizer a run at a time
+        // instead of as a character token per code point.
+        if (m_insertion_mode == InsertionMode::InBody && !m_stack_of_open_elements.is_empty() && adjusted_current_node().namespace_() == Namespace::HTML) {
+            if (auto text = m_tokenizer.consume_plain_text_run(); !text.is_empty()) {
+                handle_plain_text_in_body(text);
+                continue;
+            }
+        }
+
         auto optional_token = m_tokenizer.next_token();
         if (!optional_token.has_value())
             break;
@@ -738,6 +753,16 @@ void HTMLDocumentParser::insert_character(u32 data)
     m_character_insertion_builder.append(Utf32View { &data, 1 });
 }
 
+void HTMLDocumentParser::insert_characters(StringView text)
+{
+    auto node = find_character_insertion_node();
+    if (node != m_character_insertion_node) {
+        flush_character_insertions();
+        m_character_insertion_node = node;
+    }
+    m_character_insertion_builder.append(text);
+}
+
 void HTMLDocumentParser::handle_after_head(HTMLToken& token)
 {
     if (token.is_character() && token.is_parser_whitespace()) {
@@ -1086,6 +1111,21 @@ bool HTMLDocumentParser::is_special_tag(const FlyString& tag_name, const FlyStri
     return false;
 }
 
+// Does what handle_in_body() does for a character token for each code point of `text`,
+// which is ASCII without any NUL (see HTMLTokenizer::consume_plain_text_run()).
+void HTMLDocumentParser::handle_plain_text_in_body(StringView text)
+{
+    // Reconstructing the active formatting elements again for the rest of the run would find them all open already.
+    reconstruct_the_active_formatting_elements();
+    insert_characters(text);
+
+    auto is_parser_whitespace = [](char c) {
+        return c == '\t' || c == '\n' || c == '\f' || c == '\r' || c == ' ';
+    };
+    if (any_of(text, [&](char c) { return !is_parser_whitespace(c); }))
+        m_frameset_ok = false;
+}
+
 void HTMLDocumentParser::handle_in_body(HTMLToken& token)
 {
     if (token.is_character()) {
@@ -76,6 +76,7 @@ private:
     void handle_in_head_noscript(HTMLToken&);
     void handle_after_head(HTMLToken&);
     void handle_in_body(HTMLToken&);
+    void handle_plain_text_in_body(StringView);
     void handle_after_body(HTMLToken&);
     void handle_after_after_body(HTMLToken&);
     void handle_text(HTMLToken&);
@@ -115,6 +116,7 @@ private:
     DOM::Element& adjusted_current_node();
     DOM::Element& node_before_current_node();
     void insert_character(u32 data);
+    void insert_characters(StringView);
     void insert_comment(HTMLToken&);
     void reconstruct_the_active_formatting_elements();
     void close_a_p_element();
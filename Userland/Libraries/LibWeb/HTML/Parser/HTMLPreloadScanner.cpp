@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/HashTable.h>
+#include <LibThreading/BackgroundAction.h>
+#include <LibWeb/DOM/Document.h>
+#include <LibWeb/HTML/Parser/HTMLPreloadScanner.h>
+#include <LibWeb/HTML/Parser/HTMLTokenizer.h>
+#include <LibWeb/Loader/LoadRequest.h>
+#include <LibWeb/Loader/ResourceLoader.h>
+
+namespace Web::HTML {
+
+// NOTE: HTMLToken::attribute() takes a FlyString, which can't be created off the main thread.
+static StringView attribute_value(HTMLToken const& token, StringView const& name)
+{
+    StringView value;
+    token.for_each_attribute([&](auto& attribute) {
+        if (attribute.local_name != name)
+            return IterationDecision::Continue;
+        value = attribute.value;
+        return IterationDecision::Break;
+    });
+    return value;
+}
+
+static bool is_stylesheet_link(HTMLToken const& token)
+{
+    bool is_stylesheet = false;
+    for (auto& part : attribute_value(token, "rel").split_view(' ')) {
+        // Alternate stylesheets aren't applied, so there's no point in loading them early.
+        if (part == "alternate")
+            return false;
+        if (part == "stylesheet")
+            is_stylesheet = true;
+    }
+    return is_stylesheet;
+}
+
+Vector<HTMLPreloadScanner::PreloadRequest> HTMLPreloadScanner::scan(StringView const& source)
+{
+    Vector<PreloadRequest> requests;
+    HashTable<String> seen_urls;
+    auto add_request = [&](ResourceKind kind, StringView const& url) {
+        if (url.is_empty() || seen_urls.set(url) != AK::HashSetResult::InsertedNewEntry)
+            return;
+        requests.append({ kind, url });
+    };
+
+    HTMLTokenizer tokenizer { source, "utf-8" };
+    for (;;) {
+        auto token = tokenizer.next_token();
+        if (!token.has_value() || token->is_end_of_file())
+            break;
+        if (!token->is_start_tag())
+            continue;
+
+        auto& tag_name = token->tag_name();
+        if (tag_name == "script") {
+            add_request(ResourceKind::Script, attribute_value(*token, "src"));
+            tokenizer.switch_to(HTMLTokenizer::State::ScriptData);
+        } else if (tag_name == "link") {
+            if (is_stylesheet_link(*token))
+                add_request(ResourceKind::StyleSheet, attribute_value(*token, "href"));
+        } else if (tag_name == "img") {
+            add_request(ResourceKind::Image, attribute_value(*token, "src"));
+        } else if (tag_name.is_one_of("style", "xmp", "iframe", "noembed", "noframes", "noscript")) {
+            // Markup in these is just text, so we have to skip over it the same way the parser would.
+            tokenizer.switch_to(HTMLTokenizer::State::RAWTEXT);
+        } else if (tag_name.is_one_of("textarea", "title")) {
+            tokenizer.switch_to(HTMLTokenizer::State::RCDATA);
+        } else if (tag_name == "plaintext") {
+            break;
+        }
+    }
+    return requests;
+}
+
+void HTMLPreloadScanner::start(DOM::Document& document, String const& source)
+{
+    ResourceLoader::the().discard_finished_preloads();
+    Threading::BackgroundAction<Vector<PreloadRequest>>::create(
+        [source](auto&) {
+            return scan(source);
+        },
+        [document = NonnullRefPtr(document)](auto requests) mutable {
+            if (!document->page())
+                return;
+            for (auto& request : requests) {
+                auto url = document->complete_url(request.url);
+                if (!url.is_valid())
+                    continue;
+                dbgln_if(HTML_PRELOAD_SCANNER_DEBUG, "HTMLPreloadScanner: Preloading {}", url);
+                auto type = request.kind == ResourceKind::Image ? Resource::Type::Image : Resource::Type::Generic;
+                ResourceLoader::the().preload_resource(type, LoadRequest::create_for_url_on_page(url, document->page()));
+            }
+        });
+}
+
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibWeb/Forward.h>
+
+namespace Web::HTML {
+
+// Tokenizes a document's source ahead of the parser to find the subresources it will need,
+// so they can start loading while the parser is still busy (for example, blocked on a script).
+class HTMLPreloadScanner {
+public:
+    enum class ResourceKind {
+        Script,
+        StyleSheet,
+        Image,
+    };
+
+    struct PreloadRequest {
+        ResourceKind kind;
+        String url;
+    };
+
+    // NOTE: This only touches its own tokenizer, so it's safe to call from any thread.
+    static Vector<PreloadRequest> scan(StringView const& source);
+
+    // Scans the source on a background thread, then starts loading what it found on the main thread.
+    static void start(DOM::Document&, String const& source);
+};
+
+}
@@ -6,6 +6,7 @@
 
 #include <AK/CharacterTypes.h>
 #include <AK/Debug.h>
+#include <AK/SIMD.h>
 #include <AK/SourceLocation.h>
 #include <LibTextCodec/Decoder.h>
 #include <LibWeb/HTML/Parser/Entities.h>
@@ -205,6 +206,56 @@ void HTMLTokenizer::skip(size_t count)
     }
 }
 
+// Returns how many bytes at the start of `bytes` the Data state would emit as plain characters,
+// i.e. ASCII other than '<', '&' and NUL. Checks sixteen bytes at a time while it can.
+static size_t plain_text_run_length(ReadonlyBytes bytes)
+{
+    using AK::SIMD::u8x16;
+
+    size_t length = 0;
+    for (; length + sizeof(u8x16) <= bytes.size(); length += sizeof(u8x16)) {
+        u8x16 chunk;
+        memcpy(&chunk, bytes.offset(length), sizeof(chunk));
+        auto stops = (chunk >= 0x80) | (chunk == '<') | (chunk == '&') | (chunk == 0);
+        u64 halves[2];
+        memcpy(halves, &stops, sizeof(halves));
+        if (halves[0] | halves[1])
+            break;
+    }
+    for (; length < bytes.size(); ++length) {
+        auto byte = bytes[length];
+        if (byte >= 0x80 || byte == '<' || byte == '&' || byte == 0)
+            break;
+    }
+    return length;
+}
+
+StringView HTMLTokenizer::consume_plain_text_run()
+{
+    if (m_state != State::Data || !m_queued_tokens.is_empty())
+        return {};
+
+    auto byte_offset = m_utf8_view.byte_offset_of(m_utf8_iterator);
+    auto remaining_input = m_decoded_input.bytes().slice(byte_offset);
+    auto length = plain_text_run_length(remaining_input);
+    if (length == 0)
+        return {};
+
+    // This is what skip(length) would do, without decoding the run one code point at a time.
+    m_source_positions.append(m_source_positions.last());
+    for (size_t i = 0; i < length; ++i) {
+        if (remaining_input[i] == '\n') {
+            m_source_positions.last().column = 0;
+            m_source_positions.last().line++;
+        } else {
+            m_source_positions.last().column++;
+        }
+    }
+    m_prev_utf8_iterator = m_utf8_view.iterator_at_byte_offset(byte_offset + length - 1);
+    m_utf8_iterator = m_utf8_view.iterator_at_byte_offset(byte_offset + length);
+    return m_decoded_input.substring_view(byte_offset, length);
+}
+
 Optional<u32> HTMLTokenizer::peek_code_point(size_t offset) const
 {
     auto it = m_utf8_iterator;
@@ -110,6 +110,10 @@ public:
 
     Optional<HTMLToken> next_token();
 
+    // If the Data state is about to emit plain text (ASCII other than '<', '&' and NUL), consumes all of it
+    // and returns it in one go instead of as a character token per code point. Otherwise returns an empty view.
+    StringView consume_plain_text_run();
+
     void switch_to(Badge<HTMLDocumentParser>, State new_state);
     void switch_to(State new_state)
     {
@@ -50,8 +50,15 @@ void BlockBox::paint(PaintContext& context, PaintPhase phase)
         context.painter().translate(-m_scroll_offset.to_type<int>());
     }
 
+    // When only part of the page is being repainted, most fragments are clipped away entirely,
+    // so don't bother painting them. The margin leaves room for glyphs that overhang their fragment.
+    // The painter keeps its clip rect translated, but in logical (unscaled) coordinates.
+    auto& painter = context.painter();
+    auto clip_rect = painter.clip_rect();
     for (auto& line_box : m_line_boxes) {
         for (auto& fragment : line_box.fragments()) {
+            if (!clip_rect.intersects(enclosing_int_rect(fragment.absolute_rect()).inflated(4, 4).translated(painter.translation())))
+                continue;
             if (context.should_show_line_box_borders())
                 context.painter().draw_rect(enclosing_int_rect(fragment.absolute_rect()), Color::Green);
             fragment.paint(context, phase);
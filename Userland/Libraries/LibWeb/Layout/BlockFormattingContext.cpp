@@ -386,6 +386,12 @@ void BlockFormattingContext::layout_block_level_children(Box& box, LayoutMode la
     float content_height = 0;
     float content_width = 0;
 
+    // Children that haven't changed since they were last laid out against a containing block of the same size
+    // keep their size and contents, and only have to be placed again. This doesn't hold if the box itself changed,
+    // or when floats are involved, since they affect the layout of everything after them in the formatting context.
+    bool can_reuse_child_layouts = layout_mode == LayoutMode::Default && !box.needs_layout();
+    auto floating_box_count = [&] { return m_left_floating_boxes.size() + m_right_floating_boxes.size(); };
+
     box.for_each_child_of_type<Box>([&](auto& child_box) {
         if (child_box.is_absolutely_positioned())
             return IterationDecision::Continue;
@@ -395,9 +401,29 @@ void BlockFormattingContext::layout_block_level_children(Box& box, LayoutMode la
             return IterationDecision::Continue;
         }
 
-        compute_width(child_box);
-        layout_inside(child_box, layout_mode);
-        compute_height(child_box);
+        auto& layout_cache = child_box.layout_cache();
+        bool can_reuse_layout = can_reuse_child_layouts
+            && is<BlockBox>(child_box)
+            && !child_box.needs_layout()
+            && !child_box.child_needs_layout()
+            && layout_cache.has_value()
+            && layout_cache->containing_block_width == box.width()
+            && layout_cache->containing_block_height == box.height()
+            && !layout_cache->added_floats_to_formatting_context
+            && floating_box_count() == 0;
+
+        if (!can_reuse_layout) {
+            auto floating_box_count_before = floating_box_count();
+            compute_width(child_box);
+            layout_inside(child_box, layout_mode);
+            compute_height(child_box);
+
+            // Layouts done to measure intrinsic sizes leave the box in a state that can't be reused.
+            if (layout_mode == LayoutMode::Default)
+                child_box.set_layout_cache(Box::LayoutCache { box.width(), box.height(), floating_box_count() != floating_box_count_before });
+            else
+                child_box.set_layout_cache({});
+        }
 
         if (child_box.computed_values().position() == CSS::Position::Relative)
             compute_position(child_box);
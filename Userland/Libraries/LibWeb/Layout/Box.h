@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <LibGfx/Rect.h>
 #include <LibWeb/Layout/LineBox.h>
@@ -122,6 +123,16 @@ public:
 
     virtual float width_of_logical_containing_block() const;
 
+    // What a box was last laid out against, so that BlockFormattingContext can tell
+    // whether laying it out again would give the same result.
+    struct LayoutCache {
+        float containing_block_width { 0 };
+        float containing_block_height { 0 };
+        bool added_floats_to_formatting_context { false };
+    };
+    Optional<LayoutCache> const& layout_cache() const { return m_layout_cache; }
+    void set_layout_cache(Optional<LayoutCache> layout_cache) { m_layout_cache = move(layout_cache); }
+
     struct BorderRadiusData {
         // FIXME: Use floats here
         int top_left { 0 };
@@ -159,6 +170,8 @@ private:
     WeakPtr<LineBoxFragment> m_containing_line_box_fragment;
 
     OwnPtr<StackingContext> m_stacking_context;
+
+    Optional<LayoutCache> m_layout_cache;
 };
 
 template<>
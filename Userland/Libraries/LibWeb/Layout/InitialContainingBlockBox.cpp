@@ -48,6 +48,18 @@ void InitialContainingBlockBox::paint_all_phases(PaintContext& context)
     stacking_context()->paint(context);
 }
 
+bool InitialContainingBlockBox::has_fixed_position_boxes() const
+{
+    bool found_fixed_position_box = false;
+    for_each_in_subtree_of_type<Box>([&](auto& box) {
+        if (!box.is_fixed_position())
+            return IterationDecision::Continue;
+        found_fixed_position_box = true;
+        return IterationDecision::Break;
+    });
+    return found_fixed_position_box;
+}
+
 HitTestResult InitialContainingBlockBox::hit_test(const Gfx::IntPoint& position, HitTestType type) const
 {
     return stacking_context()->hit_test(position, type);
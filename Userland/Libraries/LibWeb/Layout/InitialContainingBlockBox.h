@@ -30,6 +30,9 @@ public:
 
     void recompute_selection_states();
 
+    // Fixed-position boxes are painted relative to the viewport, so they move against the rest of the page when it scrolls.
+    bool has_fixed_position_boxes() const;
+
 private:
     virtual bool is_initial_containing_block_box() const override { return true; }
 
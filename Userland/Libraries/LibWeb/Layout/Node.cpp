@@ -151,6 +151,24 @@ void Node::set_needs_display()
     }
 }
 
+void Node::set_needs_layout()
+{
+    m_needs_layout = true;
+    for (auto* ancestor = parent(); ancestor && !ancestor->m_child_needs_layout; ancestor = ancestor->parent())
+        ancestor->m_child_needs_layout = true;
+}
+
+void Node::clear_needs_layout_in_subtree()
+{
+    // Nodes that were moved around while building the tree may carry bits their new ancestors don't know about,
+    // so don't trust child_needs_layout to find every dirty node here.
+    for_each_in_inclusive_subtree([](auto& node) {
+        node.m_needs_layout = false;
+        node.m_child_needs_layout = false;
+        return IterationDecision::Continue;
+    });
+}
+
 Gfx::FloatPoint Node::box_type_agnostic_position() const
 {
     if (is<Box>(*this))
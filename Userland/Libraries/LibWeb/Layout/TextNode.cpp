@@ -207,19 +207,15 @@ void TextNode::split_into_lines_by_rules(InlineFormattingContext& context, Layou
     float available_width = context.available_width_at_line(line_boxes.size() - 1) - line_boxes.last().width();
 
     compute_text_for_rendering(do_collapse, line_boxes.last().is_empty_or_ends_in_whitespace());
-    ChunkIterator iterator(m_text_for_rendering, layout_mode, do_wrap_lines, do_respect_linebreaks);
 
-    for (;;) {
-        auto chunk_opt = iterator.next();
-        if (!chunk_opt.has_value())
-            break;
-        auto& chunk = chunk_opt.value();
+    for (auto& measured_chunk : measured_chunks(font, layout_mode, do_wrap_lines, do_respect_linebreaks)) {
+        auto chunk = measured_chunk.chunk;
 
         // Collapse entire fragment into non-existence if previous fragment on line ended in whitespace.
         if (do_collapse && line_boxes.last().is_empty_or_ends_in_whitespace() && chunk.is_all_whitespace)
             continue;
 
-        float chunk_width;
+        float chunk_width = measured_chunk.width;
         if (do_wrap_lines) {
             if (do_collapse && is_ascii_space(*chunk.view.begin()) && line_boxes.last().is_empty_or_ends_in_whitespace()) {
                 // This is a non-empty chunk that starts with collapsible whitespace.
@@ -228,9 +224,10 @@ void TextNode::split_into_lines_by_rules(InlineFormattingContext& context, Layou
                 ++chunk.start;
                 --chunk.length;
                 chunk.view = chunk.view.substring_view(1, chunk.view.byte_length() - 1);
+                chunk_width = font.width(chunk.view);
             }
 
-            chunk_width = font.width(chunk.view) + font.glyph_spacing();
+            chunk_width += font.glyph_spacing();
 
             if (line_boxes.last().width() > 0 && chunk_width > available_width) {
                 containing_block.add_line_box();
@@ -239,8 +236,6 @@ void TextNode::split_into_lines_by_rules(InlineFormattingContext& context, Layou
                 if (do_collapse && chunk.is_all_whitespace)
                     continue;
             }
-        } else {
-            chunk_width = font.width(chunk.view);
         }
 
         line_boxes.last().add_fragment(*this, chunk.start, chunk.length, chunk_width, font.glyph_height());
@@ -258,6 +253,34 @@ void TextNode::split_into_lines_by_rules(InlineFormattingContext& context, Layou
     }
 }
 
+Vector<TextNode::MeasuredChunk> const& TextNode::measured_chunks(Gfx::Font const& font, LayoutMode layout_mode, bool wrap_lines, bool respect_linebreaks)
+{
+    if (m_chunk_cache.font.ptr() == &font
+        && m_chunk_cache.layout_mode == layout_mode
+        && m_chunk_cache.wrap_lines == wrap_lines
+        && m_chunk_cache.respect_linebreaks == respect_linebreaks
+        && m_chunk_cache.text == m_text_for_rendering)
+        return m_chunk_cache.chunks;
+
+    // NOTE: The chunks point into the cached text, which keeps it alive even if m_text_for_rendering changes.
+    m_chunk_cache.text = m_text_for_rendering;
+    m_chunk_cache.font = font;
+    m_chunk_cache.layout_mode = layout_mode;
+    m_chunk_cache.wrap_lines = wrap_lines;
+    m_chunk_cache.respect_linebreaks = respect_linebreaks;
+    m_chunk_cache.chunks.clear();
+
+    ChunkIterator iterator(m_chunk_cache.text, layout_mode, wrap_lines, respect_linebreaks);
+    for (;;) {
+        auto chunk = iterator.next();
+        if (!chunk.has_value())
+            break;
+        float width = font.width(chunk->view);
+        m_chunk_cache.chunks.append({ chunk.value(), width });
+    }
+    return m_chunk_cache.chunks;
+}
+
 void TextNode::split_into_lines(InlineFormattingContext& context, LayoutMode layout_mode)
 {
     bool do_collapse = true;
@@ -64,7 +64,25 @@ private:
     void paint_cursor_if_needed(PaintContext&, const LineBoxFragment&) const;
     void paint_text_decoration(Gfx::Painter&, LineBoxFragment const&) const;
 
+    struct MeasuredChunk {
+        Chunk chunk;
+        float width { 0 };
+    };
+    Vector<MeasuredChunk> const& measured_chunks(Gfx::Font const&, LayoutMode, bool wrap_lines, bool respect_linebreaks);
+
     String m_text_for_rendering;
+
+    // The chunks from the last time this text was split into lines, which only depend on the text,
+    // the font and the line breaking rules, so they can be reused when the surrounding block is laid out again.
+    struct ChunkCache {
+        String text;
+        RefPtr<Gfx::Font const> font;
+        LayoutMode layout_mode { LayoutMode::Default };
+        bool wrap_lines { false };
+        bool respect_linebreaks { false };
+        Vector<MeasuredChunk> chunks;
+    };
+    ChunkCache m_chunk_cache;
 };
 
 template<>
@@ -66,6 +66,8 @@ static Layout::Node& insertion_parent_for_block_node(Layout::Node& layout_parent
     layout_parent.set_children_are_inline(false);
     for (auto& child : children) {
         layout_parent.last_child()->append_child(child);
+        // Let the new anonymous wrapper and its ancestors know about any changes within the moved child.
+        child.set_needs_layout();
     }
     layout_parent.last_child()->set_children_are_inline(true);
     // Then it's safe to insert this block into parent.
@@ -111,6 +113,8 @@ void TreeBuilder::create_layout_tree(DOM::Node& dom_node, TreeBuilder::Context&
             insertion_point.append_child(*layout_node);
             insertion_point.set_children_are_inline(false);
         }
+        // New nodes start out needing layout, but when building a partial tree their ancestors need to know about them too.
+        layout_node->set_needs_layout();
     }
 
     auto* shadow_root = is<DOM::Element>(dom_node) ? verify_cast<DOM::Element>(dom_node).shadow_root() : nullptr;
@@ -190,8 +194,10 @@ void TreeBuilder::remove_irrelevant_boxes(NodeWithStyle& root)
     // - they are the first and/or last child of a tabular container
     // - whose immediate sibling, if any, is a table-non-root box
 
-    for (auto& box : to_remove)
+    for (auto& box : to_remove) {
+        box.parent()->set_needs_layout();
         box.parent()->remove_child(box);
+    }
 }
 
 static bool is_table_track(CSS::Display display)
@@ -263,10 +269,15 @@ static void wrap_in_anonymous(NonnullRefPtrVector<Node>& sequence, Node* nearest
         parent.remove_child(child);
         wrapper->append_child(child);
     }
+    auto& wrapper_ref = *wrapper;
     if (nearest_sibling)
         parent.insert_before(move(wrapper), *nearest_sibling);
     else
         parent.append_child(move(wrapper));
+    wrapper_ref.set_needs_layout();
+    // The wrapped children may have pending changes that the wrapper doesn't know about yet.
+    for (auto& child : sequence)
+        child.set_needs_layout();
 }
 
 void TreeBuilder::generate_missing_child_wrappers(NodeWithStyle& root)
@@ -32,8 +32,29 @@ ResourceLoader::ResourceLoader()
 {
 }
 
+static HashMap<LoadRequest, NonnullRefPtr<Resource>> s_resource_cache;
+
+// Loads that were still in flight when preload_resource() was called for them, and that load_sync() hasn't picked up yet.
+static HashMap<LoadRequest, NonnullRefPtr<Resource>> s_preloaded_resources;
+
 void ResourceLoader::load_sync(const LoadRequest& request, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback)
 {
+    // If this is being preloaded, wait for that load instead of starting another one.
+    // Each preload is only handed out once, and a failed one is retried below as if it had never happened.
+    if (auto it = s_preloaded_resources.find(request); it != s_preloaded_resources.end()) {
+        auto resource = it->value;
+        s_preloaded_resources.remove(it);
+        dbgln_if(CACHE_DEBUG, "Waiting for preloaded resource for: {}", request.url());
+        while (!resource->is_loaded() && !resource->is_failed())
+            Core::EventLoop::current().pump();
+        if (resource->is_loaded()) {
+            success_callback(resource->encoded_data(), resource->response_headers(), resource->status_code());
+            return;
+        }
+        if (auto cached = s_resource_cache.find(request); cached != s_resource_cache.end() && cached->value.ptr() == resource.ptr())
+            s_resource_cache.remove(cached);
+    }
+
     Core::EventLoop loop;
 
     load(
@@ -51,8 +72,6 @@ void ResourceLoader::load_sync(const LoadRequest& request, Function<void(Readonl
     loop.exec();
 }
 
-static HashMap<LoadRequest, NonnullRefPtr<Resource>> s_resource_cache;
-
 RefPtr<Resource> ResourceLoader::load_resource(Resource::Type type, const LoadRequest& request)
 {
     if (!request.is_valid())
@@ -89,12 +108,36 @@ RefPtr<Resource> ResourceLoader::load_resource(Resource::Type type, const LoadRe
     return resource;
 }
 
+void ResourceLoader::preload_resource(Resource::Type type, const LoadRequest& request)
+{
+    // Resources that don't go through the cache would just be loaded twice.
+    if (request.url().protocol() == "file")
+        return;
+    auto resource = load_resource(type, request);
+    // Something that finished loading before this document asked for it may well be stale, so leave it to the cache rules.
+    if (resource && !resource->is_loaded() && !resource->is_failed())
+        s_preloaded_resources.set(request, resource.release_nonnull());
+}
+
+void ResourceLoader::discard_finished_preloads()
+{
+    Vector<LoadRequest> finished_requests;
+    for (auto& it : s_preloaded_resources) {
+        if (it.value->is_loaded() || it.value->is_failed())
+            finished_requests.append(it.key);
+    }
+    for (auto& request : finished_requests)
+        s_preloaded_resources.remove(request);
+}
+
 void ResourceLoader::load(const LoadRequest& request, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback)
 {
     auto& url = request.url();
 
     if (is_port_blocked(url.port())) {
         dbgln("ResourceLoader::load: Error: blocked port {} from URL {}", url.port(), url);
+        if (error_callback)
+            error_callback(String::formatted("Port {} is blocked", url.port()), {});
         return;
     }
 
@@ -215,6 +258,7 @@ void ResourceLoader::clear_cache()
 {
     dbgln_if(CACHE_DEBUG, "Clearing {} items from ResourceLoader cache", s_resource_cache.size());
     s_resource_cache.clear();
+    s_preloaded_resources.clear();
 }
 
 }
@@ -32,6 +32,11 @@ public:
 
     RefPtr<Resource> load_resource(Resource::Type, const LoadRequest&);
 
+    // Starts loading a resource that the page is expected to ask for soon, so that it's in the cache by then.
+    void preload_resource(Resource::Type, const LoadRequest&);
+    // Forgets preloads that nobody picked up while they were in flight. Called whenever a new document starts preloading.
+    void discard_finished_preloads();
+
     void load(const LoadRequest&, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback = nullptr);
     void load(const URL&, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback = nullptr);
     void load_sync(const LoadRequest&, Function<void(ReadonlyBytes, const HashMap<String, String, CaseInsensitiveStringTraits>& response_headers, Optional<u32> status_code)> success_callback, Function<void(const String&, Optional<u32> status_code)> error_callback = nullptr);
@@ -107,14 +107,10 @@ void EditEventHandler::handle_insert(DOM::Position position, u32 code_point)
         builder.append_code_point(code_point);
         builder.append(node.data().substring_view(position.offset()));
         node.set_data(builder.to_string());
-
-        node.invalidate_style();
     }
 
-    // FIXME: When nodes are removed from the DOM, the associated layout nodes become stale and still
-    //        remain in the layout tree. This has to be fixed, this just causes everything to be recomputed
-    //        which really hurts performance.
-    m_frame.document()->force_layout();
+    // Setting the data has marked the text's layout node as needing layout, so only that needs updating.
+    m_frame.document()->update_layout();
 
     m_frame.did_edit({});
 }
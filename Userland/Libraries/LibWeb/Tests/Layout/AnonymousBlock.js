@@ -0,0 +1,21 @@
+describe("AnonymousBlock", () => {
+    loadLocalPage("AnonymousBlock.html");
+
+    afterInitialPageLoad(page => {
+        test("Changing text inside an inline wrapped in an anonymous block", () => {
+            const inline = page.document.getElementById("inline");
+            const block = page.document.getElementById("block");
+
+            // The span shares its parent with a block, so it ends up inside an anonymous block.
+            const offsetBefore = block.offsetTop;
+            expect(offsetBefore).toBeGreaterThan(0);
+
+            inline.firstChild.data = "Some text that is far too long to fit on a single line of this container";
+            expect(block.offsetTop).toBeGreaterThan(offsetBefore);
+
+            inline.firstChild.data = "Short";
+            expect(block.offsetTop).toBe(offsetBefore);
+        });
+    });
+    waitForPageToLoad();
+});
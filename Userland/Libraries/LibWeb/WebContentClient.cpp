@@ -15,6 +15,8 @@ WebContentClient::WebContentClient(OutOfProcessWebView& view)
     : IPC::ServerConnection<WebContentClientEndpoint, WebContentServerEndpoint>(*this, "/tmp/portal/webcontent")
     , m_view(view)
 {
+    // Input events tend to come in bursts, so let them share a write.
+    set_batching_enabled(true);
 }
 
 void WebContentClient::die()
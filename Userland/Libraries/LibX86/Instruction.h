@@ -474,6 +474,7 @@ public:
     String mnemonic() const;
 
     u8 op() const { return m_op; }
+    u8 sub_op() const { return m_sub_op; }
     u8 modrm_byte() const { return m_modrm.m_rm_byte; }
     u8 slash() const { return (modrm_byte() >> 3) & 7; }
 
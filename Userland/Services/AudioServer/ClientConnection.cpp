@@ -35,6 +35,8 @@ ClientConnection::~ClientConnection()
 
 void ClientConnection::die()
 {
+    if (m_queue)
+        m_queue->detach();
     s_connections.remove(client_id());
 }
 
@@ -78,6 +80,7 @@ Messages::AudioServer::EnqueueBufferResponse ClientConnection::enqueue_buffer(Co
     if (!m_queue)
         m_queue = m_mixer.create_queue(*this);
 
+    m_queue->retire_played_buffers();
     if (m_queue->is_full())
         return false;
 
@@ -94,6 +97,25 @@ Messages::AudioServer::GetRemainingSamplesResponse ClientConnection::get_remaini
     return remaining;
 }
 
+Messages::AudioServer::GetUnderrunCountResponse ClientConnection::get_underrun_count()
+{
+    u32 underruns = 0;
+    if (m_queue)
+        underruns = m_queue->get_underrun_count();
+
+    return underruns;
+}
+
+Messages::AudioServer::GetLatencyResponse ClientConnection::get_latency()
+{
+    // Everything still queued has to go through the mixer, which is always one mix buffer ahead of the device.
+    u32 latency = AUDIO_MIX_BUFFER_FRAMES;
+    if (m_queue)
+        latency += m_queue->get_remaining_samples();
+
+    return latency;
+}
+
 Messages::AudioServer::GetPlayedSamplesResponse ClientConnection::get_played_samples()
 {
     int played = 0;
@@ -40,6 +40,8 @@ private:
     virtual Messages::AudioServer::EnqueueBufferResponse enqueue_buffer(Core::AnonymousBuffer const&, i32, int) override;
     virtual Messages::AudioServer::GetRemainingSamplesResponse get_remaining_samples() override;
     virtual Messages::AudioServer::GetPlayedSamplesResponse get_played_samples() override;
+    virtual Messages::AudioServer::GetUnderrunCountResponse get_underrun_count() override;
+    virtual Messages::AudioServer::GetLatencyResponse get_latency() override;
     virtual void set_paused(bool) override;
     virtual void clear_buffer(bool) override;
     virtual Messages::AudioServer::GetPlayingBufferResponse get_playing_buffer() override;
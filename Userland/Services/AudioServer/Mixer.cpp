@@ -13,13 +13,18 @@
 #include <AudioServer/Mixer.h>
 #include <LibCore/ConfigFile.h>
 #include <LibCore/Timer.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <stdlib.h>
 #include <sys/ioctl.h>
+#include <unistd.h>
 
 namespace AudioServer {
 
-u8 Mixer::m_zero_filled_buffer[4096];
+using AK::SIMD::f64x2;
+using AK::SIMD::i32x2;
+
+u8 Mixer::m_zero_filled_buffer[AUDIO_MIX_BUFFER_FRAMES * 2 * sizeof(i16)];
 
 Mixer::Mixer(NonnullRefPtr<Core::ConfigFile> config)
     : m_device(Core::File::construct("/dev/audio", this))
@@ -39,6 +44,20 @@ Mixer::Mixer(NonnullRefPtr<Core::ConfigFile> config)
     pthread_mutex_init(&m_pending_mutex, nullptr);
     pthread_cond_init(&m_pending_cond, nullptr);
 
+    if (pipe2(m_retire_pipe_fds, O_CLOEXEC) < 0) {
+        perror("pipe2");
+        return;
+    }
+    // The mixer thread must never block on this; a full pipe already means a pending wakeup.
+    fcntl(m_retire_pipe_fds[1], F_SETFL, O_NONBLOCK);
+    m_retire_notifier = Core::Notifier::construct(m_retire_pipe_fds[0], Core::Notifier::Read, this);
+    m_retire_notifier->on_ready_to_read = [this] {
+        u8 buffer[64];
+        if (read(m_retire_pipe_fds[0], buffer, sizeof(buffer)) < 0)
+            perror("read");
+        retire_played_buffers();
+    };
+
     m_muted = m_config->read_bool_entry("Master", "Mute", false);
     m_main_volume = m_config->read_num_entry("Master", "Volume", 100);
 
@@ -52,8 +71,9 @@ Mixer::~Mixer()
 NonnullRefPtr<BufferQueue> Mixer::create_queue(ClientConnection& client)
 {
     auto queue = adopt_ref(*new BufferQueue(client));
+    m_queues.append(queue);
     pthread_mutex_lock(&m_pending_mutex);
-    m_pending_mixing.append(*queue);
+    m_pending_mixing.append(queue.ptr());
     m_added_queue = true;
     pthread_cond_signal(&m_pending_cond);
     pthread_mutex_unlock(&m_pending_mutex);
@@ -63,60 +83,66 @@ NonnullRefPtr<BufferQueue> Mixer::create_queue(ClientConnection& client)
 void Mixer::mix()
 {
     decltype(m_pending_mixing) active_mix_queues;
+    Array<f64x2, AUDIO_MIX_BUFFER_FRAMES> mixed_buffer;
+    Array<LittleEndian<i16>, AUDIO_MIX_BUFFER_FRAMES * 2> output_buffer;
 
     for (;;) {
-        if (active_mix_queues.is_empty() || m_added_queue) {
+        if (active_mix_queues.is_empty()) {
             pthread_mutex_lock(&m_pending_mutex);
-            pthread_cond_wait(&m_pending_cond, &m_pending_mutex);
+            while (m_pending_mixing.is_empty())
+                pthread_cond_wait(&m_pending_cond, &m_pending_mutex);
             active_mix_queues.extend(move(m_pending_mixing));
+            m_added_queue = false;
             pthread_mutex_unlock(&m_pending_mutex);
+        } else if (m_added_queue && pthread_mutex_trylock(&m_pending_mutex) == 0) {
+            // Never wait for the event loop while there is something to play, we'll just pick the queue up next time.
+            active_mix_queues.extend(move(m_pending_mixing));
             m_added_queue = false;
+            pthread_mutex_unlock(&m_pending_mutex);
         }
 
-        active_mix_queues.remove_all_matching([&](auto& entry) { return !entry->client(); });
+        bool should_retire = false;
+        active_mix_queues.remove_all_matching([&](auto* queue) {
+            if (!queue->is_detached())
+                return false;
+            queue->release();
+            should_retire = true;
+            return true;
+        });
 
-        Audio::Frame mixed_buffer[1024];
-        auto mixed_buffer_length = (int)(sizeof(mixed_buffer) / sizeof(Audio::Frame));
+        mixed_buffer.fill(f64x2 { 0, 0 });
 
         // Mix the buffers together into the output
-        for (auto& queue : active_mix_queues) {
-            if (!queue->client()) {
-                queue->clear();
-                continue;
-            }
+        for (auto* queue : active_mix_queues) {
+            if (queue->mix_into(mixed_buffer.span()))
+                should_retire = true;
+        }
 
-            for (int i = 0; i < mixed_buffer_length; ++i) {
-                auto& mixed_sample = mixed_buffer[i];
-                Audio::Frame sample;
-                if (!queue->get_next_sample(sample))
-                    break;
-                mixed_sample += sample;
-            }
+        if (should_retire) {
+            u8 wakeup = 0;
+            // If the pipe is full, the event loop has a wakeup pending anyway.
+            [[maybe_unused]] auto rc = write(m_retire_pipe_fds[1], &wakeup, sizeof(wakeup));
         }
 
-        if (m_muted) {
+        if (m_muted.load(AK::memory_order_relaxed)) {
             m_device->write(m_zero_filled_buffer, sizeof(m_zero_filled_buffer));
         } else {
-            Array<u8, 4096> buffer;
-            OutputMemoryStream stream { buffer };
-
-            for (int i = 0; i < mixed_buffer_length; ++i) {
-                auto& mixed_sample = mixed_buffer[i];
-
-                mixed_sample.scale(m_main_volume);
-                mixed_sample.clip();
-
-                LittleEndian<i16> out_sample;
-                out_sample = mixed_sample.left * NumericLimits<i16>::max();
-                stream << out_sample;
-
-                out_sample = mixed_sample.right * NumericLimits<i16>::max();
-                stream << out_sample;
+            f64x2 const volume = f64x2 { 1, 1 } * (main_volume() / 100.0);
+            f64x2 const max_sample = { 1, 1 };
+            f64x2 const min_sample = { -1, -1 };
+            f64x2 const sample_scale = f64x2 { 1, 1 } * NumericLimits<i16>::max();
+
+            for (size_t i = 0; i < mixed_buffer.size(); ++i) {
+                auto mixed_sample = mixed_buffer[i] * volume;
+                mixed_sample = mixed_sample > max_sample ? max_sample : mixed_sample;
+                mixed_sample = mixed_sample < min_sample ? min_sample : mixed_sample;
+
+                auto out_sample = __builtin_convertvector(mixed_sample * sample_scale, i32x2);
+                output_buffer[i * 2] = out_sample[0];
+                output_buffer[i * 2 + 1] = out_sample[1];
             }
 
-            VERIFY(stream.is_end());
-            VERIFY(!stream.has_any_error());
-            m_device->write(stream.data(), stream.size());
+            m_device->write(reinterpret_cast<u8 const*>(output_buffer.data()), sizeof(output_buffer));
         }
     }
 }
@@ -134,7 +160,7 @@ void Mixer::set_main_volume(int volume)
     request_setting_sync();
 
     ClientConnection::for_each([&](ClientConnection& client) {
-        client.did_change_main_mix_volume({}, m_main_volume);
+        client.did_change_main_mix_volume({}, main_volume());
     });
 }
 
@@ -144,7 +170,7 @@ void Mixer::set_muted(bool muted)
         return;
     m_muted = muted;
 
-    m_config->write_bool_entry("Master", "Mute", m_muted);
+    m_config->write_bool_entry("Master", "Mute", muted);
     request_setting_sync();
 
     ClientConnection::for_each([muted](ClientConnection& client) {
@@ -169,6 +195,13 @@ u16 Mixer::audiodevice_get_sample_rate() const
     return sample_rate;
 }
 
+void Mixer::retire_played_buffers()
+{
+    for (auto& queue : m_queues)
+        queue->retire_played_buffers();
+    m_queues.remove_all_matching([](auto& queue) { return queue->is_released(); });
+}
+
 void Mixer::request_setting_sync()
 {
     if (m_config_write_timer.is_null() || !m_config_write_timer->is_active()) {
@@ -189,7 +222,118 @@ BufferQueue::BufferQueue(ClientConnection& client)
 
 void BufferQueue::enqueue(NonnullRefPtr<Audio::Buffer>&& buffer)
 {
-    m_remaining_samples += buffer->sample_count();
-    m_queue.enqueue(move(buffer));
+    VERIFY(!is_full());
+    auto write_index = m_write_index.load(AK::memory_order_relaxed);
+    m_enqueued_samples += buffer->sample_count();
+    m_slots[write_index % capacity] = { move(buffer), false };
+    m_write_index.store(write_index + 1, AK::memory_order_release);
 }
+
+void BufferQueue::retire_played_buffers()
+{
+    auto read_index = m_read_index.load(AK::memory_order_acquire);
+    for (; m_retire_index != read_index; ++m_retire_index) {
+        auto& slot = m_slots[m_retire_index % capacity];
+        if (slot.finished && m_client)
+            m_client->did_finish_playing_buffer({}, slot.buffer->id());
+        slot.buffer = nullptr;
+    }
+}
+
+void BufferQueue::clear(bool paused)
+{
+    // The mixer thread drops everything enqueued so far the next time it looks at this queue.
+    m_cleared_samples = m_enqueued_samples;
+    m_played_samples_at_clear = m_played_samples.load(AK::memory_order_relaxed);
+    m_discard_index.store(m_write_index.load(AK::memory_order_relaxed), AK::memory_order_release);
+    m_clear_count.fetch_add(1, AK::memory_order_release);
+    m_paused.store(paused, AK::memory_order_relaxed);
+}
+
+int BufferQueue::get_remaining_samples() const
+{
+    auto consumed_samples = m_consumed_samples.load(AK::memory_order_relaxed);
+    // Until the mixer thread has caught up with a clear, nothing from before it counts.
+    if (static_cast<i32>(consumed_samples - m_cleared_samples) < 0)
+        consumed_samples = m_cleared_samples;
+    return m_enqueued_samples - consumed_samples;
+}
+
+bool BufferQueue::mix_into(Span<f64x2> mix_buffer)
+{
+    bool should_retire = false;
+    auto read_index = m_read_index.load(AK::memory_order_relaxed);
+
+    // Loaded before the discard index, so that seeing a clear here means also seeing what it discards.
+    auto clear_count = m_clear_count.load(AK::memory_order_acquire);
+    auto discard_index = m_discard_index.load(AK::memory_order_acquire);
+    if (static_cast<i32>(discard_index - read_index) > 0) {
+        u32 discarded_samples = 0;
+        for (; read_index != discard_index; ++read_index) {
+            auto& slot = m_slots[read_index % capacity];
+            discarded_samples += slot.buffer->sample_count() - m_position;
+            slot.finished = false;
+            m_position = 0;
+        }
+        m_consumed_samples.fetch_add(discarded_samples, AK::memory_order_relaxed);
+        m_read_index.store(read_index, AK::memory_order_release);
+        m_playing_buffer_id.store(-1, AK::memory_order_relaxed);
+        should_retire = true;
+    }
+
+    // Running dry only counts as an underrun if the client meant to keep playing. Clients stop (or seek) by clearing
+    // the queue, often after it has already run dry at the end of a stream, and running dry while paused is expected.
+    bool paused = m_paused.load(AK::memory_order_relaxed);
+    if (clear_count != m_seen_clear_count || paused) {
+        m_seen_clear_count = clear_count;
+        m_is_playing = false;
+        m_starved = false;
+    }
+
+    if (paused)
+        return should_retire;
+
+    auto write_index = m_write_index.load(AK::memory_order_acquire);
+    size_t mixed_samples = 0;
+    while (mixed_samples < mix_buffer.size() && read_index != write_index) {
+        auto& slot = m_slots[read_index % capacity];
+        auto& buffer = *slot.buffer;
+        m_playing_buffer_id.store(buffer.id(), AK::memory_order_relaxed);
+
+        auto sample_count = min(mix_buffer.size() - mixed_samples, static_cast<size_t>(buffer.sample_count() - m_position));
+        auto* samples = buffer.samples() + m_position;
+        auto* mixed = mix_buffer.offset_pointer(mixed_samples);
+        for (size_t i = 0; i < sample_count; ++i)
+            mixed[i] += f64x2 { samples[i].left, samples[i].right };
+
+        mixed_samples += sample_count;
+        m_position += sample_count;
+        if (m_position >= static_cast<u32>(buffer.sample_count())) {
+            slot.finished = true;
+            m_position = 0;
+            m_read_index.store(++read_index, AK::memory_order_release);
+            should_retire = true;
+        }
+    }
+
+    if (mixed_samples > 0) {
+        // We ran dry while playing, and the client has only now caught up.
+        if (m_starved)
+            m_underrun_count.fetch_add(1, AK::memory_order_relaxed);
+        m_starved = false;
+        m_is_playing = true;
+        m_consumed_samples.fetch_add(mixed_samples, AK::memory_order_relaxed);
+        m_played_samples.fetch_add(mixed_samples, AK::memory_order_relaxed);
+    }
+
+    if (mixed_samples < mix_buffer.size()) {
+        if (m_is_playing)
+            m_starved = true;
+        m_is_playing = false;
+        m_playing_buffer_id.store(-1, AK::memory_order_relaxed);
+    }
+
+    return should_retire;
+}
+
 }
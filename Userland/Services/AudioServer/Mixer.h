@@ -8,15 +8,17 @@
 #pragma once
 
 #include "ClientConnection.h"
+#include <AK/Array.h>
 #include <AK/Atomic.h>
 #include <AK/Badge.h>
 #include <AK/ByteBuffer.h>
-#include <AK/NonnullRefPtrVector.h>
-#include <AK/Queue.h>
 #include <AK/RefCounted.h>
+#include <AK/SIMD.h>
+#include <AK/Span.h>
 #include <AK/WeakPtr.h>
 #include <LibAudio/Buffer.h>
 #include <LibCore/File.h>
+#include <LibCore/Notifier.h>
 #include <LibCore/Timer.h>
 #include <LibThreading/Mutex.h>
 #include <LibThreading/Thread.h>
@@ -25,70 +27,82 @@ namespace AudioServer {
 
 class ClientConnection;
 
+// Number of frames the mixer hands to the audio device at once.
+constexpr size_t AUDIO_MIX_BUFFER_FRAMES = 1024;
+
+// A single-producer, single-consumer ring of buffers between a client connection and the mixer thread.
+// The event loop enqueues buffers and later retires the ones the mixer thread is done with, so the mixer
+// thread never allocates, drops a reference or talks to the client. The samples themselves stay in the
+// anonymous buffers the client shared with us.
 class BufferQueue : public RefCounted<BufferQueue> {
 public:
     explicit BufferQueue(ClientConnection&);
     ~BufferQueue() { }
 
-    bool is_full() const { return m_queue.size() >= 3; }
+    // These are called on the event loop.
+    bool is_full() const { return m_write_index.load(AK::memory_order_relaxed) - m_retire_index >= capacity; }
     void enqueue(NonnullRefPtr<Audio::Buffer>&&);
-
-    bool get_next_sample(Audio::Frame& sample)
-    {
-        if (m_paused)
-            return false;
-
-        while (!m_current && !m_queue.is_empty())
-            m_current = m_queue.dequeue();
-
-        if (!m_current)
-            return false;
-
-        sample = m_current->samples()[m_position++];
-        --m_remaining_samples;
-        ++m_played_samples;
-
-        if (m_position >= m_current->sample_count()) {
-            m_client->did_finish_playing_buffer({}, m_current->id());
-            m_current = nullptr;
-            m_position = 0;
-        }
-        return true;
-    }
+    void retire_played_buffers();
+    void clear(bool paused = false);
+    void set_paused(bool paused) { m_paused.store(paused, AK::memory_order_relaxed); }
+    void detach() { m_detached.store(true, AK::memory_order_release); }
+    bool is_released() const { return m_released.load(AK::memory_order_acquire); }
 
     ClientConnection* client() { return m_client.ptr(); }
 
-    void clear(bool paused = false)
-    {
-        m_queue.clear();
-        m_position = 0;
-        m_remaining_samples = 0;
-        m_played_samples = 0;
-        m_current = nullptr;
-        m_paused = paused;
-    }
-
-    void set_paused(bool paused)
-    {
-        m_paused = paused;
-    }
-
-    int get_remaining_samples() const { return m_remaining_samples; }
-    int get_played_samples() const { return m_played_samples; }
-    int get_playing_buffer() const
-    {
-        if (m_current)
-            return m_current->id();
-        return -1;
-    }
+    int get_remaining_samples() const;
+    int get_played_samples() const { return m_played_samples.load(AK::memory_order_relaxed) - m_played_samples_at_clear; }
+    int get_playing_buffer() const { return m_playing_buffer_id.load(AK::memory_order_relaxed); }
+    u32 get_underrun_count() const { return m_underrun_count.load(AK::memory_order_relaxed); }
+
+    // These are called on the mixer thread.
+    // Adds the next frames of this queue onto the mix buffer, and returns whether any buffers are ready to be retired.
+    bool mix_into(Span<AK::SIMD::f64x2> mix_buffer);
+    bool is_detached() const { return m_detached.load(AK::memory_order_acquire); }
+    // After this, the mixer thread must not touch the queue anymore.
+    void release() { m_released.store(true, AK::memory_order_release); }
 
 private:
-    RefPtr<Audio::Buffer> m_current;
-    Queue<NonnullRefPtr<Audio::Buffer>> m_queue;
-    int m_position { 0 };
-    int m_remaining_samples { 0 };
-    int m_played_samples { 0 };
-    bool m_paused { false };
+    static constexpr u32 capacity = 4;
+
+    struct Slot {
+        RefPtr<Audio::Buffer> buffer;
+        // Whether the buffer was played to the end rather than cleared.
+        bool finished { false };
+    };
+
+    Array<Slot, capacity> m_slots;
+
+    // The indices only ever grow, and wrap around together.
+    // Slots in [retire, read) are done, and slots in [read, write) are waiting to be played.
+    Atomic<u32> m_write_index { 0 };
+    Atomic<u32> m_read_index { 0 };
+    Atomic<u32> m_discard_index { 0 };
+    u32 m_retire_index { 0 };
+
+    // Bumped on every clear, even one with nothing left to discard, so the mixer thread can tell a stop apart from an underrun.
+    Atomic<u32> m_clear_count { 0 };
+
+    // Only touched by the event loop.
+    u32 m_enqueued_samples { 0 };
+    u32 m_cleared_samples { 0 };
+    u32 m_played_samples_at_clear { 0 };
+
+    // Only touched by the mixer thread.
+    u32 m_position { 0 };
+    u32 m_seen_clear_count { 0 };
+    bool m_is_playing { false };
+    bool m_starved { false };
+
+    // Written by the mixer thread, read by the event loop.
+    Atomic<u32> m_consumed_samples { 0 };
+    Atomic<u32> m_played_samples { 0 };
+    Atomic<i32> m_playing_buffer_id { -1 };
+    Atomic<u32> m_underrun_count { 0 };
+
+    Atomic<bool> m_paused { false };
+    Atomic<bool> m_detached { false };
+    Atomic<bool> m_released { false };
     WeakPtr<ClientConnection> m_client;
 };
 
@@ -100,10 +114,10 @@ public:
 
     NonnullRefPtr<BufferQueue> create_queue(ClientConnection&);
 
-    int main_volume() const { return m_main_volume; }
+    int main_volume() const { return m_main_volume.load(AK::memory_order_relaxed); }
     void set_main_volume(int volume);
 
-    bool is_muted() const { return m_muted; }
+    bool is_muted() const { return m_muted.load(AK::memory_order_relaxed); }
     void set_muted(bool);
 
     int audiodevice_set_sample_rate(u16 sample_rate);
@@ -111,23 +125,32 @@ public:
 
 private:
     void request_setting_sync();
+    void retire_played_buffers();
 
-    Vector<NonnullRefPtr<BufferQueue>> m_pending_mixing;
+    // All queues that the mixer thread may still be looking at, owned by the event loop.
+    Vector<NonnullRefPtr<BufferQueue>> m_queues;
+
+    // New queues on their way to the mixer thread. It only ever blocks on this lock while it has nothing to play.
+    Vector<BufferQueue*> m_pending_mixing;
     Atomic<bool> m_added_queue { false };
     pthread_mutex_t m_pending_mutex;
     pthread_cond_t m_pending_cond;
 
+    // The mixer thread writes to this pipe to have the event loop retire played buffers and released queues.
+    int m_retire_pipe_fds[2] { -1, -1 };
+    RefPtr<Core::Notifier> m_retire_notifier;
+
     RefPtr<Core::File> m_device;
 
     NonnullRefPtr<Threading::Thread> m_sound_thread;
 
-    bool m_muted { false };
-    int m_main_volume { 100 };
+    Atomic<bool> m_muted { false };
+    Atomic<int> m_main_volume { 100 };
 
     NonnullRefPtr<Core::ConfigFile> m_config;
     RefPtr<Core::Timer> m_config_write_timer;
 
-    static u8 m_zero_filled_buffer[4096];
+    static u8 m_zero_filled_buffer[AUDIO_MIX_BUFFER_FRAMES * 2 * sizeof(i16)];
 
     void mix();
 };
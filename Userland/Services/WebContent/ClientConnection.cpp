@@ -35,6 +35,9 @@ ClientConnection::ClientConnection(NonnullRefPtr<Core::LocalSocket> socket, int
     , m_page_host(PageHost::create(*this))
 {
     s_connections.set(client_id, *this);
+    // We send the browser lots of small notifications, and now and then a huge one (page source, DOM tree).
+    set_batching_enabled(true);
+    enable_shared_memory_transport();
     m_paint_flush_timer = Core::Timer::create_single_shot(0, [this] { flush_pending_paint_requests(); });
 }
 
@@ -168,7 +171,7 @@ void ClientConnection::key_down(i32 key, unsigned int modifiers, u32 code_point)
     page().handle_keydown((KeyCode)key, modifiers, code_point);
 }
 
-void ClientConnection::debug_request(const String& request, const String& argument)
+void ClientConnection::debug_request(StringView request, StringView argument)
 {
     if (request == "dump-dom-tree") {
         if (auto* doc = page().top_level_browsing_context().document())
@@ -190,6 +193,15 @@ void ClientConnection::debug_request(const String& request, const String& argume
         }
     }
 
+    if (request == "dump-style-statistics") {
+        if (auto* doc = page().top_level_browsing_context().document()) {
+            auto& statistics = doc->style_update_statistics();
+            dbgln("Style updates: {}, elements restyled: {} total, {} in the last update, {} at most in one update",
+                statistics.style_updates, statistics.total_elements_restyled,
+                statistics.elements_restyled_in_last_update, statistics.max_elements_restyled_in_one_update);
+        }
+    }
+
     if (request == "collect-garbage") {
         Web::Bindings::main_thread_vm().heap().collect_garbage(JS::Heap::CollectionType::CollectGarbage, true);
     }
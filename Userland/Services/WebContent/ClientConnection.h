@@ -46,7 +46,7 @@ private:
     virtual void key_down(i32, unsigned, u32) override;
     virtual void add_backing_store(i32, Gfx::ShareableBitmap const&) override;
     virtual void remove_backing_store(i32) override;
-    virtual void debug_request(String const&, String const&) override;
+    virtual void debug_request(StringView, StringView) override;
     virtual void get_source() override;
     virtual void inspect_dom_tree() override;
     virtual void js_console_initialize() override;
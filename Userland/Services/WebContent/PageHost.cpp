@@ -44,6 +44,7 @@ Gfx::Palette PageHost::palette() const
 void PageHost::set_palette_impl(const Gfx::PaletteImpl& impl)
 {
     m_palette_impl = impl;
+    m_needs_full_repaint = true;
 }
 
 Web::Layout::InitialContainingBlockBox* PageHost::layout_root()
@@ -54,14 +55,83 @@ Web::Layout::InitialContainingBlockBox* PageHost::layout_root()
     return document->layout_node();
 }
 
+static constexpr size_t max_dirty_rects_to_paint_separately = 4;
+
+// Copies a rect of pixels, which may overlap the destination if both bitmaps are the same.
+static void copy_pixels(Gfx::Bitmap& to, const Gfx::IntPoint& to_position, const Gfx::Bitmap& from, const Gfx::IntRect& from_rect)
+{
+    size_t row_size = from_rect.width() * sizeof(Gfx::RGBA32);
+    auto copy_row = [&](int y) {
+        memmove(to.scanline(to_position.y() + y) + to_position.x(), from.scanline(from_rect.y() + y) + from_rect.x(), row_size);
+    };
+    if (&to == &from && to_position.y() > from_rect.y()) {
+        for (int y = from_rect.height() - 1; y >= 0; --y)
+            copy_row(y);
+    } else {
+        for (int y = 0; y < from_rect.height(); ++y)
+            copy_row(y);
+    }
+}
+
 void PageHost::paint(const Gfx::IntRect& content_rect, Gfx::Bitmap& target)
+{
+    Gfx::DisjointRectSet dirty_rects;
+
+    auto retained_rect = m_retained_content_rect.intersected(content_rect);
+    bool can_reuse_last_paint = !m_needs_full_repaint
+        && m_last_painted_bitmap
+        && m_last_painted_bitmap->size() == target.size()
+        && m_last_painted_bitmap->format() == target.format()
+        && target.bpp() == 32
+        && target.scale() == 1
+        && content_rect.size() == target.size()
+        && !retained_rect.is_empty();
+
+    // Fixed-position boxes don't scroll along with the pixels around them, so moving those pixels would smear them.
+    if (can_reuse_last_paint && content_rect.location() != m_last_painted_content_rect.location()) {
+        if (auto* layout_root = this->layout_root(); layout_root && layout_root->has_fixed_position_boxes())
+            can_reuse_last_paint = false;
+    }
+
+    if (can_reuse_last_paint) {
+        // Scrolling moves what's already painted, so only the newly exposed and invalidated parts need painting.
+        copy_pixels(target, retained_rect.location() - content_rect.location(), *m_last_painted_bitmap, retained_rect.translated(-m_last_painted_content_rect.location()));
+        dirty_rects.add_many(content_rect.shatter(retained_rect));
+        for (auto& rect : m_damage_since_last_paint.rects()) {
+            auto dirty_rect = rect.intersected(content_rect);
+            if (!dirty_rect.is_empty())
+                dirty_rects.add(dirty_rect);
+        }
+    } else {
+        dirty_rects.add(content_rect);
+    }
+
+    // Every paint walks the whole layout tree, so don't do it for lots of little rects.
+    if (dirty_rects.size() > max_dirty_rects_to_paint_separately) {
+        Gfx::IntRect bounding_rect;
+        for (auto& dirty_rect : dirty_rects.rects())
+            bounding_rect = bounding_rect.is_empty() ? dirty_rect : bounding_rect.united(dirty_rect);
+        dirty_rects = Gfx::DisjointRectSet(bounding_rect);
+    }
+
+    for (auto& dirty_rect : dirty_rects.rects())
+        paint_rect(content_rect, dirty_rect, target);
+
+    m_last_painted_bitmap = target;
+    m_last_painted_content_rect = content_rect;
+    m_retained_content_rect = content_rect;
+    m_damage_since_last_paint.clear();
+    m_needs_full_repaint = false;
+}
+
+void PageHost::paint_rect(const Gfx::IntRect& content_rect, const Gfx::IntRect& dirty_rect, Gfx::Bitmap& target)
 {
     Gfx::Painter painter(target);
-    Gfx::IntRect bitmap_rect { {}, content_rect.size() };
+    painter.add_clip_rect(dirty_rect.translated(-content_rect.location()));
 
     auto* layout_root = this->layout_root();
     if (!layout_root) {
-        painter.fill_rect(bitmap_rect, Color::White);
+        painter.fill_rect({ {}, content_rect.size() }, Color::White);
         return;
     }
 
@@ -73,16 +143,20 @@ void PageHost::paint(const Gfx::IntRect& content_rect, Gfx::Bitmap& target)
 
 void PageHost::set_viewport_rect(const Gfx::IntRect& rect)
 {
+    // Invalidations outside the viewport aren't reported, so we can only trust the pixels that stayed inside it.
+    m_retained_content_rect.intersect(rect);
     page().top_level_browsing_context().set_viewport_rect(rect);
 }
 
 void PageHost::page_did_invalidate(const Gfx::IntRect& content_rect)
 {
+    m_damage_since_last_paint.add(content_rect);
     m_client.async_did_invalidate_content_rect(content_rect);
 }
 
 void PageHost::page_did_change_selection()
 {
+    m_needs_full_repaint = true;
     m_client.async_did_change_selection();
 }
 
@@ -93,6 +167,7 @@ void PageHost::page_did_request_cursor_change(Gfx::StandardCursor cursor)
 
 void PageHost::page_did_layout()
 {
+    m_needs_full_repaint = true;
     auto* layout_root = this->layout_root();
     VERIFY(layout_root);
     auto content_size = enclosing_int_rect(layout_root->absolute_rect()).size();
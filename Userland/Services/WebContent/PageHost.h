@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Rect.h>
 #include <LibWeb/Page/Page.h>
 
@@ -30,7 +31,11 @@ public:
     void set_viewport_rect(const Gfx::IntRect&);
     void set_screen_rects(const Vector<Gfx::IntRect, 4>& rects, size_t main_screen_index) { m_screen_rect = rects[main_screen_index]; };
 
-    void set_should_show_line_box_borders(bool b) { m_should_show_line_box_borders = b; }
+    void set_should_show_line_box_borders(bool b)
+    {
+        m_should_show_line_box_borders = b;
+        m_needs_full_repaint = true;
+    }
 
 private:
     // ^PageClient
@@ -66,12 +71,22 @@ private:
 
     Web::Layout::InitialContainingBlockBox* layout_root();
     void setup_palette();
+    void paint_rect(const Gfx::IntRect& content_rect, const Gfx::IntRect& dirty_rect, Gfx::Bitmap&);
 
     ClientConnection& m_client;
     NonnullOwnPtr<Web::Page> m_page;
     RefPtr<Gfx::PaletteImpl> m_palette_impl;
     Gfx::IntRect m_screen_rect;
     bool m_should_show_line_box_borders { false };
+
+    // The pixels of the last paint stay valid until something invalidates them, so the next paint
+    // (which is usually of the other backing store, after a scroll) can copy them instead of painting them again.
+    RefPtr<Gfx::Bitmap> m_last_painted_bitmap;
+    Gfx::IntRect m_last_painted_content_rect;
+    // The part of the last painted rect that has been inside the viewport ever since, and has thus had its invalidations reported to us.
+    Gfx::IntRect m_retained_content_rect;
+    Gfx::DisjointRectSet m_damage_since_last_paint;
+    bool m_needs_full_repaint { true };
 };
 
 }
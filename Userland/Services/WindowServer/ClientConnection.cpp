@@ -1088,6 +1088,21 @@ void ClientConnection::set_flash_flush(bool enabled)
     Compositor::the().set_flash_flush(enabled);
 }
 
+Messages::WindowServer::GetCompositorStatisticsResponse ClientConnection::get_compositor_statistics()
+{
+    auto& statistics = Compositor::the().frame_statistics();
+    return {
+        statistics.frame_count,
+        statistics.frames_over_budget,
+        statistics.last_frame_time_us,
+        statistics.average_frame_time_us,
+        statistics.max_frame_time_us,
+        statistics.last_occlusions_time_us,
+        statistics.last_flush_rect_count,
+        statistics.last_coalesced_flush_rect_count,
+    };
+}
+
 void ClientConnection::set_window_parent_from_client(i32 client_id, i32 parent_id, i32 child_id)
 {
     auto child_window = window_from_id(child_id);
@@ -16,11 +16,14 @@
 #include <AK/Debug.h>
 #include <AK/Memory.h>
 #include <AK/ScopeGuard.h>
+#include <AK/Time.h>
 #include <LibCore/Timer.h>
 #include <LibGfx/Font.h>
 #include <LibGfx/Painter.h>
 #include <LibGfx/StylePainter.h>
 #include <LibThreading/BackgroundAction.h>
+#include <LibThreading/WorkerPool.h>
+#include <unistd.h>
 
 namespace WindowServer {
 
@@ -41,6 +44,12 @@ static WallpaperMode mode_to_enum(const String& name)
     return WallpaperMode::Center;
 }
 
+static constexpr size_t max_compositor_worker_threads = 7;
+
+// Below this, waking up the worker threads costs more than it saves.
+static constexpr i64 min_pixels_to_compose_in_parallel = 128 * 128;
+static constexpr int compose_tile_height = 32;
+
 Compositor::Compositor()
 {
     m_display_link_notify_timer = add<Core::Timer>(
@@ -63,6 +72,9 @@ Compositor::Compositor()
         },
         this);
 
+    if (auto processor_count = sysconf(_SC_NPROCESSORS_ONLN); processor_count > 1)
+        m_worker_pool = make<Threading::WorkerPool>(min(static_cast<size_t>(processor_count - 1), max_compositor_worker_threads), "Compositor");
+
     init_bitmaps();
 }
 
@@ -169,9 +181,18 @@ void Compositor::compose()
         return;
     }
 
+    auto frame_start = Time::now_monotonic();
+    ScopeGuard record_frame_time = [&] {
+        did_compose_frame((Time::now_monotonic() - frame_start).to_microseconds());
+    };
+    m_frame_statistics.last_flush_rect_count = 0;
+    m_frame_statistics.last_coalesced_flush_rect_count = 0;
+
     if (m_occlusions_dirty) {
         m_occlusions_dirty = false;
+        auto occlusions_start = Time::now_monotonic();
         recompute_occlusions();
+        m_frame_statistics.last_occlusions_time_us = (Time::now_monotonic() - occlusions_start).to_microseconds();
     }
 
     // We should have recomputed occlusions if any overlay rects were changed
@@ -329,8 +350,7 @@ void Compositor::compose()
                 if (!screen_render_rect.is_empty()) {
                     dbgln_if(COMPOSE_DEBUG, "  render wallpaper opaque: {} on screen #{}", screen_render_rect, screen.index());
                     prepare_rect(screen, render_rect);
-                    auto& back_painter = *screen.compositor_screen_data().m_back_painter;
-                    paint_wallpaper(screen, back_painter, render_rect, screen_rect);
+                    screen.compositor_screen_data().m_compose_commands.append({ ComposeCommand::Target::BackBuffer, render_rect });
                 }
                 return IterationDecision::Continue;
             });
@@ -343,8 +363,7 @@ void Compositor::compose()
                 if (!screen_render_rect.is_empty()) {
                     dbgln_if(COMPOSE_DEBUG, "  render wallpaper transparent: {} on screen #{}", screen_render_rect, screen.index());
                     prepare_transparency_rect(screen, render_rect);
-                    auto& temp_painter = *screen.compositor_screen_data().m_temp_painter;
-                    paint_wallpaper(screen, temp_painter, render_rect, screen_rect);
+                    screen.compositor_screen_data().m_compose_commands.append({ ComposeCommand::Target::TemporaryBuffer, render_rect });
                 }
                 return IterationDecision::Continue;
             });
@@ -352,104 +371,106 @@ void Compositor::compose()
         });
     }
 
-    auto compose_window = [&](Window& window) -> IterationDecision {
-        if (window.screens().is_empty()) {
-            // This window doesn't intersect with any screens, so there's nothing to render
-            return IterationDecision::Continue;
-        }
+    // NOTE: This runs on the worker pool, so it must only read the window and paint into the given painter.
+    auto compose_window_rect = [&](Screen& screen, Gfx::Painter& painter, Window& window, const Gfx::IntRect& rect) {
         auto transition_offset = window_transition_offset(window);
         auto frame_rect = window.frame().render_rect().translated(transition_offset);
         auto window_rect = window.rect().translated(transition_offset);
         auto frame_rects = frame_rect.shatter(window_rect);
+        RefPtr<Gfx::Bitmap> backing_store = window.backing_store();
 
-        dbgln_if(COMPOSE_DEBUG, "  window {} frame rect: {}", window.title(), frame_rect);
+        if (!window.is_fullscreen()) {
+            rect.for_each_intersected(frame_rects, [&](const Gfx::IntRect& intersected_rect) {
+                Gfx::PainterStateSaver saver(painter);
+                painter.add_clip_rect(intersected_rect);
+                painter.translate(transition_offset);
+                dbgln_if(COMPOSE_DEBUG, "    render frame: {}", intersected_rect);
+                window.frame().paint(screen, painter, intersected_rect.translated(-transition_offset));
+                return IterationDecision::Continue;
+            });
+        }
 
-        RefPtr<Gfx::Bitmap> backing_store = window.backing_store();
-        auto compose_window_rect = [&](Screen& screen, Gfx::Painter& painter, const Gfx::IntRect& rect) {
-            if (!window.is_fullscreen()) {
-                rect.for_each_intersected(frame_rects, [&](const Gfx::IntRect& intersected_rect) {
-                    Gfx::PainterStateSaver saver(painter);
-                    painter.add_clip_rect(intersected_rect);
-                    painter.translate(transition_offset);
-                    dbgln_if(COMPOSE_DEBUG, "    render frame: {}", intersected_rect);
-                    window.frame().paint(screen, painter, intersected_rect.translated(-transition_offset));
-                    return IterationDecision::Continue;
-                });
-            }
+        auto clear_window_rect = [&](const Gfx::IntRect& clear_rect) {
+            auto fill_color = wm.palette().window();
+            if (!window.is_opaque())
+                fill_color.set_alpha(255 * window.opacity());
+            painter.fill_rect(clear_rect, fill_color);
+        };
 
-            auto clear_window_rect = [&](const Gfx::IntRect& clear_rect) {
-                auto fill_color = wm.palette().window();
-                if (!window.is_opaque())
-                    fill_color.set_alpha(255 * window.opacity());
-                painter.fill_rect(clear_rect, fill_color);
-            };
+        if (!backing_store) {
+            clear_window_rect(window_rect.intersected(rect));
+            return;
+        }
 
-            if (!backing_store) {
-                clear_window_rect(window_rect.intersected(rect));
-                return;
-            }
+        // Decide where we would paint this window's backing store.
+        // This is subtly different from widow.rect(), because window
+        // size may be different from its backing store size. This
+        // happens when the window has been resized and the client
+        // has not yet attached a new backing store. In this case,
+        // we want to try to blit the backing store at the same place
+        // it was previously, and fill the rest of the window with its
+        // background color.
+        Gfx::IntRect backing_rect;
+        backing_rect.set_size(backing_store->size());
+        switch (WindowManager::the().resize_direction_of_window(window)) {
+        case ResizeDirection::None:
+        case ResizeDirection::Right:
+        case ResizeDirection::Down:
+        case ResizeDirection::DownRight:
+            backing_rect.set_location(window_rect.location());
+            break;
+        case ResizeDirection::Left:
+        case ResizeDirection::Up:
+        case ResizeDirection::UpLeft:
+            backing_rect.set_right_without_resize(window_rect.right());
+            backing_rect.set_bottom_without_resize(window_rect.bottom());
+            break;
+        case ResizeDirection::UpRight:
+            backing_rect.set_left(window.rect().left());
+            backing_rect.set_bottom_without_resize(window_rect.bottom());
+            break;
+        case ResizeDirection::DownLeft:
+            backing_rect.set_right_without_resize(window_rect.right());
+            backing_rect.set_top(window_rect.top());
+            break;
+        }
 
-            // Decide where we would paint this window's backing store.
-            // This is subtly different from widow.rect(), because window
-            // size may be different from its backing store size. This
-            // happens when the window has been resized and the client
-            // has not yet attached a new backing store. In this case,
-            // we want to try to blit the backing store at the same place
-            // it was previously, and fill the rest of the window with its
-            // background color.
-            Gfx::IntRect backing_rect;
-            backing_rect.set_size(backing_store->size());
-            switch (WindowManager::the().resize_direction_of_window(window)) {
-            case ResizeDirection::None:
-            case ResizeDirection::Right:
-            case ResizeDirection::Down:
-            case ResizeDirection::DownRight:
-                backing_rect.set_location(window_rect.location());
-                break;
-            case ResizeDirection::Left:
-            case ResizeDirection::Up:
-            case ResizeDirection::UpLeft:
-                backing_rect.set_right_without_resize(window_rect.right());
-                backing_rect.set_bottom_without_resize(window_rect.bottom());
-                break;
-            case ResizeDirection::UpRight:
-                backing_rect.set_left(window.rect().left());
-                backing_rect.set_bottom_without_resize(window_rect.bottom());
-                break;
-            case ResizeDirection::DownLeft:
-                backing_rect.set_right_without_resize(window_rect.right());
-                backing_rect.set_top(window_rect.top());
-                break;
-            }
+        Gfx::IntRect dirty_rect_in_backing_coordinates = rect.intersected(window_rect)
+                                                             .intersected(backing_rect)
+                                                             .translated(-backing_rect.location());
 
-            Gfx::IntRect dirty_rect_in_backing_coordinates = rect.intersected(window_rect)
-                                                                 .intersected(backing_rect)
-                                                                 .translated(-backing_rect.location());
-
-            if (!dirty_rect_in_backing_coordinates.is_empty()) {
-                auto dst = backing_rect.location().translated(dirty_rect_in_backing_coordinates.location());
-
-                if (window.client() && window.client()->is_unresponsive()) {
-                    if (window.is_opaque()) {
-                        painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [](Color src) {
-                            return src.to_grayscale().darkened(0.75f);
-                        });
-                    } else {
-                        u8 alpha = 255 * window.opacity();
-                        painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [&](Color src) {
-                            auto color = src.to_grayscale().darkened(0.75f);
-                            color.set_alpha(alpha);
-                            return color;
-                        });
-                    }
+        if (!dirty_rect_in_backing_coordinates.is_empty()) {
+            auto dst = backing_rect.location().translated(dirty_rect_in_backing_coordinates.location());
+
+            if (window.client() && window.client()->is_unresponsive()) {
+                if (window.is_opaque()) {
+                    painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [](Color src) {
+                        return src.to_grayscale().darkened(0.75f);
+                    });
                 } else {
-                    painter.blit(dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity());
+                    u8 alpha = 255 * window.opacity();
+                    painter.blit_filtered(dst, *backing_store, dirty_rect_in_backing_coordinates, [&](Color src) {
+                        auto color = src.to_grayscale().darkened(0.75f);
+                        color.set_alpha(alpha);
+                        return color;
+                    });
                 }
+            } else {
+                painter.blit(dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity());
             }
+        }
 
-            for (auto background_rect : window_rect.shatter(backing_rect))
-                clear_window_rect(background_rect);
-        };
+        for (auto background_rect : window_rect.shatter(backing_rect))
+            clear_window_rect(background_rect);
+    };
+
+    auto compose_window = [&](Window& window) -> IterationDecision {
+        if (window.screens().is_empty()) {
+            // This window doesn't intersect with any screens, so there's nothing to render
+            return IterationDecision::Continue;
+        }
+
+        dbgln_if(COMPOSE_DEBUG, "  window {} frame rect: {}", window.title(), window.frame().render_rect().translated(window_transition_offset(window)));
 
         auto& dirty_rects = window.dirty_rects();
 
@@ -462,6 +483,12 @@ void Compositor::compose()
                 dbgln("    transparent: {}", r);
         }
 
+        // The frame is painted from its rendered cache, which has to be brought up to date before any tile is painted.
+        if (!dirty_rects.is_empty() && !window.is_fullscreen()) {
+            for (auto* screen : window.screens())
+                window.frame().render_to_cache(*screen);
+        }
+
         // Render opaque portions directly to the back buffer
         auto& opaque_rects = window.opaque_rects();
         if (!opaque_rects.is_empty()) {
@@ -473,10 +500,7 @@ void Compositor::compose()
                     dbgln_if(COMPOSE_DEBUG, "    render opaque: {} on screen #{}", screen_render_rect, screen->index());
 
                     prepare_rect(*screen, screen_render_rect);
-                    auto& back_painter = *screen->compositor_screen_data().m_back_painter;
-                    Gfx::PainterStateSaver saver(back_painter);
-                    back_painter.add_clip_rect(screen_render_rect);
-                    compose_window_rect(*screen, back_painter, screen_render_rect);
+                    screen->compositor_screen_data().m_compose_commands.append({ ComposeCommand::Target::BackBuffer, screen_render_rect, &window });
                 }
                 return IterationDecision::Continue;
             });
@@ -494,9 +518,8 @@ void Compositor::compose()
                         continue;
                     dbgln_if(COMPOSE_DEBUG, "    render wallpaper: {} on screen #{}", screen_render_rect, screen->index());
 
-                    auto& temp_painter = *screen->compositor_screen_data().m_temp_painter;
                     prepare_transparency_rect(*screen, screen_render_rect);
-                    paint_wallpaper(*screen, temp_painter, screen_render_rect, screen_rect);
+                    screen->compositor_screen_data().m_compose_commands.append({ ComposeCommand::Target::TemporaryBuffer, screen_render_rect });
                 }
                 return IterationDecision::Continue;
             });
@@ -512,10 +535,7 @@ void Compositor::compose()
                     dbgln_if(COMPOSE_DEBUG, "    render transparent: {} on screen #{}", screen_render_rect, screen->index());
 
                     prepare_transparency_rect(*screen, screen_render_rect);
-                    auto& temp_painter = *screen->compositor_screen_data().m_temp_painter;
-                    Gfx::PainterStateSaver saver(temp_painter);
-                    temp_painter.add_clip_rect(screen_render_rect);
-                    compose_window_rect(*screen, temp_painter, screen_render_rect);
+                    screen->compositor_screen_data().m_compose_commands.append({ ComposeCommand::Target::TemporaryBuffer, screen_render_rect, &window });
                 }
                 return IterationDecision::Continue;
             });
@@ -523,6 +543,52 @@ void Compositor::compose()
         return IterationDecision::Continue;
     };
 
+    // Replays the recorded painting of a screen, one horizontal tile at a time. Every tile gets its own
+    // painters, and the tiles don't overlap, so they can be painted on the worker pool.
+    auto paint_compose_commands = [&](Screen& screen) {
+        auto& screen_data = screen.compositor_screen_data();
+        auto& commands = screen_data.m_compose_commands;
+        if (commands.is_empty())
+            return;
+
+        auto screen_rect = screen.rect();
+        Gfx::IntRect bounds;
+        for (auto& command : commands)
+            bounds = bounds.united(command.rect.intersected(screen_rect));
+
+        auto paint_tile = [&](Gfx::IntRect const& tile) {
+            Gfx::Painter back_painter(*screen_data.m_back_bitmap);
+            back_painter.translate(-screen_rect.location());
+            back_painter.add_clip_rect(tile);
+            Gfx::Painter temp_painter(*screen_data.m_temp_bitmap);
+            temp_painter.translate(-screen_rect.location());
+            temp_painter.add_clip_rect(tile);
+
+            for (auto& command : commands) {
+                if (!command.rect.intersects(tile))
+                    continue;
+                auto& painter = command.target == ComposeCommand::Target::BackBuffer ? back_painter : temp_painter;
+                Gfx::PainterStateSaver saver(painter);
+                painter.add_clip_rect(command.rect);
+                if (command.window)
+                    compose_window_rect(screen, painter, *command.window, command.rect);
+                else
+                    paint_wallpaper(screen, painter, command.rect, screen_rect);
+            }
+        };
+
+        if (!m_worker_pool || static_cast<i64>(bounds.width()) * bounds.height() < min_pixels_to_compose_in_parallel) {
+            paint_tile(bounds);
+        } else {
+            size_t tile_count = (bounds.height() + compose_tile_height - 1) / compose_tile_height;
+            m_worker_pool->for_each_index(tile_count, [&](size_t tile_index) {
+                Gfx::IntRect tile { bounds.x(), bounds.y() + static_cast<int>(tile_index) * compose_tile_height, bounds.width(), compose_tile_height };
+                paint_tile(tile.intersected(bounds));
+            });
+        }
+        commands.clear_with_capacity();
+    };
+
     // Paint the window stack.
     if (m_invalidated_window) {
         auto* fullscreen_window = wm.active_fullscreen_window();
@@ -536,7 +602,14 @@ void Compositor::compose()
                 return IterationDecision::Continue;
             });
         }
+    }
+
+    Screen::for_each([&](auto& screen) {
+        paint_compose_commands(screen);
+        return IterationDecision::Continue;
+    });
 
+    if (m_invalidated_window) {
         // Check that there are no overlapping transparent and opaque flush rectangles
         VERIFY(![&]() {
             bool is_overlapping = false;
@@ -567,8 +640,11 @@ void Compositor::compose()
         Screen::for_each([&](auto& screen) {
             auto screen_rect = screen.rect();
             auto& screen_data = screen.compositor_screen_data();
+            Vector<Gfx::IntRect, 32> physical_rects;
+            physical_rects.ensure_capacity(screen_data.m_flush_transparent_rects.size());
             for (auto& rect : screen_data.m_flush_transparent_rects.rects())
-                screen_data.m_back_painter->blit(rect.location(), *screen_data.m_temp_bitmap, rect.translated(-screen_rect.location()));
+                physical_rects.unchecked_append(rect.translated(-screen_rect.location()) * screen.scale_factor());
+            copy_rects(*screen_data.m_back_bitmap, *screen_data.m_temp_bitmap, physical_rects);
             return IterationDecision::Continue;
         });
     }
@@ -601,6 +677,96 @@ void Compositor::compose()
     });
 }
 
+void Compositor::did_compose_frame(u32 frame_time_us)
+{
+    auto& statistics = m_frame_statistics;
+    ++statistics.frame_count;
+    if (frame_time_us > frame_budget_us)
+        ++statistics.frames_over_budget;
+    statistics.last_frame_time_us = frame_time_us;
+    statistics.max_frame_time_us = max(statistics.max_frame_time_us, frame_time_us);
+    // An exponential moving average, so that a single slow frame doesn't dominate for long.
+    if (statistics.frame_count == 1)
+        statistics.average_frame_time_us = frame_time_us;
+    else
+        statistics.average_frame_time_us = (statistics.average_frame_time_us * 7 + frame_time_us) / 8;
+}
+
+// Copying a rect to or from the screen costs about as much as copying this many extra pixels,
+// between setting up the copy, walking the scanlines and telling the device about it.
+static constexpr i64 flush_rect_overhead_in_pixels = 64 * 64;
+static constexpr size_t max_flush_rects_to_coalesce = 128;
+
+// Below this, waking up the worker threads costs more than it saves.
+static constexpr i64 min_pixels_to_copy_in_parallel = 256 * 256;
+static constexpr int copy_band_height = 64;
+
+static i64 area_of(Gfx::IntRect const& rect)
+{
+    return static_cast<i64>(rect.width()) * rect.height();
+}
+
+// Animations and moving windows tend to produce lots of small flush rects right next to each other.
+// Merge any two of them whenever copying their bounding rect is cheaper than copying both separately.
+// The merged rects may overlap, which is fine since the same pixels are copied either way.
+static void coalesce_flush_rects(Vector<Gfx::IntRect, 32>& rects)
+{
+    if (rects.size() < 2 || rects.size() > max_flush_rects_to_coalesce)
+        return;
+
+    bool did_merge;
+    do {
+        did_merge = false;
+        for (size_t i = 0; i < rects.size(); ++i) {
+            for (size_t j = i + 1; j < rects.size();) {
+                auto united = rects[i].united(rects[j]);
+                if (area_of(united) - area_of(rects[i]) - area_of(rects[j]) > flush_rect_overhead_in_pixels) {
+                    ++j;
+                    continue;
+                }
+                rects[i] = united;
+                rects.remove(j);
+                did_merge = true;
+                j = i + 1;
+            }
+        }
+    } while (did_merge);
+}
+
+static void copy_rect_between_bitmaps(Gfx::Bitmap& to, Gfx::Bitmap const& from, Gfx::IntRect const& physical_rect)
+{
+    for (int y = physical_rect.top(); y <= physical_rect.bottom(); ++y)
+        fast_u32_copy(to.scanline(y) + physical_rect.x(), from.scanline(y) + physical_rect.x(), physical_rect.width());
+}
+
+void Compositor::copy_rects(Gfx::Bitmap& to, Gfx::Bitmap const& from, Span<Gfx::IntRect const> physical_rects)
+{
+    i64 total_pixels = 0;
+    Gfx::IntRect bounds;
+    for (auto& rect : physical_rects) {
+        total_pixels += area_of(rect);
+        bounds = bounds.united(rect);
+    }
+
+    if (!m_worker_pool || total_pixels < min_pixels_to_copy_in_parallel) {
+        for (auto& rect : physical_rects)
+            copy_rect_between_bitmaps(to, from, rect);
+        return;
+    }
+
+    // Hand out horizontal bands rather than whole rects, so that the work is spread evenly
+    // and rects that overlap are always copied by the same thread.
+    size_t band_count = (bounds.height() + copy_band_height - 1) / copy_band_height;
+    m_worker_pool->for_each_index(band_count, [&](size_t band_index) {
+        Gfx::IntRect band { bounds.x(), bounds.y() + static_cast<int>(band_index) * copy_band_height, bounds.width(), copy_band_height };
+        for (auto& rect : physical_rects) {
+            auto part = rect.intersected(band);
+            if (!part.is_empty())
+                copy_rect_between_bitmaps(to, from, part);
+        }
+    });
+}
+
 void Compositor::flush(Screen& screen)
 {
     auto& screen_data = screen.compositor_screen_data();
@@ -634,21 +800,26 @@ void Compositor::flush(Screen& screen)
         }
     }
 
-    if (device_can_flush_buffers && screen_data.m_screen_can_set_buffer) {
-        if (!screen_data.m_has_flipped) {
-            // If we have not flipped any buffers before, we should be flushing
-            // the entire buffer to make sure that the device has all the bits we wrote
-            screen_data.m_flush_rects = { screen.rect() };
-        }
+    if (device_can_flush_buffers && screen_data.m_screen_can_set_buffer && !screen_data.m_has_flipped) {
+        // If we have not flipped any buffers before, we should be flushing
+        // the entire buffer to make sure that the device has all the bits we wrote
+        screen_data.m_flush_rects = { screen.rect() };
+    }
 
+    Vector<Gfx::IntRect, 32> flush_rects;
+    flush_rects.ensure_capacity(screen_data.m_flush_rects.size() + screen_data.m_flush_transparent_rects.size() + screen_data.m_flush_special_rects.size());
+    flush_rects.extend(screen_data.m_flush_rects.rects());
+    flush_rects.extend(screen_data.m_flush_transparent_rects.rects());
+    flush_rects.extend(screen_data.m_flush_special_rects.rects());
+    m_frame_statistics.last_flush_rect_count += flush_rects.size();
+    coalesce_flush_rects(flush_rects);
+    m_frame_statistics.last_coalesced_flush_rect_count += flush_rects.size();
+
+    if (device_can_flush_buffers && screen_data.m_screen_can_set_buffer) {
         // If we also support buffer flipping we need to make sure we transfer all
         // updated areas to the device before we flip. We already modified the framebuffer
         // memory, but the device needs to know what areas we actually did update.
-        for (auto& rect : screen_data.m_flush_rects.rects())
-            screen.queue_flush_display_rect(rect.translated(-screen_rect.location()));
-        for (auto& rect : screen_data.m_flush_transparent_rects.rects())
-            screen.queue_flush_display_rect(rect.translated(-screen_rect.location()));
-        for (auto& rect : screen_data.m_flush_special_rects.rects())
+        for (auto& rect : flush_rects)
             screen.queue_flush_display_rect(rect.translated(-screen_rect.location()));
 
         screen.flush_display((!screen_data.m_screen_can_set_buffer || screen_data.m_buffers_are_flipped) ? 0 : 1);
@@ -659,56 +830,34 @@ void Compositor::flush(Screen& screen)
         screen_data.m_has_flipped = true;
     }
 
-    auto do_flush = [&](Gfx::IntRect rect) {
+    // NOTE: The meaning of a flush depends on whether we can flip buffers or not.
+    //
+    //       If flipping is supported, flushing means that we've flipped, and now we
+    //       copy the changed bits from the front buffer to the back buffer, to keep
+    //       them in sync.
+    //
+    //       If flipping is not supported, flushing means that we copy the changed
+    //       rects from the backing bitmap to the display framebuffer.
+    auto& to_bitmap = screen_data.m_screen_can_set_buffer ? *screen_data.m_back_bitmap : *screen_data.m_front_bitmap;
+    auto& from_bitmap = screen_data.m_screen_can_set_buffer ? *screen_data.m_front_bitmap : *screen_data.m_back_bitmap;
+
+    // Almost everything in Compositor is in logical coordinates, with the painters having
+    // a scale applied. But copying accesses the pixels directly, so it must work in physical coordinates.
+    Vector<Gfx::IntRect, 32> physical_flush_rects;
+    physical_flush_rects.ensure_capacity(flush_rects.size());
+    for (auto& rect : flush_rects) {
         VERIFY(screen_rect.contains(rect));
-        rect.translate_by(-screen_rect.location());
-
-        // Almost everything in Compositor is in logical coordinates, with the painters having
-        // a scale applied. But this routine accesses the backbuffer pixels directly, so it
-        // must work in physical coordinates.
-        auto scaled_rect = rect * screen.scale_factor();
-        Gfx::RGBA32* front_ptr = screen_data.m_front_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
-        Gfx::RGBA32* back_ptr = screen_data.m_back_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
-        size_t pitch = screen_data.m_back_bitmap->pitch();
-
-        // NOTE: The meaning of a flush depends on whether we can flip buffers or not.
-        //
-        //       If flipping is supported, flushing means that we've flipped, and now we
-        //       copy the changed bits from the front buffer to the back buffer, to keep
-        //       them in sync.
-        //
-        //       If flipping is not supported, flushing means that we copy the changed
-        //       rects from the backing bitmap to the display framebuffer.
-
-        Gfx::RGBA32* to_ptr;
-        const Gfx::RGBA32* from_ptr;
-
-        if (screen_data.m_screen_can_set_buffer) {
-            to_ptr = back_ptr;
-            from_ptr = front_ptr;
-        } else {
-            to_ptr = front_ptr;
-            from_ptr = back_ptr;
-        }
+        physical_flush_rects.unchecked_append(rect.translated(-screen_rect.location()) * screen.scale_factor());
+    }
+    copy_rects(to_bitmap, from_bitmap, physical_flush_rects);
 
-        for (int y = 0; y < scaled_rect.height(); ++y) {
-            fast_u32_copy(to_ptr, from_ptr, scaled_rect.width());
-            from_ptr = (const Gfx::RGBA32*)((const u8*)from_ptr + pitch);
-            to_ptr = (Gfx::RGBA32*)((u8*)to_ptr + pitch);
-        }
-        if (device_can_flush_buffers) {
-            // Whether or not we need to flush buffers, we need to at least track what we modified
-            // so that we can flush these areas next time before we flip buffers. Or, if we don't
-            // support buffer flipping then we will flush them shortly.
-            screen.queue_flush_display_rect(rect);
-        }
-    };
-    for (auto& rect : screen_data.m_flush_rects.rects())
-        do_flush(rect);
-    for (auto& rect : screen_data.m_flush_transparent_rects.rects())
-        do_flush(rect);
-    for (auto& rect : screen_data.m_flush_special_rects.rects())
-        do_flush(rect);
+    if (device_can_flush_buffers) {
+        // Whether or not we need to flush buffers, we need to at least track what we modified
+        // so that we can flush these areas next time before we flip buffers. Or, if we don't
+        // support buffer flipping then we will flush them shortly.
+        for (auto& rect : flush_rects)
+            screen.queue_flush_display_rect(rect.translated(-screen_rect.location()));
+    }
     if (device_can_flush_buffers && !screen_data.m_screen_can_set_buffer) {
         // If we also support flipping buffers we don't really need to flush these areas right now.
         // Instead, we skip this step and just keep track of them until shortly before the next flip.
@@ -1184,8 +1333,8 @@ void Compositor::recompute_occlusions()
             w.screens().clear_with_capacity();
 
             auto transition_offset = window_transition_offset(w);
-            auto transparent_frame_render_rects = w.frame().transparent_render_rects();
-            auto opaque_frame_render_rects = w.frame().opaque_render_rects();
+            auto transparent_frame_render_rects = w.frame().transparent_render_rects().clone();
+            auto opaque_frame_render_rects = w.frame().opaque_render_rects().clone();
             if (window_stack_transition_in_progress) {
                 transparent_frame_render_rects.translate_by(transition_offset);
                 opaque_frame_render_rects.translate_by(transition_offset);
@@ -1224,15 +1373,15 @@ void Compositor::recompute_occlusions()
                 if (!render_rect_on_screen.intersects(w2_render_rect_on_screen))
                     return IterationDecision::Continue;
 
-                auto opaque_rects = w2.frame().opaque_render_rects();
-                auto transparent_rects = w2.frame().transparent_render_rects();
-                if (window_stack_transition_in_progress) {
-                    auto transition_offset_2 = window_transition_offset(w2);
-                    opaque_rects.translate_by(transition_offset_2);
-                    transparent_rects.translate_by(transition_offset_2);
-                }
-                opaque_rects = opaque_rects.intersected(render_rect_on_screen);
-                transparent_rects = transparent_rects.intersected(render_rect_on_screen);
+                // Intersect the cached rects first and only translate what's left of them.
+                Gfx::IntPoint transition_offset_2;
+                if (window_stack_transition_in_progress)
+                    transition_offset_2 = window_transition_offset(w2);
+                auto render_rect_in_w2_space = render_rect_on_screen.translated(-transition_offset_2);
+                auto opaque_rects = w2.frame().opaque_render_rects().intersected(render_rect_in_w2_space);
+                auto transparent_rects = w2.frame().transparent_render_rects().intersected(render_rect_in_w2_space);
+                opaque_rects.translate_by(transition_offset_2);
+                transparent_rects.translate_by(transition_offset_2);
                 if (opaque_rects.is_empty() && transparent_rects.is_empty())
                     return IterationDecision::Continue;
                 VERIFY(!opaque_rects.intersects(transparent_rects));
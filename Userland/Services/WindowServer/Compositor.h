@@ -8,12 +8,17 @@
 
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
+#include <AK/Vector.h>
 #include <LibCore/Object.h>
 #include <LibGfx/Color.h>
 #include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Font.h>
 #include <WindowServer/Overlays.h>
 
+namespace Threading {
+class WorkerPool;
+}
+
 namespace WindowServer {
 
 class Animation;
@@ -32,6 +37,19 @@ enum class WallpaperMode {
     Unchecked
 };
 
+// Something compose() paints into a screen's back or temporary buffer. Painting is recorded first
+// and then replayed in order for every tile of the screen, which lets the tiles be painted in parallel.
+struct ComposeCommand {
+    enum class Target {
+        BackBuffer,
+        TemporaryBuffer,
+    };
+    Target target;
+    Gfx::IntRect rect;
+    // The window to paint within rect, or the wallpaper if this is null.
+    Window* window { nullptr };
+};
+
 struct CompositorScreenData {
     RefPtr<Gfx::Bitmap> m_front_bitmap;
     RefPtr<Gfx::Bitmap> m_back_bitmap;
@@ -54,6 +72,8 @@ struct CompositorScreenData {
     Gfx::DisjointRectSet m_flush_transparent_rects;
     Gfx::DisjointRectSet m_flush_special_rects;
 
+    Vector<ComposeCommand> m_compose_commands;
+
     Gfx::Painter& overlay_painter() { return *m_temp_painter; }
 
     void init_bitmaps(Compositor&, Screen&);
@@ -85,12 +105,25 @@ struct CompositorScreenData {
     }
 };
 
+struct CompositorFrameStatistics {
+    u64 frame_count { 0 };
+    u64 frames_over_budget { 0 };
+    u32 last_frame_time_us { 0 };
+    u32 average_frame_time_us { 0 };
+    u32 max_frame_time_us { 0 };
+    u32 last_occlusions_time_us { 0 };
+    u32 last_flush_rect_count { 0 };
+    u32 last_coalesced_flush_rect_count { 0 };
+};
+
 class Compositor final : public Core::Object {
     C_OBJECT(Compositor)
     friend struct CompositorScreenData;
     friend class Overlay;
 
 public:
+    static constexpr u32 frame_budget_us = 1'000'000 / 60;
+
     static Compositor& the();
 
     void compose();
@@ -182,6 +215,8 @@ public:
 
     void set_flash_flush(bool b) { m_flash_flush = b; }
 
+    CompositorFrameStatistics const& frame_statistics() const { return m_frame_statistics; }
+
     static NonnullOwnPtr<CompositorScreenData> create_screen_data(Badge<Screen>)
     {
         return adopt_own(*new CompositorScreenData());
@@ -203,6 +238,8 @@ private:
     void recompute_occlusions();
     void change_cursor(const Cursor*);
     void flush(Screen&);
+    void copy_rects(Gfx::Bitmap& to, Gfx::Bitmap const& from, Span<Gfx::IntRect const> physical_rects);
+    void did_compose_frame(u32 frame_time_us);
     Gfx::IntPoint window_transition_offset(Window&);
     void update_animations(Screen&, Gfx::DisjointRectSet& flush_rects);
     void create_window_stack_switch_overlay(WindowStack&);
@@ -247,6 +284,11 @@ private:
     Optional<Gfx::Color> m_custom_background_color;
 
     HashTable<Animation*> m_animations;
+
+    CompositorFrameStatistics m_frame_statistics;
+
+    // Helps with copying pixels around, which is most of the work that doesn't touch shared painter state.
+    OwnPtr<Threading::WorkerPool> m_worker_pool;
 };
 
 }
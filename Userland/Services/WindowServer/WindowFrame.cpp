@@ -538,38 +538,87 @@ Gfx::IntRect WindowFrame::unconstrained_render_rect() const
     return inflated_for_shadow(rect());
 }
 
-Gfx::DisjointRectSet WindowFrame::opaque_render_rects() const
+auto WindowFrame::render_rects_key() const -> RenderRectsKey
 {
-    if (has_alpha_channel()) {
-        if (m_window.is_opaque())
-            return constrained_render_rect_to_screen(m_window.rect());
+    auto frame_rect = rect();
+    return {
+        .window_rect = m_window.rect(),
+        .frame_rect = frame_rect,
+        .render_rect = render_rect(),
+        .constrained_window_rect = constrained_render_rect_to_screen(m_window.rect()),
+        .constrained_frame_rect = constrained_render_rect_to_screen(frame_rect),
+        .has_alpha_channel = has_alpha_channel(),
+        .is_window_opaque = m_window.is_opaque(),
+        .has_shadow = has_shadow(),
+    };
+}
+
+Optional<Gfx::IntPoint> WindowFrame::RenderRectsKey::translation_to(RenderRectsKey const& other) const
+{
+    if (has_alpha_channel != other.has_alpha_channel || is_window_opaque != other.is_window_opaque || has_shadow != other.has_shadow)
         return {};
-    }
-    if (m_window.is_opaque())
-        return constrained_render_rect_to_screen(rect());
-    Gfx::DisjointRectSet opaque_rects;
-    opaque_rects.add_many(constrained_render_rect_to_screen(rect()).shatter(m_window.rect()));
-    return opaque_rects;
+    auto delta = other.window_rect.location() - window_rect.location();
+    auto is_translated = [&](Gfx::IntRect const& a, Gfx::IntRect const& b) {
+        return a.size() == b.size() && b.location() - a.location() == delta;
+    };
+    if (!is_translated(window_rect, other.window_rect) || !is_translated(frame_rect, other.frame_rect) || !is_translated(render_rect, other.render_rect))
+        return {};
+    if (!is_translated(constrained_window_rect, other.constrained_window_rect) || !is_translated(constrained_frame_rect, other.constrained_frame_rect))
+        return {};
+    return delta;
 }
 
-Gfx::DisjointRectSet WindowFrame::transparent_render_rects() const
+void WindowFrame::update_render_rects_cache() const
 {
-    if (has_alpha_channel()) {
-        if (m_window.is_opaque()) {
-            Gfx::DisjointRectSet transparent_rects;
-            transparent_rects.add_many(render_rect().shatter(m_window.rect()));
-            return transparent_rects;
+    auto key = render_rects_key();
+    if (m_render_rects_key.has_value()) {
+        if (*m_render_rects_key == key)
+            return;
+        // Moving a window doesn't change the shape of its render rects, so there's no need to shatter them again.
+        if (auto delta = m_render_rects_key->translation_to(key); delta.has_value()) {
+            m_opaque_render_rects.translate_by(*delta);
+            m_transparent_render_rects.translate_by(*delta);
+            m_render_rects_key = key;
+            return;
         }
-        return render_rect();
     }
 
-    auto total_render_rect = render_rect();
-    Gfx::DisjointRectSet transparent_rects;
-    if (has_shadow())
-        transparent_rects.add_many(total_render_rect.shatter(rect()));
-    if (!m_window.is_opaque())
-        transparent_rects.add(m_window.rect().intersected(total_render_rect));
-    return transparent_rects;
+    m_opaque_render_rects.clear_with_capacity();
+    if (key.has_alpha_channel) {
+        if (key.is_window_opaque)
+            m_opaque_render_rects.add(key.constrained_window_rect);
+    } else if (key.is_window_opaque) {
+        m_opaque_render_rects.add(key.constrained_frame_rect);
+    } else {
+        m_opaque_render_rects.add_many(key.constrained_frame_rect.shatter(key.window_rect));
+    }
+
+    m_transparent_render_rects.clear_with_capacity();
+    if (key.has_alpha_channel) {
+        if (key.is_window_opaque)
+            m_transparent_render_rects.add_many(key.render_rect.shatter(key.window_rect));
+        else
+            m_transparent_render_rects.add(key.render_rect);
+    } else {
+        if (key.has_shadow)
+            m_transparent_render_rects.add_many(key.render_rect.shatter(key.frame_rect));
+        if (!key.is_window_opaque)
+            m_transparent_render_rects.add(key.window_rect.intersected(key.render_rect));
+    }
+
+    m_render_rects_key = key;
+}
+
+Gfx::DisjointRectSet const& WindowFrame::opaque_render_rects() const
+{
+    update_render_rects_cache();
+    return m_opaque_render_rects;
+}
+
+Gfx::DisjointRectSet const& WindowFrame::transparent_render_rects() const
+{
+    update_render_rects_cache();
+    return m_transparent_render_rects;
 }
 
 void WindowFrame::invalidate_titlebar()
@@ -11,6 +11,7 @@
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/RefPtr.h>
 #include <LibCore/Forward.h>
+#include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Forward.h>
 #include <LibGfx/WindowTheme.h>
 
@@ -56,8 +57,8 @@ public:
     Gfx::IntRect rect() const;
     Gfx::IntRect render_rect() const;
     Gfx::IntRect unconstrained_render_rect() const;
-    Gfx::DisjointRectSet opaque_render_rects() const;
-    Gfx::DisjointRectSet transparent_render_rects() const;
+    Gfx::DisjointRectSet const& opaque_render_rects() const;
+    Gfx::DisjointRectSet const& transparent_render_rects() const;
 
     void paint(Screen&, Gfx::Painter&, const Gfx::IntRect&);
     void render(Screen&, Gfx::Painter&);
@@ -137,6 +138,23 @@ private:
 
     Gfx::IntRect constrained_render_rect_to_screen(const Gfx::IntRect&) const;
 
+    // Everything the opaque and transparent render rects are derived from.
+    struct RenderRectsKey {
+        Gfx::IntRect window_rect;
+        Gfx::IntRect frame_rect;
+        Gfx::IntRect render_rect;
+        Gfx::IntRect constrained_window_rect;
+        Gfx::IntRect constrained_frame_rect;
+        bool has_alpha_channel { false };
+        bool is_window_opaque { false };
+        bool has_shadow { false };
+
+        bool operator==(RenderRectsKey const&) const = default;
+        Optional<Gfx::IntPoint> translation_to(RenderRectsKey const&) const;
+    };
+    RenderRectsKey render_rects_key() const;
+    void update_render_rects_cache() const;
+
     Window& m_window;
     NonnullOwnPtrVector<Button> m_buttons;
     Button* m_close_button { nullptr };
@@ -149,6 +167,11 @@ private:
     size_t m_flash_counter { 0 };
     float m_opacity { 1 };
     bool m_has_alpha_channel { false };
+
+    // The compositor asks for these for every pair of overlapping windows whenever it recomputes occlusions.
+    mutable Optional<RenderRectsKey> m_render_rects_key;
+    mutable Gfx::DisjointRectSet m_opaque_render_rects;
+    mutable Gfx::DisjointRectSet m_transparent_render_rects;
 };
 
 }
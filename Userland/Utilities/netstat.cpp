@@ -46,6 +46,7 @@ int main(int argc, char** argv)
     bool flag_tcp = false;
     bool flag_udp = false;
     bool flag_program = false;
+    bool flag_extended = false;
 
     Core::ArgsParser args_parser;
     args_parser.set_general_help("Display network connections");
@@ -54,6 +55,7 @@ int main(int argc, char** argv)
     args_parser.add_option(flag_tcp, "Display only TCP network connections", "tcp", 't');
     args_parser.add_option(flag_udp, "Display only UDP network connections", "udp", 'u');
     args_parser.add_option(flag_program, "Show the PID and name of the program to which each socket belongs", "program", 'p');
+    args_parser.add_option(flag_extended, "Show the congestion window and round-trip time of TCP connections", "extended", 'e');
     args_parser.parse(argc, argv);
 
     bool has_protocol_flag = (flag_tcp || flag_udp);
@@ -93,6 +95,8 @@ int main(int argc, char** argv)
     int peer_address_column = -1;
     int state_column = -1;
     int program_column = -1;
+    int congestion_window_column = -1;
+    int rtt_column = -1;
 
     auto add_column = [&](auto title, auto alignment, auto width) {
         columns.append({ title, alignment, width, {} });
@@ -105,6 +109,8 @@ int main(int argc, char** argv)
     local_address_column = add_column("Local Address", Alignment::Left, 20);
     peer_address_column = add_column("Peer Address", Alignment::Left, 20);
     state_column = add_column("State", Alignment::Left, 11);
+    congestion_window_column = flag_extended ? add_column("Cwnd", Alignment::Right, 9) : -1;
+    rtt_column = flag_extended ? add_column("RTT", Alignment::Right, 9) : -1;
     program_column = flag_program ? add_column("PID/Program", Alignment::Left, 11) : -1;
 
     auto print_column = [](auto& column, auto& string) {
@@ -177,12 +183,18 @@ int main(int argc, char** argv)
             auto formatted_local_address = String::formatted("{}:{}", local_address, local_port);
             auto state = if_object.get("state").to_string();
             auto origin_pid = (if_object.has("origin_pid")) ? if_object.get("origin_pid").to_u32() : -1;
+            auto congestion_window = if_object.get("congestion_window").to_string();
+            auto smoothed_rtt_us = if_object.get("smoothed_rtt_us").to_u32();
 
             if (!flag_all && ((state == "Listen" && !flag_list) || (state != "Listen" && flag_list)))
                 continue;
 
             if (protocol_column != -1)
                 columns[protocol_column].buffer = "tcp";
+            if (congestion_window_column != -1)
+                columns[congestion_window_column].buffer = congestion_window;
+            if (rtt_column != -1)
+                columns[rtt_column].buffer = smoothed_rtt_us ? String::formatted("{}.{:03}ms", smoothed_rtt_us / 1000, smoothed_rtt_us % 1000) : "-";
             if (bytes_in_column != -1)
                 columns[bytes_in_column].buffer = bytes_in;
             if (bytes_out_column != -1)
@@ -239,6 +251,10 @@ int main(int argc, char** argv)
                 columns[peer_address_column].buffer = String::formatted("{}:{}", peer_address, peer_port);
             if (state_column != -1)
                 columns[state_column].buffer = "-";
+            if (congestion_window_column != -1)
+                columns[congestion_window_column].buffer = "-";
+            if (rtt_column != -1)
+                columns[rtt_column].buffer = "-";
             if (flag_program && program_column != -1)
                 columns[program_column].buffer = get_formatted_program(origin_pid);
 
@@ -13,12 +13,24 @@ int main(int argc, char** argv)
     auto app = GUI::Application::construct(argc, argv);
 
     int flash_flush = -1;
+    bool show_statistics = false;
     Core::ArgsParser args_parser;
     args_parser.add_option(flash_flush, "Flash flush (repaint) rectangles", "flash-flush", 'f', "0/1");
+    args_parser.add_option(show_statistics, "Show compositor frame statistics", "statistics", 's');
     args_parser.parse(argc, argv);
 
     if (flash_flush != -1) {
         GUI::WindowServerConnection::the().async_set_flash_flush(flash_flush);
     }
+    if (show_statistics) {
+        auto statistics = GUI::WindowServerConnection::the().get_compositor_statistics();
+        outln("Frames composed:      {}", statistics.frame_count());
+        outln("Frames over budget:   {}", statistics.frames_over_budget());
+        outln("Last frame time:      {} us", statistics.last_frame_time_us());
+        outln("Average frame time:   {} us", statistics.average_frame_time_us());
+        outln("Max frame time:       {} us", statistics.max_frame_time_us());
+        outln("Last occlusions time: {} us", statistics.last_occlusions_time_us());
+        outln("Last flush rects:     {} ({} after coalescing)", statistics.last_flush_rect_count(), statistics.last_coalesced_flush_rect_count());
+    }
     return 0;
 }